@@ -0,0 +1,443 @@
+// audio_analyzer.h - ShaderToy-style 512x2 sound texture (// @audio iChannel source)
+//
+// Row 0 holds the FFT magnitude spectrum, row 1 the waveform, both as 8-bit values with
+// the same mapping as WebAudio's AnalyserNode (which is what ShaderToy samples).
+//
+// A worker thread reads samples from a WAV file (or any FFmpeg-readable file such as OGG,
+// or a capture device via libavdevice when built with it), runs a windowed radix-2 FFT,
+// and publishes each finished 512x2 texture through a lock-free triple buffer. The render
+// thread only ever picks up the latest published texture; it never waits on the analyzer.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef HAVE_FFMPEG
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#ifdef HAVE_AVDEVICE
+#include <libavdevice/avdevice.h>
+#endif
+}
+#endif
+
+// Lock-free single-producer/single-consumer "latest value" buffer.
+// The producer fills back(), then publish() swaps it with the shared middle slot;
+// the consumer's update() swaps the middle slot into front() only if something new arrived.
+template <typename T>
+class TripleBuffer {
+public:
+    T& back() { return buffers[backIndex]; }
+    const T& front() const { return buffers[frontIndex]; }
+
+    void publish() {
+        int previous = middle.exchange(backIndex | DIRTY, std::memory_order_acq_rel);
+        backIndex = previous & INDEX_MASK;
+    }
+
+    // Returns true if front() changed since the last call
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & DIRTY)) {
+            return false;
+        }
+        int previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+private:
+    static const int DIRTY = 4;
+    static const int INDEX_MASK = 3;
+    T buffers[3];
+    std::atomic<int> middle{1};
+    int backIndex = 0;   // Producer only
+    int frontIndex = 2;  // Consumer only
+};
+
+// In-place iterative radix-2 FFT on split real/imaginary arrays.
+// Twiddles are precomputed per stage and laid out contiguously, so the inner butterfly
+// loop is a straight run over unit-stride float arrays that compilers vectorise
+// (SSE/AVX on x86, NEON on Apple Silicon).
+class RadixTwoFFT {
+public:
+    explicit RadixTwoFFT(int size) : n(size), bitReverse(size) {
+        int bits = 0;
+        while ((1 << bits) < n) bits++;
+        for (int i = 0; i < n; i++) {
+            int r = 0;
+            for (int b = 0; b < bits; b++) {
+                r |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            bitReverse[i] = r;
+        }
+        for (int half = 1; half < n; half *= 2) {
+            for (int j = 0; j < half; j++) {
+                double angle = -M_PI * j / half;
+                twiddleRe.push_back((float)std::cos(angle));
+                twiddleIm.push_back((float)std::sin(angle));
+            }
+        }
+    }
+
+    int size() const { return n; }
+
+    void transform(float* re, float* im) const {
+        for (int i = 0; i < n; i++) {
+            int j = bitReverse[i];
+            if (j > i) {
+                std::swap(re[i], re[j]);
+                std::swap(im[i], im[j]);
+            }
+        }
+
+        const float* wRe = twiddleRe.data();
+        const float* wIm = twiddleIm.data();
+        for (int half = 1; half < n; half *= 2) {
+            for (int start = 0; start < n; start += 2 * half) {
+                float* aRe = re + start;
+                float* aIm = im + start;
+                float* bRe = aRe + half;
+                float* bIm = aIm + half;
+                for (int j = 0; j < half; j++) {
+                    float tRe = bRe[j] * wRe[j] - bIm[j] * wIm[j];
+                    float tIm = bRe[j] * wIm[j] + bIm[j] * wRe[j];
+                    bRe[j] = aRe[j] - tRe;
+                    bIm[j] = aIm[j] - tIm;
+                    aRe[j] += tRe;
+                    aIm[j] += tIm;
+                }
+            }
+            wRe += half;
+            wIm += half;
+        }
+    }
+
+private:
+    int n;
+    std::vector<int> bitReverse;
+    std::vector<float> twiddleRe;
+    std::vector<float> twiddleIm;
+};
+
+class AudioAnalyzer {
+public:
+    static const int TEXTURE_WIDTH = 512;
+    static const int TEXTURE_HEIGHT = 2;
+    static const int FFT_SIZE = 2048;
+    typedef std::vector<uint8_t> Texture;  // TEXTURE_WIDTH * TEXTURE_HEIGHT bytes, R8
+
+    AudioAnalyzer() : fft(FFT_SIZE) {}
+    ~AudioAnalyzer() { stop(); }
+
+    // "mic" (or "capture") selects the default input device; anything else is a file
+    bool open(const std::string& source) {
+        stop();
+        samples.clear();
+        capture = (source == "mic" || source == "capture");
+        if (capture) {
+            return openCapture();
+        }
+        bool loaded = loadWav(source);
+        if (!loaded) {
+            samples.clear();
+            loaded = loadWithFFmpeg(source);
+        }
+        if (!loaded) {
+            std::cerr << "✗ Could not load audio: " << source << std::endl;
+            return false;
+        }
+        std::cout << "✓ Audio: " << source << " (" << sampleRate << " Hz, "
+                  << samples.size() / (double)sampleRate << " s)" << std::endl;
+        return true;
+    }
+
+    void start() {
+        for (int i = 0; i < 3; i++) {
+            latest.back().assign(TEXTURE_WIDTH * TEXTURE_HEIGHT, 0);
+            latest.publish();
+        }
+        latest.update();
+        smoothed.assign(FFT_SIZE / 2, 0.0f);
+        running = true;
+        worker = std::thread(&AudioAnalyzer::analyzeLoop, this);
+    }
+
+    void stop() {
+        running = false;
+        if (worker.joinable()) {
+            worker.join();
+        }
+#ifdef HAVE_FFMPEG
+        closeDecoder();
+#endif
+    }
+
+    // Render thread: returns the newest texture if one was published since the last call
+    const Texture* latestTexture() {
+        return latest.update() ? &latest.front() : nullptr;
+    }
+
+    int rate() const { return sampleRate; }
+
+private:
+    RadixTwoFFT fft;
+    std::vector<float> samples;  // Mono; whole file, or a rolling window when capturing
+    int sampleRate = 44100;
+    bool capture = false;
+    std::vector<float> smoothed;
+    TripleBuffer<Texture> latest;
+    std::atomic<bool> running{false};
+    std::thread worker;
+
+    // WebAudio AnalyserNode defaults (ShaderToy uses them unchanged)
+    static constexpr float SMOOTHING = 0.8f;
+    static constexpr float MIN_DB = -100.0f;
+    static constexpr float MAX_DB = -30.0f;
+
+    static uint32_t readLE(const uint8_t* p, int bytes) {
+        uint32_t v = 0;
+        for (int i = 0; i < bytes; i++) v |= (uint32_t)p[i] << (8 * i);
+        return v;
+    }
+
+    // Minimal RIFF/WAVE reader: PCM 8/16/24/32-bit and IEEE float, mixed down to mono
+    bool loadWav(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (data.size() < 12 || memcmp(data.data(), "RIFF", 4) != 0 || memcmp(data.data() + 8, "WAVE", 4) != 0) {
+            return false;
+        }
+
+        int format = 0, channels = 0, bits = 0;
+        size_t pos = 12;
+        while (pos + 8 <= data.size()) {
+            uint32_t chunkSize = readLE(&data[pos + 4], 4);
+            const uint8_t* chunk = &data[pos + 8];
+            size_t available = std::min<size_t>(chunkSize, data.size() - pos - 8);
+            if (memcmp(&data[pos], "fmt ", 4) == 0 && available >= 16) {
+                format = readLE(chunk, 2);
+                channels = readLE(chunk + 2, 2);
+                sampleRate = readLE(chunk + 4, 4);
+                bits = readLE(chunk + 14, 2);
+                if (format == 0xFFFE && available >= 26) format = readLE(chunk + 24, 2);  // WAVE_FORMAT_EXTENSIBLE
+            } else if (memcmp(&data[pos], "data", 4) == 0) {
+                // Only layouts the loop below can read: integer PCM of whole bytes, 32-bit float
+                bool pcm = format == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+                if (!(pcm || (format == 3 && bits == 32)) || channels < 1 || channels > 8) {
+                    return false;
+                }
+                int bytesPerSample = bits / 8;
+                size_t frames = available / (bytesPerSample * channels);
+                samples.resize(frames);
+                for (size_t f = 0; f < frames; f++) {
+                    float sum = 0.0f;
+                    for (int c = 0; c < channels; c++) {
+                        const uint8_t* s = chunk + (f * channels + c) * bytesPerSample;
+                        if (format == 3 && bits == 32) {
+                            float v;
+                            memcpy(&v, s, 4);
+                            sum += v;
+                        } else if (bits == 8) {
+                            sum += (s[0] - 128) / 128.0f;
+                        } else {
+                            int32_t v = (int32_t)(readLE(s, bytesPerSample) << (32 - bits));
+                            sum += v / 2147483648.0f;
+                        }
+                    }
+                    samples[f] = sum / channels;
+                }
+                return true;
+            }
+            pos += 8 + chunkSize + (chunkSize & 1);
+        }
+        return false;
+    }
+
+    // Waveform row: the most recent samples; spectrum row: smoothed dB magnitudes
+    void analyzeWindow(const float* window, Texture& out) {
+        std::vector<float> re(FFT_SIZE), im(FFT_SIZE, 0.0f);
+        for (int i = 0; i < FFT_SIZE; i++) {
+            // Blackman window, as WebAudio
+            float a = 2.0f * (float)M_PI * i / (FFT_SIZE - 1);
+            float w = 0.42f - 0.5f * std::cos(a) + 0.08f * std::cos(2.0f * a);
+            re[i] = window[i] * w;
+        }
+        fft.transform(re.data(), im.data());
+
+        for (int k = 0; k < TEXTURE_WIDTH; k++) {
+            float magnitude = std::sqrt(re[k] * re[k] + im[k] * im[k]) / FFT_SIZE;
+            smoothed[k] = SMOOTHING * smoothed[k] + (1.0f - SMOOTHING) * magnitude;
+            float db = 20.0f * std::log10(std::max(smoothed[k], 1e-12f));
+            float scaled = 255.0f * (db - MIN_DB) / (MAX_DB - MIN_DB);
+            out[k] = (uint8_t)std::max(0.0f, std::min(255.0f, scaled));
+        }
+
+        const float* wave = window + FFT_SIZE - TEXTURE_WIDTH;
+        for (int i = 0; i < TEXTURE_WIDTH; i++) {
+            float v = 128.0f * (1.0f + wave[i]);
+            out[TEXTURE_WIDTH + i] = (uint8_t)std::max(0.0f, std::min(255.0f, v));
+        }
+    }
+
+    void analyzeLoop() {
+        auto startTime = std::chrono::steady_clock::now();
+        std::vector<float> window(FFT_SIZE, 0.0f);
+        size_t lastEnd = SIZE_MAX;
+
+        while (running) {
+            size_t end;
+            if (capture) {
+#ifdef HAVE_FFMPEG
+                if (!readCapture()) break;  // Blocks on the device, which paces the loop
+#endif
+                end = samples.size();
+            } else {
+                // Playback clock: file position follows wall time from start(), looping
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+                end = samples.empty() ? 0 : (size_t)(elapsed * sampleRate) % samples.size();
+                if (end == lastEnd) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(4));
+                    continue;
+                }
+            }
+            lastEnd = end;
+
+            for (int i = 0; i < FFT_SIZE; i++) {
+                int64_t idx = (int64_t)end - FFT_SIZE + i;
+                if (!capture && !samples.empty()) {
+                    idx = (idx % (int64_t)samples.size() + samples.size()) % samples.size();
+                }
+                window[i] = (idx >= 0 && idx < (int64_t)samples.size()) ? samples[idx] : 0.0f;
+            }
+
+            analyzeWindow(window.data(), latest.back());
+            latest.publish();
+
+            if (!capture) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(8));  // ~120 analyses/s
+            }
+        }
+    }
+
+#ifdef HAVE_FFMPEG
+    AVFormatContext* formatCtx = nullptr;
+    AVCodecContext* codecCtx = nullptr;
+    AVPacket* packet = nullptr;
+    AVFrame* frame = nullptr;
+    int streamIndex = -1;
+
+    bool openDecoder(const char* url, const AVInputFormat* inputFormat) {
+        if (avformat_open_input(&formatCtx, url, inputFormat, nullptr) < 0) return false;
+        if (avformat_find_stream_info(formatCtx, nullptr) < 0) return false;
+        const AVCodec* codec = nullptr;
+        streamIndex = av_find_best_stream(formatCtx, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+        if (streamIndex < 0 || !codec) return false;
+        codecCtx = avcodec_alloc_context3(codec);
+        avcodec_parameters_to_context(codecCtx, formatCtx->streams[streamIndex]->codecpar);
+        if (avcodec_open2(codecCtx, codec, nullptr) < 0) return false;
+        sampleRate = codecCtx->sample_rate;
+        packet = av_packet_alloc();
+        frame = av_frame_alloc();
+        return true;
+    }
+
+    void closeDecoder() {
+        if (frame) av_frame_free(&frame);
+        if (packet) av_packet_free(&packet);
+        if (codecCtx) avcodec_free_context(&codecCtx);
+        if (formatCtx) avformat_close_input(&formatCtx);
+    }
+
+    // Mix one decoded frame down to mono float, whatever the sample format
+    void appendFrame(const AVFrame* f) {
+        int channels = f->ch_layout.nb_channels;
+        bool planar = f->format == AV_SAMPLE_FMT_FLTP || f->format == AV_SAMPLE_FMT_S16P || f->format == AV_SAMPLE_FMT_S32P;
+        for (int i = 0; i < f->nb_samples; i++) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; c++) {
+                const uint8_t* base = planar ? f->extended_data[c] : f->extended_data[0];
+                int index = planar ? i : i * channels + c;
+                switch (f->format) {
+                    case AV_SAMPLE_FMT_FLT:
+                    case AV_SAMPLE_FMT_FLTP: sum += reinterpret_cast<const float*>(base)[index]; break;
+                    case AV_SAMPLE_FMT_S16:
+                    case AV_SAMPLE_FMT_S16P: sum += reinterpret_cast<const int16_t*>(base)[index] / 32768.0f; break;
+                    case AV_SAMPLE_FMT_S32:
+                    case AV_SAMPLE_FMT_S32P: sum += reinterpret_cast<const int32_t*>(base)[index] / 2147483648.0f; break;
+                    default: break;
+                }
+            }
+            samples.push_back(channels > 0 ? sum / channels : 0.0f);
+        }
+    }
+
+    // Decode the next packet's worth of audio; false at end of stream or on error
+    bool decodeSome() {
+        while (av_read_frame(formatCtx, packet) >= 0) {
+            bool ours = packet->stream_index == streamIndex;
+            if (ours) avcodec_send_packet(codecCtx, packet);
+            av_packet_unref(packet);
+            if (!ours) continue;
+            while (avcodec_receive_frame(codecCtx, frame) == 0) {
+                appendFrame(frame);
+                av_frame_unref(frame);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool loadWithFFmpeg(const std::string& path) {
+        bool ok = openDecoder(path.c_str(), nullptr);
+        while (ok && decodeSome()) {}
+        closeDecoder();
+        return ok && !samples.empty();
+    }
+
+    bool openCapture() {
+#ifdef HAVE_AVDEVICE
+        avdevice_register_all();
+#ifdef __APPLE__
+        const AVInputFormat* inputFormat = av_find_input_format("avfoundation");
+        const char* device = ":0";
+#else
+        const AVInputFormat* inputFormat = av_find_input_format("alsa");
+        const char* device = "default";
+#endif
+        if (inputFormat && openDecoder(device, inputFormat)) {
+            std::cout << "✓ Audio: capturing from default input device (" << sampleRate << " Hz)" << std::endl;
+            return true;
+        }
+        closeDecoder();
+#endif
+        std::cerr << "⚠ No audio capture device available" << std::endl;
+        return false;
+    }
+
+    // Keep a rolling window of the most recent captured samples
+    bool readCapture() {
+        if (!decodeSome()) return false;
+        if (samples.size() > (size_t)FFT_SIZE * 4) {
+            samples.erase(samples.begin(), samples.end() - FFT_SIZE);
+        }
+        return true;
+    }
+#else
+    bool loadWithFFmpeg(const std::string&) { return false; }
+    bool openCapture() {
+        std::cerr << "⚠ Audio capture needs FFmpeg (libavdevice)" << std::endl;
+        return false;
+    }
+#endif
+};
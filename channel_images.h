@@ -0,0 +1,349 @@
+// channel_images.h - CPU-side loading of cubemap and 3D volume iChannel sources
+//
+//   // @iChannel2 cube skies/bridge/          six faces: posx/negx/posy/negy/posz/negz (or px/nx/...)
+//   // @iChannel2 cube skies/bridge.png       one image in a horizontal (4x3) or vertical (3x4) cross
+//   // @iChannel3 volume clouds.bin           ShaderToy volume file (see loadVolume)
+//   // @iChannel3 volume noise:64             procedural tileable RGBA noise, cached on disk
+//
+// Everything is expanded to tightly packed RGBA8, faces/slices stored one after another,
+// which is exactly the buffer layout vkCmdCopyBufferToImage expects for 6 layers or depth.
+// Needs stb_image.h to be included first.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+struct ChannelImageData {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t depth = 1;   // Slices for volumes
+    uint32_t layers = 1;  // 6 for cubemaps
+    std::vector<uint8_t> pixels;
+
+    size_t sliceBytes() const { return (size_t)width * height * 4; }
+};
+
+namespace channel_images {
+
+// Vulkan cube face order: +X, -X, +Y, -Y, +Z, -Z
+static const char* FACE_NAMES[3][6] = {
+    {"posx", "negx", "posy", "negy", "posz", "negz"},
+    {"px", "nx", "py", "ny", "pz", "nz"},
+    {"right", "left", "top", "bottom", "front", "back"},
+};
+
+inline bool isDirectory(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+inline std::string findFace(const std::string& dir, int face) {
+    static const char* extensions[] = {".jpg", ".png", ".jpeg", ".bmp", ".tga"};
+    for (auto& names : FACE_NAMES) {
+        for (const char* ext : extensions) {
+            std::string path = dir + "/" + names[face] + ext;
+            std::ifstream probe(path);
+            if (probe.good()) {
+                return path;
+            }
+        }
+    }
+    return "";
+}
+
+// Six separate face images, all the same square size
+inline bool loadCubeFaces(const std::string& dir, ChannelImageData& out) {
+    out.layers = 6;
+    out.depth = 1;
+    for (int face = 0; face < 6; face++) {
+        std::string path = findFace(dir, face);
+        int w, h, channels;
+        stbi_uc* pixels = path.empty() ? nullptr : stbi_load(path.c_str(), &w, &h, &channels, STBI_rgb_alpha);
+        if (!pixels) {
+            std::cerr << "✗ Missing cubemap face " << FACE_NAMES[0][face] << " in " << dir << std::endl;
+            return false;
+        }
+        if (face == 0) {
+            out.width = w;
+            out.height = h;
+            out.pixels.resize(out.sliceBytes() * 6);
+        }
+        if ((uint32_t)w != out.width || (uint32_t)h != out.height || w != h) {
+            std::cerr << "✗ Cubemap faces must be square and equal size: " << path << std::endl;
+            stbi_image_free(pixels);
+            return false;
+        }
+        memcpy(out.pixels.data() + out.sliceBytes() * face, pixels, out.sliceBytes());
+        stbi_image_free(pixels);
+    }
+    return true;
+}
+
+// One image holding the faces as a cross:
+//   horizontal 4x3:     +Y            vertical 3x4:     +Y
+//                   -X  +Z  +X  -Z                  -X  +Z  +X
+//                       -Y                              -Y
+//                                                       -Z (rotated 180°)
+inline bool loadCubeCross(const std::string& path, ChannelImageData& out) {
+    int w, h, channels;
+    stbi_uc* pixels = stbi_load(path.c_str(), &w, &h, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        std::cerr << "✗ Could not load cubemap: " << path << std::endl;
+        return false;
+    }
+
+    bool horizontal = w * 3 == h * 4;
+    bool vertical = w * 4 == h * 3;
+    if (!horizontal && !vertical) {
+        std::cerr << "✗ Cubemap cross must be 4x3 or 3x4 faces: " << path << " (" << w << "x" << h << ")" << std::endl;
+        stbi_image_free(pixels);
+        return false;
+    }
+
+    // Cell (column, row) of each face in Vulkan order
+    static const int H_CELLS[6][2] = {{2, 1}, {0, 1}, {1, 0}, {1, 2}, {1, 1}, {3, 1}};
+    static const int V_CELLS[6][2] = {{2, 1}, {0, 1}, {1, 0}, {1, 2}, {1, 1}, {1, 3}};
+    const int (*cells)[2] = horizontal ? H_CELLS : V_CELLS;
+
+    uint32_t size = horizontal ? w / 4 : w / 3;
+    out.width = size;
+    out.height = size;
+    out.layers = 6;
+    out.depth = 1;
+    out.pixels.resize(out.sliceBytes() * 6);
+
+    for (int face = 0; face < 6; face++) {
+        bool rotate = vertical && face == 5;
+        uint8_t* dst = out.pixels.data() + out.sliceBytes() * face;
+        for (uint32_t y = 0; y < size; y++) {
+            uint32_t srcY = cells[face][1] * size + (rotate ? size - 1 - y : y);
+            const uint8_t* srcRow = pixels + ((size_t)srcY * w + cells[face][0] * size) * 4;
+            uint8_t* dstRow = dst + (size_t)y * size * 4;
+            if (!rotate) {
+                memcpy(dstRow, srcRow, size * 4);
+                continue;
+            }
+            for (uint32_t x = 0; x < size; x++) {
+                memcpy(dstRow + x * 4, srcRow + (size - 1 - x) * 4, 4);
+            }
+        }
+    }
+    stbi_image_free(pixels);
+    return true;
+}
+
+inline bool loadCubemap(const std::string& path, ChannelImageData& out) {
+    return isDirectory(path) ? loadCubeFaces(path, out) : loadCubeCross(path, out);
+}
+
+// Neutral sky so a missing cubemap still binds a valid samplerCube
+inline void fallbackCubemap(ChannelImageData& out) {
+    const uint32_t size = 16;
+    out.width = size;
+    out.height = size;
+    out.layers = 6;
+    out.depth = 1;
+    out.pixels.resize(out.sliceBytes() * 6);
+    for (int face = 0; face < 6; face++) {
+        for (uint32_t y = 0; y < size; y++) {
+            // Up face bright, down face dark, sides graded top to bottom
+            float t = face == 2 ? 1.0f : face == 3 ? 0.0f : 1.0f - (y + 0.5f) / size;
+            uint8_t* p = out.pixels.data() + out.sliceBytes() * face + (size_t)y * size * 4;
+            for (uint32_t x = 0; x < size; x++, p += 4) {
+                p[0] = (uint8_t)(40 + 120 * t);
+                p[1] = (uint8_t)(50 + 150 * t);
+                p[2] = (uint8_t)(70 + 185 * t);
+                p[3] = 255;
+            }
+        }
+    }
+}
+
+// ShaderToy volume format: "BIN\0", uint32 width/height/depth, uint8 channels (1 or 4),
+// uint8 layout (0), uint16 format (0 = uint8), then width*height*depth*channels bytes
+struct VolumeHeader {
+    char signature[4];
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint8_t channels;
+    uint8_t layout;
+    uint16_t format;
+};
+
+inline bool loadVolume(const std::string& path, ChannelImageData& out) {
+    std::ifstream file(path, std::ios::binary);
+    VolumeHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.signature, "BIN", 4) != 0) {
+        return false;
+    }
+    if ((header.channels != 1 && header.channels != 4) || header.format != 0 ||
+        header.width == 0 || header.height == 0 || header.depth == 0) {
+        std::cerr << "✗ Unsupported volume layout (need 8-bit, 1 or 4 channels): " << path << std::endl;
+        return false;
+    }
+
+    size_t voxels = (size_t)header.width * header.height * header.depth;
+    std::vector<uint8_t> raw(voxels * header.channels);
+    if (!file.read(reinterpret_cast<char*>(raw.data()), raw.size())) {
+        std::cerr << "✗ Truncated volume file: " << path << std::endl;
+        return false;
+    }
+
+    out.width = header.width;
+    out.height = header.height;
+    out.depth = header.depth;
+    out.layers = 1;
+    if (header.channels == 4) {
+        out.pixels.swap(raw);
+        return true;
+    }
+    out.pixels.resize(voxels * 4);
+    for (size_t i = 0; i < voxels; i++) {
+        uint8_t v = raw[i];
+        out.pixels[i * 4 + 0] = v;
+        out.pixels[i * 4 + 1] = v;
+        out.pixels[i * 4 + 2] = v;
+        out.pixels[i * 4 + 3] = 255;
+    }
+    return true;
+}
+
+inline bool saveVolume(const std::string& path, const ChannelImageData& volume) {
+    VolumeHeader header = {{'B', 'I', 'N', '\0'}, volume.width, volume.height, volume.depth, 4, 0, 0};
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(volume.pixels.data()), volume.pixels.size());
+    return file.good();
+}
+
+inline uint32_t hashLattice(int x, int y, int z, uint32_t seed) {
+    uint32_t h = seed ^ (uint32_t)x * 0x8da6b343u ^ (uint32_t)y * 0xd8163841u ^ (uint32_t)z * 0xcb1ab31fu;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+// Value noise on a lattice of `period` cells that wraps, so the volume tiles seamlessly
+inline float tiledValueNoise(float x, float y, float z, int period, uint32_t seed) {
+    int x0 = (int)std::floor(x), y0 = (int)std::floor(y), z0 = (int)std::floor(z);
+    float fx = x - x0, fy = y - y0, fz = z - z0;
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fy = fy * fy * (3.0f - 2.0f * fy);
+    fz = fz * fz * (3.0f - 2.0f * fz);
+
+    float corners[8];
+    for (int i = 0; i < 8; i++) {
+        int cx = ((x0 + (i & 1)) % period + period) % period;
+        int cy = ((y0 + ((i >> 1) & 1)) % period + period) % period;
+        int cz = ((z0 + (i >> 2)) % period + period) % period;
+        corners[i] = (hashLattice(cx, cy, cz, seed) & 0xffffff) / float(0xffffff);
+    }
+    float x00 = corners[0] + (corners[1] - corners[0]) * fx;
+    float x10 = corners[2] + (corners[3] - corners[2]) * fx;
+    float x01 = corners[4] + (corners[5] - corners[4]) * fx;
+    float x11 = corners[6] + (corners[7] - corners[6]) * fx;
+    float y0v = x00 + (x10 - x00) * fy;
+    float y1v = x01 + (x11 - x01) * fy;
+    return y0v + (y1v - y0v) * fz;
+}
+
+// Four independent fBm channels (RGBA), slices generated in parallel.
+// Threads pull slice indices from a shared counter so uneven cores stay busy.
+inline void generateNoiseVolume(uint32_t size, ChannelImageData& out) {
+    out.width = size;
+    out.height = size;
+    out.depth = size;
+    out.layers = 1;
+    out.pixels.resize((size_t)size * size * size * 4);
+
+    const int octaves = 5;
+    const int basePeriod = 4;
+    std::atomic<uint32_t> nextSlice{0};
+
+    auto worker = [&]() {
+        for (uint32_t z = nextSlice++; z < size; z = nextSlice++) {
+            uint8_t* p = out.pixels.data() + (size_t)z * size * size * 4;
+            for (uint32_t y = 0; y < size; y++) {
+                for (uint32_t x = 0; x < size; x++, p += 4) {
+                    for (int c = 0; c < 4; c++) {
+                        float sum = 0.0f, amplitude = 0.5f, norm = 0.0f;
+                        int period = basePeriod;
+                        for (int o = 0; o < octaves && period <= (int)size; o++, period *= 2) {
+                            float scale = (float)period / size;
+                            sum += amplitude * tiledValueNoise(x * scale, y * scale, z * scale, period, 0x9e3779b9u * (c + 1) + o);
+                            norm += amplitude;
+                            amplitude *= 0.5f;
+                        }
+                        p[c] = (uint8_t)std::lround(255.0f * sum / norm);
+                    }
+                }
+            }
+        }
+    };
+
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < threadCount; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+inline std::string cacheDirectory() {
+    const char* xdg = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    std::string base = xdg && *xdg ? xdg : home ? std::string(home) + "/.cache" : "/tmp";
+    mkdir(base.c_str(), 0755);
+    std::string dir = base + "/metalshade";
+    mkdir(dir.c_str(), 0755);
+    return dir;
+}
+
+// "noise" or "noise:N" (N = edge length, default 32 like ShaderToy's noise volumes)
+inline void noiseVolume(const std::string& spec, ChannelImageData& out) {
+    uint32_t size = 32;
+    size_t colon = spec.find(':');
+    if (colon != std::string::npos) {
+        size = (uint32_t)std::max(4, std::min(256, atoi(spec.c_str() + colon + 1)));
+    }
+
+    // Bump the version when the generator changes so stale caches are ignored
+    std::string cachePath = cacheDirectory() + "/noise3d-" + std::to_string(size) + "-v1.bin";
+    if (loadVolume(cachePath, out) && out.width == size && out.depth == size) {
+        std::cout << "✓ Noise volume " << size << "³ (cached: " << cachePath << ")" << std::endl;
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    generateNoiseVolume(size, out);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "✓ Noise volume " << size << "³ generated in " << (int)ms << " ms";
+    if (saveVolume(cachePath, out)) {
+        std::cout << " → " << cachePath;
+    }
+    std::cout << std::endl;
+}
+
+inline bool isNoiseSpec(const std::string& spec) {
+    return spec.empty() || spec == "noise" || spec.compare(0, 6, "noise:") == 0;
+}
+
+}  // namespace channel_images
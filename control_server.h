@@ -0,0 +1,326 @@
+// control_server.h - Remote control of the viewer over a local socket (--control)
+//
+// Show-control software and benchmark scripts drive the viewer with one JSON object per line
+// on a Unix domain socket (--control /tmp/metalshade.sock) or a loopback TCP port
+// (--control 9000), and get one JSON line back per command:
+//
+//   {"cmd": "load", "path": "shaders/tunnel.frag"}     {"cmd": "next"}   {"cmd": "prev"}
+//   {"cmd": "set", "name": "ITER", "value": 512}        (an ISF vec takes "value": [x, y, ...])
+//   {"cmd": "time", "value": 12.5}                      {"cmd": "pause"}  {"cmd": "pause", "value": false}
+//   {"cmd": "screenshot", "path": "shot.png"}           {"cmd": "stats"}
+//
+// One thread owns every socket: it parses the lines into Commands and pushes them on an
+// SpscQueue (keyboard_state.h) that the render loop drains once per frame, so commands take
+// effect between frames exactly like key presses. Replies come back the same way on a second
+// queue, tagged with the connection they belong to. An "id" member of a command is echoed in
+// its reply. Client sockets are non-blocking: replies wait in a per-connection outbox flushed
+// when the socket can take them, and a client that lets 1 MiB pile up is disconnected.
+#pragma once
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "isf_inputs.h"
+#include "keyboard_state.h"
+
+namespace control_server {
+
+struct Command {
+    uint64_t client = 0;  // Connection the reply goes to
+    std::string id;       // The command's "id", as JSON, echoed in the reply ("" if none)
+    std::string cmd;      // "load", "next", "prev", "set", "time", "pause", "screenshot", "stats"
+    std::string name;     // load, screenshot: "path"; set: "name"
+    std::vector<double> values;  // "value": a number, bool or array of numbers (empty if absent)
+};
+
+struct Reply {
+    uint64_t client = 0;
+    std::string json;  // One line, without the newline
+};
+
+constexpr size_t REPLY_SLOTS = 256;
+using CommandQueue = SpscQueue<Command, 256>;
+using ReplyQueue = SpscQueue<Reply, REPLY_SLOTS>;
+
+// text as a JSON string
+inline std::string quote(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += static_cast<unsigned char>(c) < 0x20 ? ' ' : c;
+    }
+    return quoted + "\"";
+}
+
+// The reply line to command: {"id": ..., members}
+inline std::string replyJson(const Command& command, const std::string& members) {
+    return "{" + (command.id.empty() ? "" : "\"id\": " + command.id + ", ") + members + "}";
+}
+
+// The command in one line of JSON; false (and error) if it isn't one
+inline bool parseCommand(const std::string& line, Command& command, std::string& error) {
+    using isf_inputs::detail::Value;
+    Value root;
+    if (!isf_inputs::detail::Parser(line).parse(root) || root.kind != Value::Object) {
+        error = "not a JSON object";
+        return false;
+    }
+    // First, so even a command that is rejected below has its id for the error reply
+    if (const Value* id = root.get("id")) {
+        if (id->kind == Value::Number) {
+            char text[32];
+            snprintf(text, sizeof(text), "%.17g", id->number);
+            command.id = text;
+        } else if (id->kind == Value::String) {
+            command.id = quote(id->text);
+        }
+    }
+    const Value* cmd = root.get("cmd");
+    if (!cmd || cmd->kind != Value::String) {
+        error = "missing \"cmd\"";
+        return false;
+    }
+    command.cmd = cmd->text;
+    for (const char* key : {"path", "name"}) {
+        if (const Value* text = root.get(key)) {
+            command.name = text->text;
+        }
+    }
+    if (const Value* value = root.get("value")) {
+        if (value->kind == Value::Number || value->kind == Value::Bool) {
+            command.values.push_back(value->number);
+        } else {
+            for (const Value& item : value->items) {
+                command.values.push_back(item.number);
+            }
+        }
+    }
+    return true;
+}
+
+class Server {
+public:
+    ~Server() { stop(); }
+
+    // address: a port number (127.0.0.1) or a Unix socket path
+    bool start(const std::string& address, std::string& error) {
+        bool tcp = !address.empty() && address.find_first_not_of("0123456789") == std::string::npos;
+        if (tcp) {
+            unsigned long port = address.size() <= 5 ? strtoul(address.c_str(), nullptr, 10) : 0;
+            if (port == 0 || port > 65535) {
+                error = "port must be 1-65535: " + address;
+                return false;
+            }
+            listenFd = socket(AF_INET, SOCK_STREAM, 0);
+            int yes = 1;
+            setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+            sockaddr_in inet{};
+            inet.sin_family = AF_INET;
+            inet.sin_port = htons(static_cast<uint16_t>(port));
+            inet.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            bound = listenFd >= 0 && bind(listenFd, reinterpret_cast<sockaddr*>(&inet), sizeof(inet)) == 0;
+        } else {
+            sockaddr_un local{};
+            local.sun_family = AF_UNIX;
+            if (address.size() >= sizeof(local.sun_path)) {
+                error = "socket path too long: " + address;
+                return false;
+            }
+            strcpy(local.sun_path, address.c_str());
+            unlink(address.c_str());  // A socket left behind by a previous run
+            listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+            bound = listenFd >= 0 && bind(listenFd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) == 0;
+            socketPath = address;
+        }
+        if (!bound || listen(listenFd, 4) < 0) {
+            error = "cannot listen on " + (tcp ? "127.0.0.1:" + address : address) + " (" + strerror(errno) + ")";
+            if (listenFd >= 0) {
+                close(listenFd);
+                listenFd = -1;
+            }
+            return false;
+        }
+        running = true;
+        worker = std::thread(&Server::serveLoop, this);
+        return true;
+    }
+
+    void stop() {
+        if (!running) {
+            return;
+        }
+        running = false;
+        worker.join();
+        for (auto& connection : connections) {
+            close(connection.second.fd);
+        }
+        connections.clear();
+        close(listenFd);
+        listenFd = -1;
+        if (!socketPath.empty()) {
+            unlink(socketPath.c_str());
+        }
+    }
+
+    // Render thread: the next command, if any. Every command popped must get one reply();
+    // commands wait in their queue while the replies already owed could fill the reply queue,
+    // so a reply always finds room and no client waits for a line that was dropped.
+    bool pop(Command& command) {
+        if (unanswered.load(std::memory_order_acquire) >= REPLY_SLOTS || !commands.pop(command)) {
+            return false;
+        }
+        unanswered.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Render thread: answer a command
+    void reply(const Command& command, const std::string& members) {
+        replies.push({command.client, replyJson(command, members)});
+    }
+
+private:
+    static constexpr size_t MAX_OUTBOX = 1 << 20;  // Unsent reply bytes before a client is dropped
+
+    struct Connection {
+        int fd;
+        std::string pending;  // Received bytes not yet ending in a newline
+        std::string outbox;   // Reply lines not yet taken by the (non-blocking) socket
+        bool closing = false;
+    };
+
+    int listenFd = -1;
+    bool bound = false;
+    std::string socketPath;
+    std::atomic<bool> running{false};
+    std::thread worker;
+    std::map<uint64_t, Connection> connections;  // Server thread only
+    uint64_t nextClient = 1;
+    CommandQueue commands;
+    ReplyQueue replies;
+    std::atomic<size_t> unanswered{0};  // Commands popped whose replies haven't been sent yet
+
+    // Queue a reply line; a client that has stopped reading is dropped rather than allowed to
+    // hold up the others (or stop())
+    static void queueLine(Connection& connection, const std::string& json) {
+        connection.outbox += json + "\n";
+        if (connection.outbox.size() > MAX_OUTBOX) {
+            connection.closing = true;
+        }
+    }
+
+    // Send what the socket takes without blocking
+    static void flush(Connection& connection) {
+        while (!connection.outbox.empty() && !connection.closing) {
+#ifdef MSG_NOSIGNAL
+            ssize_t sent = send(connection.fd, connection.outbox.data(), connection.outbox.size(), MSG_NOSIGNAL);
+#else
+            ssize_t sent = send(connection.fd, connection.outbox.data(), connection.outbox.size(), 0);
+#endif
+            if (sent < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    connection.closing = true;
+                }
+                return;
+            }
+            connection.outbox.erase(0, static_cast<size_t>(sent));
+        }
+    }
+
+    void serveLoop() {
+        while (running) {
+            std::vector<pollfd> fds = {{listenFd, POLLIN, 0}};
+            std::vector<uint64_t> clients;
+            for (const auto& connection : connections) {
+                short events = POLLIN | (connection.second.outbox.empty() ? 0 : POLLOUT);
+                fds.push_back({connection.second.fd, events, 0});
+                clients.push_back(connection.first);
+            }
+            poll(fds.data(), fds.size(), 5);  // Short, so replies go out soon after each frame
+
+            if (fds[0].revents & POLLIN) {
+                int fd = accept(listenFd, nullptr, nullptr);
+                if (fd >= 0) {
+#ifdef SO_NOSIGPIPE
+                    int yes = 1;
+                    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(yes));
+#endif
+                    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                    connections[nextClient++] = {fd, "", "", false};
+                }
+            }
+            for (size_t i = 1; i < fds.size(); i++) {
+                if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    receive(connections[clients[i - 1]], clients[i - 1]);
+                }
+            }
+            Reply answer;
+            while (replies.pop(answer)) {
+                unanswered.fetch_sub(1, std::memory_order_release);
+                auto it = connections.find(answer.client);
+                if (it != connections.end()) {
+                    queueLine(it->second, answer.json);
+                }
+            }
+            for (auto it = connections.begin(); it != connections.end();) {
+                flush(it->second);
+                if (it->second.closing) {
+                    close(it->second.fd);
+                    it = connections.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    void receive(Connection& connection, uint64_t client) {
+        char buffer[4096];
+        ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return;
+        }
+        if (received <= 0) {
+            connection.closing = true;
+            return;
+        }
+        connection.pending.append(buffer, static_cast<size_t>(received));
+        size_t newline;
+        while ((newline = connection.pending.find('\n')) != std::string::npos) {
+            std::string line = connection.pending.substr(0, newline);
+            connection.pending.erase(0, newline + 1);
+            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+            Command command;
+            std::string error;
+            command.client = client;
+            if (!parseCommand(line, command, error)) {
+                queueLine(connection, replyJson(command, "\"ok\": false, \"error\": " + quote(error)));
+            } else if (!commands.push(command)) {
+                queueLine(connection, replyJson(command, "\"ok\": false, \"error\": \"busy\""));
+            }
+        }
+        if (connection.pending.size() > 65536) {
+            queueLine(connection, "{\"ok\": false, \"error\": \"line too long\"}");
+            connection.pending.clear();
+        }
+    }
+};
+
+}  // namespace control_server
@@ -1,11 +1,30 @@
 #!/usr/bin/env python3
 """Convert Book of Shaders format to Vulkan GLSL"""
+import os
 import sys
 import re
 
 input_file = sys.argv[1]
 output_file = sys.argv[2]
 
+# Uniform block shared with the viewer (generated from uniforms.h)
+with open(os.path.join(os.path.dirname(os.path.abspath(__file__)), 'uniforms.glsl'), 'r') as f:
+    uniform_block = f.read()
+
+# Optional: --header FILE with the viewer's full header (iChannel sampler types depend on
+# the channel directives); default is four sampler2D channels at bindings 1-4
+vulkan_header = "#version 450\n\nlayout(location = 0) in vec2 fragCoord;\nlayout(location = 0) out vec4 fragColor;\n\n"
+vulkan_header += uniform_block + "\n"
+vulkan_header += "".join(f"layout(binding = {i + 1}) uniform sampler2D iChannel{i};\n" for i in range(4))
+if '--header' in sys.argv[3:]:
+    with open(sys.argv[sys.argv.index('--header') + 1], 'r') as f:
+        vulkan_header = f.read()
+vulkan_header += "\n"
+
+# Every member of the uniform block is accessed as ubo.<name>
+block = re.search(r'uniform\s+UniformBufferObject\s*\{(.*?)\}', vulkan_header, re.DOTALL)
+ubo_fields = re.findall(r'\b(\w+)\s*(?:\[\s*\d+\s*\])?\s*;', block.group(1)) if block else []
+
 with open(input_file, 'r') as f:
     shader = f.read()
 
@@ -25,7 +44,9 @@ shader = re.sub(r'^\s*uniform\s+vec3\s+u_mouse\s*;', '', shader, flags=re.MULTIL
 shader = re.sub(r'^\s*uniform\s+float\s+u_time\s*;', '', shader, flags=re.MULTILINE)
 shader = re.sub(r'^\s*uniform\s+sampler2D\s+u_tex0\s*;', '', shader, flags=re.MULTILINE)
 shader = re.sub(r'^\s*uniform\s+vec2\s+u_tex0Resolution\s*;', '', shader, flags=re.MULTILINE)
-shader = re.sub(r'^\s*uniform\s+sampler2D\s+\w+\s*;', '', shader, flags=re.MULTILINE)
+shader = re.sub(r'^\s*uniform\s+sampler(2D|3D|Cube)\s+\w+\s*;', '', shader, flags=re.MULTILINE)
+for field in ubo_fields:
+    shader = re.sub(r'^\s*uniform\s+\w+\s+' + field + r'\s*(\[\s*\d+\s*\])?\s*;', '', shader, flags=re.MULTILINE)
 
 # Replace uniform references (word boundaries to avoid replacing variables)
 # Book of Shaders format
@@ -35,9 +56,8 @@ shader = re.sub(r'\bu_mouse\b', 'ubo.iMouse.xy', shader)
 shader = re.sub(r'\bu_tex0\b', 'iChannel0', shader)
 
 # ShaderToy format (if not already prefixed with ubo.)
-shader = re.sub(r'(?<!ubo\.)\biTime\b', 'ubo.iTime', shader)
-shader = re.sub(r'(?<!ubo\.)\biResolution\b', 'ubo.iResolution', shader)
-shader = re.sub(r'(?<!ubo\.)\biMouse\b', 'ubo.iMouse', shader)
+for field in ubo_fields:
+    shader = re.sub(r'(?<![\w.])' + field + r'\b', 'ubo.' + field, shader)
 
 # Replace gl_FragCoord and gl_FragColor
 shader = re.sub(r'\bgl_FragCoord\b', 'fragCoord', shader)
@@ -73,21 +93,6 @@ if main_match:
     )
 
 # Add Vulkan header
-vulkan_header = """#version 450
-
-layout(location = 0) in vec2 fragCoord;
-layout(location = 0) out vec4 fragColor;
-
-layout(binding = 0) uniform UniformBufferObject {
-    vec3 iResolution;
-    float iTime;
-    vec4 iMouse;
-} ubo;
-
-layout(binding = 1) uniform sampler2D iChannel0;
-
-"""
-
 shader = vulkan_header + shader
 
 with open(output_file, 'w') as f:
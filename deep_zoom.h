@@ -0,0 +1,619 @@
+// deep_zoom.h - Perturbation deep zoom: arbitrary-precision reference orbit, float deltas
+//
+// A shader with a `// @deepzoom [re im]` line gets deepZoomIterations(fragCoord) (see
+// glslLibrary). Instead of iterating z² + c in floats, which fall apart near 1e5 zoom, each
+// pixel iterates its difference δ from a reference orbit Z computed once on the CPU at full
+// precision and uploaded as a storage buffer at ORBIT_BINDING:
+//
+//   δ' = 2·Z·δ + δ² + δ0        (δ0 = pixel c - reference c)
+//
+// δ is kept as a float mantissa with a separate exponent (rescaled each iteration), so
+// deltas of 1e-300 stay representable. The first `skip` iterations are replaced by a cubic
+// series approximation δ = A·δ0 + B·δ0² + C·δ0³ evaluated per pixel. A glitch (the pixel's
+// orbit passing closer to 0 than its distance from the reference, |Z + δ| < |δ|) or the
+// reference escaping first is handled by rebasing: δ becomes Z + δ and the pixel continues
+// from the start of the same orbit.
+//
+// Engine owns the view centre (BigFloat, fixed point with 32-bit limbs) and computes orbits
+// on a background thread, so the viewer keeps drawing with the previous orbit (the shader
+// only needs the offset between the view and the reference) until the new one is ready.
+// Above PARALLEL_LIMBS an iteration's three products (x², y², x·y) run on three threads.
+// SA coefficients and the view offset are doubles, which limits zoom to MAX_ZOOM.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace deep_zoom {
+
+constexpr uint32_t ORBIT_BINDING = 6;       // After the ISF inputs block (5)
+constexpr uint32_t MAX_ITERATIONS = 1 << 16;
+constexpr size_t HEADER_SIZE = 64;
+constexpr size_t BUFFER_SIZE = HEADER_SIZE + MAX_ITERATIONS * 2 * sizeof(float);
+constexpr double MAX_ZOOM = 1e300;          // Offsets and SA coefficients are doubles
+constexpr double VIEW_HEIGHT = 3.0;         // Complex-plane units across the image at zoom 1
+constexpr double ESCAPE_RADIUS2 = 256.0;
+constexpr size_t PARALLEL_LIMBS = 16;       // ~500 bits; below, a product is cheaper than a handoff
+constexpr double SA_TOLERANCE = 1.0 / (1 << 24);
+
+// Signed fixed-point number: limbs[0] is the integer part, limbs[i] the i-th 32 bits of
+// the fraction. Operands of one operation have the same limb count.
+class BigFloat {
+public:
+    explicit BigFloat(size_t limbCount = 2) : limbs(limbCount, 0) {}
+
+    static BigFloat fromDouble(double value, size_t limbCount) {
+        BigFloat result(limbCount);
+        result.negative = value < 0.0;
+        double magnitude = std::fabs(value);
+        for (size_t i = 0; i < limbCount && magnitude > 0.0; i++) {
+            double digit = std::floor(magnitude);
+            result.limbs[i] = static_cast<uint32_t>(digit);
+            magnitude = (magnitude - digit) * 4294967296.0;
+        }
+        return result;
+    }
+
+    // Decimal like "-0.74364388703715870475219150611477"; false if it isn't a number
+    static bool parse(const std::string& text, BigFloat& result) {
+        size_t at = 0;
+        bool negative = at < text.size() && (text[at] == '-' || text[at] == '+') ? text[at++] == '-' : false;
+        size_t point = text.find('.', at);
+        std::string integer = text.substr(at, point == std::string::npos ? std::string::npos : point - at);
+        std::string fraction = point == std::string::npos ? "" : text.substr(point + 1);
+        if (integer.empty() && fraction.empty()) return false;
+        if (integer.find_first_not_of("0123456789") != std::string::npos) return false;
+        if (fraction.find_first_not_of("0123456789") != std::string::npos) return false;
+        if (integer.size() > 9) return false;
+
+        result = BigFloat(2 + fraction.size() * 10 / 96);  // log2(10) bits per digit, plus a guard limb
+        for (size_t i = fraction.size(); i-- > 0;) {
+            result.limbs[0] = static_cast<uint32_t>(fraction[i] - '0');
+            result.divide(10);
+        }
+        result.limbs[0] = integer.empty() ? 0 : static_cast<uint32_t>(std::stoul(integer));
+        result.negative = negative && !result.isZero();
+        return true;
+    }
+
+    size_t size() const { return limbs.size(); }
+
+    BigFloat withLimbs(size_t limbCount) const {
+        BigFloat result = *this;
+        result.limbs.resize(limbCount, 0);
+        return result;
+    }
+
+    double toDouble() const {
+        double value = 0.0;
+        for (size_t i = limbs.size(); i-- > 0;) {
+            value = value / 4294967296.0 + limbs[i];
+        }
+        return negative ? -value : value;
+    }
+
+    bool isZero() const {
+        return std::all_of(limbs.begin(), limbs.end(), [](uint32_t limb) { return limb == 0; });
+    }
+
+    friend BigFloat operator+(const BigFloat& a, const BigFloat& b) { return add(a, b, false); }
+    friend BigFloat operator-(const BigFloat& a, const BigFloat& b) { return add(a, b, true); }
+
+    // a·b truncated to out's limb count (out may not alias a or b)
+    static void multiply(const BigFloat& a, const BigFloat& b, BigFloat& out) {
+        size_t n = out.limbs.size();
+        unsigned __int128 accumulator = 0;
+        for (size_t k = n + 1; k-- > 0;) {  // Column k has weight 2^(-32k); column n is a guard
+            size_t first = k >= b.limbs.size() ? k - (b.limbs.size() - 1) : 0;
+            size_t last = std::min(k, a.limbs.size() - 1);
+            for (size_t i = first; i <= last; i++) {
+                accumulator += static_cast<uint64_t>(a.limbs[i]) * b.limbs[k - i];
+            }
+            if (k < n) {
+                out.limbs[k] = static_cast<uint32_t>(accumulator);
+            }
+            accumulator >>= 32;
+        }
+        out.negative = (a.negative != b.negative) && !out.isZero();
+    }
+
+    void doubleInPlace() {
+        uint32_t carry = 0;
+        for (size_t i = limbs.size(); i-- > 0;) {
+            uint32_t next = limbs[i] >> 31;
+            limbs[i] = (limbs[i] << 1) | carry;
+            carry = next;
+        }
+    }
+
+private:
+    bool negative = false;
+    std::vector<uint32_t> limbs;
+
+    void divide(uint32_t divisor) {
+        uint64_t remainder = 0;
+        for (uint32_t& limb : limbs) {
+            uint64_t current = (remainder << 32) | limb;
+            limb = static_cast<uint32_t>(current / divisor);
+            remainder = current % divisor;
+        }
+    }
+
+    static bool magnitudeLess(const BigFloat& a, const BigFloat& b) {
+        return std::lexicographical_compare(a.limbs.begin(), a.limbs.end(), b.limbs.begin(), b.limbs.end());
+    }
+
+    static BigFloat add(const BigFloat& a, const BigFloat& b, bool subtract) {
+        bool bNegative = b.negative != subtract;
+        BigFloat result(a.limbs.size());
+        if (a.negative == bNegative) {
+            uint64_t carry = 0;
+            for (size_t i = a.limbs.size(); i-- > 0;) {
+                uint64_t sum = static_cast<uint64_t>(a.limbs[i]) + b.limbs[i] + carry;
+                result.limbs[i] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+            result.negative = a.negative;
+        } else {
+            bool swap = magnitudeLess(a, b);
+            const BigFloat& larger = swap ? b : a;
+            const BigFloat& smaller = swap ? a : b;
+            int64_t borrow = 0;
+            for (size_t i = a.limbs.size(); i-- > 0;) {
+                int64_t difference = static_cast<int64_t>(larger.limbs[i]) - smaller.limbs[i] - borrow;
+                borrow = difference < 0;
+                result.limbs[i] = static_cast<uint32_t>(difference + (borrow << 32));
+            }
+            result.negative = swap ? bNegative : a.negative;
+        }
+        result.negative = result.negative && !result.isZero();
+        return result;
+    }
+};
+
+// Limbs for a view with this pixel spacing: the integer limb, the bits down to one pixel
+// and 32 guard bits
+inline size_t limbsFor(double pixelSpacing) {
+    int bits = static_cast<int>(std::ceil(-std::log2(pixelSpacing))) + 32;
+    return 1 + static_cast<size_t>(std::max(1, (bits + 31) / 32));
+}
+
+// Iteration budget for a zoom level: deeper views need longer orbits to resolve
+inline uint32_t iterationsFor(double zoom) {
+    double iterations = 256.0 + 64.0 * std::max(0.0, std::log2(zoom));
+    return static_cast<uint32_t>(std::min<double>(MAX_ITERATIONS, iterations));
+}
+
+// The squares of x and y and their product for one iteration. With helpers, y² and x·y are
+// computed on two other threads while the caller squares x; they spin between iterations
+// (yielding), since one iteration takes microseconds and a condition variable wake-up is
+// about as long.
+class Products {
+public:
+    explicit Products(bool parallel) {
+        if (parallel) {
+            for (int i = 1; i <= 2; i++) {
+                helpers.emplace_back([this, i] { helperLoop(i); });
+            }
+        }
+    }
+
+    ~Products() {
+        stopping = true;
+        for (std::thread& helper : helpers) {
+            helper.join();
+        }
+    }
+
+    unsigned threads() const { return 1 + static_cast<unsigned>(helpers.size()); }
+
+    void compute(const BigFloat& x, const BigFloat& y, BigFloat& xx, BigFloat& yy, BigFloat& xy) {
+        if (helpers.empty()) {
+            BigFloat::multiply(x, x, xx);
+            BigFloat::multiply(y, y, yy);
+            BigFloat::multiply(x, y, xy);
+            return;
+        }
+        inputX = &x;
+        inputY = &y;
+        outputs[1] = &yy;
+        outputs[2] = &xy;
+        pending.store(2, std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_release);
+        BigFloat::multiply(x, x, xx);
+        while (pending.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    std::vector<std::thread> helpers;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> generation{0};
+    std::atomic<int> pending{0};
+    const BigFloat* inputX = nullptr;
+    const BigFloat* inputY = nullptr;
+    BigFloat* outputs[3] = {nullptr, nullptr, nullptr};
+
+    void helperLoop(int index) {
+        uint64_t seen = 0;
+        while (true) {
+            uint64_t current;
+            while ((current = generation.load(std::memory_order_acquire)) == seen) {
+                if (stopping) return;
+                std::this_thread::yield();
+            }
+            seen = current;
+            const BigFloat& other = index == 1 ? *inputY : *inputX;
+            BigFloat::multiply(other, *inputY, *outputs[index]);
+            pending.fetch_sub(1, std::memory_order_release);
+        }
+    }
+};
+
+struct Orbit {
+    BigFloat x, y;              // Reference point
+    uint32_t maxIterations = 0;
+    bool escaped = false;       // Stopped before maxIterations (more iterations won't help)
+    std::vector<double> z;      // Z_0 = 0, Z_1, ... as re, im pairs
+    double millis = 0.0;
+    unsigned threads = 1;
+
+    size_t points() const { return z.size() / 2; }
+};
+
+// Z_{n+1} = Z_n² + c at the precision of cx/cy, until escape or maxIterations; gives up
+// (returns false) when cancel is set
+inline bool computeOrbit(const BigFloat& cx, const BigFloat& cy, uint32_t maxIterations, const std::atomic<bool>& cancel,
+                         Orbit& orbit) {
+    auto start = std::chrono::steady_clock::now();
+    size_t n = cx.size();
+    Products products(n >= PARALLEL_LIMBS && std::thread::hardware_concurrency() >= 3);
+    orbit.x = cx;
+    orbit.y = cy;
+    orbit.maxIterations = maxIterations;
+    orbit.escaped = false;
+    orbit.threads = products.threads();
+    orbit.z.assign(2, 0.0);
+    orbit.z.reserve(static_cast<size_t>(maxIterations) * 2);
+
+    BigFloat x(n), y(n), xx(n), yy(n), xy(n);
+    for (uint32_t i = 1; i < maxIterations; i++) {
+        products.compute(x, y, xx, yy, xy);
+        x = xx - yy + cx;
+        xy.doubleInPlace();
+        y = xy + cy;
+        double re = x.toDouble(), im = y.toDouble();
+        orbit.z.push_back(re);
+        orbit.z.push_back(im);
+        if (re * re + im * im > ESCAPE_RADIUS2) {
+            orbit.escaped = true;
+            break;
+        }
+        if ((i & 255) == 0 && cancel) {
+            return false;
+        }
+    }
+    orbit.millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// std430 layout of the block in glslLibrary()
+struct Header {
+    float a[2], b[2], c[2];  // SA coefficients, pre-scaled by powers of 2^exponent
+    float pixelScale;        // δ0 = 2^exponent · (pixelScale · (fragCoord - iResolution/2) + offset)
+    int32_t exponent;
+    float offset[2];         // View centre - reference, in units of 2^exponent
+    int32_t skip;            // Iterations the series approximation replaces
+    int32_t length;          // Orbit points
+    int32_t maxIterations;
+    int32_t padding[3];
+};
+static_assert(sizeof(Header) == HEADER_SIZE, "Header must match the GLSL block");
+
+// Cubic series for δ_n in terms of v = δ0 / 2^exponent, from Z_0 until it stops being
+// accurate to float precision anywhere within |v| <= vmax (or its terms leave float range)
+inline void seriesApproximation(const Orbit& orbit, int exponent, double vmax, uint32_t maxIterations, Header& header) {
+    const double scale = std::ldexp(1.0, exponent);
+    double a[2] = {0.0, 0.0}, b[2] = {0.0, 0.0}, c[2] = {0.0, 0.0};
+    double best[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    uint32_t skip = 0;
+    uint32_t last = std::min<uint32_t>(maxIterations, static_cast<uint32_t>(orbit.points())) - 1;
+    for (uint32_t n = 0; n < last; n++) {
+        double zr = 2.0 * orbit.z[2 * n], zi = 2.0 * orbit.z[2 * n + 1];
+        // A' = 2ZA + 1, B' = 2ZB + A²·s, C' = 2ZC + 2AB·s (B, C pre-scaled by s and s²)
+        double na[2] = {zr * a[0] - zi * a[1] + 1.0, zr * a[1] + zi * a[0]};
+        double nb[2] = {zr * b[0] - zi * b[1] + (a[0] * a[0] - a[1] * a[1]) * scale,
+                        zr * b[1] + zi * b[0] + 2.0 * a[0] * a[1] * scale};
+        double nc[2] = {zr * c[0] - zi * c[1] + 2.0 * (a[0] * b[0] - a[1] * b[1]) * scale,
+                        zr * c[1] + zi * c[0] + 2.0 * (a[0] * b[1] + a[1] * b[0]) * scale};
+        double magnitudeA = std::hypot(na[0], na[1]);
+        double magnitudeC = std::hypot(nc[0], nc[1]);
+        bool representable = magnitudeA < 1e30 && std::hypot(nb[0], nb[1]) < 1e30 && magnitudeC < 1e30;
+        if (!representable || magnitudeC * vmax * vmax > SA_TOLERANCE * magnitudeA) {
+            break;
+        }
+        std::copy(na, na + 2, a);
+        std::copy(nb, nb + 2, b);
+        std::copy(nc, nc + 2, c);
+        skip = n + 1;
+        best[0] = a[0], best[1] = a[1], best[2] = b[0], best[3] = b[1], best[4] = c[0], best[5] = c[1];
+    }
+    for (int i = 0; i < 2; i++) {
+        header.a[i] = static_cast<float>(best[i]);
+        header.b[i] = static_cast<float>(best[2 + i]);
+        header.c[i] = static_cast<float>(best[4 + i]);
+    }
+    header.skip = static_cast<int32_t>(skip);
+}
+
+class Engine {
+public:
+    ~Engine() { stop(); }
+
+    // Centre the view on (x, y) and make that the home position (new shader, or R)
+    void setHome(const BigFloat& x, const BigFloat& y) {
+        homeX = x;
+        homeY = y;
+        home();
+    }
+
+    void home() {
+        centreX = homeX;
+        centreY = homeY;
+        lastZoom = 0.0;
+    }
+
+    // Move the view by a drag of (dx, dy) pixels (fragCoord direction)
+    void pan(double dx, double dy) {
+        centreX = centreX - BigFloat::fromDouble(dx * spacing, centreX.size());
+        centreY = centreY - BigFloat::fromDouble(dy * spacing, centreY.size());
+    }
+
+    // Once per frame. The zoom keeps the point under cursor (fragCoord) fixed; drag is a pan
+    // in progress. Starts a new reference orbit when the current one is too coarse, too
+    // short or off screen; with wait, blocks until it is ready (offline rendering). Returns
+    // true when a new orbit was installed.
+    bool update(double zoom, double width, double height, double cursorX, double cursorY, double dragX, double dragY,
+                bool wait) {
+        zoom = std::min(MAX_ZOOM, std::max(1e-2, zoom));
+        double newSpacing = VIEW_HEIGHT / (zoom * height);
+        limbs = limbsFor(newSpacing);
+        if (centreX.size() < limbs) {
+            centreX = centreX.withLimbs(limbs);
+            centreY = centreY.withLimbs(limbs);
+        }
+        if (lastZoom > 0.0 && zoom != lastZoom) {
+            double shift = spacing - newSpacing;
+            centreX = centreX + BigFloat::fromDouble((cursorX - 0.5 * width) * shift, centreX.size());
+            centreY = centreY + BigFloat::fromDouble((cursorY - 0.5 * height) * shift, centreY.size());
+        }
+        lastZoom = zoom;
+        spacing = newSpacing;
+        viewX = centreX - BigFloat::fromDouble(dragX * spacing, centreX.size());
+        viewY = centreY - BigFloat::fromDouble(dragY * spacing, centreY.size());
+        halfDiagonal = 0.5 * std::hypot(width, height) * spacing;
+        iterations = iterationsFor(zoom);
+
+        bool installed = collect(false);
+        if (needsOrbit(current) && (!working || needsOrbit(requested))) {
+            requested.x = viewX.withLimbs(limbs);
+            requested.y = viewY.withLimbs(limbs);
+            requested.maxIterations = iterations;
+            if (working) {
+                requestPending = true;  // Started when the running one finishes
+            } else {
+                start();
+            }
+        }
+        while (wait && working) {
+            installed = collect(true) || installed;
+        }
+        return installed;
+    }
+
+    bool ready() const { return current.points() > 0; }
+    const Orbit& orbit() const { return current; }
+    uint64_t version() const { return orbitVersion; }  // Changes with every installed orbit
+
+    // Header for the current view, and the orbit too unless bufferVersion says the buffer
+    // already holds it
+    void fill(void* buffer, uint64_t& bufferVersion) const {
+        Header header{};
+        size_t length = std::min<size_t>(current.points(), MAX_ITERATIONS);
+        double offset[2] = {offsetFrom(current.x, viewX), offsetFrom(current.y, viewY)};
+        double reach = std::max(halfDiagonal, std::hypot(offset[0], offset[1]));
+        int exponent;
+        std::frexp(reach, &exponent);
+        header.exponent = exponent;
+        header.pixelScale = static_cast<float>(std::ldexp(spacing, -exponent));
+        header.offset[0] = static_cast<float>(std::ldexp(offset[0], -exponent));
+        header.offset[1] = static_cast<float>(std::ldexp(offset[1], -exponent));
+        header.length = static_cast<int32_t>(length);
+        header.maxIterations = static_cast<int32_t>(iterations);
+        double vmax = std::ldexp(halfDiagonal, -exponent) + std::hypot(header.offset[0], header.offset[1]);
+        if (length > 1) {
+            seriesApproximation(current, exponent, vmax, iterations, header);
+        }
+        memcpy(buffer, &header, sizeof(header));
+
+        if (bufferVersion != orbitVersion) {
+            float* points = reinterpret_cast<float*>(static_cast<char*>(buffer) + HEADER_SIZE);
+            for (size_t i = 0; i < 2 * length; i++) {
+                points[i] = static_cast<float>(current.z[i]);
+            }
+            if (length == 0) {
+                points[0] = points[1] = 0.0f;  // Z = 0: the shader iterates plain floats until the first orbit
+            }
+            bufferVersion = orbitVersion;
+        }
+    }
+
+    // Abandon the orbit being computed (shader switch, shutdown)
+    void stop() {
+        cancel = true;
+        if (worker.joinable()) {
+            worker.join();
+        }
+        working = false;
+        requestPending = false;
+        cancel = false;
+    }
+
+private:
+    BigFloat homeX, homeY, centreX, centreY, viewX, viewY;
+    double lastZoom = 0.0;
+    double spacing = VIEW_HEIGHT;  // Complex-plane units per pixel
+    double halfDiagonal = 0.0;
+    size_t limbs = 2;
+    uint32_t iterations = 0;
+
+    Orbit current, computed, requested;  // requested: x, y and maxIterations of the next job
+    uint64_t orbitVersion = 1;           // Buffers start at 0, so the first fill uploads
+    std::thread worker;
+    bool working = false;
+    bool requestPending = false;
+    bool succeeded = false;
+    std::atomic<bool> finished{false};
+    std::atomic<bool> cancel{false};
+
+    // view - reference as a double (the view's precision decides)
+    static double offsetFrom(const BigFloat& reference, const BigFloat& view) {
+        return (view - reference.withLimbs(view.size())).toDouble();
+    }
+
+    // The view outgrew this orbit: too coarse, not long enough, or its reference off screen
+    bool needsOrbit(const Orbit& orbit) const {
+        if (orbit.x.size() < limbs) return true;
+        if (orbit.maxIterations < iterations && !orbit.escaped) return true;
+        return std::hypot(offsetFrom(orbit.x, viewX), offsetFrom(orbit.y, viewY)) > halfDiagonal;
+    }
+
+    void start() {
+        working = true;
+        finished = false;
+        Orbit job = requested;
+        worker = std::thread([this, job] {
+            succeeded = computeOrbit(job.x, job.y, job.maxIterations, cancel, computed);
+            finished.store(true, std::memory_order_release);
+        });
+    }
+
+    // Install a finished orbit (waiting for it if block) and start the pending request
+    bool collect(bool block) {
+        if (!working || (!block && !finished.load(std::memory_order_acquire))) {
+            return false;
+        }
+        worker.join();
+        working = false;
+        if (succeeded) {
+            std::swap(current, computed);
+            orbitVersion++;
+        }
+        if (requestPending) {
+            requestPending = false;
+            start();
+        }
+        return succeeded;
+    }
+};
+
+// Look for `// @deepzoom [re im]`; false if the shader has no such line. The centre
+// defaults to the Mandelbrot set's middle.
+inline bool parseDirective(const std::string& source, BigFloat& x, BigFloat& y) {
+    size_t at = source.find("// @deepzoom");
+    if (at == std::string::npos) {
+        return false;
+    }
+    size_t end = source.find('\n', at);
+    std::string line = source.substr(at + 12, end == std::string::npos ? std::string::npos : end - at - 12);
+    char re[512] = {0}, im[512] = {0};
+    x = BigFloat::fromDouble(-0.5, 2);
+    y = BigFloat::fromDouble(0.0, 2);
+    if (sscanf(line.c_str(), "%511s %511s", re, im) == 2) {
+        BigFloat px, py;
+        if (BigFloat::parse(re, px) && BigFloat::parse(im, py)) {
+            size_t limbs = std::max(px.size(), py.size());
+            x = px.withLimbs(limbs);
+            y = py.withLimbs(limbs);
+        }
+    }
+    return true;
+}
+
+// The storage block and deepZoomIterations(), injected into converted shaders with a
+// // @deepzoom line
+inline std::string glslLibrary() {
+    return R"(
+// Deep zoom (deep_zoom.h): reference orbit and per-view constants
+layout(std430, binding = 6) readonly buffer DeepZoomOrbit {
+    vec2 dzA;
+    vec2 dzB;
+    vec2 dzC;
+    float dzPixelScale;
+    int dzExponent;
+    vec2 dzOffset;
+    int dzSkip;
+    int dzLength;
+    int dzMaxIterations;
+    int dzPadding0;
+    int dzPadding1;
+    int dzPadding2;
+    vec2 dzOrbit[];
+};
+
+vec2 dzMul(vec2 a, vec2 b) {
+    return vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+
+// Smooth escape iteration count of this pixel's c, or -1.0 if it didn't escape within
+// dzMaxIterations. delta = w * 2^e, with w kept near 1.
+float deepZoomIterations(vec2 fragCoord) {
+    vec2 v = dzPixelScale * (fragCoord - 0.5 * ubo.iResolution.xy) + dzOffset;
+    vec2 v2 = dzMul(v, v);
+    vec2 w = dzMul(dzA, v) + dzMul(dzB, v2) + dzMul(dzC, dzMul(v2, v));
+    int e = dzExponent;
+    int m = dzSkip;
+    for (int n = dzSkip; n < dzMaxIterations; n++) {
+        float size = max(abs(w.x), abs(w.y));
+        if (size > 0.0) {
+            int k;
+            frexp(size, k);
+            w = ldexp(w, ivec2(-k));
+            e += k;
+        }
+        vec2 Z = dzOrbit[m];
+        vec2 delta = ldexp(w, ivec2(e));
+        vec2 z = Z + delta;
+        float r2 = dot(z, z);
+        if (r2 > 256.0) {
+            return float(n) + 1.0 - log2(log2(r2) * 0.5);
+        }
+        if (r2 < dot(delta, delta) || m + 1 >= dzLength) {
+            // Glitch or end of the reference: rebase onto its start (Z_0 = 0), delta = z,
+            // at a scale that holds both Z and the old delta
+            int k;
+            frexp(max(abs(Z.x), abs(Z.y)), k);
+            int rebased = max(e, k);
+            w = ldexp(Z, ivec2(-rebased)) + ldexp(w, ivec2(e - rebased));
+            e = rebased;
+            Z = vec2(0.0);
+            m = 0;
+        }
+        w = 2.0 * dzMul(Z, w) + ldexp(dzMul(w, w), ivec2(e)) + ldexp(v, ivec2(dzExponent - e));
+        m++;
+    }
+    return -1.0;
+}
+)";
+}
+
+}  // namespace deep_zoom
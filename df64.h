@@ -0,0 +1,167 @@
+// df64.h - Double-float ("df64") arithmetic for shaders on GPUs without fp64
+//
+// A shader with a `// @precision df64` line gets the GLSL library below: a df64 is a vec2
+// (hi, lo) holding the unevaluated sum hi + lo, which carries about 48 bits of mantissa
+// instead of float's 24 - enough to push float zoom shaders from ~1e5 to ~1e13. A complex
+// df64 is a vec4 (re.hi, re.lo, im.hi, im.lo).
+//
+// The operations are built from error-free transforms: TwoSum recovers the rounding error of
+// an addition, TwoProd that of a product with one fma(). Their intermediates are `precise`
+// (SPIR-V NoContraction) so the compiler can't fuse or reassociate them away. On MoltenVK,
+// Metal fast math can still do so; run df64 shaders with MVK_CONFIG_FAST_MATH_ENABLED=0.
+//
+// The viewer passes the values a zoom shader needs beyond float as hi/lo pairs: iPan +
+// iPanLo is the pan offset, iZoomCenter the zoom focus (see split()).
+#pragma once
+
+#include <string>
+
+namespace df64 {
+
+constexpr double MAX_ZOOM = 1e13;  // ~48 bits of mantissa, less a few for the iteration
+
+// True if the shader asks for the library
+inline bool requested(const std::string& source) {
+    size_t at = source.find("// @precision");
+    while (at != std::string::npos) {
+        size_t end = source.find('\n', at);
+        std::string line = source.substr(at, end == std::string::npos ? std::string::npos : end - at);
+        if (line.find("df64") != std::string::npos) {
+            return true;
+        }
+        at = source.find("// @precision", at + 1);
+    }
+    return false;
+}
+
+// value ≈ hi + lo, with hi the nearest float
+inline void split(double value, float& hi, float& lo) {
+    hi = static_cast<float>(value);
+    lo = static_cast<float>(value - static_cast<double>(hi));
+}
+
+inline std::string glslLibrary() {
+    return R"(
+// Double-float arithmetic (df64.h): vec2(hi, lo) = hi + lo
+vec2 df64(float a) {
+    return vec2(a, 0.0);
+}
+
+float df64ToFloat(vec2 a) {
+    return a.x + a.y;
+}
+
+vec2 df64TwoSum(float a, float b) {
+    precise float s = a + b;
+    precise float v = s - a;
+    precise float e = (a - (s - v)) + (b - v);
+    return vec2(s, e);
+}
+
+// |a| >= |b|
+vec2 df64QuickTwoSum(float a, float b) {
+    precise float s = a + b;
+    precise float e = b - (s - a);
+    return vec2(s, e);
+}
+
+vec2 df64TwoProd(float a, float b) {
+    precise float p = a * b;
+    precise float e = fma(a, b, -p);
+    return vec2(p, e);
+}
+
+vec2 df64Add(vec2 a, vec2 b) {
+    vec2 s = df64TwoSum(a.x, b.x);
+    vec2 t = df64TwoSum(a.y, b.y);
+    precise float lo = s.y + t.x;
+    s = df64QuickTwoSum(s.x, lo);
+    precise float lo2 = s.y + t.y;
+    return df64QuickTwoSum(s.x, lo2);
+}
+
+vec2 df64Sub(vec2 a, vec2 b) {
+    return df64Add(a, -b);
+}
+
+vec2 df64Mul(vec2 a, vec2 b) {
+    vec2 p = df64TwoProd(a.x, b.x);
+    precise float lo = fma(a.x, b.y, fma(a.y, b.x, p.y));
+    return df64QuickTwoSum(p.x, lo);
+}
+
+vec2 df64Mul(vec2 a, float b) {
+    vec2 p = df64TwoProd(a.x, b);
+    precise float lo = fma(a.y, b, p.y);
+    return df64QuickTwoSum(p.x, lo);
+}
+
+vec2 df64Sqr(vec2 a) {
+    vec2 p = df64TwoProd(a.x, a.x);
+    precise float lo = fma(2.0 * a.x, a.y, p.y);
+    return df64QuickTwoSum(p.x, lo);
+}
+
+vec2 df64Div(vec2 a, vec2 b) {
+    float q1 = a.x / b.x;
+    vec2 r = df64Sub(a, df64Mul(b, q1));
+    float q2 = r.x / b.x;
+    r = df64Sub(r, df64Mul(b, q2));
+    float q3 = r.x / b.x;
+    return df64Add(df64QuickTwoSum(q1, q2), df64(q3));
+}
+
+vec2 df64Sqrt(vec2 a) {
+    if (a.x <= 0.0) {
+        return vec2(0.0);
+    }
+    float x = inversesqrt(a.x);
+    float y = a.x * x;
+    vec2 e = df64Sub(a, df64TwoProd(y, y));
+    return df64TwoSum(y, e.x * x * 0.5);
+}
+
+bool df64Less(vec2 a, vec2 b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+// Complex df64: vec4(re.hi, re.lo, im.hi, im.lo)
+vec4 df64c(vec2 re, vec2 im) {
+    return vec4(re, im);
+}
+
+vec4 df64cAdd(vec4 a, vec4 b) {
+    return vec4(df64Add(a.xy, b.xy), df64Add(a.zw, b.zw));
+}
+
+vec4 df64cSub(vec4 a, vec4 b) {
+    return vec4(df64Sub(a.xy, b.xy), df64Sub(a.zw, b.zw));
+}
+
+vec4 df64cMul(vec4 a, vec4 b) {
+    return vec4(df64Sub(df64Mul(a.xy, b.xy), df64Mul(a.zw, b.zw)),
+                df64Add(df64Mul(a.xy, b.zw), df64Mul(a.zw, b.xy)));
+}
+
+vec4 df64cSqr(vec4 a) {
+    return vec4(df64Sub(df64Sqr(a.xy), df64Sqr(a.zw)), df64Mul(df64Mul(a.xy, a.zw), 2.0));
+}
+
+// |a|², as a float: enough for escape tests
+float df64cLength2(vec4 a) {
+    float re = df64ToFloat(a.xy), im = df64ToFloat(a.zw);
+    return re * re + im * im;
+}
+
+// The viewer's pan offset (iPan + iPanLo, pixels) and zoom focus (iZoomCenter) as complex df64
+vec4 df64Pan() {
+    return vec4(ubo.iPan.x, ubo.iPanLo.x, ubo.iPan.y, ubo.iPanLo.y);
+}
+
+vec4 df64ZoomCenter() {
+    return ubo.iZoomCenter.xzyw;
+}
+)";
+}
+
+}  // namespace df64
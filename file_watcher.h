@@ -0,0 +1,179 @@
+// file_watcher.h - Debounced change notification for a set of files (shader hot reload)
+//
+// On Linux this uses inotify on the files' parent directories rather than on the files:
+// editors commonly save by writing a temporary file and renaming it over the original,
+// which replaces the inode a per-file watch would be attached to. Elsewhere the files'
+// modification times are polled every 100 ms.
+//
+// A background thread collects changed paths; poll() hands them over only once no new
+// change has arrived for the debounce interval, so an editor's save burst (truncate, write,
+// rename, chmod) turns into one batch and one rebuild.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+class FileWatcher {
+public:
+    explicit FileWatcher(double debounceSeconds = 0.15) : debounce(debounceSeconds) {}
+
+    ~FileWatcher() { stop(); }
+
+    // Replace the watched set (starts the watcher thread on first use)
+    void watch(const std::vector<std::string>& paths) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            files.clear();
+            for (const std::string& path : paths) {
+                files[canonical(path)] = modificationTime(path);
+            }
+            pending.clear();
+            filesChanged = true;
+        }
+        if (!thread.joinable()) {
+            running = true;
+            thread = std::thread([this] { watchLoop(); });
+        }
+    }
+
+    void stop() {
+        running = false;
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    // Main thread: the settled set of changed files, if any
+    bool poll(std::set<std::string>& changed) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.empty() || secondsSince(lastChange) < debounce) {
+            return false;
+        }
+        changed.insert(pending.begin(), pending.end());
+        pending.clear();
+        return true;
+    }
+
+    // Absolute path with symlinks, "." and ".." resolved (as reported by poll())
+    static std::string canonical(const std::string& path) {
+        char resolved[PATH_MAX];
+        return realpath(path.c_str(), resolved) ? std::string(resolved) : path;
+    }
+
+private:
+    double debounce;
+    std::mutex mutex;
+    std::map<std::string, double> files;  // Canonical path → last seen mtime
+    std::set<std::string> pending;
+    std::chrono::steady_clock::time_point lastChange;
+    bool filesChanged = false;
+    std::atomic<bool> running{false};
+    std::thread thread;
+
+    static double secondsSince(std::chrono::steady_clock::time_point time) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - time).count();
+    }
+
+    static double modificationTime(const std::string& path) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) {
+            return 0.0;
+        }
+#ifdef __APPLE__
+        return info.st_mtimespec.tv_sec + info.st_mtimespec.tv_nsec * 1e-9;
+#else
+        return info.st_mtim.tv_sec + info.st_mtim.tv_nsec * 1e-9;
+#endif
+    }
+
+    // Caller holds the mutex
+    void markChanged(const std::string& path) {
+        if (files.count(path)) {
+            pending.insert(path);
+            lastChange = std::chrono::steady_clock::now();
+        }
+    }
+
+#ifdef __linux__
+    void watchLoop() {
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        std::map<int, std::string> directories;  // Watch descriptor → directory
+        alignas(struct inotify_event) char buffer[4096];
+
+        while (running) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (filesChanged) {
+                    for (const auto& entry : directories) {
+                        inotify_rm_watch(fd, entry.first);
+                    }
+                    directories.clear();
+                    std::set<std::string> parents;
+                    for (const auto& entry : files) {
+                        parents.insert(entry.first.substr(0, entry.first.find_last_of('/')));
+                    }
+                    for (const std::string& directory : parents) {
+                        int wd = inotify_add_watch(fd, directory.c_str(),
+                                                   IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ATTRIB);
+                        if (wd >= 0) {
+                            directories[wd] = directory;
+                        }
+                    }
+                    filesChanged = false;
+                }
+            }
+
+            struct pollfd ready = {fd, POLLIN, 0};
+            if (::poll(&ready, 1, 100) <= 0) {
+                continue;
+            }
+            ssize_t length;
+            while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (char* at = buffer; at < buffer + length;) {
+                    const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(at);
+                    auto directory = directories.find(event->wd);
+                    if (directory != directories.end() && event->len > 0) {
+                        markChanged(directory->second + "/" + event->name);
+                    }
+                    at += sizeof(struct inotify_event) + event->len;
+                }
+            }
+        }
+        close(fd);
+    }
+#else
+    void watchLoop() {
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            std::lock_guard<std::mutex> lock(mutex);
+            filesChanged = false;
+            for (auto& entry : files) {
+                double mtime = modificationTime(entry.first);
+                if (mtime != entry.second) {
+                    entry.second = mtime;
+                    markChanged(entry.first);
+                }
+            }
+        }
+    }
+#endif
+};
@@ -0,0 +1,486 @@
+// frame_server.h - Streams rendered frames to local clients over HTTP (MJPEG) and WebSocket
+//
+// --serve PORT listens on 127.0.0.1 only:
+//
+//   GET /          a page showing the stream
+//   GET /stream    multipart/x-mixed-replace MJPEG, for <img> tags, browsers, ffplay, curl
+//   WebSocket /    one binary message per frame: a JPEG file
+//   WebSocket /raw one binary message per frame: width and height (little-endian uint32),
+//                  then RGBA8 rows, top row first
+//
+// The render thread hands over frames it has read back (submit()); ENCODER threads turn them
+// into JPEGs (jpeg_writer.h), several frames at once, and publish the newest to every client.
+// Each client has a one-frame mailbox and its own sender thread: a frame that arrives while
+// the previous one is still unsent replaces it and counts as dropped for that client, so a
+// slow client sees a lower frame rate and never holds up the others or the render loop.
+// Messages from WebSocket clients are never read; a client that goes away is noticed on the
+// next send.
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "jpeg_writer.h"
+
+namespace frame_server {
+
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;  // SO_NOSIGPIPE is set on each socket instead
+#endif
+
+// SHA-1 of data (for the WebSocket handshake only)
+inline std::string sha1(const std::string& data) {
+    uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+    std::string message = data;
+    uint64_t bitLength = static_cast<uint64_t>(data.size()) * 8;
+    message += static_cast<char>(0x80);
+    while (message.size() % 64 != 56) {
+        message += '\0';
+    }
+    for (int i = 7; i >= 0; i--) {
+        message += static_cast<char>(bitLength >> (i * 8));
+    }
+    auto rotate = [](uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+    for (size_t chunk = 0; chunk < message.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(&message[chunk + i * 4]);
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 80; i++) {
+            w[i] = rotate(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5a827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8f1bbcdc;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+            uint32_t next = rotate(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotate(b, 30);
+            b = a;
+            a = next;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    std::string digest;
+    for (uint32_t word : h) {
+        for (int i = 3; i >= 0; i--) {
+            digest += static_cast<char>(word >> (i * 8));
+        }
+    }
+    return digest;
+}
+
+inline std::string base64(const std::string& data) {
+    static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < data.size(); i += 3) {
+        uint32_t n = static_cast<unsigned char>(data[i]) << 16;
+        if (i + 1 < data.size()) n |= static_cast<unsigned char>(data[i + 1]) << 8;
+        if (i + 2 < data.size()) n |= static_cast<unsigned char>(data[i + 2]);
+        out += alphabet[(n >> 18) & 63];
+        out += alphabet[(n >> 12) & 63];
+        out += i + 1 < data.size() ? alphabet[(n >> 6) & 63] : '=';
+        out += i + 2 < data.size() ? alphabet[n & 63] : '=';
+    }
+    return out;
+}
+
+// Sec-WebSocket-Accept for a Sec-WebSocket-Key
+inline std::string acceptKey(const std::string& key) {
+    return base64(sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"));
+}
+
+inline bool sendAll(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t sent = send(fd, p, size, SEND_FLAGS);
+        if (sent <= 0) {
+            return false;
+        }
+        p += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+struct Frame {
+    uint64_t sequence = 0;
+    uint32_t width = 0, height = 0;
+    std::vector<uint8_t> jpeg;  // Empty if no client wants JPEG
+    std::vector<uint8_t> rgba;  // Empty if no client wants raw frames
+};
+
+enum class Mode { Mjpeg, WebSocketJpeg, WebSocketRaw };
+
+class Server {
+public:
+    static constexpr unsigned ENCODERS = 3;
+
+    ~Server() { stop(); }
+
+    bool start(uint16_t port, int jpegQuality, std::string& error) {
+        quality = jpegQuality;
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int yes = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+            listen(listenFd, 8) < 0) {
+            error = "cannot listen on 127.0.0.1:" + std::to_string(port) + " (" + strerror(errno) + ")";
+            if (listenFd >= 0) {
+                close(listenFd);
+                listenFd = -1;
+            }
+            return false;
+        }
+        running = true;
+        acceptThread = std::thread(&Server::acceptLoop, this);
+        for (unsigned i = 0; i < ENCODERS; i++) {
+            encoders.emplace_back(&Server::encodeLoop, this);
+        }
+        return true;
+    }
+
+    void stop() {
+        if (!running) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            running = false;
+            jobReady.notify_all();
+        }
+        acceptThread.join();
+        for (std::thread& encoder : encoders) {
+            encoder.join();
+        }
+        encoders.clear();
+        close(listenFd);
+        listenFd = -1;
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (auto& client : clients) {
+            client->close();
+        }
+        clients.clear();
+    }
+
+    // Render thread: true if anyone is watching (no point reading frames back otherwise)
+    bool hasClients() const { return clientCount.load(std::memory_order_relaxed) > 0; }
+
+    // Render thread: encode and publish a frame. rgba must stay valid until busy is cleared
+    // (by an encoder thread, once it is done with it).
+    void submit(const uint8_t* rgba, uint32_t width, uint32_t height, uint64_t sequence, std::atomic<bool>* busy) {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        jobs.push_back({rgba, width, height, sequence, busy});
+        jobReady.notify_one();
+    }
+
+    uint64_t framesSent() const { return sent.load(); }
+    uint64_t framesDropped() const { return dropped.load(); }
+
+private:
+    struct Job {
+        const uint8_t* rgba;
+        uint32_t width, height;
+        uint64_t sequence;
+        std::atomic<bool>* busy;
+    };
+
+    class Client {
+    public:
+        Client(int socket, Server& owner) : fd(socket), server(owner) {
+            thread = std::thread(&Client::sendLoop, this);
+        }
+
+        ~Client() { close(); }
+
+        // Handshake done, frames wanted (mode is only meaningful from then on)
+        bool streaming() const { return ready.load(std::memory_order_acquire) && !closed.load(); }
+        bool wantsRaw() const { return mode == Mode::WebSocketRaw; }
+        bool alive() const { return !closed.load(); }
+
+        // Replace whatever is waiting to be sent
+        void post(const std::shared_ptr<const Frame>& frame) {
+            std::lock_guard<std::mutex> lock(mailboxMutex);
+            if (mailbox) {
+                server.dropped++;
+            }
+            mailbox = frame;
+            mailboxReady.notify_one();
+        }
+
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(mailboxMutex);
+                closed = true;
+                mailboxReady.notify_one();
+            }
+            if (thread.joinable()) {
+                shutdown(fd, SHUT_RDWR);
+                thread.join();
+                ::close(fd);
+            }
+        }
+
+    private:
+        int fd;
+        Mode mode = Mode::Mjpeg;
+        std::atomic<bool> ready{false};
+        Server& server;
+        std::thread thread;
+        std::mutex mailboxMutex;
+        std::condition_variable mailboxReady;
+        std::shared_ptr<const Frame> mailbox;
+        std::atomic<bool> closed{false};
+
+        // The request is read here rather than on the accept thread, so a client that connects
+        // and says nothing only ties up its own thread until the receive timeout
+        void sendLoop() {
+            if (!handshake(fd, mode)) {
+                closed = true;
+                return;
+            }
+            ready.store(true, std::memory_order_release);
+            server.clientCount++;
+            for (;;) {
+                std::shared_ptr<const Frame> frame;
+                {
+                    std::unique_lock<std::mutex> lock(mailboxMutex);
+                    mailboxReady.wait(lock, [&] { return mailbox || closed; });
+                    if (closed) {
+                        break;  // Closed by the server
+                    }
+                    frame.swap(mailbox);
+                }
+                if (!sendFrame(*frame)) {
+                    closed = true;
+                    break;
+                }
+                server.sent++;
+            }
+            server.clientCount--;
+        }
+
+        bool sendFrame(const Frame& frame) {
+            if (mode == Mode::Mjpeg) {
+                std::string header = "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: " +
+                                     std::to_string(frame.jpeg.size()) + "\r\n\r\n";
+                return sendAll(fd, header.data(), header.size()) &&
+                       sendAll(fd, frame.jpeg.data(), frame.jpeg.size()) && sendAll(fd, "\r\n", 2);
+            }
+            uint8_t prefix[8];
+            size_t prefixSize = 0;
+            const std::vector<uint8_t>& payload = mode == Mode::WebSocketRaw ? frame.rgba : frame.jpeg;
+            if (mode == Mode::WebSocketRaw) {
+                uint32_t size[2] = {frame.width, frame.height};
+                for (int i = 0; i < 8; i++) {
+                    prefix[i] = static_cast<uint8_t>(size[i / 4] >> (8 * (i % 4)));
+                }
+                prefixSize = 8;
+            }
+            // Unmasked binary message, 64-bit length
+            uint64_t length = payload.size() + prefixSize;
+            uint8_t header[10] = {0x82, 127};
+            for (int i = 0; i < 8; i++) {
+                header[2 + i] = static_cast<uint8_t>(length >> (8 * (7 - i)));
+            }
+            return sendAll(fd, header, sizeof(header)) && sendAll(fd, prefix, prefixSize) &&
+                   sendAll(fd, payload.data(), payload.size());
+        }
+    };
+
+    int listenFd = -1;
+    int quality = 85;
+    std::atomic<bool> running{false};
+    std::thread acceptThread;
+    std::vector<std::thread> encoders;
+
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::deque<Job> jobs;
+
+    std::mutex clientsMutex;
+    std::list<std::unique_ptr<Client>> clients;
+    std::atomic<int> clientCount{0};
+    std::atomic<uint64_t> published{0};  // Newest sequence sent out (+1)
+    std::atomic<uint64_t> sent{0}, dropped{0};
+
+    void encodeLoop() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(jobMutex);
+                jobReady.wait(lock, [&] { return !jobs.empty() || !running; });
+                if (jobs.empty()) {
+                    return;
+                }
+                job = jobs.front();
+                jobs.pop_front();
+            }
+            bool raw = false, jpeg = false;
+            {
+                std::lock_guard<std::mutex> lock(clientsMutex);
+                for (const auto& client : clients) {
+                    if (client->streaming()) {
+                        (client->wantsRaw() ? raw : jpeg) = true;
+                    }
+                }
+            }
+            auto frame = std::make_shared<Frame>();
+            frame->sequence = job.sequence;
+            frame->width = job.width;
+            frame->height = job.height;
+            if (raw) {
+                frame->rgba.assign(job.rgba, job.rgba + static_cast<size_t>(job.width) * job.height * 4);
+            }
+            if (jpeg) {
+                frame->jpeg = jpeg_writer::encode(job.rgba, job.width, job.height, quality);
+            }
+            job.busy->store(false, std::memory_order_release);
+
+            // Encoders finish out of order: never replace a newer frame with an older one
+            uint64_t previous = published.load();
+            while (previous <= job.sequence && !published.compare_exchange_weak(previous, job.sequence + 1)) {
+            }
+            if (previous > job.sequence) {
+                dropped++;
+                continue;
+            }
+            // A client that finished its handshake since the formats were chosen waits for the
+            // next frame rather than getting an empty payload
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            for (const auto& client : clients) {
+                if (client->streaming() && (client->wantsRaw() ? raw : jpeg)) {
+                    client->post(frame);
+                }
+            }
+        }
+    }
+
+    void acceptLoop() {
+        while (running) {
+            pollfd listening{listenFd, POLLIN, 0};
+            if (poll(&listening, 1, 100) <= 0) {
+                reapClients();
+                continue;
+            }
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+#ifdef SO_NOSIGPIPE
+            int yes = 1;
+            setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(yes));
+#endif
+            timeval timeout{2, 0};  // A client that doesn't finish its request in time is dropped
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            clients.emplace_back(new Client(fd, *this));
+        }
+    }
+
+    // Join the sender threads of clients that went away
+    void reapClients() {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        clients.remove_if([](const std::unique_ptr<Client>& client) { return !client->alive(); });
+    }
+
+    // Read the request and answer it; true if the connection now carries a stream
+    static bool handshake(int fd, Mode& mode) {
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                return false;
+            }
+            request.append(buffer, static_cast<size_t>(received));
+        }
+        std::istringstream lines(request);
+        std::string method, path, line, key;
+        lines >> method >> path;
+        std::getline(lines, line);
+        while (std::getline(lines, line) && line != "\r") {
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) {
+                continue;
+            }
+            std::string name = line.substr(0, colon);
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+            if (name == "sec-websocket-key") {
+                key = line.substr(colon + 1);
+                key.erase(0, key.find_first_not_of(' '));
+                key.erase(key.find_last_not_of("\r ") + 1);
+            }
+        }
+
+        std::string response;
+        if (method == "GET" && !key.empty() && (path == "/" || path == "/raw")) {
+            mode = path == "/raw" ? Mode::WebSocketRaw : Mode::WebSocketJpeg;
+            response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: " + acceptKey(key) + "\r\n\r\n";
+            return sendAll(fd, response.data(), response.size());
+        }
+        if (method == "GET" && path == "/stream") {
+            mode = Mode::Mjpeg;
+            response = "HTTP/1.1 200 OK\r\nContent-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+                       "Cache-Control: no-cache\r\nConnection: close\r\n\r\n";
+            return sendAll(fd, response.data(), response.size());
+        }
+        if (method == "GET" && path == "/") {
+            std::string page = "<!DOCTYPE html><title>metalshade</title>"
+                               "<body style=\"margin:0;background:#000\">"
+                               "<img src=\"/stream\" style=\"width:100vw;height:100vh;object-fit:contain\">";
+            response = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: " +
+                       std::to_string(page.size()) + "\r\nConnection: close\r\n\r\n" + page;
+        } else {
+            response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        }
+        sendAll(fd, response.data(), response.size());
+        return false;
+    }
+};
+
+}  // namespace frame_server
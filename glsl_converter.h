@@ -0,0 +1,492 @@
+// glsl_converter.h - In-process ShaderToy / Book of Shaders → Vulkan GLSL conversion
+//
+// The source is split into tokens (identifiers, numbers, punctuation, whitespace,
+// comments, preprocessor lines) and rewritten token by token, so nothing inside comments
+// is touched, `foo.iTime` stays a member access, and a local variable that shadows a
+// uniform keeps its name inside its scope. Rules:
+//
+//   uniform <type> iTime; / u_time; / sampler decls     removed (the header provides them)
+//   iTime, iFrame, ... (every uniforms.h field)          ubo.iTime, ubo.iFrame, ...
+//   u_time, u_resolution, u_mouse, u_texN                Book of Shaders equivalents
+//   gl_FragCoord / gl_FragColor                          fragCoord / fragColor
+//   texture2D, textureCube, texture2DLod, ...            texture, textureLod, ...
+//   #version                                             dropped (the header has #version 450)
+//   void mainImage(out vec4 c, [in] vec2 p)              kept; a main() wrapper calls it
+//   // @param N int 64 (with #define N / const int N)    layout(constant_id) const int N (shader_params.h)
+//   ISF INPUTS (float, color, bool, point2D)             push-constant block ISFInputs (isf_inputs.h)
+//   // @deepzoom [re im]                                 orbit buffer + deepZoomIterations() (deep_zoom.h)
+//   // @precision df64                                   double-float library df64Add, df64cMul, ... (df64.h)
+//   // @recolor with iterate() and colorize()            a main() running either pass (iteration_buffer.h)
+//
+// Identifiers inside #define/#if lines are rewritten too (so `#define t iTime` works), but
+// declarations there are not tracked.
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "deep_zoom.h"
+#include "df64.h"
+#include "isf_inputs.h"
+#include "iteration_buffer.h"
+#include "shader_params.h"
+#include "uniforms.h"
+
+namespace glsl_converter {
+
+enum class TokenKind { Identifier, Number, Punct, Space, Comment, Preprocessor };
+
+struct Token {
+    TokenKind kind;
+    std::string text;
+};
+
+inline bool isIdentStart(char c) { return std::isalpha((unsigned char)c) || c == '_'; }
+inline bool isIdentChar(char c) { return std::isalnum((unsigned char)c) || c == '_'; }
+
+inline std::vector<Token> tokenize(const std::string& src) {
+    std::vector<Token> tokens;
+    size_t i = 0, n = src.size();
+    bool lineStart = true;  // Only whitespace so far on this line (preprocessor detection)
+
+    while (i < n) {
+        char c = src[i];
+        size_t start = i;
+
+        if (c == '#' && lineStart) {
+            // Preprocessor line, including backslash continuations
+            while (i < n && src[i] != '\n') {
+                if (src[i] == '\\' && i + 1 < n && src[i + 1] == '\n') {
+                    i += 2;
+                } else {
+                    i++;
+                }
+            }
+            tokens.push_back({TokenKind::Preprocessor, src.substr(start, i - start)});
+            continue;
+        }
+
+        if (c == '/' && i + 1 < n && src[i + 1] == '/') {
+            while (i < n && src[i] != '\n') i++;
+            tokens.push_back({TokenKind::Comment, src.substr(start, i - start)});
+            continue;
+        }
+        if (c == '/' && i + 1 < n && src[i + 1] == '*') {
+            size_t end = src.find("*/", i + 2);
+            i = end == std::string::npos ? n : end + 2;
+            tokens.push_back({TokenKind::Comment, src.substr(start, i - start)});
+            continue;
+        }
+
+        if (std::isspace((unsigned char)c)) {
+            while (i < n && std::isspace((unsigned char)src[i])) {
+                if (src[i] == '\n') lineStart = true;
+                i++;
+            }
+            tokens.push_back({TokenKind::Space, src.substr(start, i - start)});
+            continue;
+        }
+        lineStart = false;
+
+        if (isIdentStart(c)) {
+            while (i < n && isIdentChar(src[i])) i++;
+            tokens.push_back({TokenKind::Identifier, src.substr(start, i - start)});
+        } else if (std::isdigit((unsigned char)c) || (c == '.' && i + 1 < n && std::isdigit((unsigned char)src[i + 1]))) {
+            // Numbers incl. 1.5e-3, 0x1F, 2u, 1.0lf
+            while (i < n && (isIdentChar(src[i]) || src[i] == '.' ||
+                             ((src[i] == '+' || src[i] == '-') && (src[i - 1] == 'e' || src[i - 1] == 'E') &&
+                              !(src[start] == '0' && start + 1 < n && (src[start + 1] == 'x' || src[start + 1] == 'X'))))) {
+                i++;
+            }
+            tokens.push_back({TokenKind::Number, src.substr(start, i - start)});
+        } else {
+            tokens.push_back({TokenKind::Punct, std::string(1, c)});
+            i++;
+        }
+    }
+    return tokens;
+}
+
+struct Result {
+    bool ok = false;
+    std::string output;
+    std::string error;
+    std::vector<shader_params::Param> params;  // // @param annotations, in constant_id order
+    isf_inputs::Block inputs;                  // ISF INPUTS the viewer feeds at runtime
+};
+
+class Converter {
+public:
+    // uniforms: block members accessed as ubo.<name>
+    explicit Converter(const std::vector<std::string>& uniforms) {
+        for (const std::string& name : uniforms) {
+            replacements[name] = "ubo." + name;
+        }
+        replacements["u_time"] = "ubo.iTime";
+        replacements["u_resolution"] = "ubo.iResolution.xy";
+        replacements["u_mouse"] = "ubo.iMouse.xy";
+        for (int i = 0; i < 4; i++) {
+            std::string n = std::to_string(i);
+            replacements["u_tex" + n] = "iChannel" + n;
+            replacements["u_tex" + n + "Resolution"] = "ubo.iChannelResolution[" + n + "].xy";
+        }
+        replacements["gl_FragCoord"] = "fragCoord";
+        replacements["gl_FragColor"] = "fragColor";
+        replacements["texture2D"] = "texture";
+        replacements["texture3D"] = "texture";
+        replacements["textureCube"] = "texture";
+        replacements["texture2DLod"] = "textureLod";
+        replacements["textureCubeLod"] = "textureLod";
+        replacements["texture2DLodEXT"] = "textureLod";
+        replacements["texture2DGradEXT"] = "textureGrad";
+        replacements["shadow2D"] = "texture";
+    }
+
+    Result convert(const std::string& source, const std::string& header) const {
+        Result result;
+        std::vector<Token> tokens = tokenize(source);
+
+        bool hasMain = false;
+        bool hasMainImage = false;
+        std::vector<bool> removed(tokens.size(), false);
+        findEntryPoints(tokens, hasMain, hasMainImage);
+        bool recolor = iteration_buffer::requested(source);
+        if (recolor && (hasMain || hasMainImage)) {
+            result.error = "// @recolor shaders define iterate() and colorize() instead of main() or mainImage()";
+            return result;
+        }
+        if (!hasMain && !hasMainImage && !recolor) {
+            result.error = "No main() or mainImage() function found";
+            return result;
+        }
+        removeUniformDeclarations(tokens, removed);
+        result.params = shader_params::parse(source);
+        removeParamDefinitions(tokens, result.params, removed);
+        result.inputs = isf_inputs::parse(source);
+
+        std::string body;
+        body.reserve(source.size() + source.size() / 4);
+
+        // Scope stack of names declared locally that shadow a replacement
+        std::vector<std::set<std::string>> scopes(1);
+        std::set<std::string> pendingParameters;  // Declared in a signature, live in the next { }
+        int parenDepth = 0;
+        const Token* previous = nullptr;  // Last significant token
+
+        // A declaration runs from its type to the `;` (or a function's `{`); every name after a
+        // `,` at its own paren depth is another declarator: `float x = 1.0, iMouse = 2.0;`
+        bool declaring = false;
+        bool declaratorNext = false;
+        int declarationDepth = 0;
+
+        // `for (` opens a scope for its init declarations that lasts until the end of the body,
+        // a { } block or a single statement
+        enum class LoopPart { Header, BodyNext, Body };
+        struct Loop {
+            size_t scope;  // Index in scopes
+            int parenDepth;
+            LoopPart part;
+        };
+        std::vector<Loop> loops;
+        bool forKeyword = false;
+        auto endLoops = [&] {
+            // Loops whose scope is innermost again have reached the end of their body
+            while (!loops.empty() && loops.back().part == LoopPart::Body && loops.back().scope + 1 == scopes.size()) {
+                scopes.pop_back();
+                loops.pop_back();
+            }
+        };
+
+        for (size_t t = 0; t < tokens.size(); t++) {
+            if (removed[t]) {
+                continue;
+            }
+            const Token& token = tokens[t];
+            bool significant = token.kind == TokenKind::Identifier || token.kind == TokenKind::Number ||
+                               token.kind == TokenKind::Punct;
+            if (significant && !loops.empty() && loops.back().part == LoopPart::BodyNext) {
+                loops.back().part = LoopPart::Body;
+            }
+            switch (token.kind) {
+                case TokenKind::Preprocessor:
+                    body += rewritePreprocessor(token.text, scopes);
+                    continue;
+                case TokenKind::Space:
+                case TokenKind::Comment:
+                    body += token.text;
+                    continue;
+                case TokenKind::Punct: {
+                    char c = token.text[0];
+                    if (c == '(') {
+                        parenDepth++;
+                        if (forKeyword) {
+                            loops.push_back({scopes.size(), parenDepth, LoopPart::Header});
+                            scopes.emplace_back();
+                        }
+                    }
+                    if (c == ')') {
+                        parenDepth = std::max(0, parenDepth - 1);
+                        if (!loops.empty() && loops.back().part == LoopPart::Header &&
+                            parenDepth < loops.back().parenDepth) {
+                            loops.back().part = LoopPart::BodyNext;
+                        }
+                    }
+                    forKeyword = false;
+                    if (c == ',' && declaring && parenDepth == declarationDepth) declaratorNext = true;
+                    if (c == '{' || c == '}' || (c == ';' && parenDepth <= declarationDepth)) {
+                        declaring = false;
+                        declaratorNext = false;
+                    }
+                    if (c == '{') {
+                        scopes.emplace_back(std::move(pendingParameters));
+                        pendingParameters.clear();
+                    }
+                    if (c == '}') {
+                        endLoops();  // A single-statement loop left unterminated in this block
+                        if (scopes.size() > 1) scopes.pop_back();
+                        endLoops();
+                    }
+                    if (c == ';') {
+                        pendingParameters.clear();  // Prototype, not a definition
+                        endLoops();
+                    }
+                    break;
+                }
+                case TokenKind::Identifier: {
+                    bool member = previous && previous->kind == TokenKind::Punct && previous->text == ".";
+                    bool signature = parenDepth > 0 && scopes.size() == 1;
+                    bool declarator = !member && !isTypeName(token.text) &&
+                                      ((previous && previous->kind == TokenKind::Identifier &&
+                                        isTypeName(previous->text)) ||
+                                       (declaratorNext && parenDepth == declarationDepth));
+                    forKeyword = token.text == "for";
+                    if (declarator && !signature) {
+                        declaring = true;
+                        declaratorNext = false;
+                        declarationDepth = parenDepth;
+                    }
+                    if (declarator && replacements.count(token.text)) {
+                        // `float iTime = ...` or a parameter named like a uniform shadows it
+                        (signature ? pendingParameters : scopes.back()).insert(token.text);
+                        body += token.text;
+                    } else if (member || isShadowed(token.text, scopes)) {
+                        body += token.text;
+                    } else {
+                        body += replace(token.text);
+                    }
+                    previous = &token;
+                    continue;
+                }
+                case TokenKind::Number:
+                    forKeyword = false;
+                    break;
+            }
+            body += token.text;
+            previous = &token;
+        }
+
+        result.output = header;
+        if (!header.empty() && header.back() != '\n') {
+            result.output += "\n";
+        }
+        if (!result.params.empty()) {
+            result.output += "\n// @param specialization constants\n";
+            for (const shader_params::Param& param : result.params) {
+                result.output += param.declaration() + "\n";
+            }
+        }
+        if (!result.inputs.inputs.empty()) {
+            result.output += "\n// ISF inputs\n" + result.inputs.declaration();
+        }
+        if (df64::requested(source)) {
+            result.output += df64::glslLibrary();
+        }
+        if (source.find("// @deepzoom") != std::string::npos) {
+            result.output += deep_zoom::glslLibrary();
+        }
+        if (recolor) {
+            result.output += iteration_buffer::declaration(result.params.size());
+        }
+        result.output += "\n" + trimmed(body) + "\n";
+        if (recolor) {
+            result.output += iteration_buffer::mainFunction();
+        }
+        if (hasMainImage && !hasMain) {
+            result.output += "\nvoid main() {\n"
+                             "    vec4 color = vec4(0.0);\n"
+                             "    mainImage(color, " + std::string(fragCoordGLSL()) + ");\n"
+                             "    fragColor = color;\n"
+                             "}\n";
+        }
+        result.ok = true;
+        return result;
+    }
+
+private:
+    std::map<std::string, std::string> replacements;
+
+    static bool isTypeName(const std::string& name) {
+        static const std::set<std::string> types = {
+            "float", "int", "uint", "bool", "double",
+            "vec2", "vec3", "vec4", "ivec2", "ivec3", "ivec4", "uvec2", "uvec3", "uvec4",
+            "bvec2", "bvec3", "bvec4", "dvec2", "dvec3", "dvec4",
+            "mat2", "mat3", "mat4", "mat2x2", "mat2x3", "mat2x4", "mat3x2", "mat3x3", "mat3x4",
+            "mat4x2", "mat4x3", "mat4x4", "sampler2D", "sampler3D", "samplerCube"};
+        return types.count(name) > 0;
+    }
+
+    static bool isShadowed(const std::string& name, const std::vector<std::set<std::string>>& scopes) {
+        for (const auto& scope : scopes) {
+            if (scope.count(name)) return true;
+        }
+        return false;
+    }
+
+    std::string replace(const std::string& name) const {
+        auto it = replacements.find(name);
+        return it == replacements.end() ? name : it->second;
+    }
+
+    static size_t nextSignificant(const std::vector<Token>& tokens, size_t t) {
+        while (t < tokens.size() && (tokens[t].kind == TokenKind::Space || tokens[t].kind == TokenKind::Comment)) t++;
+        return t;
+    }
+
+    // `void main (` / `void mainImage (` at global scope
+    static void findEntryPoints(const std::vector<Token>& tokens, bool& hasMain, bool& hasMainImage) {
+        int depth = 0;
+        for (size_t t = 0; t < tokens.size(); t++) {
+            const Token& token = tokens[t];
+            if (token.kind == TokenKind::Punct) {
+                if (token.text == "{") depth++;
+                if (token.text == "}") depth--;
+                continue;
+            }
+            if (depth != 0 || token.kind != TokenKind::Identifier || token.text != "void") {
+                continue;
+            }
+            size_t name = nextSignificant(tokens, t + 1);
+            size_t paren = nextSignificant(tokens, name + 1);
+            if (paren >= tokens.size() || tokens[paren].text != "(") {
+                continue;
+            }
+            if (tokens[name].text == "main") hasMain = true;
+            if (tokens[name].text == "mainImage") hasMainImage = true;
+        }
+    }
+
+    // Drop `uniform <type> <name> [N];` when the header already provides <name>, plus any
+    // sampler uniform (channels are always iChannel0-3)
+    void removeUniformDeclarations(const std::vector<Token>& tokens, std::vector<bool>& removed) const {
+        for (size_t t = 0; t < tokens.size(); t++) {
+            if (tokens[t].kind != TokenKind::Identifier || tokens[t].text != "uniform") {
+                continue;
+            }
+            size_t type = nextSignificant(tokens, t + 1);
+            size_t name = nextSignificant(tokens, type + 1);
+            if (name >= tokens.size() || tokens[name].kind != TokenKind::Identifier) {
+                continue;
+            }
+            bool sampler = tokens[type].text.compare(0, 7, "sampler") == 0;
+            if (!sampler && !replacements.count(tokens[name].text)) {
+                continue;
+            }
+            size_t end = name + 1;
+            while (end < tokens.size() && tokens[end].text != ";") end++;
+            if (end == tokens.size()) {
+                continue;
+            }
+            for (size_t k = t; k <= end; k++) {
+                removed[k] = true;
+            }
+            t = end;
+        }
+    }
+
+    // Drop the `#define NAME value` or global `const <type> NAME = value;` an @param replaces
+    static void removeParamDefinitions(const std::vector<Token>& tokens, const std::vector<shader_params::Param>& params,
+                                       std::vector<bool>& removed) {
+        std::set<std::string> names;
+        for (const shader_params::Param& param : params) {
+            names.insert(param.name);
+        }
+        if (names.empty()) {
+            return;
+        }
+        int depth = 0;
+        for (size_t t = 0; t < tokens.size(); t++) {
+            const Token& token = tokens[t];
+            if (token.kind == TokenKind::Preprocessor) {
+                // Object-like macros only: `#define N(x)` is a function, not a parameter
+                std::vector<Token> inner = tokenize(token.text.substr(token.text.find('#') + 1));
+                size_t directive = nextSignificant(inner, 0);
+                size_t name = nextSignificant(inner, directive + 1);
+                if (name < inner.size() && inner[directive].text == "define" && names.count(inner[name].text) &&
+                    (name + 1 == inner.size() || inner[name + 1].text != "(")) {
+                    removed[t] = true;
+                }
+                continue;
+            }
+            if (token.kind == TokenKind::Punct) {
+                if (token.text == "{") depth++;
+                if (token.text == "}") depth--;
+                continue;
+            }
+            if (depth != 0 || token.kind != TokenKind::Identifier || token.text != "const") {
+                continue;
+            }
+            size_t type = nextSignificant(tokens, t + 1);
+            size_t name = nextSignificant(tokens, type + 1);
+            size_t assign = nextSignificant(tokens, name + 1);
+            if (assign >= tokens.size() || !isTypeName(tokens[type].text) || !names.count(tokens[name].text) ||
+                tokens[assign].text != "=") {
+                continue;
+            }
+            size_t end = assign + 1;
+            while (end < tokens.size() && tokens[end].text != ";") end++;
+            if (end == tokens.size()) {
+                continue;
+            }
+            for (size_t k = t; k <= end; k++) {
+                removed[k] = true;
+            }
+            t = end;
+        }
+    }
+
+    std::string rewritePreprocessor(const std::string& line, const std::vector<std::set<std::string>>& scopes) const {
+        size_t hash = line.find('#');
+        size_t directive = line.find_first_not_of(" \t", hash + 1);
+        if (directive != std::string::npos && line.compare(directive, 7, "version") == 0) {
+            return "";
+        }
+        std::string out = line.substr(0, directive);
+        std::vector<Token> inner = tokenize(directive == std::string::npos ? "" : line.substr(directive));
+        const Token* previous = nullptr;
+        for (const Token& token : inner) {
+            bool member = previous && previous->text == ".";
+            if (token.kind == TokenKind::Identifier && !member && !isShadowed(token.text, scopes)) {
+                out += replace(token.text);
+            } else {
+                out += token.text;
+            }
+            if (token.kind != TokenKind::Space && token.kind != TokenKind::Comment) {
+                previous = &token;
+            }
+        }
+        return out;
+    }
+
+    static std::string trimmed(const std::string& text) {
+        size_t begin = text.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos) return "";
+        size_t end = text.find_last_not_of(" \t\r\n");
+        return text.substr(begin, end - begin + 1);
+    }
+};
+
+}  // namespace glsl_converter
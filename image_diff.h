@@ -0,0 +1,144 @@
+// image_diff.h - Per-pixel and structural (SSIM) differences between two RGBA8 frames
+//
+// For --golden, which compares rendered frames against stored references:
+//   absDiff   |a - b| per byte, and the largest of them, 16 bytes at a time with SSE2 or NEON
+//             (plain C elsewhere)
+//   ssim      mean structural similarity of the luma over 8x8 windows at a stride of 4, the
+//             usual constants for 8-bit data; 1 for identical images, near 0 for unrelated ones
+//   compare   both, plus the count of pixels whose largest channel difference exceeds a
+//             tolerance, and a heat map of the per-pixel difference for the diff image
+// Everything works on one pair of images on the calling thread; --golden runs the pairs in
+// parallel on a WorkPool.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define IMAGE_DIFF_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define IMAGE_DIFF_NEON 1
+#endif
+
+namespace image_diff {
+
+// diff[i] = |a[i] - b[i]|; returns the largest
+inline uint8_t absDiff(const uint8_t* a, const uint8_t* b, uint8_t* diff, size_t size) {
+    size_t i = 0;
+    uint8_t largest = 0;
+#if IMAGE_DIFF_SSE2
+    __m128i maximum = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i d = _mm_or_si128(_mm_subs_epu8(x, y), _mm_subs_epu8(y, x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(diff + i), d);
+        maximum = _mm_max_epu8(maximum, d);
+    }
+    alignas(16) uint8_t lanes[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), maximum);
+    largest = *std::max_element(lanes, lanes + 16);
+#elif IMAGE_DIFF_NEON
+    uint8x16_t maximum = vdupq_n_u8(0);
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t d = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+        vst1q_u8(diff + i, d);
+        maximum = vmaxq_u8(maximum, d);
+    }
+    largest = vmaxvq_u8(maximum);
+#endif
+    for (; i < size; i++) {
+        diff[i] = static_cast<uint8_t>(a[i] > b[i] ? a[i] - b[i] : b[i] - a[i]);
+        largest = std::max(largest, diff[i]);
+    }
+    return largest;
+}
+
+// Rec. 601 luma of each pixel, 0..255
+inline std::vector<float> luma(const uint8_t* rgba, uint32_t width, uint32_t height) {
+    std::vector<float> result(static_cast<size_t>(width) * height);
+    for (size_t p = 0; p < result.size(); p++) {
+        const uint8_t* px = rgba + p * 4;
+        result[p] = 0.299f * px[0] + 0.587f * px[1] + 0.114f * px[2];
+    }
+    return result;
+}
+
+constexpr uint32_t WINDOW = 8;
+constexpr uint32_t STRIDE = 4;
+
+// Mean SSIM over the windows (images smaller than a window are compared as one window)
+inline double ssim(const uint8_t* a, const uint8_t* b, uint32_t width, uint32_t height) {
+    const double c1 = (0.01 * 255) * (0.01 * 255);
+    const double c2 = (0.03 * 255) * (0.03 * 255);
+    std::vector<float> x = luma(a, width, height);
+    std::vector<float> y = luma(b, width, height);
+    uint32_t windowWidth = std::min(WINDOW, width);
+    uint32_t windowHeight = std::min(WINDOW, height);
+    double total = 0.0;
+    uint64_t windows = 0;
+    for (uint32_t top = 0; top + windowHeight <= height; top += STRIDE) {
+        for (uint32_t left = 0; left + windowWidth <= width; left += STRIDE) {
+            float sx = 0, sy = 0, sxx = 0, syy = 0, sxy = 0;
+            for (uint32_t row = top; row < top + windowHeight; row++) {
+                const float* rx = &x[static_cast<size_t>(row) * width + left];
+                const float* ry = &y[static_cast<size_t>(row) * width + left];
+                for (uint32_t c = 0; c < windowWidth; c++) {
+                    sx += rx[c];
+                    sy += ry[c];
+                    sxx += rx[c] * rx[c];
+                    syy += ry[c] * ry[c];
+                    sxy += rx[c] * ry[c];
+                }
+            }
+            double n = static_cast<double>(windowWidth) * windowHeight;
+            double mx = sx / n, my = sy / n;
+            double vx = std::max(0.0, sxx / n - mx * mx);
+            double vy = std::max(0.0, syy / n - my * my);
+            double cov = sxy / n - mx * my;
+            total += (2 * mx * my + c1) * (2 * cov + c2) / ((mx * mx + my * my + c1) * (vx + vy + c2));
+            windows++;
+        }
+    }
+    return windows ? total / windows : 1.0;
+}
+
+struct Result {
+    uint8_t maxDiff = 0;           // Largest channel difference
+    uint64_t differingPixels = 0;  // Pixels with a channel differing by more than the tolerance
+    double ssim = 1.0;
+};
+
+// Compare two RGBA8 images of the same size; with heatMap, also fill it (RGBA8, same size) with
+// each pixel's largest channel difference, amplified, red where it exceeds the tolerance
+inline Result compare(const uint8_t* a, const uint8_t* b, uint32_t width, uint32_t height, uint8_t tolerance,
+                      std::vector<uint8_t>* heatMap = nullptr) {
+    Result result;
+    size_t pixels = static_cast<size_t>(width) * height;
+    std::vector<uint8_t> diff(pixels * 4);
+    result.maxDiff = absDiff(a, b, diff.data(), diff.size());
+    if (heatMap) {
+        heatMap->assign(pixels * 4, 255);
+    }
+    for (size_t p = 0; p < pixels; p++) {
+        const uint8_t* d = &diff[p * 4];
+        uint8_t largest = std::max(std::max(d[0], d[1]), std::max(d[2], d[3]));
+        bool over = largest > tolerance;
+        result.differingPixels += over;
+        if (heatMap) {
+            uint8_t level = static_cast<uint8_t>(std::min(255, largest * 4));
+            uint8_t* out = &(*heatMap)[p * 4];
+            out[0] = over ? 255 : level;
+            out[1] = over ? 255 - level : level;
+            out[2] = over ? 0 : level;
+        }
+    }
+    result.ssim = ssim(a, b, width, height);
+    return result;
+}
+
+}  // namespace image_diff
@@ -0,0 +1,118 @@
+// input_events.h - Timestamped mouse input, the iMouseHistory samples and iMouse smoothing
+//
+// The mouse callbacks push every move, button and scroll event, stamped with steadySeconds(),
+// into an SpscQueue (keyboard_state.h); the render loop drains it once per frame. GLFW only
+// calls back while events are polled, so the viewer also polls while it waits for a frame's
+// fence: cursor motion is then sampled at the polling rate rather than the frame rate.
+//
+// Draining feeds two things:
+//   MouseHistory  the last HISTORY_SIZE cursor positions with their timestamps and buttons,
+//                 uploaded newest first as iMouseHistory for brush shaders to draw strokes
+//   Smoother      an exponential filter advanced from sample to sample over real time, so
+//                 iMouse settles the same way whether the cursor moved once or fifty times
+//                 during a frame
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "keyboard_state.h"
+
+namespace input_events {
+
+constexpr uint32_t HISTORY_SIZE = 32;  // Length of iMouseHistory in uniforms.h
+
+enum class Kind : uint8_t { Move, Button, Scroll };
+
+struct Event {
+    double timestamp;  // steadySeconds() when the callback ran
+    Kind kind;
+    int button;        // Button: GLFW button number
+    bool pressed;      // Button: press or release
+    double x, y;       // Move, Button: cursor position (window coordinates); Scroll: offsets
+};
+
+using Queue = SpscQueue<Event, 1024>;
+
+// Bit of Sample::buttons for a GLFW button (left, right, middle, 4, 5)
+inline uint32_t buttonBit(int button) {
+    return button >= 0 && button < 5 ? 1u << button : 0u;
+}
+
+struct Sample {
+    double timestamp = 0.0;
+    double x = 0.0, y = 0.0;  // Window coordinates
+    uint32_t buttons = 0;
+};
+
+// Ring of the latest cursor samples; at(0) is the newest
+class MouseHistory {
+public:
+    void clear() {
+        count = 0;
+        arrived = 0;
+    }
+
+    void push(const Sample& sample) {
+        newest = (newest + 1) % HISTORY_SIZE;
+        samples[newest] = sample;
+        count = count < HISTORY_SIZE ? count + 1 : HISTORY_SIZE;
+        arrived++;
+    }
+
+    uint32_t size() const { return count; }
+    const Sample& at(uint32_t i) const { return samples[(newest + HISTORY_SIZE - i) % HISTORY_SIZE]; }
+
+    // Samples pushed since the last call (at most size() - 1 while an older one remains, so a
+    // stroke can always be joined to where the previous frame left it)
+    uint32_t takeArrived() {
+        uint32_t result = arrived < count ? arrived : (count > 0 ? count - 1 : 0);
+        arrived = 0;
+        return result;
+    }
+
+private:
+    Sample samples[HISTORY_SIZE];
+    uint32_t newest = 0;
+    uint32_t count = 0;
+    uint32_t arrived = 0;
+};
+
+// First-order low-pass over a piecewise-constant target: between samples the position decays
+// toward the last one with time constant tau seconds
+class Smoother {
+public:
+    void reset(double x, double y, double timestamp) {
+        smoothX = targetX = x;
+        smoothY = targetY = y;
+        time = timestamp;
+    }
+
+    // The target jumps to (x, y) at timestamp
+    void sample(double x, double y, double timestamp, double tau) {
+        advance(timestamp, tau);
+        targetX = x;
+        targetY = y;
+    }
+
+    void advance(double timestamp, double tau) {
+        double dt = timestamp - time;
+        if (dt <= 0.0) {
+            return;
+        }
+        double a = tau > 0.0 ? 1.0 - std::exp(-dt / tau) : 1.0;
+        smoothX += (targetX - smoothX) * a;
+        smoothY += (targetY - smoothY) * a;
+        time = timestamp;
+    }
+
+    double x() const { return smoothX; }
+    double y() const { return smoothY; }
+
+private:
+    double smoothX = 0.0, smoothY = 0.0;
+    double targetX = 0.0, targetY = 0.0;
+    double time = 0.0;
+};
+
+}  // namespace input_events
@@ -0,0 +1,188 @@
+// input_trace.h - Input traces for --record / --replay
+//
+// A trace is the input of one interactive session, as text: a header naming the shader, the
+// framebuffer size and the tunable values it started from, then one line per input callback
+// and one per frame, each tagged with the frame it preceded:
+//
+//   metalshade-trace 1
+//   shader shaders/paint.frag
+//   size 1600 1200
+//   value ITER 256                   (a <base>.params line)
+//   selected 0                       (Tab stop)
+//   <frame> move <t> <x> <y>         cursor, framebuffer pixels
+//   <frame> button <t> <button> <pressed> <mods>
+//   <frame> scroll <t> <dx> <dy>
+//   <frame> key <t> <key> <action> <mods>
+//   <frame> frame <t>                the frame sampled its input here
+//
+// t is seconds since the recording started. Pan and zoom are not stored: they follow from
+// the drags, scrolls and keys. Replay feeds the lines back through the same handlers
+// and hashes every frame (frameHash) so two runs can be compared.
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace input_trace {
+
+enum class Kind { Frame, Move, Button, Scroll, Key };
+
+struct Entry {
+    uint64_t frame = 0;
+    Kind kind = Kind::Frame;
+    double time = 0.0;
+    int code = 0;      // Button or key
+    int action = 0;    // Button: pressed (0/1); key: GLFW action
+    int mods = 0;
+    double x = 0.0, y = 0.0;  // Move: position; scroll: offsets
+};
+
+struct Trace {
+    std::string shader;
+    uint32_t width = 0, height = 0;
+    std::string values;  // <base>.params lines
+    int selected = 0;
+    std::vector<Entry> entries;
+};
+
+inline const char* kindName(Kind kind) {
+    switch (kind) {
+        case Kind::Frame: return "frame";
+        case Kind::Move: return "move";
+        case Kind::Button: return "button";
+        case Kind::Scroll: return "scroll";
+        case Kind::Key: return "key";
+    }
+    return "?";
+}
+
+class Writer {
+public:
+    bool open(const std::string& path, const std::string& shader, uint32_t width, uint32_t height,
+              const std::string& values, int selected, std::string& error) {
+        file.open(path);
+        if (!file) {
+            error = "cannot create " + path;
+            return false;
+        }
+        file << "metalshade-trace 1\nshader " << shader << "\nsize " << width << " " << height << "\n";
+        std::istringstream lines(values);
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (!line.empty() && line[0] != '#') {
+                file << "value " << line << "\n";
+            }
+        }
+        file << "selected " << selected << "\n";
+        return true;
+    }
+
+    bool isOpen() const { return file.is_open(); }
+
+    void write(const Entry& entry) {
+        char line[160];
+        switch (entry.kind) {
+            case Kind::Frame:
+                snprintf(line, sizeof(line), "%llu frame %.6f\n", (unsigned long long)entry.frame, entry.time);
+                break;
+            case Kind::Move:
+            case Kind::Scroll:
+                snprintf(line, sizeof(line), "%llu %s %.6f %.3f %.3f\n", (unsigned long long)entry.frame,
+                         kindName(entry.kind), entry.time, entry.x, entry.y);
+                break;
+            case Kind::Button:
+            case Kind::Key:
+                snprintf(line, sizeof(line), "%llu %s %.6f %d %d %d\n", (unsigned long long)entry.frame,
+                         kindName(entry.kind), entry.time, entry.code, entry.action, entry.mods);
+                break;
+        }
+        file << line;
+    }
+
+    void close() {
+        if (file.is_open()) {
+            file.close();
+        }
+    }
+
+private:
+    std::ofstream file;
+};
+
+inline bool read(const std::string& path, Trace& trace, std::string& error) {
+    std::ifstream file(path);
+    std::string line;
+    if (!file || !std::getline(file, line) || line != "metalshade-trace 1") {
+        error = path + " is not a metalshade input trace";
+        return false;
+    }
+    int number = 1;
+    while (std::getline(file, line)) {
+        number++;
+        std::istringstream fields(line);
+        std::string first;
+        if (!(fields >> first)) {
+            continue;
+        }
+        if (first == "shader") {
+            std::getline(fields >> std::ws, trace.shader);
+            continue;
+        } else if (first == "size") {
+            fields >> trace.width >> trace.height;
+            continue;
+        } else if (first == "value") {
+            std::string rest;
+            std::getline(fields >> std::ws, rest);
+            trace.values += rest + "\n";
+            continue;
+        } else if (first == "selected") {
+            fields >> trace.selected;
+            continue;
+        }
+
+        Entry entry;
+        std::string kind;
+        char* end = nullptr;
+        entry.frame = strtoull(first.c_str(), &end, 10);
+        if (*end != '\0') {
+            fields.setstate(std::ios::failbit);
+        }
+        fields >> kind >> entry.time;
+        if (kind == "frame") {
+            entry.kind = Kind::Frame;
+        } else if (kind == "move" || kind == "scroll") {
+            entry.kind = kind == "move" ? Kind::Move : Kind::Scroll;
+            fields >> entry.x >> entry.y;
+        } else if (kind == "button" || kind == "key") {
+            entry.kind = kind == "button" ? Kind::Button : Kind::Key;
+            fields >> entry.code >> entry.action >> entry.mods;
+        } else {
+            fields.setstate(std::ios::failbit);
+        }
+        if (!fields) {
+            error = path + ":" + std::to_string(number) + ": malformed line";
+            return false;
+        }
+        trace.entries.push_back(entry);
+    }
+    if (trace.shader.empty() || trace.width == 0 || trace.height == 0) {
+        error = path + " has no shader or size";
+        return false;
+    }
+    return true;
+}
+
+// FNV-1a of a frame's pixels
+inline uint64_t frameHash(const uint8_t* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+}  // namespace input_trace
@@ -0,0 +1,320 @@
+// isf_inputs.h - ISF INPUTS (float, color, bool, point2D) as runtime-tunable shader values
+//
+//   /*{ "INPUTS": [
+//         {"NAME": "brightness", "TYPE": "float", "DEFAULT": 0.5, "MIN": 0.0, "MAX": 2.0},
+//         {"NAME": "tint", "TYPE": "color", "DEFAULT": [1.0, 0.6, 0.2, 1.0]},
+//         {"NAME": "invert", "TYPE": "bool", "DEFAULT": false},
+//         {"NAME": "center", "TYPE": "point2D", "DEFAULT": [640, 360]} ] }*/
+//
+// The inputs are packed into one block (colors first, so std140 and std430 offsets agree).
+// Up to PUSH_CONSTANT_LIMIT bytes it is a push-constant block, updated with one
+// vkCmdPushConstants per frame; larger ones become a uniform block at UNIFORM_BINDING. The
+// block is anonymous, so shaders use the ISF names unchanged. Other input types (image,
+// audio, long, event) are ignored here.
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace isf_inputs {
+
+constexpr uint32_t PUSH_CONSTANT_LIMIT = 128;  // Minimum maxPushConstantsSize every device has
+constexpr uint32_t UNIFORM_BINDING = 5;        // After the UBO (0) and iChannel0-3 (1-4)
+constexpr uint32_t MAX_BLOCK_SIZE = 4096;
+
+enum class Type { Float, Color, Bool, Point2D };
+
+struct Input {
+    std::string name;
+    Type type = Type::Float;
+    float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float min[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float max[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    bool ranged = true;     // point2D without MIN/MAX is unbounded (pixels)
+    uint32_t offset = 0;    // Byte offset in the block
+
+    int components() const {
+        switch (type) {
+            case Type::Color: return 4;
+            case Type::Point2D: return 2;
+            default: return 1;
+        }
+    }
+
+    // Up/Down step for one component
+    float step(int component) const {
+        if (type == Type::Bool) return 1.0f;
+        if (!ranged) return 8.0f;
+        return std::max(1e-6f, (max[component] - min[component]) / 50.0f);
+    }
+
+    void adjust(int component, int direction) {
+        float& v = value[component];
+        if (type == Type::Bool) {
+            v = v != 0.0f ? 0.0f : 1.0f;
+            return;
+        }
+        v += direction * step(component);
+        if (ranged) {
+            v = std::min(max[component], std::max(min[component], v));
+        }
+    }
+
+    std::string valueText() const {
+        if (type == Type::Bool) return value[0] != 0.0f ? "on" : "off";
+        std::string text;
+        char number[32];
+        for (int c = 0; c < components(); c++) {
+            snprintf(number, sizeof(number), type == Type::Point2D ? "%.0f" : "%.2f", value[c]);
+            text += (c ? " " : "") + std::string(number);
+        }
+        return components() > 1 ? "(" + text + ")" : text;
+    }
+};
+
+struct Block {
+    std::vector<Input> inputs;
+    uint32_t size = 0;  // Bytes, including trailing padding to 16
+
+    bool pushConstant() const { return size <= PUSH_CONSTANT_LIMIT; }
+
+    const Input* find(const std::string& name) const {
+        for (const Input& input : inputs) {
+            if (input.name == name) return &input;
+        }
+        return nullptr;
+    }
+
+    // GLSL declaration of the block (nothing if there are no inputs)
+    std::string declaration() const {
+        if (inputs.empty()) {
+            return "";
+        }
+        static const char* typeNames[] = {"float", "vec4", "bool", "vec2"};
+        std::string glsl = pushConstant() ? "layout(push_constant) uniform ISFInputs {\n"
+                                          : "layout(set = 0, binding = " + std::to_string(UNIFORM_BINDING) +
+                                                ") uniform ISFInputs {\n";
+        std::vector<const Input*> members;
+        for (const Input& input : inputs) {
+            members.push_back(&input);
+        }
+        std::sort(members.begin(), members.end(), [](const Input* a, const Input* b) { return a->offset < b->offset; });
+        for (const Input* input : members) {
+            glsl += "    " + std::string(typeNames[static_cast<int>(input->type)]) + " " + input->name + ";\n";
+        }
+        return glsl + "};\n";
+    }
+
+    // Current values in block layout; data must hold size bytes
+    void pack(uint8_t* data) const {
+        memset(data, 0, size);
+        for (const Input& input : inputs) {
+            if (input.type == Type::Bool) {
+                uint32_t flag = input.value[0] != 0.0f ? 1 : 0;
+                memcpy(data + input.offset, &flag, sizeof(flag));
+            } else {
+                memcpy(data + input.offset, input.value, input.components() * sizeof(float));
+            }
+        }
+    }
+
+    // Keep values of inputs that still exist with the same type (after an edit of the shader)
+    void keepValues(const Block& previous) {
+        for (Input& input : inputs) {
+            const Input* old = previous.find(input.name);
+            if (old && old->type == input.type) {
+                memcpy(input.value, old->value, sizeof(input.value));
+            }
+        }
+    }
+};
+
+namespace detail {
+
+// Just enough JSON for ISF headers
+struct Value {
+    enum Kind { Null, Bool, Number, String, Array, Object } kind = Null;
+    double number = 0.0;
+    std::string text;
+    std::vector<Value> items;
+    std::map<std::string, Value> members;
+
+    const Value* get(const std::string& key) const {
+        auto it = members.find(key);
+        return it == members.end() ? nullptr : &it->second;
+    }
+};
+
+class Parser {
+public:
+    explicit Parser(const std::string& json) : s(json) {}
+
+    bool parse(Value& value) {
+        skipSpace();
+        if (at >= s.size()) return false;
+        char c = s[at];
+        if (c == '{') return parseObject(value);
+        if (c == '[') return parseArray(value);
+        if (c == '"') {
+            value.kind = Value::String;
+            return parseString(value.text);
+        }
+        if (s.compare(at, 4, "true") == 0 || s.compare(at, 5, "false") == 0) {
+            value.kind = Value::Bool;
+            value.number = s[at] == 't' ? 1.0 : 0.0;
+            at += s[at] == 't' ? 4 : 5;
+            return true;
+        }
+        if (s.compare(at, 4, "null") == 0) {
+            at += 4;
+            return true;
+        }
+        char* end = nullptr;
+        value.number = strtod(s.c_str() + at, &end);
+        if (end == s.c_str() + at) return false;
+        value.kind = Value::Number;
+        at = end - s.c_str();
+        return true;
+    }
+
+private:
+    const std::string& s;
+    size_t at = 0;
+
+    void skipSpace() {
+        while (at < s.size() && std::isspace((unsigned char)s[at])) at++;
+    }
+
+    bool expect(char c) {
+        skipSpace();
+        if (at < s.size() && s[at] == c) {
+            at++;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseString(std::string& out) {
+        at++;  // Opening quote
+        while (at < s.size() && s[at] != '"') {
+            if (s[at] == '\\' && at + 1 < s.size()) {
+                at++;
+                out += s[at] == 'n' ? '\n' : s[at] == 't' ? '\t' : s[at];
+            } else {
+                out += s[at];
+            }
+            at++;
+        }
+        return at++ < s.size();
+    }
+
+    bool parseArray(Value& value) {
+        value.kind = Value::Array;
+        at++;
+        if (expect(']')) return true;
+        do {
+            value.items.emplace_back();
+            if (!parse(value.items.back())) return false;
+        } while (expect(','));
+        return expect(']');
+    }
+
+    bool parseObject(Value& value) {
+        value.kind = Value::Object;
+        at++;
+        if (expect('}')) return true;
+        do {
+            skipSpace();
+            std::string key;
+            if (at >= s.size() || s[at] != '"' || !parseString(key) || !expect(':')) return false;
+            if (!parse(value.members[key])) return false;
+        } while (expect(','));
+        return expect('}');
+    }
+};
+
+inline void readFloats(const Value* value, float* out, int count) {
+    if (!value) return;
+    if (value->kind == Value::Number || value->kind == Value::Bool) {
+        out[0] = static_cast<float>(value->number);
+        return;
+    }
+    for (int i = 0; i < count && i < (int)value->items.size(); i++) {
+        out[i] = static_cast<float>(value->items[i].number);
+    }
+}
+
+}  // namespace detail
+
+// Inputs from the leading /*{ ... }*/ JSON header of an ISF shader (an empty block otherwise)
+inline Block parse(const std::string& source) {
+    using detail::Value;
+    Block block;
+    size_t begin = source.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos || source.compare(begin, 3, "/*{") != 0) {
+        return block;
+    }
+    size_t end = source.find("}*/", begin);
+    if (end == std::string::npos) {
+        return block;
+    }
+    std::string json = source.substr(begin + 2, end - begin - 1);
+    Value header;
+    if (!detail::Parser(json).parse(header) || header.kind != Value::Object) {
+        return block;
+    }
+    const Value* inputs = header.get("INPUTS");
+    if (!inputs || inputs->kind != Value::Array) {
+        return block;
+    }
+
+    for (const Value& item : inputs->items) {
+        const Value* name = item.get("NAME");
+        const Value* type = item.get("TYPE");
+        if (!name || !type || name->kind != Value::String || type->kind != Value::String) {
+            continue;
+        }
+        Input input;
+        input.name = name->text;
+        if (type->text == "float") {
+            input.type = Type::Float;
+        } else if (type->text == "color") {
+            input.type = Type::Color;
+            input.value[3] = 1.0f;
+        } else if (type->text == "bool") {
+            input.type = Type::Bool;
+        } else if (type->text == "point2D") {
+            input.type = Type::Point2D;
+            input.ranged = item.get("MIN") && item.get("MAX");
+        } else {
+            continue;
+        }
+        detail::readFloats(item.get("MIN"), input.min, input.components());
+        detail::readFloats(item.get("MAX"), input.max, input.components());
+        detail::readFloats(item.get("DEFAULT"), input.value, input.components());
+        block.inputs.push_back(input);
+    }
+
+    // Colors, then points, then scalars: every member lands on its alignment without holes.
+    // Inputs keep their ISF order (the order the viewer cycles through them).
+    uint32_t offset = 0;
+    for (int components : {4, 2, 1}) {
+        for (Input& input : block.inputs) {
+            if (input.components() == components) {
+                input.offset = offset;
+                offset += components * 4;
+            }
+        }
+    }
+    block.size = (offset + 15) / 16 * 16;
+    return block;
+}
+
+}  // namespace isf_inputs
@@ -0,0 +1,53 @@
+// iteration_buffer.h - Two-pass escape-time shaders: iterate once, recolour every frame
+//
+// A shader with a `// @recolor` line defines two functions instead of main()/mainImage():
+//
+//   vec2 iterate(vec2 fragCoord)                  the expensive part, e.g. (smooth iteration
+//                                                  count, distance estimate)
+//   vec4 colorize(vec2 iterations, vec2 fragCoord) the palette, from iterate()'s result
+//
+// The converter builds one fragment shader that does either, chosen by a specialization
+// constant (PASS_CONSTANT, the constant_id after the @params). The viewer makes two pipelines
+// from it: pass 0 renders iterate() into an RG32F image at ITERATIONS_BINDING, pass 1 reads it
+// back (iIterations, one texel per pixel) through colorize(). Pass 0 only runs when the view
+// changes, so animating or cycling a palette costs only pass 1.
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "uniforms.h"
+
+namespace iteration_buffer {
+
+constexpr uint32_t ITERATIONS_BINDING = 7;  // After the deep zoom orbit buffer (6)
+constexpr uint32_t ITERATE_PASS = 0;
+constexpr uint32_t COLORIZE_PASS = 1;       // The constant's default: the pipeline without it
+
+// True if the shader asks for the two passes
+inline bool requested(const std::string& source) {
+    return source.find("// @recolor") != std::string::npos;
+}
+
+// Declarations the shader's functions can see (colorize() may also fetch neighbouring texels)
+inline std::string declaration(size_t passConstantId) {
+    return "\n// @recolor passes (iteration_buffer.h)\n"
+           "layout(constant_id = " + std::to_string(passConstantId) + ") const uint METALSHADE_PASS = " +
+           std::to_string(COLORIZE_PASS) + "u;\n"
+           "layout(binding = " + std::to_string(ITERATIONS_BINDING) + ") uniform sampler2D iIterations;\n";
+}
+
+// The entry point. Pass 0 renders into iIterations' image, so it must never read it: the
+// branch is folded away once the constant is specialized.
+inline std::string mainFunction() {
+    return "\nvoid main() {\n"
+           "    vec2 pixel = " + std::string(fragCoordGLSL()) + ";\n"
+           "    if (METALSHADE_PASS == " + std::to_string(ITERATE_PASS) + "u) {\n"
+           "        fragColor = vec4(iterate(pixel), 0.0, 0.0);\n"
+           "    } else {\n"
+           "        fragColor = colorize(texelFetch(iIterations, ivec2(gl_FragCoord.xy), 0).xy, pixel);\n"
+           "    }\n"
+           "}\n";
+}
+
+}  // namespace iteration_buffer
@@ -0,0 +1,292 @@
+// jpeg_writer.h - Baseline JPEG encoder for streamed frames (--serve)
+//
+// RGBA8 in (top row first, alpha ignored), a complete JFIF file out: YCbCr with 4:2:0 chroma,
+// the Annex K quantization tables scaled by quality (1-100, as libjpeg) and the Annex K
+// Huffman tables, so nothing has to be optimized per image. The DCT is the separable matrix
+// form, about a thousand multiply-adds per 8x8 block: enough for a few 720p frames a second
+// per thread, and --serve encodes on several. One call encodes one image and keeps no state,
+// so threads can encode at once.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace jpeg_writer {
+
+// Natural (row-major) index of each zigzag position
+constexpr uint8_t ZIGZAG[64] = {
+    0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,  12, 19, 26, 33, 40, 48,
+    41, 34, 27, 20, 13, 6,  7,  14, 21, 28, 35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23,
+    30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+constexpr uint8_t LUMA_QUANT[64] = {
+    16, 11, 10, 16, 24,  40,  51,  61,  12, 12, 14, 19, 26,  58,  60,  55,
+    14, 13, 16, 24, 40,  57,  69,  56,  14, 17, 22, 29, 51,  87,  80,  62,
+    18, 22, 37, 56, 68,  109, 103, 77,  24, 35, 55, 64, 81,  104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99};
+
+constexpr uint8_t CHROMA_QUANT[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99, 24, 26, 56, 99, 99, 99,
+    99, 99, 47, 66, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99};
+
+// Huffman tables: code counts per length 1-16, then the symbols in code order
+constexpr uint8_t DC_LUMA_BITS[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+constexpr uint8_t DC_CHROMA_BITS[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+constexpr uint8_t DC_VALUES[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+constexpr uint8_t AC_LUMA_BITS[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+constexpr uint8_t AC_LUMA_VALUES[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71,
+    0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0, 0x24, 0x33, 0x62, 0x72,
+    0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+    0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83,
+    0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3,
+    0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa};
+
+constexpr uint8_t AC_CHROMA_BITS[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+constexpr uint8_t AC_CHROMA_VALUES[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13, 0x22,
+    0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0, 0x15, 0x62, 0x72, 0xd1,
+    0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x35, 0x36,
+    0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+    0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a,
+    0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a,
+    0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba,
+    0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa};
+
+struct Code {
+    uint16_t bits = 0;
+    uint8_t length = 0;
+};
+
+struct HuffmanTable {
+    Code codes[256];
+
+    HuffmanTable(const uint8_t* counts, const uint8_t* values) {
+        uint16_t code = 0;
+        size_t k = 0;
+        for (int length = 1; length <= 16; length++) {
+            for (int i = 0; i < counts[length - 1]; i++) {
+                codes[values[k++]] = {code++, static_cast<uint8_t>(length)};
+            }
+            code <<= 1;
+        }
+    }
+};
+
+// Tables shared by every encode (built once, thread-safely)
+struct Tables {
+    HuffmanTable dcLuma{DC_LUMA_BITS, DC_VALUES}, dcChroma{DC_CHROMA_BITS, DC_VALUES};
+    HuffmanTable acLuma{AC_LUMA_BITS, AC_LUMA_VALUES}, acChroma{AC_CHROMA_BITS, AC_CHROMA_VALUES};
+    float dct[8][8];  // dct[u][x] = c(u)/2 cos((2x+1)u pi/16)
+
+    Tables() {
+        for (int u = 0; u < 8; u++) {
+            for (int x = 0; x < 8; x++) {
+                double c = u == 0 ? std::sqrt(0.5) : 1.0;
+                dct[u][x] = static_cast<float>(c / 2.0 * std::cos((2 * x + 1) * u * M_PI / 16.0));
+            }
+        }
+    }
+
+    static const Tables& get() {
+        static const Tables tables;
+        return tables;
+    }
+};
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& output) : out(output) {}
+
+    void write(uint32_t bits, int length) {
+        buffer = (buffer << length) | (bits & ((1u << length) - 1));
+        count += length;
+        while (count >= 8) {
+            uint8_t byte = static_cast<uint8_t>(buffer >> (count - 8));
+            out.push_back(byte);
+            if (byte == 0xff) {
+                out.push_back(0);  // Byte stuffing
+            }
+            count -= 8;
+        }
+    }
+
+    void write(const Code& code) { write(code.bits, code.length); }
+
+    // Pad the last byte with ones
+    void flush() {
+        if (count > 0) {
+            write(0x7f, 8 - count);
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t buffer = 0;
+    int count = 0;
+};
+
+// Magnitude category and the bits that follow it (negative values in one's complement)
+inline int category(int value, uint32_t& bits) {
+    int magnitude = value < 0 ? -value : value;
+    int length = 0;
+    while (magnitude >> length) {
+        length++;
+    }
+    bits = static_cast<uint32_t>(value < 0 ? value - 1 : value);
+    return length;
+}
+
+// DCT, quantize and entropy-code one 8x8 block of level-shifted samples
+inline void encodeBlock(BitWriter& writer, const float block[64], const float quant[64], int& previousDc,
+                        const HuffmanTable& dc, const HuffmanTable& ac) {
+    const Tables& tables = Tables::get();
+    float rows[64], coefficients[64];
+    for (int y = 0; y < 8; y++) {
+        for (int u = 0; u < 8; u++) {
+            float sum = 0.0f;
+            for (int x = 0; x < 8; x++) {
+                sum += tables.dct[u][x] * block[y * 8 + x];
+            }
+            rows[y * 8 + u] = sum;
+        }
+    }
+    for (int v = 0; v < 8; v++) {
+        for (int u = 0; u < 8; u++) {
+            float sum = 0.0f;
+            for (int y = 0; y < 8; y++) {
+                sum += tables.dct[v][y] * rows[y * 8 + u];
+            }
+            coefficients[v * 8 + u] = sum;
+        }
+    }
+
+    int zigzag[64];
+    for (int i = 0; i < 64; i++) {
+        zigzag[i] = static_cast<int>(std::lround(coefficients[ZIGZAG[i]] / quant[ZIGZAG[i]]));
+    }
+
+    uint32_t bits;
+    int length = category(zigzag[0] - previousDc, bits);
+    writer.write(dc.codes[length]);
+    if (length > 0) {
+        writer.write(bits, length);
+    }
+    previousDc = zigzag[0];
+
+    int run = 0;
+    for (int i = 1; i < 64; i++) {
+        if (zigzag[i] == 0) {
+            run++;
+            continue;
+        }
+        while (run >= 16) {
+            writer.write(ac.codes[0xf0]);  // Sixteen zeros
+            run -= 16;
+        }
+        length = category(zigzag[i], bits);
+        writer.write(ac.codes[(run << 4) | length]);
+        writer.write(bits, length);
+        run = 0;
+    }
+    if (run > 0) {
+        writer.write(ac.codes[0x00]);  // End of block
+    }
+}
+
+inline void writeMarker(std::vector<uint8_t>& out, uint8_t marker, uint16_t length) {
+    out.insert(out.end(), {0xff, marker, static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length)});
+}
+
+inline void writeHuffmanTable(std::vector<uint8_t>& out, uint8_t classAndId, const uint8_t* counts,
+                              const uint8_t* values) {
+    size_t symbols = 0;
+    for (int i = 0; i < 16; i++) {
+        symbols += counts[i];
+    }
+    writeMarker(out, 0xc4, static_cast<uint16_t>(2 + 1 + 16 + symbols));
+    out.push_back(classAndId);
+    out.insert(out.end(), counts, counts + 16);
+    out.insert(out.end(), values, values + symbols);
+}
+
+// Encode an RGBA8 image; quality 1-100
+inline std::vector<uint8_t> encode(const uint8_t* rgba, uint32_t width, uint32_t height, int quality = 85) {
+    const Tables& tables = Tables::get();
+    quality = std::max(1, std::min(100, quality));
+    int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+    uint8_t lumaQuant[64], chromaQuant[64];
+    float lumaDivisor[64], chromaDivisor[64];
+    for (int i = 0; i < 64; i++) {
+        lumaQuant[i] = static_cast<uint8_t>(std::max(1, std::min(255, (LUMA_QUANT[i] * scale + 50) / 100)));
+        chromaQuant[i] = static_cast<uint8_t>(std::max(1, std::min(255, (CHROMA_QUANT[i] * scale + 50) / 100)));
+        lumaDivisor[i] = lumaQuant[i];
+        chromaDivisor[i] = chromaQuant[i];
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(static_cast<size_t>(width) * height / 4 + 1024);
+    out.insert(out.end(), {0xff, 0xd8});  // SOI
+    writeMarker(out, 0xe0, 16);           // JFIF 1.1, no density, no thumbnail
+    out.insert(out.end(), {'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0});
+
+    writeMarker(out, 0xdb, 2 + 2 * 65);  // Quantization tables, zigzag order
+    out.push_back(0);
+    for (int i = 0; i < 64; i++) out.push_back(lumaQuant[ZIGZAG[i]]);
+    out.push_back(1);
+    for (int i = 0; i < 64; i++) out.push_back(chromaQuant[ZIGZAG[i]]);
+
+    writeMarker(out, 0xc0, 17);  // Baseline frame: Y at 2x2, Cb and Cr at 1x1
+    out.insert(out.end(), {8, static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height),
+                           static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width), 3, 1, 0x22, 0, 2, 0x11, 1,
+                           3, 0x11, 1});
+
+    writeHuffmanTable(out, 0x00, DC_LUMA_BITS, DC_VALUES);
+    writeHuffmanTable(out, 0x10, AC_LUMA_BITS, AC_LUMA_VALUES);
+    writeHuffmanTable(out, 0x01, DC_CHROMA_BITS, DC_VALUES);
+    writeHuffmanTable(out, 0x11, AC_CHROMA_BITS, AC_CHROMA_VALUES);
+
+    writeMarker(out, 0xda, 12);  // Start of scan
+    out.insert(out.end(), {3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0});
+
+    BitWriter writer(out);
+    int dcY = 0, dcCb = 0, dcCr = 0;
+    float y[4][64], cb[64], cr[64];
+    for (uint32_t mcuY = 0; mcuY < height; mcuY += 16) {
+        for (uint32_t mcuX = 0; mcuX < width; mcuX += 16) {
+            std::fill(cb, cb + 64, 0.0f);
+            std::fill(cr, cr + 64, 0.0f);
+            for (uint32_t row = 0; row < 16; row++) {
+                uint32_t sourceY = std::min(mcuY + row, height - 1);  // Edges repeat the last pixel
+                for (uint32_t column = 0; column < 16; column++) {
+                    uint32_t sourceX = std::min(mcuX + column, width - 1);
+                    const uint8_t* px = rgba + (static_cast<size_t>(sourceY) * width + sourceX) * 4;
+                    float r = px[0], g = px[1], b = px[2];
+                    y[(row / 8) * 2 + column / 8][(row % 8) * 8 + column % 8] =
+                        0.299f * r + 0.587f * g + 0.114f * b - 128.0f;
+                    int chroma = (row / 2) * 8 + column / 2;
+                    cb[chroma] += 0.25f * (-0.168736f * r - 0.331264f * g + 0.5f * b);
+                    cr[chroma] += 0.25f * (0.5f * r - 0.418688f * g - 0.081312f * b);
+                }
+            }
+            for (int block = 0; block < 4; block++) {
+                encodeBlock(writer, y[block], lumaDivisor, dcY, tables.dcLuma, tables.acLuma);
+            }
+            encodeBlock(writer, cb, chromaDivisor, dcCb, tables.dcChroma, tables.acChroma);
+            encodeBlock(writer, cr, chromaDivisor, dcCr, tables.dcChroma, tables.acChroma);
+        }
+    }
+    writer.flush();
+    out.insert(out.end(), {0xff, 0xd9});  // EOI
+    return out;
+}
+
+}  // namespace jpeg_writer
@@ -0,0 +1,180 @@
+// keyboard_state.h - ShaderToy keyboard texture (256x3, R8) for the keyboard iChannel source
+//
+//   row 0: key is down            texelFetch(iChannel0, ivec2(KEY, 0), 0).x
+//   row 1: key went down this frame
+//   row 2: toggles on every press
+//
+// Columns are JavaScript keyCodes (A = 65, space = 32, left arrow = 37, ...) so ShaderToy
+// shaders work unchanged. Key events are pushed with a timestamp into a lock-free SPSC ring
+// from the input callback and drained once per frame by the render loop, which also tracks
+// the span of columns that changed so only that part of the texture is re-uploaded.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+// Bounded single-producer/single-consumer ring; push() fails (drops) when full
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool push(const T& item) {
+        size_t head = writeIndex.load(std::memory_order_relaxed);
+        if (head - readIndex.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items[head & (Capacity - 1)] = item;
+        writeIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        size_t tail = readIndex.load(std::memory_order_relaxed);
+        if (tail == writeIndex.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[tail & (Capacity - 1)];
+        readIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T items[Capacity];
+    alignas(64) std::atomic<size_t> writeIndex{0};
+    alignas(64) std::atomic<size_t> readIndex{0};
+};
+
+inline double steadySeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class KeyboardState {
+public:
+    static const uint32_t TEXTURE_WIDTH = 256;
+    static const uint32_t TEXTURE_HEIGHT = 3;
+
+    struct KeyEvent {
+        uint8_t keyCode;
+        bool pressed;
+        double timestamp;  // steadySeconds() when the event arrived
+    };
+
+    KeyboardState() { reset(); }
+
+    void reset() {
+        memset(texture, 0, sizeof(texture));
+        KeyEvent discard;
+        while (events.pop(discard)) {
+        }
+        dirtyBegin = 0;
+        dirtyEnd = TEXTURE_WIDTH;  // Whole texture on the first upload
+    }
+
+    // Input thread: queue a GLFW key event (repeats and unmapped keys are ignored)
+    void push(int glfwKey, bool pressed) {
+        int code = jsKeyCode(glfwKey);
+        if (code > 0) {
+            events.push({(uint8_t)code, pressed, steadySeconds()});
+        }
+    }
+
+    // Render thread, once per frame: apply queued events. Returns the timestamp of the
+    // oldest event applied (for latency tracking), or a negative value if none arrived.
+    double drain() {
+        // "Pressed this frame" only lasts one frame
+        for (uint32_t x = 0; x < TEXTURE_WIDTH; x++) {
+            if (texture[1][x]) {
+                texture[1][x] = 0;
+                markDirty(x);
+            }
+        }
+
+        double oldest = -1.0;
+        KeyEvent event;
+        while (events.pop(event)) {
+            uint8_t x = event.keyCode;
+            if (event.pressed && !texture[0][x]) {
+                texture[0][x] = 255;
+                texture[1][x] = 255;
+                texture[2][x] ^= 255;
+            } else if (!event.pressed) {
+                texture[0][x] = 0;
+            }
+            markDirty(x);
+            if (oldest < 0.0) {
+                oldest = event.timestamp;
+            }
+        }
+        return oldest;
+    }
+
+    bool dirty() const { return dirtyBegin < dirtyEnd; }
+    uint32_t dirtyOffset() const { return dirtyBegin; }
+    uint32_t dirtyWidth() const { return dirtyEnd - dirtyBegin; }
+
+    // Copy the texture into an upload buffer and clear the dirty span
+    void copyTo(void* destination) {
+        memcpy(destination, texture, sizeof(texture));
+        dirtyBegin = TEXTURE_WIDTH;
+        dirtyEnd = 0;
+    }
+
+    // GLFW key → JavaScript keyCode (0 if ShaderToy has no equivalent)
+    static int jsKeyCode(int key) {
+        if ((key >= 'A' && key <= 'Z') || (key >= '0' && key <= '9') || key == ' ') return key;
+        if (key >= 290 && key <= 301) return 112 + (key - 290);  // F1-F12
+        if (key >= 320 && key <= 329) return 96 + (key - 320);   // Keypad 0-9
+        switch (key) {
+            case 256: return 27;   // Escape
+            case 257: return 13;   // Enter
+            case 258: return 9;    // Tab
+            case 259: return 8;    // Backspace
+            case 260: return 45;   // Insert
+            case 261: return 46;   // Delete
+            case 262: return 39;   // Right
+            case 263: return 37;   // Left
+            case 264: return 40;   // Down
+            case 265: return 38;   // Up
+            case 266: return 33;   // Page up
+            case 267: return 34;   // Page down
+            case 268: return 36;   // Home
+            case 269: return 35;   // End
+            case 340: case 344: return 16;  // Shift
+            case 341: case 345: return 17;  // Control
+            case 342: case 346: return 18;  // Alt
+            case 330: return 110;  // Keypad .
+            case 331: return 111;  // Keypad /
+            case 332: return 106;  // Keypad *
+            case 333: return 109;  // Keypad -
+            case 334: return 107;  // Keypad +
+            case 335: return 13;   // Keypad enter
+            case ';': return 186;
+            case '=': return 187;
+            case ',': return 188;
+            case '-': return 189;
+            case '.': return 190;
+            case '/': return 191;
+            case '`': return 192;
+            case '[': return 219;
+            case '\\': return 220;
+            case ']': return 221;
+            case '\'': return 222;
+        }
+        return 0;
+    }
+
+private:
+    uint8_t texture[TEXTURE_HEIGHT][TEXTURE_WIDTH];
+    SpscQueue<KeyEvent, 256> events;
+    uint32_t dirtyBegin;
+    uint32_t dirtyEnd;
+
+    void markDirty(uint32_t x) {
+        dirtyBegin = std::min(dirtyBegin, x);
+        dirtyEnd = std::max(dirtyEnd, x + 1);
+    }
+};
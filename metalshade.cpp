@@ -13,28 +13,69 @@
 #include <unistd.h> // For getcwd
 #include <dirent.h> // For directory scanning
 #include <algorithm> // For std::sort
+#include <numeric>   // For std::accumulate
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "channel_images.h"
+#include "video_decoder.h"
+#include "audio_analyzer.h"
+#include "keyboard_state.h"
+#include "uniforms.h"
+#include "glsl_converter.h"
+#include "work_pool.h"
+#include "file_watcher.h"
+#include "spirv_interface.h"
+#include "shader_params.h"
+#include "isf_inputs.h"
+#include "spirv_optimizer.h"
+#include "spirv_analysis.h"
+#include "spirv_cpu.h"
+#include "png_writer.h"
+#include "deep_zoom.h"
+#include "df64.h"
+#include "input_events.h"
+#include "input_trace.h"
+#include "iteration_buffer.h"
+#include "image_diff.h"
+#include "video_encoder.h"
+#include "frame_server.h"
+#include "control_server.h"
 
 const int WIDTH = 1280;
 const int HEIGHT = 720;
 
-struct UniformBufferObject {
-    alignas(16) float iResolution[3];
-    alignas(4) float iTime;
-    alignas(16) float iMouse[4];
-    alignas(8) float iScroll[2];  // Accumulated scroll offset (x, y)
-    // Button states as individual floats (std140 array alignment is complex)
-    alignas(4) float iButtonLeft;
-    alignas(4) float iButtonRight;
-    alignas(4) float iButtonMiddle;
-    alignas(4) float iButton4;
-    alignas(4) float iButton5;
-    // Pan offset for drag-and-drop (accumulated pixel offset)
-    alignas(8) float iPan[2];
+// What feeds each iChannel. iChannel0-3 live at descriptor bindings 1-4.
+enum class ChannelKind { Texture, Feedback, Video, Audio, Keyboard, Cube, Volume };
+
+struct ChannelSource {
+    ChannelKind kind = ChannelKind::Texture;
+    std::string path;
+};
+
+// Device image owned by a cube or volume channel
+struct ChannelImage {
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+};
+
+// Small R8 image refreshed from the CPU (audio, keyboard) through one mapped staging
+// buffer per frame in flight, so writing this frame's data never races the GPU
+struct StreamingImage {
+    ChannelImage target;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<VkBuffer> stagingBuffers;
+    std::vector<VkDeviceMemory> stagingMemories;
+    std::vector<void*> stagingMapped;
 };
 
+const int CHANNEL_COUNT = 4;
+
+// Full-screen triangle used when a shader has no vertex stage of its own
+const char* const DEFAULT_VERTEX_SHADER = "/opt/3d/metalshade/shaders/example.vert.spv";
+
 std::vector<char> readFile(const std::string& filename) {
     std::ifstream file(filename, std::ios::ate | std::ios::binary);
     if (!file.is_open()) {
@@ -50,6 +91,959 @@ std::vector<char> readFile(const std::string& filename) {
 
 class MetalshadeViewer {
 public:
+    // Advance iTime by 1/fps per frame instead of wall-clock time (deterministic simulations)
+    void setOptimization(spirv_optimizer::Level level) {
+        spirvOptimization = level;
+    }
+
+    void setFixedStep(double fps) {
+        fixedTimeStep = fps > 0.0 ? 1.0 / fps : 0.0;
+    }
+
+    // --serve: stream the window's frames on 127.0.0.1:port
+    void setServePort(uint16_t port) {
+        servePort = port;
+    }
+
+    // --control: take commands on a Unix socket path or a 127.0.0.1 port number
+    void setControlAddress(const std::string& address) {
+        controlAddress = address;
+    }
+
+    // --record: write the session's input to path for --replay
+    void setRecordPath(const std::string& path) {
+        recordPath = path;
+    }
+
+    // --convert: convert one shader and print (or write) the Vulkan GLSL, no window or device
+    int convertOnly(const std::string& inputPath, const std::string& outputPath) {
+        std::string absPath = getAbsolutePath(inputPath);
+        parseChannelSources(absPath);
+        if (!outputPath.empty()) {
+            return convertShaderFile(absPath, outputPath) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        std::ifstream input(absPath);
+        std::stringstream source;
+        source << input.rdbuf();
+        glsl_converter::Result converted = shaderConverter.convert(source.str(), shaderHeader());
+        if (!converted.ok) {
+            std::cerr << "✗ " << converted.error << " in " << inputPath << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << converted.output;
+        return EXIT_SUCCESS;
+    }
+
+    // --convert-check: golden-file regression check of the converter over a shader corpus.
+    // Every .frag under corpusDir is converted and compared with goldenDir/<same path>.glsl;
+    // with update set, missing or differing goldens are (re)written instead.
+    int checkConversions(const std::string& corpusDir, const std::string& goldenDir, bool update) {
+        std::vector<std::string> files;
+        collectFiles(corpusDir, ".frag", files);
+        std::sort(files.begin(), files.end());
+        if (files.empty()) {
+            std::cerr << "✗ No .frag files under " << corpusDir << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        int matched = 0, differed = 0, written = 0, failed = 0;
+        double totalMicros = 0.0;
+        for (const std::string& file : files) {
+            std::string relative = file.substr(corpusDir.size() + 1);
+            std::string goldenPath = goldenDir + "/" + relative.substr(0, relative.size() - 5) + ".glsl";
+
+            std::ifstream input(file);
+            std::stringstream source;
+            source << input.rdbuf();
+            parseChannelSources(getAbsolutePath(file));
+
+            auto start = std::chrono::steady_clock::now();
+            glsl_converter::Result converted = shaderConverter.convert(source.str(), shaderHeader());
+            totalMicros += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            std::string actual = converted.ok ? converted.output : "// ERROR: " + converted.error + "\n";
+            if (!converted.ok) {
+                failed++;
+            }
+
+            std::ifstream goldenFile(goldenPath);
+            std::stringstream golden;
+            golden << goldenFile.rdbuf();
+            if (goldenFile.is_open() && golden.str() == actual) {
+                matched++;
+                continue;
+            }
+            if (update) {
+                makeDirectories(goldenPath.substr(0, goldenPath.find_last_of('/')));
+                std::ofstream(goldenPath) << actual;
+                written++;
+                continue;
+            }
+            differed++;
+            std::cout << "✗ " << relative << (goldenFile.is_open() ? ": " + firstDifference(golden.str(), actual)
+                                                                    : ": no golden (run with --update)") << std::endl;
+        }
+
+        std::cout << (differed ? "✗ " : "✓ ") << files.size() << " shaders: " << matched << " match, "
+                  << differed << " differ, " << written << " written, " << failed << " not convertible; "
+                  << totalMicros / files.size() << " µs/shader" << std::endl;
+        return differed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    // --golden: frames rendered at GOLDEN_TIMES, GOLDEN_WIDTH x GOLDEN_HEIGHT
+    static constexpr double GOLDEN_TIMES[] = {0.0, 1.0, 5.0};
+    static constexpr uint32_t GOLDEN_WIDTH = 320;
+    static constexpr uint32_t GOLDEN_HEIGHT = 180;
+    static constexpr uint8_t GOLDEN_TOLERANCE = 8;         // Channel difference a driver may introduce
+    static constexpr double GOLDEN_MAX_DIFFERING = 0.001;  // Fraction of pixels allowed past it
+    static constexpr size_t GOLDEN_BATCH = 64;             // Frames held before comparing them
+
+    struct GoldenFrame {
+        std::string name;  // "<relative path> t=<time>"
+        std::string goldenPath, diffPath;
+        std::vector<uint8_t> pixels;
+        std::string status;  // "match", "differ", "written", "missing", "size" or "unwritable"
+        image_diff::Result diff;
+    };
+
+    // --golden: render every .frag under corpusDir headless at GOLDEN_TIMES (declared @param and
+    // ISF defaults, fixed iDate) and compare each frame with <goldenDir>/<relative>.t<time>.png.
+    // A frame matches if its SSIM is at least minSsim and few pixels differ by more than
+    // GOLDEN_TOLERANCE; otherwise golden | rendered | heat map goes to <diffDir>/<relative>.t<time>.png.
+    // The GPU renders one shader at a time while the comparisons run in parallel in batches.
+    // update writes the rendered frames as the new references instead.
+    int checkGoldenImages(const std::string& corpusDir, const std::string& goldenDir, bool update, double minSsim,
+                          std::string diffDir) {
+        std::vector<std::string> files;
+        collectFiles(corpusDir, ".frag", files);
+        std::sort(files.begin(), files.end());
+        if (files.empty()) {
+            std::cerr << "✗ No .frag files under " << corpusDir << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (diffDir.empty()) {
+            diffDir = goldenDir + "-diffs";
+        }
+
+        WorkPool pool;
+        std::vector<GoldenFrame> batch;
+        size_t matched = 0, differed = 0, written = 0, frames = 0, failed = 0;
+        auto compareBatch = [&]() {
+            pool.parallelFor(batch.size(), [&](size_t index, unsigned) {
+                compareGoldenFrame(batch[index], update, minSsim);
+            });
+            for (const GoldenFrame& frame : batch) {
+                frames++;
+                if (frame.status == "match") {
+                    matched++;
+                    continue;
+                }
+                if (frame.status == "written") {
+                    written++;
+                    continue;
+                }
+                differed++;
+                if (frame.status == "differ") {
+                    char row[128];
+                    snprintf(row, sizeof(row), ": SSIM %.4f, %llu pixels differ (max %d) → ", frame.diff.ssim,
+                             (unsigned long long)frame.diff.differingPixels, frame.diff.maxDiff);
+                    std::cout << "✗ " << frame.name << row << frame.diffPath << std::endl;
+                } else if (frame.status == "size") {
+                    std::cout << "✗ " << frame.name << ": golden is not " << GOLDEN_WIDTH << "x" << GOLDEN_HEIGHT
+                              << std::endl;
+                } else if (frame.status == "unwritable") {
+                    std::cout << "✗ " << frame.name << ": could not write " << frame.goldenPath << std::endl;
+                } else {
+                    std::cout << "✗ " << frame.name << ": no golden (run with --update)" << std::endl;
+                }
+            }
+            batch.clear();
+        };
+
+        replaying = true;  // As in a replay: fixed iDate and input clock, no .params writes
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& file : files) {
+            std::string relative = file.substr(corpusDir.size() + 1);
+            relative = relative.substr(0, relative.size() - 5);
+            currentShaderPath = file;
+            if (!compileAndLoadShader(currentShaderPath)) {
+                std::cout << "✗ " << relative << ".frag: does not compile" << std::endl;
+                failed++;
+                continue;
+            }
+            readTunables(shaderParamsPath, shaderParams, isfInputs);  // Defaults, not the user's .params
+            initOffscreen(GOLDEN_WIDTH, GOLDEN_HEIGHT);
+            frameCount = 0;
+            for (double time : GOLDEN_TIMES) {
+                char suffix[32], label[32];
+                snprintf(suffix, sizeof(suffix), ".t%g.png", time);
+                snprintf(label, sizeof(label), ".frag t=%g", time);
+                GoldenFrame frame;
+                frame.name = relative + label;
+                frame.goldenPath = goldenDir + "/" + relative + suffix;
+                frame.diffPath = diffDir + "/" + relative + suffix;
+                renderOffscreen(time, &frame.pixels);
+                batch.push_back(std::move(frame));
+            }
+            vkDeviceWaitIdle(device);
+            destroyPipelineVariants();
+            cleanup();
+            if (batch.size() >= GOLDEN_BATCH) {
+                compareBatch();
+            }
+        }
+        compareBatch();
+        replaying = false;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        char summary[224];
+        snprintf(summary, sizeof(summary),
+                 "%zu frames of %zu shaders: %zu match, %zu differ, %zu written, %zu not compiled "
+                 "(SSIM ≥ %.4f) in %.1f s",
+                 frames, files.size(), matched, differed, written, failed, minSsim, seconds);
+        std::cout << (differed || failed ? "✗ " : "✓ ") << summary << std::endl;
+        return differed || failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    // One --golden comparison, on a pool thread: touches only frame and the files it names
+    static void compareGoldenFrame(GoldenFrame& frame, bool update, double minSsim) {
+        int width = 0, height = 0, channels = 0;
+        stbi_uc* golden = stbi_load(frame.goldenPath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (golden && width == static_cast<int>(GOLDEN_WIDTH) && height == static_cast<int>(GOLDEN_HEIGHT)) {
+            std::vector<uint8_t> heatMap;
+            frame.diff = image_diff::compare(golden, frame.pixels.data(), GOLDEN_WIDTH, GOLDEN_HEIGHT,
+                                             GOLDEN_TOLERANCE, &heatMap);
+            bool close = frame.diff.ssim >= minSsim &&
+                         frame.diff.differingPixels <= GOLDEN_MAX_DIFFERING * GOLDEN_WIDTH * GOLDEN_HEIGHT;
+            frame.status = close ? "match" : "differ";
+            if (!close && !update) {
+                // Side by side: golden, rendered, heat map
+                size_t row = static_cast<size_t>(GOLDEN_WIDTH) * 4;
+                std::vector<uint8_t> sheet(row * 3 * GOLDEN_HEIGHT);
+                for (uint32_t y = 0; y < GOLDEN_HEIGHT; y++) {
+                    uint8_t* out = &sheet[y * row * 3];
+                    memcpy(out, golden + y * row, row);
+                    memcpy(out + row, &frame.pixels[y * row], row);
+                    memcpy(out + row * 2, &heatMap[y * row], row);
+                }
+                writePng(frame.diffPath, sheet.data(), GOLDEN_WIDTH * 3, GOLDEN_HEIGHT);
+            }
+        } else {
+            frame.status = golden ? "size" : "missing";
+        }
+        if (golden) {
+            stbi_image_free(golden);
+        }
+        if (update && frame.status != "match") {
+            frame.status = writePng(frame.goldenPath, frame.pixels.data(), GOLDEN_WIDTH, GOLDEN_HEIGHT)
+                               ? "written"
+                               : "unwritable";
+        }
+    }
+
+    static bool writePng(const std::string& path, const uint8_t* rgba, uint32_t width, uint32_t height) {
+        if (path.find('/') != std::string::npos) {
+            makeDirectories(path.substr(0, path.find_last_of('/')));
+        }
+        png_writer::Writer writer;
+        std::string error;
+        return writer.open(path, width, height, error) && writer.writeRows(rgba, height) && writer.close();
+    }
+
+    // --validate: convert and compile every .frag under corpusDir on all cores; with
+    // buildPipelines also create a pipeline for each on a headless device. Writes a JSON
+    // report (to reportPath, or stdout) with per-stage timings and compiler diagnostics.
+    int validateCorpus(const std::string& corpusDir, bool buildPipelines, const std::string& reportPath) {
+        std::vector<std::string> files;
+        collectFiles(corpusDir, ".frag", files);
+        std::sort(files.begin(), files.end());
+        if (files.empty()) {
+            std::cerr << "✗ No .frag files under " << corpusDir << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        char tempTemplate[] = "/tmp/metalshade-validate-XXXXXX";
+        if (!mkdtemp(tempTemplate)) {
+            std::cerr << "✗ Could not create a temporary directory" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::string tempDir = tempTemplate;
+
+        // Device and pipeline messages go to stderr; stdout may be the report
+        std::streambuf* console = std::cout.rdbuf();
+        VkShaderModule vertShaderModule = VK_NULL_HANDLE;
+        spirv_interface::Interface vertexInterface;
+        if (buildPipelines) {
+            std::cout.rdbuf(std::cerr.rdbuf());
+            initHeadlessVulkan();
+            std::vector<char> vertShaderCode = readFile(DEFAULT_VERTEX_SHADER);
+            vertexInterface = reflectShader(vertShaderCode, VK_SHADER_STAGE_VERTEX_BIT);
+            vertShaderModule = createShaderModule(vertShaderCode);
+        }
+
+        WorkPool pool;
+        std::vector<ShaderValidation> results(files.size());
+        auto start = std::chrono::steady_clock::now();
+        pool.parallelFor(files.size(), [&](size_t index, unsigned) {
+            validateShader(files[index], tempDir + "/" + std::to_string(index), vertShaderModule, vertexInterface,
+                           results[index]);
+        });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        rmdir(tempDir.c_str());
+        std::cout.rdbuf(console);
+
+        if (buildPipelines) {
+            vkDestroyShaderModule(device, vertShaderModule, nullptr);
+            destroyLayoutCache();
+            vkDestroyRenderPass(device, renderPass, nullptr);
+            vkDestroyRenderPass(device, panRenderPass, nullptr);
+            vkDestroyRenderPass(device, iterationRenderPass, nullptr);
+            vkDestroyDevice(device, nullptr);
+            vkDestroyInstance(instance, nullptr);
+        }
+
+        size_t passed = 0;
+        std::ostringstream shaders;
+        for (size_t i = 0; i < files.size(); i++) {
+            const ShaderValidation& result = results[i];
+            std::string relative = files[i].substr(corpusDir.size() + 1);
+            if (result.status == "pass") {
+                passed++;
+            } else {
+                std::cerr << "✗ " << relative << ": " << result.status
+                          << (result.diagnostics.empty() ? "" : " - " + result.diagnostics[0]) << std::endl;
+            }
+            shaders << (i ? ",\n" : "") << "    {\"path\": " << jsonString(relative)
+                    << ", \"status\": \"" << result.status << "\""
+                    << ", \"convertMicros\": " << (int64_t)result.convertMicros
+                    << ", \"compileMicros\": " << (int64_t)result.compileMicros
+                    << ", \"pipelineMicros\": " << (int64_t)result.pipelineMicros << ", \"diagnostics\": [";
+            for (size_t d = 0; d < result.diagnostics.size(); d++) {
+                shaders << (d ? ", " : "") << jsonString(result.diagnostics[d]);
+            }
+            shaders << "]}";
+        }
+
+        std::ofstream reportFile;
+        if (!reportPath.empty()) {
+            reportFile.open(reportPath);
+            if (!reportFile.is_open()) {
+                std::cerr << "✗ Could not write: " << reportPath << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        std::ostream& report = reportPath.empty() ? std::cout : reportFile;
+        report << "{\n  \"corpus\": " << jsonString(corpusDir) << ",\n  \"threads\": " << pool.size()
+               << ",\n  \"pipelines\": " << (buildPipelines ? "true" : "false") << ",\n  \"seconds\": " << seconds
+               << ",\n  \"passed\": " << passed << ",\n  \"failed\": " << files.size() - passed
+               << ",\n  \"shaders\": [\n" << shaders.str() << "\n  ]\n}\n";
+
+        std::cerr << (passed == files.size() ? "✓ " : "✗ ") << passed << "/" << files.size() << " shaders valid in "
+                  << seconds << " s on " << pool.size() << " threads" << std::endl;
+        return passed == files.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // --analyze: static cost report (spirv_analysis) for a shader or every .frag under a
+    // directory, as JSON on stdout or in reportPath. With timeFrames > 0 each shader is also
+    // rendered headless and its median GPU time recorded, and a linear cost model is fitted
+    // over the corpus to show how well the static counts predict it.
+    int analyzeShaders(const std::string& target, int timeFrames, const std::string& reportPath) {
+        std::vector<std::string> files;
+        if (channel_images::isDirectory(target)) {
+            collectFiles(target, ".frag", files);
+            std::sort(files.begin(), files.end());
+        } else {
+            files.push_back(resolveFragmentShader(target));
+        }
+        if (files.empty()) {
+            std::cerr << "✗ No .frag files under " << target << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        char tempTemplate[] = "/tmp/metalshade-analyze-XXXXXX";
+        if (!mkdtemp(tempTemplate)) {
+            std::cerr << "✗ Could not create a temporary directory" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::string tempDir = tempTemplate;
+
+        std::vector<ShaderValidation> results(files.size());
+        std::vector<spirv_analysis::Report> reports(files.size());
+        WorkPool pool;
+        pool.parallelFor(files.size(), [&](size_t index, unsigned) {
+            std::vector<char> code;
+            validateShader(files[index], tempDir + "/" + std::to_string(index), VK_NULL_HANDLE, {}, results[index],
+                           &code);
+            if (results[index].status != "pass") {
+                return;
+            }
+            std::vector<uint32_t> words(code.size() / 4);
+            memcpy(words.data(), code.data(), words.size() * 4);
+            std::string error;
+            if (!spirv_analysis::analyze(words.data(), words.size(), reports[index], error)) {
+                results[index].status = "analyze-failed";
+                results[index].diagnostics.push_back(error);
+            }
+        });
+        rmdir(tempDir.c_str());
+
+        // Timed runs, one device per shader (viewer messages go to stderr, stdout is the report)
+        std::vector<double> gpuMillis(files.size(), -1.0);
+        if (timeFrames > 0) {
+            std::streambuf* console = std::cout.rdbuf(std::cerr.rdbuf());
+            for (size_t i = 0; i < files.size(); i++) {
+                if (results[i].status != "pass") continue;
+                try {
+                    MetalshadeViewer timer;
+                    gpuMillis[i] = timer.timeShader(files[i], timeFrames);
+                } catch (const std::exception& e) {
+                    std::cerr << "✗ " << files[i] << ": " << e.what() << std::endl;
+                }
+            }
+            std::cout.rdbuf(console);
+        }
+
+        std::vector<const spirv_analysis::Report*> timedReports;
+        std::vector<double> timedMillis;
+        for (size_t i = 0; i < files.size(); i++) {
+            if (gpuMillis[i] >= 0.0) {
+                timedReports.push_back(&reports[i]);
+                timedMillis.push_back(gpuMillis[i]);
+            }
+        }
+        spirv_analysis::CostModel model = spirv_analysis::fitCostModel(timedReports, timedMillis);
+
+        std::ostringstream shaders;
+        size_t analyzed = 0;
+        for (size_t i = 0; i < files.size(); i++) {
+            std::string relative = files.size() > 1 ? files[i].substr(target.size() + 1) : files[i];
+            shaders << (i ? ",\n" : "") << "    {\"path\": " << jsonString(relative) << ", \"status\": \""
+                    << results[i].status << "\"";
+            if (results[i].status != "pass") {
+                std::cerr << "✗ " << relative << ": " << results[i].status
+                          << (results[i].diagnostics.empty() ? "" : " - " + results[i].diagnostics[0]) << std::endl;
+                shaders << "}";
+                continue;
+            }
+            analyzed++;
+            shaders << ",\n" << reports[i].json("      ");
+            if (gpuMillis[i] >= 0.0) {
+                shaders << ",\n      \"gpuMillis\": " << gpuMillis[i];
+                if (model.valid) shaders << ", \"predictedMillis\": " << model.predict(reports[i]);
+            }
+            shaders << "}";
+        }
+
+        std::ofstream reportFile;
+        if (!reportPath.empty()) {
+            reportFile.open(reportPath);
+            if (!reportFile.is_open()) {
+                std::cerr << "✗ Could not write: " << reportPath << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        std::ostream& report = reportPath.empty() ? std::cout : reportFile;
+        report << "{\n  \"target\": " << jsonString(target);
+        if (timeFrames > 0) {
+            report << ",\n  \"timing\": {\"width\": " << WIDTH << ", \"height\": " << HEIGHT
+                   << ", \"frames\": " << timeFrames << "}";
+        }
+        if (model.valid) {
+            report << ",\n  \"costModel\": {\"samples\": " << timedMillis.size()
+                   << ", \"interceptMillis\": " << model.intercept << ", \"aluMillis\": " << model.weights[0]
+                   << ", \"transcendentalMillis\": " << model.weights[1]
+                   << ", \"textureMillis\": " << model.weights[2] << ", \"r2\": " << model.r2 << "}";
+        }
+        report << ",\n  \"shaders\": [\n" << shaders.str() << "\n  ]\n}\n";
+
+        std::cerr << (analyzed == files.size() ? "✓ " : "⚠ ") << analyzed << "/" << files.size()
+                  << " shaders analyzed";
+        if (model.valid) {
+            std::cerr << ", cost model R² = " << model.r2 << " over " << timedMillis.size() << " timed shaders";
+        }
+        std::cerr << std::endl;
+        return analyzed == files.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Median GPU time per frame of a shader rendered headless (for --analyze)
+    double timeShader(const std::string& shaderPath, int frames) {
+        currentShaderPath = shaderPath;
+        if (!compileAndLoadShader(currentShaderPath)) {
+            return -1.0;
+        }
+        initOffscreen(WIDTH, HEIGHT);
+        for (int i = 0; i < 3; i++) {
+            renderOffscreen(i / 60.0);
+        }
+        std::vector<double> millis;
+        for (int i = 0; i < frames; i++) {
+            millis.push_back(renderOffscreen((i + 3) / 60.0));
+        }
+        std::sort(millis.begin(), millis.end());
+        vkDeviceWaitIdle(device);
+        destroyPipelineVariants();
+        cleanup();
+        return millis[millis.size() / 2];
+    }
+
+    // --compare-opt: render shaderPath offscreen without spirv-opt, with -O and with -Os and
+    // compare fragment SPIR-V size, pipeline creation time, GPU time per frame (median and
+    // mean over frames) and the largest channel difference from the unoptimised image
+    int compareOptimization(const std::string& shaderPath, int frames) {
+        currentShaderPath = resolveFragmentShader(shaderPath);
+        if (!compileAndLoadShader(currentShaderPath)) {
+            return EXIT_FAILURE;
+        }
+        initOffscreen(WIDTH, HEIGHT);
+        std::string fragSpvPath =
+            getShaderDirectory(currentShaderPath) + "/" + getShaderBaseName(currentShaderPath) + ".frag.spv";
+
+        const spirv_optimizer::Level levels[] = {spirv_optimizer::Level::None, spirv_optimizer::Level::Performance,
+                                                 spirv_optimizer::Level::Size};
+        std::vector<uint8_t> reference, pixels;
+        std::cout << "\n  level   frag bytes   pipeline ms   median ms   mean ms   max diff" << std::endl;
+        for (spirv_optimizer::Level level : levels) {
+            spirvOptimization = level;
+            vkDeviceWaitIdle(device);
+            recreatePipeline();
+            double pipelineMillis = lastPipelineMillis;
+            size_t fragBytes = loadStageCode(fragSpvPath).size();
+
+            // Same frame sequence for every level, so feedback shaders see the same history
+            frameCount = 0;
+            for (int i = 0; i < 3; i++) {
+                renderOffscreen(i / 60.0);
+            }
+            std::vector<double> millis;
+            for (int i = 0; i < frames; i++) {
+                millis.push_back(renderOffscreen((i + 3) / 60.0));
+            }
+            renderOffscreen(1.0, &pixels);
+            int maxDiff = 0;
+            if (reference.empty()) {
+                reference = pixels;
+            } else {
+                for (size_t i = 0; i < pixels.size(); i++) {
+                    maxDiff = std::max(maxDiff, std::abs(pixels[i] - reference[i]));
+                }
+            }
+
+            double mean = std::accumulate(millis.begin(), millis.end(), 0.0) / millis.size();
+            std::sort(millis.begin(), millis.end());
+            char row[128];
+            snprintf(row, sizeof(row), "  %-5s %12zu %13.2f %11.3f %9.3f %10d",
+                     level == spirv_optimizer::Level::None ? "none" : spirv_optimizer::levelFlag(level), fragBytes,
+                     pipelineMillis, millis[millis.size() / 2], mean, maxDiff);
+            std::cout << row << std::endl;
+        }
+        std::cout << "  (" << frames << " frames at " << WIDTH << "x" << HEIGHT
+                  << (timestampPool != VK_NULL_HANDLE ? ", GPU timestamps" : ", CPU wall time") << ")" << std::endl;
+
+        vkDeviceWaitIdle(device);
+        destroyPipelineVariants();
+        cleanup();
+        return EXIT_SUCCESS;
+    }
+
+    // --cpu: render shaderPath on the CPU by interpreting its SPIR-V (no Vulkan device needed)
+    // and report throughput; with compare, render the same frames through Vulkan (lavapipe
+    // where there is no GPU) and report how far the last images differ
+    int renderOnCpu(const std::string& shaderPath, int frames, bool compare) {
+        currentShaderPath = resolveFragmentShader(shaderPath);
+        if (!compileAndLoadShader(currentShaderPath)) {
+            return EXIT_FAILURE;
+        }
+        auto words = [](const std::vector<char>& code) {
+            std::vector<uint32_t> result(code.size() / 4);
+            memcpy(result.data(), code.data(), result.size() * 4);
+            return result;
+        };
+        std::string fragSpvPath =
+            getShaderDirectory(currentShaderPath) + "/" + getShaderBaseName(currentShaderPath) + ".frag.spv";
+        spirv_cpu::Renderer renderer;
+        std::string error;
+        if (!renderer.load(words(loadStageCode(vertexShaderPath(currentShaderPath))), words(loadStageCode(fragSpvPath)),
+                           shader_params::constants(shaderParams), error)) {
+            std::cerr << "✗ CPU renderer: " << error << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // The CPU can provide the texture and the previous frame; other channels read as black
+        swapchainExtent = {WIDTH, HEIGHT};
+        spirv_cpu::Texture texture = loadCpuTexture(), feedback;
+        bool usesFeedback = false;
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            ChannelKind kind = channelSources[i].kind;
+            if (kind == ChannelKind::Texture || kind == ChannelKind::Feedback) {
+                usesFeedback = usesFeedback || kind == ChannelKind::Feedback;
+                renderer.setTexture(1 + i, kind == ChannelKind::Feedback ? &feedback : &texture);
+            } else {
+                std::cout << "⚠ iChannel" << i << " is not available on the CPU, it reads as black" << std::endl;
+            }
+        }
+        for (uint32_t binding = 1 + CHANNEL_COUNT; binding < spirv_cpu::MAX_BINDINGS; binding++) {
+            if (binding != isf_inputs::UNIFORM_BINDING) renderer.setTexture(binding, &texture);
+        }
+        for (uint32_t binding : renderer.fragmentProgram().unsupportedTextures()) {
+            std::cout << "⚠ Binding " << binding << " is a cube or 3D texture, it reads as black on the CPU" << std::endl;
+        }
+
+        WorkPool pool;
+        std::vector<uint8_t> pixels;
+        std::vector<double> millis;
+        frameCount = 0;
+        for (int i = 0; i < frames; i++) {
+            timeOverride = i / 60.0;
+            UniformBufferObject ubo{};
+            fillUniforms(ubo);
+            updateInputs();
+            renderer.setBlock(0, &ubo, sizeof(ubo));
+            renderer.setBlock(isf_inputs::UNIFORM_BINDING, isfInputData.data(), isfInputData.size());
+            renderer.setBlock(spirv_cpu::PUSH_CONSTANTS, isfInputData.data(), isfInputData.size());
+
+            auto start = std::chrono::steady_clock::now();
+            if (!renderer.render(WIDTH, HEIGHT, pixels, pool)) {
+                throw std::runtime_error("Vertex shader produced no triangles on the CPU!");
+            }
+            millis.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            if (usesFeedback) {
+                // This frame is the next one's iChannel input (UNORM, no sRGB decode)
+                feedback.width = WIDTH;
+                feedback.height = HEIGHT;
+                feedback.rgba.resize(pixels.size());
+                for (size_t p = 0; p < pixels.size(); p++) {
+                    feedback.rgba[p] = pixels[p] / 255.0f;
+                }
+            }
+        }
+        std::sort(millis.begin(), millis.end());
+        double median = millis[millis.size() / 2];
+        char row[160];
+        snprintf(row, sizeof(row), "\n  CPU: %d frames at %ux%u on %u threads, median %.1f ms, %.2f Mpix/s", frames,
+                 WIDTH, HEIGHT, pool.size(), median, WIDTH * HEIGHT / median / 1000.0);
+        std::cout << row << std::endl;
+        if (!compare) {
+            return EXIT_SUCCESS;
+        }
+
+        // The same frame sequence through Vulkan, so feedback shaders see the same history
+        std::vector<uint8_t> reference;
+        initOffscreen(WIDTH, HEIGHT);
+        frameCount = 0;
+        millis.clear();
+        for (int i = 0; i < frames; i++) {
+            millis.push_back(renderOffscreen(i / 60.0, i + 1 == frames ? &reference : nullptr));
+        }
+        std::sort(millis.begin(), millis.end());
+        median = millis[millis.size() / 2];
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        snprintf(row, sizeof(row), "  GPU: %s, median %.2f ms, %.2f Mpix/s", properties.deviceName, median,
+                 WIDTH * HEIGHT / median / 1000.0);
+        std::cout << row << std::endl;
+
+        int maxDiff = 0;
+        uint64_t totalDiff = 0;
+        size_t differing = 0;
+        for (size_t p = 0; p < pixels.size(); p += 4) {
+            int pixelDiff = 0;
+            for (size_t c = 0; c < 4; c++) {
+                int diff = std::abs(pixels[p + c] - reference[p + c]);
+                pixelDiff = std::max(pixelDiff, diff);
+                totalDiff += diff;
+            }
+            maxDiff = std::max(maxDiff, pixelDiff);
+            if (pixelDiff > 2) differing++;
+        }
+        snprintf(row, sizeof(row), "  Difference: max %d, mean %.3f per channel, %.2f%% of pixels off by more than 2",
+                 maxDiff, static_cast<double>(totalDiff) / pixels.size(), 100.0 * differing / (pixels.size() / 4));
+        std::cout << row << std::endl;
+
+        vkDeviceWaitIdle(device);
+        destroyPipelineVariants();
+        cleanup();
+        return EXIT_SUCCESS;
+    }
+
+    // --render: draw shaderPath at iTime = time as a width x height image, larger than any
+    // framebuffer, in tileSize tiles of the same virtual image (iResolution and fragCoord are
+    // those of the whole image), and stream it to a PNG. A tile renders while the one before
+    // it is copied out, and each finished row of tiles goes to the writer, so host memory is
+    // one row of tiles however large the image.
+    int renderTiled(const std::string& shaderPath, uint32_t width, uint32_t height, double time, uint32_t tileSize,
+                    std::string outputPath) {
+        currentShaderPath = resolveFragmentShader(shaderPath);
+        if (!compileAndLoadShader(currentShaderPath)) {
+            return EXIT_FAILURE;
+        }
+        if (outputPath.empty()) {
+            outputPath = getShaderBaseName(currentShaderPath) + "_" + std::to_string(width) + "x" +
+                         std::to_string(height) + ".png";
+        }
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            if (channelSources[i].kind == ChannelKind::Feedback && shaderInterface.uses(1 + i)) {
+                std::cout << "⚠ iChannel" << i << " is the previous frame; in a tiled render it holds a previous tile"
+                          << std::endl;
+            }
+        }
+
+        uint32_t tileWidth = std::min(tileSize, width);
+        uint32_t tileHeight = std::min(tileSize, height);
+        initOffscreen(tileWidth, tileHeight);
+        auto finish = [&](int status) {
+            vkDeviceWaitIdle(device);
+            virtualExtent = {0, 0};
+            tileOrigin = {0, 0};
+            timeOverride = -1.0;
+            destroyPipelineVariants();
+            cleanup();
+            return status;
+        };
+
+        // Converted mainImage() shaders place each tile through iTileOrigin; any other shader
+        // draws the whole image's quad through a viewport that size
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        const VkPhysicalDeviceLimits& limits = properties.limits;
+        if (!uniformUseOf(graphicsPipeline).tileOrigin &&
+            (width > limits.maxViewportDimensions[0] || height > limits.maxViewportDimensions[1] ||
+             -static_cast<float>(width) < limits.viewportBoundsRange[0] ||
+             -static_cast<float>(height) < limits.viewportBoundsRange[0])) {
+            std::cerr << "✗ " << width << "x" << height << " is larger than " << properties.deviceName
+                      << " allows (viewports up to " << limits.maxViewportDimensions[0] << "x"
+                      << limits.maxViewportDimensions[1] << ")" << std::endl;
+            return finish(EXIT_FAILURE);
+        }
+
+        png_writer::Writer writer;
+        std::string error;
+        if (!writer.open(outputPath, width, height, error)) {
+            std::cerr << "✗ " << error << std::endl;
+            return finish(EXIT_FAILURE);
+        }
+
+        // One set of uniforms for every tile but iTileOrigin; they and the inputs go into the
+        // tile's frame slot
+        virtualExtent = {width, height};
+        timeOverride = time;
+        UniformBufferObject ubo{};
+        fillUniforms(ubo);
+        for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            currentFrame = i;
+            updateInputs();
+            updateDeepZoom();
+        }
+
+        uint32_t columns = (width + tileWidth - 1) / tileWidth;
+        uint32_t rows = (height + tileHeight - 1) / tileHeight;
+        uint32_t tiles = columns * rows;
+        std::vector<uint8_t> strip(static_cast<size_t>(width) * tileHeight * 4);  // One row of tiles
+        bool written = true;
+        auto collect = [&](uint32_t tile) {
+            int frame = tile % MAX_FRAMES_IN_FLIGHT;
+            vkWaitForFences(device, 1, &inFlightFences[frame], VK_TRUE, UINT64_MAX);
+            uint32_t column = tile % columns;
+            uint32_t x = column * tileWidth;
+            uint32_t y = tile / columns * tileHeight;
+            uint32_t copyWidth = std::min(tileWidth, width - x);
+            uint32_t copyHeight = std::min(tileHeight, height - y);
+            const uint8_t* pixels = static_cast<const uint8_t*>(readbackMapped[frame]);
+            for (uint32_t r = 0; r < copyHeight; r++) {
+                memcpy(&strip[(static_cast<size_t>(r) * width + x) * 4],
+                       pixels + static_cast<size_t>(r) * tileWidth * 4, static_cast<size_t>(copyWidth) * 4);
+            }
+            if (column + 1 == columns) {
+                written = writer.writeRows(strip.data(), copyHeight) && written;
+            }
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t tile = 0; tile < tiles; tile++) {
+            currentFrame = tile % MAX_FRAMES_IN_FLIGHT;
+            if (tile >= static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT)) {
+                collect(tile - MAX_FRAMES_IN_FLIGHT);
+            }
+            tileOrigin = {static_cast<int32_t>(tile % columns * tileWidth),
+                          static_cast<int32_t>(tile / columns * tileHeight)};
+            fillTileOrigin(ubo);
+            writeUniforms(ubo);
+            submitOffscreen(true, false);
+            currentFeedbackBuffer = 1 - currentFeedbackBuffer;
+        }
+        for (uint32_t tile = tiles > static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) ? tiles - MAX_FRAMES_IN_FLIGHT : 0;
+             tile < tiles; tile++) {
+            collect(tile);
+        }
+        written = writer.close() && written;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (!written) {
+            std::cerr << "✗ Failed to write " << outputPath << std::endl;
+            return finish(EXIT_FAILURE);
+        }
+        char row[160];
+        snprintf(row, sizeof(row), "✓ Rendered %ux%u as %u tiles of %ux%u in %.2f s (%.1f Mpix/s) → ", width,
+                 height, tiles, tileWidth, tileHeight, seconds, width * static_cast<double>(height) / seconds / 1e6);
+        std::cout << row << outputPath << std::endl;
+        return finish(EXIT_SUCCESS);
+    }
+
+    // --encode: render frames of shaderPath headless at fps and encode them straight into a
+    // video file. Three stages overlap: the GPU renders frame n while the encoder's converter
+    // turns frame n-1 (read in place from its readback buffer) into YUV and its encoder
+    // compresses the frames before that (video_encoder.h).
+    int encodeVideo(const std::string& shaderPath, const std::string& outputPath, uint32_t width, uint32_t height,
+                    int fps, uint64_t frames, const std::string& codec) {
+        currentShaderPath = resolveFragmentShader(shaderPath);
+        if (!compileAndLoadShader(currentShaderPath)) {
+            return EXIT_FAILURE;
+        }
+        VideoEncoder encoder;
+        std::string error;
+        if (!encoder.open(outputPath, width, height, fps, codec, error)) {
+            std::cerr << "✗ " << error << std::endl;
+            return EXIT_FAILURE;
+        }
+        initOffscreen(width, height);
+        fixedTimeStep = 1.0 / fps;
+        frameCount = 0;
+        std::cout << "✓ Encoding " << frames << " frames at " << width << "x" << height << ", " << fps << " fps with "
+                  << encoder.codecName() << " → " << outputPath << std::endl;
+
+        std::vector<const void*> slots(readbackMapped, readbackMapped + MAX_FRAMES_IN_FLIGHT);
+        encoder.start(slots);
+        bool encoding = true;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t frame = 0; frame < frames && encoding; frame++) {
+            currentFrame = static_cast<int>(frame % MAX_FRAMES_IN_FLIGHT);
+            if (frame > 0) {
+                // The previous frame is done: hand it over, and the uniform buffer is free again
+                int previous = static_cast<int>((frame - 1) % MAX_FRAMES_IN_FLIGHT);
+                vkWaitForFences(device, 1, &inFlightFences[previous], VK_TRUE, UINT64_MAX);
+                encoder.submit(frame - 1);
+            }
+            if (frame >= static_cast<uint64_t>(MAX_FRAMES_IN_FLIGHT)) {
+                encoding = encoder.waitForSlot(frame - MAX_FRAMES_IN_FLIGHT);
+            }
+            timeOverride = frame * fixedTimeStep;
+            updateUniformBuffer();
+            updateInputs();
+            updateDeepZoom();
+            submitOffscreen(true, false);
+            currentFeedbackBuffer = 1 - currentFeedbackBuffer;
+        }
+        if (encoding && frames > 0) {
+            vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+            encoder.submit(frames - 1);
+        }
+        bool written = encoder.finish();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        vkDeviceWaitIdle(device);
+        timeOverride = -1.0;
+        destroyPipelineVariants();
+        cleanup();
+        if (!written) {
+            std::cerr << "✗ Failed to encode " << outputPath << std::endl;
+            return EXIT_FAILURE;
+        }
+        uint64_t encoded = encoder.framesEncoded();
+        char row[192];
+        snprintf(row, sizeof(row),
+                 "✓ Encoded %llu frames in %.2f s (%.1f fps); converting %.2f ms/frame, encoding %.2f ms/frame",
+                 (unsigned long long)encoded, seconds, encoded / seconds, encoder.convertSeconds() * 1e3 / encoded,
+                 encoder.encodeSeconds() * 1e3 / encoded);
+        std::cout << row << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    // --replay: feed a --record trace back headless at its framebuffer size, one frame per
+    // recorded frame at a fixed timestep (--fixed-step, default 60), and report GPU time per frame and
+    // a hash of every frame's pixels; the trace hash matches between runs that render alike
+    int replayTrace(const std::string& tracePath, const std::string& reportPath) {
+        input_trace::Trace trace;
+        std::string error;
+        if (!input_trace::read(tracePath, trace, error)) {
+            std::cerr << "✗ " << error << std::endl;
+            return EXIT_FAILURE;
+        }
+        currentShaderPath = resolveFragmentShader(trace.shader);
+        if (!compileAndLoadShader(currentShaderPath)) {
+            return EXIT_FAILURE;
+        }
+        std::istringstream values(trace.values);
+        readShaderValues(values);
+        selectedTunable = trace.selected;
+        if (fixedTimeStep <= 0.0) {
+            fixedTimeStep = 1.0 / 60.0;
+        }
+        replaying = true;
+        replayClock = 0.0;
+        mouseSmoother.reset(trace.width / 2.0, trace.height / 2.0, 0.0);
+        initOffscreen(trace.width, trace.height);
+        frameCount = 0;
+
+        std::vector<uint8_t> pixels;
+        std::vector<double> millis;
+        std::vector<uint64_t> hashes;
+        for (const input_trace::Entry& entry : trace.entries) {
+            replayClock = entry.time;
+            switch (entry.kind) {
+                case input_trace::Kind::Move:
+                    onCursorPos(entry.x, entry.y);
+                    break;
+                case input_trace::Kind::Button:
+                    onMouseButton(entry.code, entry.action ? GLFW_PRESS : GLFW_RELEASE, entry.mods);
+                    break;
+                case input_trace::Kind::Scroll:
+                    onScroll(entry.x, entry.y);
+                    break;
+                case input_trace::Kind::Key:
+                    onKey(entry.code, entry.action, entry.mods);
+                    break;
+                case input_trace::Kind::Frame:
+                    millis.push_back(renderOffscreen(hashes.size() * fixedTimeStep, &pixels));
+                    hashes.push_back(input_trace::frameHash(pixels.data(), pixels.size()));
+                    break;
+            }
+        }
+        vkDeviceWaitIdle(device);
+        destroyPipelineVariants();
+        cleanup();
+        replaying = false;
+
+        if (hashes.empty()) {
+            std::cerr << "✗ " << tracePath << " has no frames" << std::endl;
+            return EXIT_FAILURE;
+        }
+        uint64_t traceHash = input_trace::frameHash(reinterpret_cast<const uint8_t*>(hashes.data()),
+                                                    hashes.size() * sizeof(uint64_t));
+        if (!reportPath.empty()) {
+            std::ofstream report(reportPath);
+            if (!report.is_open()) {
+                std::cerr << "✗ Could not write: " << reportPath << std::endl;
+                return EXIT_FAILURE;
+            }
+            report << "frame,ms,hash\n";
+            for (size_t i = 0; i < hashes.size(); i++) {
+                char row[64];
+                snprintf(row, sizeof(row), "%zu,%.4f,%016llx\n", i, millis[i], (unsigned long long)hashes[i]);
+                report << row;
+            }
+        }
+
+        std::vector<double> sorted = millis;
+        std::sort(sorted.begin(), sorted.end());
+        char row[192];
+        snprintf(row, sizeof(row),
+                 "✓ Replayed %zu frames at %ux%u: median %.3f ms, p95 %.3f ms, max %.3f ms\n"
+                 "  last frame %016llx, trace %016llx",
+                 sorted.size(), trace.width, trace.height, sorted[sorted.size() / 2],
+                 sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)], sorted.back(),
+                 (unsigned long long)hashes.back(), (unsigned long long)traceHash);
+        std::cout << row << std::endl;
+        return EXIT_SUCCESS;
+    }
+
     void run(const std::string& initialShader = "") {
         loadShaderList(initialShader);
 
@@ -66,19 +1060,21 @@ public:
     }
 
 private:
-    GLFWwindow* window;
+    GLFWwindow* window = nullptr;
     VkInstance instance;
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     VkDevice device;
     VkQueue graphicsQueue;
-    VkSurfaceKHR surface;
+    VkSurfaceKHR surface = VK_NULL_HANDLE;  // Stays null on a headless device
     VkSwapchainKHR swapchain;
     std::vector<VkImage> swapchainImages;
     VkFormat swapchainImageFormat;
     VkExtent2D swapchainExtent;
     std::vector<VkImageView> swapchainImageViews;
     VkRenderPass renderPass;
-    VkDescriptorSetLayout descriptorSetLayout;
+    VkRenderPass panRenderPass;  // renderPass loading the previous contents (// @pancoherent)
+    VkRenderPass iterationRenderPass;  // Into the RG32F iteration buffer (// @recolor pass 0)
+    VkDescriptorSetLayout descriptorSetLayout;  // Those of shaderInterface, owned by layoutCache
     VkPipelineLayout pipelineLayout;
     VkPipeline graphicsPipeline;
     std::vector<VkFramebuffer> swapchainFramebuffers;
@@ -88,11 +1084,12 @@ private:
     std::vector<VkSemaphore> renderFinishedSemaphores;
     std::vector<VkFence> inFlightFences;
     size_t currentFrame = 0;
-    const int MAX_FRAMES_IN_FLIGHT = 2;
+    static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 
-    VkBuffer uniformBuffer;
+    VkBuffer uniformBuffer;  // One slot per frame in flight, uniformSlotSize apart
     VkDeviceMemory uniformBufferMemory;
     void* uniformBufferMapped;
+    VkDeviceSize uniformSlotSize = 0;
 
     VkImage textureImage;
     VkDeviceMemory textureImageMemory;
@@ -106,6 +1103,41 @@ private:
     VkFramebuffer feedbackFramebuffers[2];
     int currentFeedbackBuffer = 0;  // Ping-pong index
 
+    // Streaming video channel (// @video)
+    static const int VIDEO_STAGING_SLOTS = 4;
+    VideoDecoder videoDecoder;
+    bool videoActive = false;
+    float videoStartTime = 0.0f;
+    std::vector<VkBuffer> videoStagingBuffers;
+    std::vector<VkDeviceMemory> videoStagingMemories;
+    VkImage videoImages[2];
+    VkDeviceMemory videoImageMemories[2];
+    VkImageView videoImageViews[2];
+    int videoFrontImage = 0;
+    int64_t videoPendingUpload = -1;           // Sequence to copy in this frame's command buffer
+    std::vector<int64_t> videoInFlightUploads;  // Per frame in flight, released after its fence
+
+    // Audio spectrum/waveform channel (// @audio), 512x2 R8 like ShaderToy
+    AudioAnalyzer audioAnalyzer;
+    bool audioActive = false;
+    StreamingImage audioImage;
+    bool audioUploadPending = false;
+
+    // Keyboard state channel (// @iChannelN keyboard), 256x3 R8 like ShaderToy
+    KeyboardState keyboardState;
+    bool keyboardActive = false;
+    StreamingImage keyboardImage;
+    bool keyboardUploadPending = false;
+    uint32_t keyboardUploadOffset = 0;
+    uint32_t keyboardUploadWidth = 0;
+    double keyboardEventTimes[MAX_FRAMES_IN_FLIGHT] = {-1.0, -1.0};  // Oldest event in each in-flight frame
+    uint64_t keyboardLatencySamples = 0;
+    double keyboardLatencyTotal = 0.0;
+    double keyboardLatencyMax = 0.0;
+
+    ChannelImage channelImages[CHANNEL_COUNT];  // Cube/volume channels, loaded per shader
+    uint32_t channelExtents[CHANNEL_COUNT][3] = {};
+
     VkDescriptorPool descriptorPool;
     std::vector<VkDescriptorSet> descriptorSets;
 
@@ -132,14 +1164,36 @@ private:
     float previousScrollY = 0.0f;  // For zoom-at-cursor
     float currentZoom = 1.0f;  // Current zoom level
     float currentTime = 0.0f;  // Current time for reset functionality
+    float lastFrameTime = 0.0f;
+    int frameCount = 0;         // iFrame, restarts at 0 for every loaded shader
+    float frameRate = 60.0f;    // Smoothed iFrameRate
+    double fixedTimeStep = 0.0; // > 0: iTime advances exactly this much per frame (--fixed-step)
+    int textureWidth = 0;       // Size of the shared @texture image (iChannelResolution)
+    int textureHeight = 0;
     double referenceMouseX = WIDTH / 2.0;  // Reference mouse position for relative zooming
     double referenceMouseY = HEIGHT / 2.0;  // (set on reset to avoid jumps at high zoom)
-    double mouseSmoothedX = WIDTH / 2.0;  // Smoothed mouse position for zoom focal point
-    double mouseSmoothedY = HEIGHT / 2.0;  // (reduces jitter at high zoom levels)
+
+    // Mouse events as the callbacks saw them, timestamped, drained once per frame into the
+    // iMouseHistory samples and the iMouse smoothing (reduces jitter at high zoom levels)
+    static constexpr uint64_t INPUT_POLL_NANOS = 2000000;  // Event polling while a frame renders
+    input_events::Queue inputEvents;
+    input_events::MouseHistory mouseHistory;
+    input_events::Smoother mouseSmoother;
+    uint32_t mouseButtons = 0;  // input_events::buttonBit()s as of the last drained event
+
+    // --record / --replay (input_trace.h): every input callback, tagged with traceFrame (the
+    // frames drawn since recording started); replay feeds them to the same handlers headless
+    std::string recordPath;
+    input_trace::Writer traceWriter;
+    double traceStart = 0.0;   // steadySeconds() when recording started
+    uint64_t traceFrame = 0;
+    bool replaying = false;
+    double replayClock = 0.0;  // Input time while replaying (trace seconds)
 
     // Pan offset for drag-and-drop (stored in zoom-independent complex-plane units)
-    float basePanX = 0.0f;  // Complex-plane units at zoom=1
-    float basePanY = 0.0f;
+    // Doubles, passed to shaders as iPan + iPanLo so // @precision df64 shaders can pan at 1e13
+    double basePanX = 0.0;  // Complex-plane units at zoom=1
+    double basePanY = 0.0;
 
     // Retina/HiDPI scale factors (framebuffer size / window size)
     float scaleX = 1.0f;
@@ -153,119 +1207,427 @@ private:
     int currentShaderIndex = 0;
     std::string currentShaderPath;
     std::string currentTexturePath;
+    glsl_converter::Converter shaderConverter{uniformNames()};
+    ChannelSource channelSources[CHANNEL_COUNT];
+    int videoChannel = -1;  // Channel index fed by the video decoder, -1 if none
+    int audioChannel = -1;
+    int keyboardChannel = -1;
     bool hasGeometryShader = false;
 
+    // Hot reload: the current shader, its #includes, vertex/geometry stages and image files
+    // are watched; a changed stage is recompiled and its pipeline built on reloadThread, then
+    // swapped in between frames. The old pipeline is destroyed once no frame in flight uses it.
+    FileWatcher shaderWatcher;
+    std::set<std::string> fragmentSources;  // Canonical paths of the shader and its #includes
+    std::string vertexSource;
+    std::string geometrySource;
+    std::string textureSource;
+    std::set<std::string> channelImageSources;  // Cube and volume files
+    std::thread reloadThread;
+    std::atomic<bool> reloadFinished{false};
+    VkPipeline reloadedPipeline = VK_NULL_HANDLE;
+    std::vector<std::pair<VkPipeline, int>> retiredPipelines;  // Pipeline, frames left in flight
+    spirv_interface::Interface reloadedInterface;
+
+    // Descriptor bindings of the running pipeline, reflected from its SPIR-V. Layouts are
+    // cached by interface hash, so shaders declaring the same bindings share them; workers
+    // (hot reload, --validate) create them too, hence the mutex.
+    struct ShaderLayout {
+        VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+        VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    };
+    spirv_interface::Interface shaderInterface;
+    std::map<uint64_t, ShaderLayout> layoutCache;
+    std::mutex layoutCacheMutex;
+
+    // Compile-time parameters (// @param) become specialization constants: a new value only
+    // needs another pipeline from the same SPIR-V, built through pipelineCache. Every variant
+    // of the current shader is kept, keyed by its constant data; graphicsPipeline is one of them.
+    std::vector<shader_params::Param> shaderParams;
+    std::string shaderParamsPath;  // Shader they were read from (values survive its reloads)
+    std::map<std::vector<uint32_t>, VkPipeline> pipelineVariants;
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    std::vector<shader_params::Param> reloadedParams;
+
+    // --opt: spirv-opt level applied to every stage when a pipeline is built (results cached on disk)
+    spirv_optimizer::Level spirvOptimization = spirv_optimizer::Level::None;
+    double lastPipelineMillis = 0.0;  // vkCreateGraphicsPipelines time in the last createShaderPipeline
+
+    // Offscreen rendering (--compare-opt): frames go to the feedback buffers, timed with
+    // timestamp queries and optionally read back (one readback buffer per frame in flight,
+    // so --render can copy out one tile while the next renders)
+    double timeOverride = -1.0;  // >= 0: iTime of the next frame
+    double timeShift = 0.0;      // Added to the clock's iTime (--control "time")
+    VkQueryPool timestampPool = VK_NULL_HANDLE;
+    double timestampPeriod = 0.0;  // Nanoseconds per tick, 0 if the queue can't write timestamps
+    VkBuffer readbackBuffers[MAX_FRAMES_IN_FLIGHT] = {};
+    VkDeviceMemory readbackMemories[MAX_FRAMES_IN_FLIGHT] = {};
+    void* readbackMapped[MAX_FRAMES_IN_FLIGHT] = {};
+
+    // --serve: frames are copied from the feedback buffer into a ring of host buffers for the
+    // stream server. A slot is busy from the copy until an encoder thread is done with it; a
+    // frame that finds every slot busy (or nobody watching) isn't copied at all, so streaming
+    // never holds up rendering.
+    static constexpr int STREAM_SLOTS = 4;
+    uint16_t servePort = 0;
+    frame_server::Server frameServer;
+    VkBuffer streamBuffers[STREAM_SLOTS] = {};
+    VkDeviceMemory streamMemories[STREAM_SLOTS] = {};
+    void* streamMapped[STREAM_SLOTS] = {};
+    std::atomic<bool> streamBusy[STREAM_SLOTS] = {};
+    int streamPending[MAX_FRAMES_IN_FLIGHT] = {};  // Slot each frame in flight copies into, -1 if none
+    uint64_t streamSequence = 0;
+
+    // --control: JSON commands from a local socket, drained once per frame before it renders.
+    // A screenshot is copied out of the feedback image like a stream frame and written once
+    // its fence signals; it answers its command then.
+    std::string controlAddress;
+    control_server::Server controlServer;
+    bool paused = false;  // iTime held at timeOverride
+    VkBuffer screenshotBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory screenshotMemory = VK_NULL_HANDLE;
+    void* screenshotMapped = nullptr;
+    VkExtent2D screenshotExtent = {0, 0};
+    bool screenshotRequested = false;
+    int screenshotFrame = -1;  // Frame in flight holding the copy, -1 if none
+    control_server::Command screenshotCommand;
+
+    // --render: the image the shader sees (iResolution, fragCoord) when it is larger than the
+    // framebuffer, and the top-left pixel of the tile being drawn. Zero extent: the framebuffer.
+    VkExtent2D virtualExtent = {0, 0};
+    VkOffset2D tileOrigin = {0, 0};
+
+    // What the stages of each pipeline from createShaderPipeline read of the uniform block
+    // (spirv_analysis, when the pipeline is made)
+    struct UniformUse {
+        bool clock = false;       // iTime, iTimeDelta, iFrame or iDate: changes every frame
+        bool tileOrigin = false;  // iTileOrigin: fragCoord comes from gl_FragCoord, not the viewport
+    };
+    std::map<VkPipeline, UniformUse> uniformUses;
+    mutable std::mutex uniformUsesMutex;
+
+    // ISF INPUTS: packed once per frame into a push-constant block (one vkCmdPushConstants),
+    // or into this frame's slot of inputsBuffers when the shader declares them as the uniform
+    // block at isf_inputs::UNIFORM_BINDING. Tab/↑↓ tune them like @params (one component at
+    // a time), Shift+drag sets a point2D; values of both are saved to <shader>.params.
+    isf_inputs::Block isfInputs;
+    isf_inputs::Block reloadedInputs;
+    std::vector<uint8_t> isfInputData;
+    VkBuffer inputsBuffers[MAX_FRAMES_IN_FLIGHT];
+    VkDeviceMemory inputsBufferMemories[MAX_FRAMES_IN_FLIGHT];
+    void* inputsBuffersMapped[MAX_FRAMES_IN_FLIGHT];
+    int selectedTunable = 0;
+    int draggedPoint = -1;  // ISF point2D input following the mouse, -1 if none
+
+    // // @deepzoom shaders: the view lives in deepZoom at arbitrary precision and the zoom is
+    // not clamped; each frame's header (and a new reference orbit, once ready) goes into
+    // this frame's orbit buffer at deep_zoom::ORBIT_BINDING
+    deep_zoom::Engine deepZoom;
+    bool deepZoomActive = false;
+    bool precisionDf64 = false;      // // @precision df64: zoom up to df64::MAX_ZOOM
+    double deepZoomPan[2] = {0.0, 0.0};  // Pixels (fragCoord) the deep zoom view was dragged
+
+    // // @pancoherent shaders draw a view that only moves with the pan, so on a pure pan the
+    // previous frame is copied into place shifted and only the exposed strips are drawn.
+    // PanView is what else must match the previous frame; origin is where the content sits
+    // (iPan, in whole pixels, or the deep zoom drag). time and frame only count for pipelines
+    // whose SPIR-V reads the clock (UniformUse), so an animated shader redraws in full.
+    struct PanView {
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkExtent2D extent = {0, 0};
+        double zoom = 0.0;
+        double focus[2] = {0.0, 0.0};  // Zoom centre (iZoomCenter)
+        uint64_t orbitVersion = 0;
+        std::vector<uint8_t> inputs;
+        double time = 0.0;   // iTime (and iTimeDelta, iDate)
+        uint64_t frame = 0;  // iFrame
+        double origin[2] = {0.0, 0.0};
+    };
+    bool panCoherent = false;
+    PanView previousView;
+    double panOrigin[2] = {0.0, 0.0};
+    bool panReuse = false;                // This frame shifts the previous one by panShift
+    VkOffset2D panShift = {0, 0};         // Framebuffer pixels (y down)
+
+    // // @recolor shaders: pass 0 (iterate()) renders into iterationImage with the companion
+    // pipeline createShaderPipeline made for each colour pipeline, pass 1 (the colour
+    // pipeline) reads it at iteration_buffer::ITERATIONS_BINDING. Pass 0 is skipped while
+    // the view (a PanView, with the exact origin) matches the one it last ran for.
+    static constexpr VkFormat ITERATION_FORMAT = VK_FORMAT_R32G32_SFLOAT;  // iterate()'s vec2
+    bool recolorActive = false;
+    std::map<VkPipeline, VkPipeline> iterationPipelines;  // Colour pipeline → pass 0 pipeline
+    std::mutex iterationPipelinesMutex;
+    VkImage iterationImage;
+    VkDeviceMemory iterationImageMemory;
+    VkImageView iterationImageView;
+    VkFramebuffer iterationFramebuffer;
+    PanView iterationView;
+    bool iterationsValid = false;  // This frame can colour the iterations already in iterationImage
+    std::string viewDirectivesPath;  // Shader the view directives were last read for
+    double unclampedZoom = 1.0;
+    VkBuffer orbitBuffers[MAX_FRAMES_IN_FLIGHT];
+    VkDeviceMemory orbitBufferMemories[MAX_FRAMES_IN_FLIGHT];
+    void* orbitBuffersMapped[MAX_FRAMES_IN_FLIGHT];
+    uint64_t orbitBufferVersions[MAX_FRAMES_IN_FLIGHT] = {};
+
+    // One Tab stop: an @param, or one component of an ISF input
+    struct Tunable {
+        int param = -1;
+        int input = -1;
+        int component = 0;
+    };
+
+    // GLFW callbacks; the handlers below are also what --replay feeds
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
-        if (action == GLFW_PRESS) {
-            MetalshadeViewer* viewer = static_cast<MetalshadeViewer*>(glfwGetWindowUserPointer(window));
+        static_cast<MetalshadeViewer*>(glfwGetWindowUserPointer(window))->onKey(key, action, mods);
+    }
+
+    static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+        static_cast<MetalshadeViewer*>(glfwGetWindowUserPointer(window))->onMouseButton(button, action, mods);
+    }
+
+    static void cursorPosCallback(GLFWwindow* window, double xpos, double ypos) {
+        static_cast<MetalshadeViewer*>(glfwGetWindowUserPointer(window))->onCursorPos(xpos, ypos);
+    }
+
+    static void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
+        static_cast<MetalshadeViewer*>(glfwGetWindowUserPointer(window))->onScroll(xoffset, yoffset);
+    }
+
+    void onKey(int key, int action, int mods) {
+        recordInput(input_trace::Kind::Key, key, action, mods, 0.0, 0.0);
+        if (action != GLFW_REPEAT) {
+            keyboardState.push(key, action == GLFW_PRESS);
+        }
+
+        // Shaders reading the keyboard own the keys; viewer shortcuts then need Ctrl
+        bool viewerKeys = !keyboardActive || (mods & GLFW_MOD_CONTROL);
+        if (action == GLFW_PRESS && !window &&
+            (key == GLFW_KEY_ESCAPE || key == GLFW_KEY_F11 || key == GLFW_KEY_F || key == GLFW_KEY_LEFT ||
+             key == GLFW_KEY_RIGHT)) {
+            return;  // --replay: no window to close or resize, and the traced shader stays
+        }
 
+        if (action == GLFW_PRESS) {
             if (key == GLFW_KEY_ESCAPE) {
                 glfwSetWindowShouldClose(window, GLFW_TRUE);
-            } else if (key == GLFW_KEY_F || key == GLFW_KEY_F11) {
-                viewer->toggleFullscreen();
+            } else if (key == GLFW_KEY_F11) {
+                toggleFullscreen();
+            } else if (!viewerKeys) {
+                return;
+            } else if (key == GLFW_KEY_F) {
+                toggleFullscreen();
             } else if (key == GLFW_KEY_LEFT) {
-                viewer->switchShader(-1);
+                switchShader(-1);
             } else if (key == GLFW_KEY_RIGHT) {
-                viewer->switchShader(1);
+                switchShader(1);
             } else if (key == GLFW_KEY_R) {
                 // Reset scroll offset and pan
-                viewer->scrollX = 0.0f;
+                scrollX = 0.0f;
                 // scrollY = 0 for regular zoom, or currentTime for auto-zoom (to reset animation)
-                viewer->scrollY = 0.0f;
-                viewer->previousScrollY = 0.0f;
-                viewer->basePanX = 0.0f;
-                viewer->basePanY = 0.0f;
+                scrollY = 0.0f;
+                previousScrollY = 0.0f;
+                basePanX = 0.0;
+                basePanY = 0.0;
+                deepZoom.home();
+                deepZoomPan[0] = deepZoomPan[1] = 0.0;
                 // Store current mouse position as reference for relative zooming
-                viewer->referenceMouseX = viewer->mouseX;
-                viewer->referenceMouseY = viewer->mouseY;
+                referenceMouseX = mouseX;
+                referenceMouseY = mouseY;
                 std::cout << "✓ Reset zoom and pan" << std::endl;
             } else if (key == GLFW_KEY_EQUAL || key == GLFW_KEY_KP_ADD) {
                 // Zoom in with + or = key
-                viewer->scrollY = std::min(100.0f, viewer->scrollY + 1.0f);
+                scrollY = std::min(scrollLimit(), scrollY + 1.0f);
             } else if (key == GLFW_KEY_MINUS || key == GLFW_KEY_KP_SUBTRACT) {
                 // Zoom out with - key
-                viewer->scrollY = std::max(-100.0f, viewer->scrollY - 1.0f);
+                scrollY = std::max(-scrollLimit(), scrollY - 1.0f);
+            } else if (key == GLFW_KEY_TAB) {
+                selectTunable((mods & GLFW_MOD_SHIFT) ? -1 : 1);
             }
         }
+        if ((action == GLFW_PRESS || action == GLFW_REPEAT) && viewerKeys &&
+            (key == GLFW_KEY_UP || key == GLFW_KEY_DOWN)) {
+            adjustTunable(key == GLFW_KEY_UP ? 1 : -1);
+        }
     }
 
-    static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
-        MetalshadeViewer* viewer = static_cast<MetalshadeViewer*>(glfwGetWindowUserPointer(window));
-
+    void onMouseButton(int button, int action, int mods) {
+        recordInput(input_trace::Kind::Button, button, action == GLFW_PRESS, mods, 0.0, 0.0);
         bool pressed = (action == GLFW_PRESS);
 
+        // Shift+drag moves an ISF point2D input instead of reaching the shader
+        if (button == GLFW_MOUSE_BUTTON_LEFT && pressed && (mods & GLFW_MOD_SHIFT)) {
+            draggedPoint = pointInputToDrag();
+            if (draggedPoint >= 0) {
+                dragPointInput();
+                return;
+            }
+        }
+        if (button == GLFW_MOUSE_BUTTON_LEFT && !pressed && draggedPoint >= 0) {
+            draggedPoint = -1;
+            saveShaderValues();
+            return;
+        }
+        inputEvents.push({inputNow(), input_events::Kind::Button, button, pressed, mouseX, mouseY});
+
         if (button == GLFW_MOUSE_BUTTON_LEFT) {
-            viewer->mouseLeftPressed = pressed;
+            mouseLeftPressed = pressed;
             if (pressed) {
-                viewer->mouseClickX = viewer->mouseX;
-                viewer->mouseClickY = viewer->mouseY;
-                viewer->buttonPressDuration[0] = 0.0f;
+                mouseClickX = mouseX;
+                mouseClickY = mouseY;
+                buttonPressDuration[0] = 0.0f;
             } else {
                 // On release: accumulate drag offset into basePan (complex-plane units)
-                // Convert from window pixels to complex-plane units at current zoom
-                double dragDeltaX = viewer->mouseX - viewer->mouseClickX;
-                double dragDeltaY = viewer->mouseY - viewer->mouseClickY;
-
-                // Normalize to 0-1 range (window coords)
-                float normDragX = static_cast<float>(dragDeltaX) / viewer->cachedWindowWidth;
-                float normDragY = static_cast<float>(dragDeltaY) / viewer->cachedWindowHeight;
-
-                // Convert to complex-plane units (accounts for current zoom and aspect)
-                // In shader: pan in normalized coords affects complex plane as: -pan * 3.0/zoom
-                // For X: also multiply by aspect
-                viewer->basePanX += normDragX * 3.0f / viewer->currentZoom / viewer->aspect;
-                viewer->basePanY += normDragY * 3.0f / viewer->currentZoom;
+                double dragPanX, dragPanY;
+                dragPan(dragPanX, dragPanY);
+                basePanX += dragPanX;
+                basePanY += dragPanY;
+                if (deepZoomActive) {
+                    double dragX = std::round((mouseX - mouseClickX) * scaleX);
+                    double dragY = std::round((mouseClickY - mouseY) * scaleY);
+                    deepZoom.pan(dragX, dragY);
+                    deepZoomPan[0] += dragX;
+                    deepZoomPan[1] += dragY;
+                }
             }
         } else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
-            viewer->mouseRightPressed = pressed;
-            if (pressed) viewer->buttonPressDuration[1] = 0.0f;
+            mouseRightPressed = pressed;
+            if (pressed) buttonPressDuration[1] = 0.0f;
         } else if (button == GLFW_MOUSE_BUTTON_MIDDLE) {
-            viewer->mouseMiddlePressed = pressed;
-            if (pressed) viewer->buttonPressDuration[2] = 0.0f;
+            mouseMiddlePressed = pressed;
+            if (pressed) buttonPressDuration[2] = 0.0f;
         } else if (button == 3) {  // GLFW_MOUSE_BUTTON_4
-            viewer->mouseButton4Pressed = pressed;
-            if (pressed) viewer->buttonPressDuration[3] = 0.0f;
+            mouseButton4Pressed = pressed;
+            if (pressed) buttonPressDuration[3] = 0.0f;
         } else if (button == 4) {  // GLFW_MOUSE_BUTTON_5
-            viewer->mouseButton5Pressed = pressed;
-            if (pressed) viewer->buttonPressDuration[4] = 0.0f;
+            mouseButton5Pressed = pressed;
+            if (pressed) buttonPressDuration[4] = 0.0f;
         }
     }
 
-    static void cursorPosCallback(GLFWwindow* window, double xpos, double ypos) {
-        MetalshadeViewer* viewer = static_cast<MetalshadeViewer*>(glfwGetWindowUserPointer(window));
-        viewer->mouseX = xpos;
-        viewer->mouseY = ypos;
+    void onCursorPos(double xpos, double ypos) {
+        recordInput(input_trace::Kind::Move, 0, 0, 0, xpos * scaleX, ypos * scaleY);
+        mouseX = xpos;
+        mouseY = ypos;
+        inputEvents.push({inputNow(), input_events::Kind::Move, 0, false, xpos, ypos});
+        if (draggedPoint >= 0) {
+            dragPointInput();
+        }
     }
 
-    static void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
-        MetalshadeViewer* viewer = static_cast<MetalshadeViewer*>(glfwGetWindowUserPointer(window));
+    void onScroll(double xoffset, double yoffset) {
+        recordInput(input_trace::Kind::Scroll, 0, 0, 0, xoffset, yoffset);
+        inputEvents.push({inputNow(), input_events::Kind::Scroll, 0, false, xoffset, yoffset});
         // Accumulate scroll offset for shaders to use as they wish
-        viewer->scrollX += static_cast<float>(xoffset);
-        viewer->scrollY += static_cast<float>(yoffset);
+        scrollX += static_cast<float>(xoffset);
+        scrollY += static_cast<float>(yoffset);
         // Clamp to prevent extreme values that cause numerical issues
-        viewer->scrollX = std::max(-100.0f, std::min(100.0f, viewer->scrollX));
-        viewer->scrollY = std::max(-100.0f, std::min(100.0f, viewer->scrollY));
+        scrollX = std::max(-100.0f, std::min(100.0f, scrollX));
+        scrollY = std::max(-scrollLimit(), std::min(scrollLimit(), scrollY));
     }
 
-    void toggleFullscreen() {
-        isFullscreen = !isFullscreen;
-
-        if (isFullscreen) {
-            // Save windowed position and size
-            glfwGetWindowPos(window, &windowedPosX, &windowedPosY);
-            glfwGetWindowSize(window, &windowedWidth, &windowedHeight);
-
-            // Get primary monitor and its video mode
-            GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-            const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    // Timestamp for input events: the wall clock, or the trace's clock while replaying
+    double inputNow() const {
+        return replaying ? replayClock : steadySeconds();
+    }
 
-            // Switch to fullscreen
-            glfwSetWindowMonitor(window, monitor, 0, 0, mode->width, mode->height, mode->refreshRate);
-            std::cout << "✓ Switched to fullscreen: " << mode->width << "x" << mode->height << std::endl;
-        } else {
-            // Switch back to windowed mode
-            glfwSetWindowMonitor(window, nullptr, windowedPosX, windowedPosY, windowedWidth, windowedHeight, 0);
-            std::cout << "✓ Switched to windowed mode: " << windowedWidth << "x" << windowedHeight << std::endl;
+    // --record: one trace line for an input callback (cursor in framebuffer pixels, so the
+    // headless replay needs no window scale)
+    void recordInput(input_trace::Kind kind, int code, int action, int mods, double x, double y) {
+        if (!traceWriter.isOpen()) {
+            return;
+        }
+        input_trace::Entry entry;
+        entry.frame = traceFrame;
+        entry.kind = kind;
+        entry.time = steadySeconds() - traceStart;
+        entry.code = code;
+        entry.action = action;
+        entry.mods = mods;
+        entry.x = x;
+        entry.y = y;
+        traceWriter.write(entry);
+    }
+
+    // --record: the frame about to sample its input; the callbacks before it belong to it
+    void recordFrame() {
+        if (!traceWriter.isOpen()) {
+            return;
+        }
+        input_trace::Entry entry;
+        entry.frame = traceFrame++;
+        entry.time = steadySeconds() - traceStart;
+        traceWriter.write(entry);
+    }
+
+    void startRecording() {
+        std::ostringstream values;
+        writeShaderValues(values);
+        std::string error;
+        if (!traceWriter.open(recordPath, currentShaderPath, swapchainExtent.width, swapchainExtent.height,
+                              values.str(), selectedTunable, error)) {
+            throw std::runtime_error("Failed to record input: " + error);
+        }
+        traceStart = steadySeconds();
+        traceFrame = 0;
+        std::cout << "✓ Recording input to " << recordPath << std::endl;
+    }
+
+    void stopRecording() {
+        if (traceWriter.isOpen()) {
+            traceWriter.close();
+            std::cout << "✓ Recorded " << traceFrame << " frames of input to " << recordPath << std::endl;
+        }
+    }
+
+    // Scroll steps either way; deep zoom and df64 shaders can go as far as their MAX_ZOOM
+    float scrollLimit() const {
+        if (deepZoomActive) return static_cast<float>(std::log(deep_zoom::MAX_ZOOM) / 0.05);
+        if (precisionDf64) return static_cast<float>(std::log(df64::MAX_ZOOM) / 0.05);
+        return 100.0f;
+    }
+
+    // The left-button drag in progress as a change of basePan (complex-plane units)
+    void dragPan(double& x, double& y) const {
+        // Convert from window pixels to complex-plane units at current zoom
+        double dragDeltaX = mouseX - mouseClickX;
+        double dragDeltaY = mouseY - mouseClickY;
+
+        // Normalize to 0-1 range (window coords)
+        double normDragX = dragDeltaX / cachedWindowWidth;
+        double normDragY = dragDeltaY / cachedWindowHeight;
+
+        // Convert to complex-plane units (accounts for current zoom and aspect)
+        // In shader: pan in normalized coords affects complex plane as: -pan * 3.0/zoom
+        // For X: also multiply by aspect
+        x = normDragX * 3.0 / viewZoom() / aspect;
+        y = normDragY * 3.0 / viewZoom();
+    }
+
+    // This frame's zoom, clamped to what the shader's precision can show
+    double viewZoom() const {
+        return std::max(0.01, std::min(precisionDf64 ? df64::MAX_ZOOM : 1e10, unclampedZoom));
+    }
+
+    void toggleFullscreen() {
+        isFullscreen = !isFullscreen;
+
+        if (isFullscreen) {
+            // Save windowed position and size
+            glfwGetWindowPos(window, &windowedPosX, &windowedPosY);
+            glfwGetWindowSize(window, &windowedWidth, &windowedHeight);
+
+            // Get primary monitor and its video mode
+            GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+            const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+
+            // Switch to fullscreen
+            glfwSetWindowMonitor(window, monitor, 0, 0, mode->width, mode->height, mode->refreshRate);
+            std::cout << "✓ Switched to fullscreen: " << mode->width << "x" << mode->height << std::endl;
+        } else {
+            // Switch back to windowed mode
+            glfwSetWindowMonitor(window, nullptr, windowedPosX, windowedPosY, windowedWidth, windowedHeight, 0);
+            std::cout << "✓ Switched to windowed mode: " << windowedWidth << "x" << windowedHeight << std::endl;
         }
     }
 
@@ -400,6 +1762,185 @@ private:
         }
     }
 
+    // Recursively collect files ending in `extension`
+    static void collectFiles(const std::string& directory, const std::string& extension, std::vector<std::string>& files) {
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) {
+            return;
+        }
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..") {
+                continue;
+            }
+            std::string path = directory + "/" + name;
+            if (channel_images::isDirectory(path)) {
+                collectFiles(path, extension, files);
+            } else if (name.size() > extension.size() &&
+                       name.compare(name.size() - extension.size(), extension.size(), extension) == 0) {
+                files.push_back(path);
+            }
+        }
+        closedir(dir);
+    }
+
+    // Outcome of one shader in --validate; status is pass, convert-failed, compile-failed
+    // or pipeline-failed
+    struct ShaderValidation {
+        std::string status = "pass";
+        double convertMicros = 0.0;
+        double compileMicros = 0.0;
+        double pipelineMicros = 0.0;
+        std::vector<std::string> diagnostics;
+    };
+
+    // One --validate work item (runs on a pool thread; intermediate files go to tempBase.*).
+    // fragSpirv, if given, receives the compiled fragment module.
+    void validateShader(const std::string& path, const std::string& tempBase, VkShaderModule vertShaderModule,
+                        const spirv_interface::Interface& vertexInterface, ShaderValidation& result,
+                        std::vector<char>* fragSpirv = nullptr) {
+        std::ifstream input(path);
+        std::stringstream source;
+        source << input.rdbuf();
+
+        std::string glslPath = path;
+        if (!isVulkanSource(source.str())) {
+            ChannelSource sources[CHANNEL_COUNT];
+            readChannelDirectives(path, sources);
+            auto start = std::chrono::steady_clock::now();
+            glsl_converter::Result converted = shaderConverter.convert(source.str(), shaderHeader(sources));
+            result.convertMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            if (!converted.ok) {
+                result.status = "convert-failed";
+                result.diagnostics.push_back(converted.error);
+                return;
+            }
+            glslPath = tempBase + ".glsl";
+            std::ofstream(glslPath) << converted.output;
+        }
+
+        std::string spvPath = tempBase + ".spv";
+        std::string compileCmd = "glslangValidator -S frag -V \"" + glslPath + "\" -o \"" + spvPath + "\" -I\"" +
+                                 getShaderDirectory(path) + "\" 2>&1";
+        auto start = std::chrono::steady_clock::now();
+        std::string output;
+        FILE* pipe = popen(compileCmd.c_str(), "r");
+        char buffer[512];
+        while (pipe && fgets(buffer, sizeof(buffer), pipe)) {
+            output += buffer;
+        }
+        int status = pipe ? pclose(pipe) : -1;
+        result.compileMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        // Errors in converted code point at the temporary file; line numbers are those of the
+        // converted source (metalshade --convert shows it)
+        std::istringstream lines(output);
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (line.find("ERROR") == std::string::npos && line.find("WARNING") == std::string::npos) {
+                continue;
+            }
+            size_t at = line.find(glslPath);
+            if (at != std::string::npos && glslPath != path) {
+                line.replace(at, glslPath.size(), "<converted>");
+            }
+            result.diagnostics.push_back(line);
+        }
+        if (glslPath != path) {
+            unlink(glslPath.c_str());
+        }
+        if (status != 0) {
+            result.status = "compile-failed";
+            unlink(spvPath.c_str());
+            return;
+        }
+        if (fragSpirv) {
+            *fragSpirv = readFile(spvPath);
+        }
+
+        if (vertShaderModule != VK_NULL_HANDLE) {
+            auto pipelineStart = std::chrono::steady_clock::now();
+            try {
+                // Reflection also rejects bindings the viewer can't feed
+                std::vector<char> fragShaderCode = readFile(spvPath);
+                spirv_interface::Interface interface = vertexInterface;
+                interface.merge(reflectShader(fragShaderCode, VK_SHADER_STAGE_FRAGMENT_BIT));
+                ShaderLayout layout = layoutFor(interface);
+                VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+
+                VkPipelineShaderStageCreateInfo shaderStages[2] = {};
+                shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+                shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+                shaderStages[0].module = vertShaderModule;
+                shaderStages[0].pName = "main";
+                shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+                shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+                shaderStages[1].module = fragShaderModule;
+                shaderStages[1].pName = "main";
+
+                VkPipeline pipeline;
+                VkResult created = createPipeline({shaderStages[0], shaderStages[1]}, layout.pipelineLayout, &pipeline);
+                if (created == VK_SUCCESS) {
+                    vkDestroyPipeline(device, pipeline, nullptr);
+                } else {
+                    result.status = "pipeline-failed";
+                    result.diagnostics.push_back("vkCreateGraphicsPipelines returned " + std::to_string(created));
+                }
+                vkDestroyShaderModule(device, fragShaderModule, nullptr);
+            } catch (const std::exception& e) {
+                result.status = "pipeline-failed";
+                result.diagnostics.push_back(e.what());
+            }
+            result.pipelineMicros =
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - pipelineStart).count();
+        }
+        unlink(spvPath.c_str());
+    }
+
+    static std::string jsonString(const std::string& text) {
+        std::string quoted = "\"";
+        for (unsigned char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+                quoted += c;
+            } else if (c < 0x20) {
+                char escape[8];
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                quoted += escape;
+            } else {
+                quoted += c;
+            }
+        }
+        return quoted + "\"";
+    }
+
+    static void makeDirectories(const std::string& path) {
+        for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+            mkdir(path.substr(0, slash).c_str(), 0755);
+            if (slash == std::string::npos) {
+                break;
+            }
+        }
+    }
+
+    // "line N: expected … got …" for the first line that differs
+    static std::string firstDifference(const std::string& expected, const std::string& actual) {
+        std::istringstream a(expected), b(actual);
+        std::string lineA, lineB;
+        for (int line = 1; ; line++) {
+            bool moreA = static_cast<bool>(std::getline(a, lineA));
+            bool moreB = static_cast<bool>(std::getline(b, lineB));
+            if (!moreA && !moreB) {
+                return "identical lines, different line endings";
+            }
+            if (!moreA || !moreB || lineA != lineB) {
+                return "line " + std::to_string(line) + ": expected \"" + (moreA ? lineA : "<eof>") +
+                       "\" got \"" + (moreB ? lineB : "<eof>") + "\"";
+            }
+        }
+    }
+
     std::string getCompiledSpvPath(const std::string& shaderPath) {
         std::string baseName = getShaderBaseName(shaderPath);
         std::string shaderDir = getShaderDirectory(shaderPath);
@@ -418,6 +1959,11 @@ private:
             }
         }
 
+        // A trace replays one shader, so switching ends the recording
+        stopRecording();
+        // A background reload reads currentShaderPath, so it must finish before the path changes
+        waitForReload();
+
         // Get the current compiled shader path to avoid duplicates
         std::string currentSpvPath = getCompiledSpvPath(currentShaderPath);
 
@@ -438,29 +1984,42 @@ private:
             std::cout << "\n[" << (currentShaderIndex + 1) << "/" << shaderList.size() << "] "
                       << currentShaderPath << std::endl;
 
-            // Recompile and reload shader
-            if (compileAndLoadShader(currentShaderPath)) {
-                // Wait for device to be idle before recreating pipeline
-                vkDeviceWaitIdle(device);
-
-                try {
-                    recreatePipeline();
-                    std::cout << "✓ Shader loaded" << std::endl;
-                    return; // Success!
-                } catch (const std::exception& e) {
-                    std::cout << "✗ Pipeline error: " << e.what() << std::endl;
-                }
-            } else {
-                std::cout << "✗ Compilation failed, trying next..." << std::endl;
+            if (loadCurrentShader()) {
+                return; // Success!
             }
 
             // Try next shader
+            std::cout << "  trying next..." << std::endl;
             attempts++;
         }
 
         std::cout << "✗ No working shaders found!" << std::endl;
     }
 
+    // Recompile currentShaderPath and swap it in; false (reported) if it doesn't compile or
+    // its pipeline can't be built
+    bool loadCurrentShader() {
+        waitForReload();
+        if (!compileAndLoadShader(currentShaderPath)) {
+            std::cout << "✗ Compilation failed" << std::endl;
+            return false;
+        }
+        // Wait for device to be idle before recreating pipeline
+        vkDeviceWaitIdle(device);
+
+        try {
+            recreatePipeline();
+            reloadChannels();
+            frameCount = 0;
+            watchShaderFiles();
+            std::cout << "✓ Shader loaded" << std::endl;
+            return true;
+        } catch (const std::exception& e) {
+            std::cout << "✗ Pipeline error: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
     std::string getShaderBaseName(const std::string& path) {
         size_t lastSlash = path.find_last_of("/\\");
         size_t lastDot = path.find_last_of(".");
@@ -547,22 +2106,9 @@ private:
         }
 
         // 2. Look for // @texture <path> directive
-        std::istringstream iss(shaderContent);
-        while (std::getline(iss, line)) {
-            size_t pos = line.find("// @texture");
-            if (pos != std::string::npos) {
-                size_t start = line.find_first_not_of(" \t", pos + 11);
-                if (start != std::string::npos) {
-                    size_t end = line.find_last_not_of(" \t\r\n");
-                    std::string texPath = line.substr(start, end - start + 1);
-
-                    // If relative path, resolve relative to shader directory
-                    if (texPath[0] != '/') {
-                        return shaderDir + "/" + texPath;
-                    }
-                    return texPath;
-                }
-            }
+        std::string texPath = findPathDirective(shaderContent, "// @texture", shaderDir);
+        if (!texPath.empty()) {
+            return texPath;
         }
 
         // 3. Fallback: look for galaxy.jpg or galaxy.png in shader directory
@@ -578,6 +2124,117 @@ private:
         return "";
     }
 
+    // Find a "// @name <path>" directive line; relative paths resolve against the shader directory
+    // (pass an empty shaderDir to get the raw argument text)
+    std::string findPathDirective(const std::string& shaderContent, const std::string& directive,
+                                  const std::string& shaderDir) {
+        std::istringstream iss(shaderContent);
+        std::string line;
+        while (std::getline(iss, line)) {
+            size_t pos = line.find(directive);
+            if (pos == std::string::npos) {
+                continue;
+            }
+            size_t start = line.find_first_not_of(" \t", pos + directive.size());
+            if (start == std::string::npos || start == pos + directive.size()) {
+                continue;  // No path, or a longer directive name (e.g. @textures)
+            }
+            size_t end = line.find_last_not_of(" \t\r\n");
+            std::string path = line.substr(start, end - start + 1);
+            return path[0] == '/' || shaderDir.empty() ? path : shaderDir + "/" + path;
+        }
+        return "";
+    }
+
+    // Assign a source to each iChannel. Defaults: iChannel0 = texture, iChannel1 = feedback.
+    //   // @video <path>                  video on iChannel0
+    //   // @audio <path|mic>              sound texture on iChannel0
+    //   // @iChannelN <kind> [path]       any kind (texture, feedback, video, audio, keyboard, cube, volume)
+    // (which decoders actually run is settled by setShaderInterface once the shader is compiled)
+    void parseChannelSources(const std::string& shaderPath) {
+        readChannelDirectives(shaderPath, channelSources);
+    }
+
+    // The directive parsing behind parseChannelSources, into any array (validation workers
+    // each keep their own)
+    void readChannelDirectives(const std::string& shaderPath, ChannelSource* sources) {
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            sources[i] = ChannelSource{};
+        }
+        sources[1].kind = ChannelKind::Feedback;
+
+        std::ifstream file(shaderPath);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        std::string content = buffer.str();
+        std::string shaderDir = getShaderDirectory(shaderPath);
+
+        std::string videoPath = findPathDirective(content, "// @video", shaderDir);
+        if (!videoPath.empty()) {
+            sources[0] = {ChannelKind::Video, videoPath};
+        }
+        // "mic"/"capture" select the default input device and "noise[:N]" a generated volume
+        auto resolveMedia = [&](const std::string& path) {
+            if (path.empty() || path[0] == '/' || path == "mic" || path == "capture" ||
+                channel_images::isNoiseSpec(path)) return path;
+            return shaderDir + "/" + path;
+        };
+        std::string audioPath = findPathDirective(content, "// @audio", "");
+        if (!audioPath.empty()) {
+            sources[0] = {ChannelKind::Audio, resolveMedia(audioPath)};
+        }
+
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            std::string spec = findPathDirective(content, "// @iChannel" + std::to_string(i), "");
+            if (spec.empty()) {
+                continue;
+            }
+            std::istringstream fields(spec);
+            std::string kind, path;
+            fields >> kind >> path;
+            path = resolveMedia(path);
+            if (kind == "texture") {
+                sources[i] = {ChannelKind::Texture, ""};
+            } else if (kind == "feedback") {
+                sources[i] = {ChannelKind::Feedback, ""};
+            } else if (kind == "video") {
+                sources[i] = {ChannelKind::Video, path};
+            } else if (kind == "audio") {
+                sources[i] = {ChannelKind::Audio, path};
+            } else if (kind == "keyboard") {
+                sources[i] = {ChannelKind::Keyboard, ""};
+            } else if (kind == "cube") {
+                sources[i] = {ChannelKind::Cube, path};
+            } else if (kind == "volume") {
+                sources[i] = {ChannelKind::Volume, path};
+            } else {
+                std::cout << "⚠ Unknown channel kind for iChannel" << i << ": " << kind << std::endl;
+            }
+        }
+    }
+
+    // True if one of the first 50 lines (skipping an ISF JSON header) is #version 450
+    static bool isVulkanSource(const std::string& source) {
+        std::istringstream lines(source);
+        std::string line;
+        bool inBlockComment = false;
+        for (int i = 0; i < 50 && std::getline(lines, line); i++) {
+            if (line.find("/*{") != std::string::npos) {
+                inBlockComment = true;
+            }
+            if (inBlockComment) {
+                if (line.find("}*/") != std::string::npos) {
+                    inBlockComment = false;
+                }
+                continue;
+            }
+            if (line.find("#version 450") != std::string::npos) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     bool isVulkanReadyShader(const std::string& path) {
         // Check if file has an extension that indicates it's already in Vulkan format
         const std::vector<std::string> vulkanExts = {".glsl", ".fsh", ".gsh", ".vsh"};
@@ -620,133 +2277,750 @@ private:
         return path; // Fallback to original
     }
 
+    // Everything convert.py prepends: inputs/outputs, the uniform block and iChannel0-3
+    // declared with the sampler type of whatever is bound to them
+    std::string shaderHeader() {
+        return shaderHeader(channelSources);
+    }
+
+    static std::string shaderHeader(const ChannelSource* sources) {
+        std::string header = "#version 450\n\n"
+                             "layout(location = 0) in vec2 fragCoord;\n"
+                             "layout(location = 0) out vec4 fragColor;\n\n" +
+                             uniformBlockGLSL() + "\n";
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            const char* samplerType = "sampler2D";
+            if (sources[i].kind == ChannelKind::Cube) samplerType = "samplerCube";
+            if (sources[i].kind == ChannelKind::Volume) samplerType = "sampler3D";
+            header += "layout(binding = " + std::to_string(1 + i) + ") uniform " + samplerType +
+                      " iChannel" + std::to_string(i) + ";\n";
+        }
+        return header;
+    }
+
+    // Convert ShaderToy / Book of Shaders source to Vulkan GLSL in-process (channel
+    // directives must already be parsed, since they decide the iChannel sampler types)
+    bool convertShaderFile(const std::string& inputPath, const std::string& outputPath) {
+        std::ifstream input(inputPath);
+        if (!input.is_open()) {
+            std::cerr << "✗ Could not read shader: " << inputPath << std::endl;
+            return false;
+        }
+        std::stringstream source;
+        source << input.rdbuf();
+
+        auto start = std::chrono::steady_clock::now();
+        glsl_converter::Result converted = shaderConverter.convert(source.str(), shaderHeader());
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (!converted.ok) {
+            std::cerr << "✗ " << converted.error << " in " << inputPath << std::endl;
+            return false;
+        }
+
+        std::ofstream output(outputPath);
+        output << converted.output;
+        if (!output.good()) {
+            std::cerr << "✗ Could not write: " << outputPath << std::endl;
+            return false;
+        }
+        std::cout << "✓ Converted: " << inputPath << " → " << outputPath << " (" << (int)micros << " µs)" << std::endl;
+        return true;
+    }
+
     bool compileAndLoadShader(const std::string& fragPath) {
         // Convert to absolute path (works when working directory changes)
         std::string absFragPath = getAbsolutePath(fragPath);
 
-        // Parse texture from shader
-        currentTexturePath = parseTextureFromShader(absFragPath);
-        if (!currentTexturePath.empty()) {
-            std::cout << "✓ Texture: " << currentTexturePath << std::endl;
+        // Parse texture from shader
+        currentTexturePath = parseTextureFromShader(absFragPath);
+        if (!currentTexturePath.empty()) {
+            std::cout << "✓ Texture: " << currentTexturePath << std::endl;
+        }
+        parseChannelSources(absFragPath);
+
+        if (!compileFragmentStage(absFragPath)) {
+            return false;
+        }
+        std::vector<shader_params::Param> params;
+        isf_inputs::Block inputs;
+        readTunables(absFragPath, params, inputs);
+        if (absFragPath == shaderParamsPath) {
+            keepParamValues(params, shaderParams);
+            inputs.keepValues(isfInputs);
+        }
+        shaderParams = params;
+        isfInputs = inputs;
+        if (absFragPath != shaderParamsPath) {
+            shaderParamsPath = absFragPath;
+            selectedTunable = 0;
+            loadShaderValues();
+        }
+        readViewDirectives(absFragPath, absFragPath != viewDirectivesPath);
+        viewDirectivesPath = absFragPath;
+        for (const shader_params::Param& param : shaderParams) {
+            std::cout << "✓ Parameter: " << param.name << " = " << param.valueText() << " [" << param.min << ".."
+                      << param.max << "]" << std::endl;
+        }
+        for (const isf_inputs::Input& input : isfInputs.inputs) {
+            std::cout << "✓ ISF input: " << input.name << " = " << input.valueText() << std::endl;
+        }
+        if (!isfInputs.inputs.empty()) {
+            std::cout << "✓ ISF inputs: " << isfInputs.size << " bytes of "
+                      << (isfInputs.pushConstant() ? "push constants" : "uniform block") << std::endl;
+        }
+        updateOverlay();
+
+        std::string baseName = getShaderBaseName(absFragPath);
+        std::string shaderDir = getShaderDirectory(absFragPath);
+
+        // Look for matching vertex shader (.vsh, .vert)
+        std::vector<std::string> vertExts = {".vsh", ".vert"};
+        std::string vertShaderPath = findMatchingShader(baseName, shaderDir, vertExts);
+
+        if (!vertShaderPath.empty()) {
+            // Found matching vertex shader - compile it
+            std::cout << "✓ Found vertex shader: " << vertShaderPath << std::endl;
+            if (!compileStage(vertShaderPath, "vert")) {
+                return false;
+            }
+        }
+
+        // Look for matching geometry shader (.gsh, .geom)
+        std::vector<std::string> geomExts = {".gsh", ".geom"};
+        std::string geomShaderPath = findMatchingShader(baseName, shaderDir, geomExts);
+
+        if (!geomShaderPath.empty()) {
+            // Found matching geometry shader - compile it
+            std::cout << "✓ Found geometry shader: " << geomShaderPath << std::endl;
+            if (!compileStage(geomShaderPath, "geom")) {
+                return false;
+            }
+            hasGeometryShader = true;
+        } else {
+            hasGeometryShader = false;
+        }
+
+        return true;
+    }
+
+    // Convert (if needed) and compile the fragment stage to <base>.frag.spv next to the source.
+    // Channel directives must already be parsed; also used by hot reload on a worker thread.
+    bool compileFragmentStage(const std::string& absFragPath) {
+        std::string baseName = getShaderBaseName(absFragPath);
+        std::string shaderDir = getShaderDirectory(absFragPath);
+
+        // Check if input is already in Vulkan-ready format (.glsl, .fsh, .gsh, .vsh)
+        bool isVulkanReady = isVulkanReadyShader(absFragPath);
+
+        std::string tempFrag;
+        if (isVulkanReady) {
+            // Already in Vulkan format, use it directly
+            tempFrag = absFragPath;
+            std::cout << "✓ Using Vulkan shader: " << tempFrag << std::endl;
+        } else {
+            // Need to convert from .frag to .glsl
+            tempFrag = shaderDir + "/" + baseName + ".glsl";
+
+            // Check if file is already in Vulkan format (has #version 450)
+            std::ifstream checkFile(absFragPath);
+            std::stringstream content;
+            content << checkFile.rdbuf();
+            checkFile.close();
+            bool needsConversion = !isVulkanSource(content.str());
+            if (!needsConversion) {
+                // Already in Vulkan format, just copy it
+                std::string copyCmd = "cp \"" + absFragPath + "\" \"" + tempFrag + "\"";
+                if (system(copyCmd.c_str()) != 0) {
+                    return false;
+                }
+            }
+
+            if (needsConversion && !convertShaderFile(absFragPath, tempFrag)) {
+                std::cerr << "✗ Shader conversion failed for: " << absFragPath << std::endl;
+                return false;
+            }
+        }
+
+        // Output .spv files in the same directory
+        std::string outputFragSpv = shaderDir + "/" + baseName + ".frag.spv";
+
+        // Compile to SPIR-V using wrapper script that adds source line context
+        std::string compileCmd = "/opt/3d/metalshade/glsl_compile.sh \"" + tempFrag + "\" \"" + outputFragSpv + "\"";
+        int result = system(compileCmd.c_str());
+        if (result != 0) {
+            std::cerr << "✗ Shader compilation failed for: " << absFragPath << std::endl;
+            std::cerr << "  GLSL shader: " << tempFrag << std::endl;
+            return false;
+        }
+
+        std::cout << "✓ Compiled: " << outputFragSpv << std::endl;
+        return true;
+    }
+
+    // Compile a vertex or geometry source to <base>.<stage>.spv beside it
+    bool compileStage(const std::string& sourcePath, const std::string& stage) {
+        std::string shaderDir = getShaderDirectory(sourcePath);
+        std::string outputSpv = shaderDir + "/" + getShaderBaseName(sourcePath) + "." + stage + ".spv";
+        std::string compileCmd = "glslangValidator -S " + stage + " -V \"" + sourcePath + "\" -o \"" + outputSpv +
+                                 "\" -I\"" + shaderDir + "\"";
+        if (system(compileCmd.c_str()) != 0) {
+            std::cerr << "✗ " << stage << " shader compilation failed: " << sourcePath << std::endl;
+            return false;
+        }
+        std::cout << "✓ Compiled " << stage << " shader: " << outputSpv << std::endl;
+        return true;
+    }
+
+    // Recursively add the files pulled in by #include "..." / <...> (resolved like
+    // glslangValidator: next to the including file, then in the shader directory)
+    static void collectIncludes(const std::string& path, const std::string& shaderDir, std::set<std::string>& sources) {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t hash = line.find_first_not_of(" \t");
+            if (hash == std::string::npos || line.compare(hash, 8, "#include") != 0) {
+                continue;
+            }
+            size_t open = line.find_first_of("\"<", hash + 8);
+            size_t close = open == std::string::npos ? open : line.find_first_of("\">", open + 1);
+            if (close == std::string::npos) {
+                continue;
+            }
+            std::string name = line.substr(open + 1, close - open - 1);
+            std::string includingDir = path.substr(0, path.find_last_of('/'));
+            for (const std::string& directory : {includingDir, shaderDir}) {
+                std::ifstream candidate(directory + "/" + name);
+                if (!candidate.good()) {
+                    continue;
+                }
+                std::string canonical = FileWatcher::canonical(directory + "/" + name);
+                if (sources.insert(canonical).second) {
+                    collectIncludes(canonical, shaderDir, sources);
+                }
+                break;
+            }
+        }
+    }
+
+    // Point the watcher at everything the current shader was built from
+    void watchShaderFiles() {
+        std::string shaderPath = FileWatcher::canonical(getAbsolutePath(currentShaderPath));
+        std::string baseName = getShaderBaseName(shaderPath);
+        std::string shaderDir = getShaderDirectory(shaderPath);
+
+        fragmentSources = {shaderPath};
+        collectIncludes(shaderPath, shaderDir, fragmentSources);
+        vertexSource = FileWatcher::canonical(findMatchingShader(baseName, shaderDir, {".vsh", ".vert"}));
+        geometrySource = hasGeometryShader ? FileWatcher::canonical(findMatchingShader(baseName, shaderDir, {".gsh", ".geom"})) : "";
+        textureSource = currentTexturePath.empty() ? "" : FileWatcher::canonical(currentTexturePath);
+        channelImageSources.clear();
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            const ChannelSource& source = channelSources[i];
+            if ((source.kind == ChannelKind::Cube || source.kind == ChannelKind::Volume) && !source.path.empty() &&
+                !channel_images::isNoiseSpec(source.path) && !channel_images::isDirectory(source.path)) {
+                channelImageSources.insert(FileWatcher::canonical(source.path));
+            }
+        }
+
+        std::vector<std::string> paths(fragmentSources.begin(), fragmentSources.end());
+        paths.insert(paths.end(), channelImageSources.begin(), channelImageSources.end());
+        for (const std::string& path : {vertexSource, geometrySource, textureSource}) {
+            if (!path.empty()) {
+                paths.push_back(path);
+            }
+        }
+        shaderWatcher.watch(paths);
+    }
+
+    // Once per frame: swap in a finished background rebuild, then start one for whatever
+    // changed on disk since. Only the stages and images that changed are rebuilt.
+    void checkHotReload() {
+        if (reloadThread.joinable()) {
+            if (!reloadFinished) {
+                return;  // Changes keep accumulating in the watcher meanwhile
+            }
+            reloadThread.join();
+            if (reloadedPipeline != VK_NULL_HANDLE) {
+                if (reloadedInterface.layoutHash() == shaderInterface.layoutHash()) {
+                    for (const auto& variant : pipelineVariants) {
+                        retiredPipelines.push_back({variant.second, MAX_FRAMES_IN_FLIGHT});
+                    }
+                    pipelineVariants.clear();
+                    graphicsPipeline = reloadedPipeline;
+                } else {
+                    // Different bindings need new descriptor sets and maybe other channels
+                    vkDeviceWaitIdle(device);
+                    destroyPipelineVariants();
+                    graphicsPipeline = reloadedPipeline;
+                    setShaderInterface(reloadedInterface);
+                    recreateDescriptorSets();
+                    reloadChannels();
+                }
+                reloadedPipeline = VK_NULL_HANDLE;
+                std::vector<uint32_t> built = shader_params::constants(reloadedParams);
+                pipelineVariants[built] = graphicsPipeline;
+                keepParamValues(reloadedParams, shaderParams);  // Adjusted while it compiled
+                reloadedInputs.keepValues(isfInputs);
+                shaderParams = reloadedParams;
+                isfInputs = reloadedInputs;
+                selectedTunable = std::min(selectedTunable, std::max(0, (int)tunables().size() - 1));
+                updateOverlay();
+                std::cout << "✓ Hot-reloaded " << currentShaderPath << std::endl;
+                if (shader_params::constants(shaderParams) != built) {
+                    applyShaderParams();
+                }
+            }
+        }
+
+        std::set<std::string> changed;
+        if (!shaderWatcher.poll(changed)) {
+            return;
+        }
+
+        std::string shaderPath = FileWatcher::canonical(getAbsolutePath(currentShaderPath));
+        if (changed.count(shaderPath)) {
+            // Directives decide channel kinds and sampler types; if they changed, reload everything
+            ChannelSource sources[CHANNEL_COUNT];
+            readChannelDirectives(shaderPath, sources);
+            bool sameChannels = parseTextureFromShader(shaderPath) == currentTexturePath;
+            for (int i = 0; i < CHANNEL_COUNT; i++) {
+                sameChannels = sameChannels && sources[i].kind == channelSources[i].kind &&
+                               sources[i].path == channelSources[i].path;
+            }
+            if (!sameChannels) {
+                std::cout << "✓ Channel directives changed, reloading " << currentShaderPath << std::endl;
+                reloadShader();
+                return;
+            }
+        }
+
+        bool fragment = false, vertex = false, geometry = false, texture = false, images = false;
+        for (const std::string& path : changed) {
+            fragment = fragment || fragmentSources.count(path);
+            vertex = vertex || path == vertexSource;
+            geometry = geometry || path == geometrySource;
+            texture = texture || path == textureSource;
+            images = images || channelImageSources.count(path);
+        }
+        if (texture) {
+            reloadTexture();
+        }
+        if (images) {
+            reloadImageChannels();
+        }
+        if (fragment) {
+            watchShaderFiles();  // #includes may have been added or removed
+        }
+        if (fragment || vertex || geometry) {
+            startReload(fragment, vertex, geometry);
+        }
+    }
+
+    void startReload(bool fragment, bool vertex, bool geometry) {
+        std::string shaderPath = getAbsolutePath(currentShaderPath);
+        std::vector<shader_params::Param> currentParams = shaderParams;
+        isf_inputs::Block currentInputs = isfInputs;
+        reloadFinished = false;
+        reloadThread = std::thread([this, shaderPath, currentParams, currentInputs, fragment, vertex, geometry] {
+            bool compiled = (!fragment || compileFragmentStage(shaderPath)) &&
+                            (!vertex || compileStage(vertexSource, "vert")) &&
+                            (!geometry || compileStage(geometrySource, "geom"));
+            if (compiled) {
+                reloadedParams = currentParams;
+                reloadedInputs = currentInputs;
+                if (fragment) {
+                    readTunables(shaderPath, reloadedParams, reloadedInputs);
+                    keepParamValues(reloadedParams, currentParams);
+                    reloadedInputs.keepValues(currentInputs);
+                }
+                try {
+                    reloadedPipeline =
+                        createShaderPipeline(reloadedInterface, shader_params::constants(reloadedParams));
+                } catch (const std::exception& e) {
+                    std::cout << "✗ Pipeline error: " << e.what() << std::endl;
+                }
+            } else {
+                std::cout << "✗ Hot reload failed, keeping the running shader" << std::endl;
+            }
+            reloadFinished = true;
+        });
+    }
+
+    // Finish (and discard) any background rebuild, e.g. before switching shaders
+    void waitForReload() {
+        if (reloadThread.joinable()) {
+            reloadThread.join();
+        }
+        if (reloadedPipeline != VK_NULL_HANDLE) {
+            destroyShaderPipeline(reloadedPipeline);
+            reloadedPipeline = VK_NULL_HANDLE;
+        }
+    }
+
+    // After the fence wait in drawFrame: destroy pipelines no frame in flight still uses
+    void releaseRetiredPipelines() {
+        for (size_t i = 0; i < retiredPipelines.size();) {
+            if (--retiredPipelines[i].second > 0) {
+                i++;
+                continue;
+            }
+            destroyShaderPipeline(retiredPipelines[i].first);
+            retiredPipelines.erase(retiredPipelines.begin() + i);
+        }
+    }
+
+    // The @param annotations and ISF inputs a shader declares (defaults)
+    static void readTunables(const std::string& path, std::vector<shader_params::Param>& params,
+                             isf_inputs::Block& inputs) {
+        std::ifstream file(path);
+        std::stringstream source;
+        source << file.rdbuf();
+        params = shader_params::parse(source.str());
+        inputs = isf_inputs::parse(source.str());
+    }
+
+    // // @precision df64, // @pancoherent, and for a new shader its // @deepzoom centre as the
+    // view (reloads of the same shader keep it)
+    void readViewDirectives(const std::string& path, bool newShader) {
+        std::ifstream file(path);
+        std::stringstream source;
+        source << file.rdbuf();
+        precisionDf64 = df64::requested(source.str());
+        panCoherent = source.str().find("// @pancoherent") != std::string::npos;
+        deep_zoom::BigFloat x, y;
+        if (newShader && deep_zoom::parseDirective(source.str(), x, y)) {
+            deepZoom.stop();
+            deepZoom.setHome(x, y);
+            deepZoomPan[0] = deepZoomPan[1] = 0.0;
+        }
+    }
+
+    // Carry values the user set over to re-read parameters of the same name and type
+    static void keepParamValues(std::vector<shader_params::Param>& params,
+                                const std::vector<shader_params::Param>& previous) {
+        for (shader_params::Param& param : params) {
+            for (const shader_params::Param& old : previous) {
+                if (old.name == param.name && old.type == param.type) {
+                    param.value = std::min(param.max, std::max(param.min, old.value));
+                }
+            }
+        }
+    }
+
+    std::vector<Tunable> tunables() const {
+        std::vector<Tunable> stops;
+        for (size_t i = 0; i < shaderParams.size(); i++) {
+            stops.push_back({(int)i, -1, 0});
+        }
+        for (size_t i = 0; i < isfInputs.inputs.size(); i++) {
+            for (int c = 0; c < isfInputs.inputs[i].components(); c++) {
+                stops.push_back({-1, (int)i, c});
+            }
+        }
+        return stops;
+    }
+
+    void selectTunable(int direction) {
+        std::vector<Tunable> stops = tunables();
+        if (stops.empty()) {
+            return;
+        }
+        selectedTunable = (selectedTunable + direction + (int)stops.size()) % stops.size();
+        std::cout << "✓ Selected " << tunableText(stops[selectedTunable]) << std::endl;
+        updateOverlay();
+    }
+
+    void adjustTunable(int direction) {
+        std::vector<Tunable> stops = tunables();
+        if (stops.empty()) {
+            return;
+        }
+        const Tunable& stop = stops[std::min(selectedTunable, (int)stops.size() - 1)];
+        if (stop.param >= 0) {
+            shader_params::Param& param = shaderParams[stop.param];
+            double previous = param.value;
+            param.adjust(direction);
+            if (param.value == previous) {
+                return;
+            }
+            applyShaderParams();
+        } else {
+            // Picked up by the next frame's push constants; no pipeline or descriptor work
+            isf_inputs::Input& input = isfInputs.inputs[stop.input];
+            input.adjust(stop.component, direction);
+            std::cout << "✓ " << tunableText(stop) << std::endl;
+        }
+        saveShaderValues();
+        updateOverlay();
+    }
+
+    // "ITER = 128" / "tint.g = (1.00 0.62 0.20 1.00)"
+    std::string tunableText(const Tunable& stop) const {
+        if (stop.param >= 0) {
+            return shaderParams[stop.param].name + " = " + shaderParams[stop.param].valueText();
+        }
+        const isf_inputs::Input& input = isfInputs.inputs[stop.input];
+        std::string name = input.name;
+        if (input.components() > 1) {
+            name += std::string(".") + "xyzw"[stop.component];
+            if (input.type == isf_inputs::Type::Color) name.back() = "rgba"[stop.component];
+        }
+        return name + " = " + input.valueText();
+    }
+
+    // The point2D Shift+drag moves: the selected input if it is one, else the first
+    int pointInputToDrag() const {
+        std::vector<Tunable> stops = tunables();
+        if (selectedTunable < (int)stops.size() && stops[selectedTunable].input >= 0 &&
+            isfInputs.inputs[stops[selectedTunable].input].type == isf_inputs::Type::Point2D) {
+            return stops[selectedTunable].input;
         }
+        for (size_t i = 0; i < isfInputs.inputs.size(); i++) {
+            if (isfInputs.inputs[i].type == isf_inputs::Type::Point2D) return (int)i;
+        }
+        return -1;
+    }
 
-        // Get shader base name and directory
-        std::string baseName = getShaderBaseName(absFragPath);
-        std::string shaderDir = getShaderDirectory(absFragPath);
+    // Cursor → framebuffer pixels, origin bottom-left like gl_FragCoord in ISF
+    void dragPointInput() {
+        isf_inputs::Input& input = isfInputs.inputs[draggedPoint];
+        float x = static_cast<float>(mouseX / cachedWindowWidth * swapchainExtent.width);
+        float y = static_cast<float>((1.0 - mouseY / cachedWindowHeight) * swapchainExtent.height);
+        input.value[0] = input.ranged ? std::min(input.max[0], std::max(input.min[0], x)) : x;
+        input.value[1] = input.ranged ? std::min(input.max[1], std::max(input.min[1], y)) : y;
+        updateOverlay();
+    }
 
-        // Check if input is already in Vulkan-ready format (.glsl, .fsh, .gsh, .vsh)
-        bool isVulkanReady = isVulkanReadyShader(fragPath);
+    // Values of the current shader's tunables live beside it in <base>.params
+    std::string shaderValuesPath() {
+        return getShaderDirectory(shaderParamsPath) + "/" + getShaderBaseName(shaderParamsPath) + ".params";
+    }
 
-        std::string tempFrag;
-        if (isVulkanReady) {
-            // Already in Vulkan format, use it directly
-            tempFrag = absFragPath;
-            std::cout << "✓ Using Vulkan shader: " << tempFrag << std::endl;
-        } else {
-            // Need to convert from .frag to .glsl
-            tempFrag = shaderDir + "/" + baseName + ".glsl";
+    void loadShaderValues() {
+        std::ifstream file(shaderValuesPath());
+        readShaderValues(file);
+    }
 
-            // Check if file is already in Vulkan format (has #version 450)
-            std::ifstream checkFile(absFragPath);
-            std::string line;
-            bool needsConversion = true;
-            bool inBlockComment = false;
-
-            // Read first 50 lines to find #version, skipping ISF/comment blocks
-            for (int i = 0; i < 50 && checkFile.is_open() && std::getline(checkFile, line); i++) {
-                // Skip ISF JSON header
-                if (line.find("/*{") != std::string::npos) {
-                    inBlockComment = true;
-                }
-                if (inBlockComment) {
-                    if (line.find("}*/") != std::string::npos) {
-                        inBlockComment = false;
-                    }
-                    continue;
+    // "name value" lines (@params) and "name v0 v1 ..." lines (ISF inputs)
+    void readShaderValues(std::istream& file) {
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string name;
+            if (!(fields >> name) || name[0] == '#') {
+                continue;
+            }
+            for (shader_params::Param& param : shaderParams) {
+                double value;
+                if (param.name == name && fields >> value) {
+                    param.value = std::min(param.max, std::max(param.min, value));
                 }
-
-                // Check for #version 450
-                if (line.find("#version 450") != std::string::npos) {
-                    // Already in Vulkan format, just copy it
-                    needsConversion = false;
-                    std::string copyCmd = "cp \"" + absFragPath + "\" \"" + tempFrag + "\"";
-                    if (system(copyCmd.c_str()) != 0) {
-                        return false;
-                    }
-                    break;
+            }
+            for (isf_inputs::Input& input : isfInputs.inputs) {
+                float value;
+                for (int c = 0; input.name == name && c < input.components() && fields >> value; c++) {
+                    input.value[c] = value;
                 }
             }
-            checkFile.close();
+        }
+    }
 
-            if (needsConversion) {
-                // Use absolute path to converter script (works regardless of working directory)
-                std::string convertCmd = "python3 /opt/3d/metalshade/convert.py \"" + absFragPath + "\" \"" + tempFrag + "\"";
-                int result = system(convertCmd.c_str());
-                if (result != 0) {
-                    std::cerr << "✗ Shader conversion failed for: " << fragPath << std::endl;
-                    return false;
-                }
+    void saveShaderValues() {
+        if ((shaderParams.empty() && isfInputs.inputs.empty()) || replaying) {
+            return;
+        }
+        std::ofstream file(shaderValuesPath());
+        file << "# metalshade values for " << getShaderBaseName(shaderParamsPath) << std::endl;
+        writeShaderValues(file);
+    }
+
+    void writeShaderValues(std::ostream& file) {
+        for (const shader_params::Param& param : shaderParams) {
+            file << param.name << " " << param.value << std::endl;
+        }
+        for (const isf_inputs::Input& input : isfInputs.inputs) {
+            file << input.name;
+            for (int c = 0; c < input.components(); c++) {
+                file << " " << input.value[c];
             }
+            file << std::endl;
         }
+    }
 
-        // Output .spv files in the same directory
-        std::string outputFragSpv = shaderDir + "/" + baseName + ".frag.spv";
-        std::string outputVertSpv = shaderDir + "/" + baseName + ".vert.spv";
+    // The window title doubles as the tunables panel: every value, the selected one marked
+    void updateOverlay() {
+        if (!window) {
+            return;
+        }
+        std::string title = "Metalshade - " + getShaderBaseName(currentShaderPath);
+        std::vector<Tunable> stops = tunables();
+        const Tunable* selected = selectedTunable < (int)stops.size() ? &stops[selectedTunable] : nullptr;
+        std::string separator = "  |  ";
+        for (size_t i = 0; i < shaderParams.size(); i++) {
+            bool current = selected && selected->param == (int)i;
+            title += separator + (current ? "▸" : "") + tunableText({(int)i, -1, 0});
+            separator = "  ";
+        }
+        for (size_t i = 0; i < isfInputs.inputs.size(); i++) {
+            bool current = selected && selected->input == (int)i;
+            title += separator + (current ? "▸" + tunableText(*selected)
+                                          : isfInputs.inputs[i].name + " = " + isfInputs.inputs[i].valueText());
+            separator = "  ";
+        }
+        glfwSetWindowTitle(window, title.c_str());
+    }
 
-        // Compile to SPIR-V using wrapper script that adds source line context
-        std::string compileCmd = "/opt/3d/metalshade/glsl_compile.sh \"" + tempFrag + "\" \"" + outputFragSpv + "\"";
-        int result = system(compileCmd.c_str());
-        if (result != 0) {
-            std::cerr << "✗ Shader compilation failed for: " << fragPath << std::endl;
-            std::cerr << "  GLSL shader: " << tempFrag << std::endl;
-            return false;
+    // Switch to the pipeline variant for the current parameter values, building it from the
+    // compiled SPIR-V if it's new. A running hot reload picks the values up when it finishes.
+    void applyShaderParams() {
+        std::string values;
+        for (const shader_params::Param& param : shaderParams) {
+            values += (values.empty() ? "" : ", ") + param.name + " = " + param.valueText();
+        }
+        if (reloadThread.joinable()) {
+            std::cout << "✓ " << values << " (after the reload)" << std::endl;
+            return;
+        }
+        std::vector<uint32_t> constants = shader_params::constants(shaderParams);
+        auto variant = pipelineVariants.find(constants);
+        if (variant != pipelineVariants.end()) {
+            graphicsPipeline = variant->second;
+            std::cout << "✓ " << values << " (cached)" << std::endl;
+            return;
         }
 
-        std::cout << "✓ Compiled: " << outputFragSpv << std::endl;
+        auto start = std::chrono::steady_clock::now();
+        spirv_interface::Interface interface;
+        VkPipeline pipeline;
+        try {
+            pipeline = createShaderPipeline(interface, constants);
+        } catch (const std::exception& e) {
+            std::cout << "✗ Pipeline error: " << e.what() << std::endl;
+            return;
+        }
+        if (interface.layoutHash() != shaderInterface.layoutHash()) {
+            // The .spv on disk is no longer the running shader's (a reload failed part way)
+            destroyShaderPipeline(pipeline);
+            std::cout << "✗ Compiled shader changed on disk; save it again to rebuild" << std::endl;
+            return;
+        }
+        double millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        pipelineVariants[constants] = pipeline;
+        graphicsPipeline = pipeline;
+        std::cout << "✓ " << values << " (pipeline built in " << std::round(millis * 10) / 10 << " ms)" << std::endl;
+    }
 
-        // Look for matching vertex shader (.vsh, .vert)
-        std::vector<std::string> vertExts = {".vsh", ".vert"};
-        std::string vertShaderPath = findMatchingShader(baseName, shaderDir, vertExts);
+    // Every variant of the current shader, including graphicsPipeline (device must be idle)
+    void destroyPipelineVariants() {
+        for (const auto& variant : pipelineVariants) {
+            destroyShaderPipeline(variant.second);
+        }
+        pipelineVariants.clear();
+    }
 
-        if (!vertShaderPath.empty()) {
-            // Found matching vertex shader - compile it
-            std::cout << "✓ Found vertex shader: " << vertShaderPath << std::endl;
-            std::string compileVertCmd = "glslangValidator -S vert -V \"" + vertShaderPath + "\" -o \"" + outputVertSpv + "\" -I\"" + shaderDir + "\"";
-            if (system(compileVertCmd.c_str()) != 0) {
-                std::cerr << "✗ Vertex shader compilation failed" << std::endl;
-                return false;
-            }
-            std::cout << "✓ Compiled vertex shader: " << outputVertSpv << std::endl;
+    // A pipeline from createShaderPipeline, with its // @recolor pass 0 pipeline if it has one
+    void destroyShaderPipeline(VkPipeline pipeline) {
+        VkPipeline iteration = iterationPipelineFor(pipeline);
+        if (iteration != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, iteration, nullptr);
+            std::lock_guard<std::mutex> lock(iterationPipelinesMutex);
+            iterationPipelines.erase(pipeline);
+        }
+        {
+            std::lock_guard<std::mutex> lock(uniformUsesMutex);
+            uniformUses.erase(pipeline);
         }
+        vkDestroyPipeline(device, pipeline, nullptr);
+    }
 
-        // Look for matching geometry shader (.gsh, .geom)
-        std::vector<std::string> geomExts = {".gsh", ".geom"};
-        std::string geomShaderPath = findMatchingShader(baseName, shaderDir, geomExts);
+    UniformUse uniformUseOf(VkPipeline pipeline) const {
+        std::lock_guard<std::mutex> lock(uniformUsesMutex);
+        auto use = uniformUses.find(pipeline);
+        return use != uniformUses.end() ? use->second : UniformUse();
+    }
 
-        if (!geomShaderPath.empty()) {
-            // Found matching geometry shader - compile it
-            std::cout << "✓ Found geometry shader: " << geomShaderPath << std::endl;
-            std::string outputGeomSpv = shaderDir + "/" + baseName + ".geom.spv";
-            std::string compileGeomCmd = "glslangValidator -S geom -V \"" + geomShaderPath + "\" -o \"" + outputGeomSpv + "\" -I\"" + shaderDir + "\"";
-            if (system(compileGeomCmd.c_str()) != 0) {
-                std::cerr << "✗ Geometry shader compilation failed" << std::endl;
-                return false;
+    // Add what one stage reads to use; a module that can't be analysed counts as reading the
+    // clock (no reuse) but not the tile origin (the viewport places its tiles)
+    static void addUniformUse(const std::vector<char>& code, UniformUse& use) {
+        std::vector<uint32_t> words(code.size() / 4);
+        memcpy(words.data(), code.data(), words.size() * 4);
+        spirv_analysis::Report report;
+        std::string error;
+        if (!spirv_analysis::analyze(words.data(), words.size(), report, error)) {
+            use.clock = true;
+            return;
+        }
+        for (const std::string& member : report.uniforms) {
+            if (member == "iTime" || member == "iTimeDelta" || member == "iFrame" || member == "iDate") {
+                use.clock = true;
+            } else if (member == "iTileOrigin") {
+                use.tileOrigin = true;
             }
-            std::cout << "✓ Compiled geometry shader: " << outputGeomSpv << std::endl;
-            hasGeometryShader = true;
-        } else {
-            hasGeometryShader = false;
         }
+    }
 
-        return true;
+    VkPipeline iterationPipelineFor(VkPipeline pipeline) {
+        std::lock_guard<std::mutex> lock(iterationPipelinesMutex);
+        auto iteration = iterationPipelines.find(pipeline);
+        return iteration != iterationPipelines.end() ? iteration->second : VK_NULL_HANDLE;
     }
 
-    void recreatePipeline() {
-        // Destroy old pipeline
-        vkDestroyPipeline(device, graphicsPipeline, nullptr);
+    // Full rebuild of the current shader in place (its channel setup changed)
+    void reloadShader() {
+        waitForReload();
+        if (!compileAndLoadShader(currentShaderPath)) {
+            std::cout << "✗ Hot reload failed, keeping the running shader" << std::endl;
+            return;
+        }
+        vkDeviceWaitIdle(device);
+        try {
+            recreatePipeline();
+            reloadChannels();
+            reloadTexture();
+            frameCount = 0;
+        } catch (const std::exception& e) {
+            std::cout << "✗ Pipeline error: " << e.what() << std::endl;
+        }
+        watchShaderFiles();
+    }
 
-        // Recreate with new shader
-        createGraphicsPipeline();
+    // Re-read the // @texture image (descriptors are rewritten, so the device must be idle)
+    void reloadTexture() {
+        vkDeviceWaitIdle(device);
+        vkDestroyImageView(device, textureImageView, nullptr);
+        vkDestroyImage(device, textureImage, nullptr);
+        vkFreeMemory(device, textureImageMemory, nullptr);
+        createTextureImage();
+        createTextureImageView();
+        for (size_t i = 0; i < descriptorSets.size(); i++) {
+            writeChannelDescriptors(descriptorSets[i]);
+        }
+        std::cout << "✓ Reloaded texture: " << currentTexturePath << std::endl;
+    }
+
+    void reloadImageChannels() {
+        vkDeviceWaitIdle(device);
+        destroyImageChannels();
+        createImageChannels();
+        for (size_t i = 0; i < descriptorSets.size(); i++) {
+            writeChannelDescriptors(descriptorSets[i]);
+        }
+    }
+
+    void recreatePipeline() {
+        // Destroy the old shader's pipelines (the device is idle)
+        destroyPipelineVariants();
+
+        // Recreate with new shader; new descriptor sets only if its bindings differ
+        VkDescriptorSetLayout previousLayout = descriptorSetLayout;
+        spirv_interface::Interface interface;
+        std::vector<uint32_t> constants = shader_params::constants(shaderParams);
+        graphicsPipeline = createShaderPipeline(interface, constants);
+        pipelineVariants[constants] = graphicsPipeline;
+        setShaderInterface(interface);
+        if (descriptorSetLayout != previousLayout) {
+            recreateDescriptorSets();
+        }
     }
 
     void initWindow() {
@@ -774,6 +3048,7 @@ private:
 
         std::cout << "✓ GLFW window created" << std::endl;
         startTime = std::chrono::steady_clock::now();
+        mouseSmoother.reset(WIDTH / 2.0, HEIGHT / 2.0, steadySeconds());
     }
 
     void initVulkan() {
@@ -781,17 +3056,298 @@ private:
         createSurface();
         pickPhysicalDevice();
         createLogicalDevice();
+        createPipelineCache();
         createSwapchain();
         createImageViews();
         createRenderPass();
-        createDescriptorSetLayout();
         createGraphicsPipeline();
         createFramebuffers();
+        createShaderResources();
+        if (servePort != 0) {
+            createStreamBuffers();
+        }
+    }
+
+    void createStreamBuffers() {
+        VkDeviceSize size = static_cast<VkDeviceSize>(swapchainExtent.width) * swapchainExtent.height * 4;
+        for (int i = 0; i < STREAM_SLOTS; i++) {
+            createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, streamBuffers[i],
+                         streamMemories[i]);
+            vkMapMemory(device, streamMemories[i], 0, size, 0, &streamMapped[i]);
+            streamBusy[i] = false;
+        }
+        std::fill(streamPending, streamPending + MAX_FRAMES_IN_FLIGHT, -1);
+        std::string error;
+        if (!frameServer.start(servePort, 85, error)) {
+            throw std::runtime_error("Failed to start the stream server: " + error);
+        }
+        std::cout << "✓ Streaming on http://127.0.0.1:" << servePort << "/ (MJPEG at /stream, WebSocket at / and /raw)"
+                  << std::endl;
+    }
+
+    // --serve: copy this frame (the feedback image, in TRANSFER_SRC layout for the blit) to a
+    // free stream buffer; collectStreamFrame() passes it on once the frame's fence signals
+    void recordStreamCopy(VkCommandBuffer commandBuffer, VkImage image) {
+        if (servePort == 0 || !frameServer.hasClients()) {
+            return;
+        }
+        int slot = 0;
+        while (slot < STREAM_SLOTS && streamBusy[slot].load(std::memory_order_acquire)) {
+            slot++;
+        }
+        if (slot == STREAM_SLOTS) {
+            return;  // The encoders are behind: this frame isn't streamed
+        }
+        streamBusy[slot].store(true, std::memory_order_relaxed);
+        streamPending[currentFrame] = slot;
+        recordHostCopy(commandBuffer, image, streamBuffers[slot]);
+    }
+
+    // Copy the framebuffer-sized image (in TRANSFER_SRC layout) to a host-visible buffer
+    void recordHostCopy(VkCommandBuffer commandBuffer, VkImage image, VkBuffer buffer) {
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {swapchainExtent.width, swapchainExtent.height, 1};
+        vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region);
+
+        VkBufferMemoryBarrier toHost{};
+        toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.buffer = buffer;
+        toHost.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr,
+                             1, &toHost, 0, nullptr);
+    }
+
+    // --serve: the frame that last used this frame-in-flight slot is done (its fence was just
+    // waited for), so its copy can go to the encoders
+    void collectStreamFrame() {
+        if (servePort == 0 || streamPending[currentFrame] < 0) {
+            return;
+        }
+        int slot = streamPending[currentFrame];
+        streamPending[currentFrame] = -1;
+        frameServer.submit(static_cast<const uint8_t*>(streamMapped[slot]), swapchainExtent.width,
+                           swapchainExtent.height, streamSequence++, &streamBusy[slot]);
+    }
+
+    void startControlServer() {
+        std::string error;
+        if (!controlServer.start(controlAddress, error)) {
+            throw std::runtime_error("Failed to start the control server: " + error);
+        }
+        bool tcp = controlAddress.find_first_not_of("0123456789") == std::string::npos;
+        std::cout << "✓ Control commands on " << (tcp ? "127.0.0.1:" : "") << controlAddress
+                  << " (one JSON object per line)" << std::endl;
+    }
+
+    // --control: run every command that arrived since the last frame, on the render thread
+    // like a key press would
+    void runControlCommands() {
+        control_server::Command command;
+        while (controlServer.pop(command)) {
+            runControlCommand(command);
+        }
+    }
+
+    void runControlCommand(const control_server::Command& command) {
+        const std::string& cmd = command.cmd;
+        double value = command.values.empty() ? 0.0 : command.values[0];
+        if (cmd == "load") {
+            std::string previous = currentShaderPath;
+            stopRecording();
+            waitForReload();  // The reload thread reads currentShaderPath
+            currentShaderPath = resolveFragmentShader(command.name);
+            std::cout << "\n[control] " << currentShaderPath << std::endl;
+            if (!fileExists(currentShaderPath) || !loadCurrentShader()) {
+                currentShaderPath = previous;  // The old shader is still running
+                controlServer.reply(command, "\"ok\": false, \"error\": " +
+                                                 jsonString("could not load " + command.name));
+                return;
+            }
+            auto listed = std::find(shaderList.begin(), shaderList.end(), currentShaderPath);
+            if (listed != shaderList.end()) {
+                currentShaderIndex = static_cast<int>(listed - shaderList.begin());
+            }
+            updateOverlay();
+            controlServer.reply(command, "\"ok\": true, \"shader\": " + jsonString(currentShaderPath));
+        } else if (cmd == "next" || cmd == "prev") {
+            switchShader(cmd == "next" ? 1 : -1);
+            updateOverlay();
+            controlServer.reply(command, "\"ok\": true, \"shader\": " + jsonString(currentShaderPath));
+        } else if (cmd == "set") {
+            std::string error = setTunable(command.name, command.values);
+            controlServer.reply(command, error.empty() ? "\"ok\": true" : "\"ok\": false, \"error\": " + jsonString(error));
+        } else if (cmd == "time") {
+            if (command.values.empty()) {
+                controlServer.reply(command, "\"ok\": false, \"error\": \"time needs a value\"");
+                return;
+            }
+            if (paused) {
+                timeOverride = std::max(0.0, value);
+            } else {
+                timeShift += value - clockSeconds();
+            }
+            controlServer.reply(command, "\"ok\": true");
+        } else if (cmd == "pause") {
+            bool pause = command.values.empty() ? !paused : value != 0.0;
+            if (pause && !paused) {
+                timeOverride = currentTime;
+            } else if (!pause && paused) {
+                timeShift += timeOverride - clockSeconds();  // Carry on from the held time
+                timeOverride = -1.0;
+            }
+            paused = pause;
+            controlServer.reply(command, std::string("\"ok\": true, \"paused\": ") + (paused ? "true" : "false"));
+        } else if (cmd == "screenshot") {
+            if (screenshotRequested || screenshotFrame >= 0) {
+                controlServer.reply(command, "\"ok\": false, \"error\": \"a screenshot is already pending\"");
+                return;
+            }
+            screenshotCommand = command;
+            if (screenshotCommand.name.empty()) {
+                screenshotCommand.name = getShaderBaseName(currentShaderPath) + ".png";
+            }
+            screenshotRequested = true;
+        } else if (cmd == "stats") {
+            controlServer.reply(command, controlStats());
+        } else {
+            controlServer.reply(command, "\"ok\": false, \"error\": " + jsonString("unknown command " + cmd));
+        }
+    }
+
+    // An @param or ISF input by name (ints round, ranges clamp, vectors take one number each);
+    // the error if there isn't one
+    std::string setTunable(const std::string& name, const std::vector<double>& values) {
+        if (values.empty()) {
+            return "set needs a value";
+        }
+        for (shader_params::Param& param : shaderParams) {
+            if (param.name == name) {
+                double value = param.type == shader_params::Type::Int ? std::round(values[0]) : values[0];
+                param.value = std::min(param.max, std::max(param.min, value));
+                applyShaderParams();
+                saveShaderValues();
+                updateOverlay();
+                return "";
+            }
+        }
+        for (isf_inputs::Input& input : isfInputs.inputs) {
+            if (input.name == name) {
+                for (int c = 0; c < input.components() && c < (int)values.size(); c++) {
+                    float value = static_cast<float>(values[c]);
+                    input.value[c] = input.ranged ? std::min(input.max[c], std::max(input.min[c], value)) : value;
+                }
+                std::cout << "✓ " << input.name << " = " << input.valueText() << std::endl;
+                saveShaderValues();
+                updateOverlay();
+                return "";
+            }
+        }
+        return "no parameter " + name + " in " + getShaderBaseName(currentShaderPath);
+    }
+
+    // The "stats" reply: what is running, how fast, and every tunable's value
+    std::string controlStats() const {
+        char numbers[160];
+        snprintf(numbers, sizeof(numbers),
+                 "\"frame\": %d, \"time\": %.4f, \"fps\": %.1f, \"paused\": %s, \"width\": %u, \"height\": %u",
+                 frameCount, currentTime, fixedTimeStep > 0.0 ? 1.0 / fixedTimeStep : frameRate,
+                 paused ? "true" : "false", swapchainExtent.width, swapchainExtent.height);
+        std::string stats = "\"ok\": true, \"shader\": " + jsonString(currentShaderPath) + ", " + numbers;
+        if (servePort != 0) {
+            stats += ", \"streamed\": " + std::to_string(frameServer.framesSent());
+        }
+        stats += ", \"params\": {";
+        std::string separator;
+        for (const shader_params::Param& param : shaderParams) {
+            char number[32];
+            snprintf(number, sizeof(number), "%.9g", param.value);
+            stats += separator + jsonString(param.name) + ": " + number;
+            separator = ", ";
+        }
+        for (const isf_inputs::Input& input : isfInputs.inputs) {
+            stats += separator + jsonString(input.name) + ": ";
+            for (int c = 0; c < input.components(); c++) {
+                char number[32];
+                snprintf(number, sizeof(number), "%.9g", input.value[c]);
+                stats += (c ? ", " : input.components() > 1 ? "[" : "") + std::string(number);
+            }
+            stats += input.components() > 1 ? "]" : "";
+            separator = ", ";
+        }
+        return stats + "}";
+    }
+
+    // --control "screenshot": copy this frame out too (the buffer follows the framebuffer size)
+    void recordScreenshotCopy(VkCommandBuffer commandBuffer, VkImage image) {
+        if (!screenshotRequested) {
+            return;
+        }
+        if (screenshotExtent.width != swapchainExtent.width || screenshotExtent.height != swapchainExtent.height) {
+            destroyScreenshotBuffer();  // No copy is pending, so nothing uses it
+            VkDeviceSize size = static_cast<VkDeviceSize>(swapchainExtent.width) * swapchainExtent.height * 4;
+            createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, screenshotBuffer,
+                         screenshotMemory);
+            vkMapMemory(device, screenshotMemory, 0, size, 0, &screenshotMapped);
+            screenshotExtent = swapchainExtent;
+        }
+        recordHostCopy(commandBuffer, image, screenshotBuffer);
+        screenshotRequested = false;
+        screenshotFrame = currentFrame;
+    }
+
+    // The screenshot's frame is done: write it (opaque, as the window shows it) and answer
+    void collectScreenshot() {
+        if (screenshotFrame != (int)currentFrame) {
+            return;
+        }
+        screenshotFrame = -1;
+        std::vector<uint8_t> pixels(static_cast<const uint8_t*>(screenshotMapped),
+                                    static_cast<const uint8_t*>(screenshotMapped) +
+                                        static_cast<size_t>(screenshotExtent.width) * screenshotExtent.height * 4);
+        for (size_t i = 3; i < pixels.size(); i += 4) {
+            pixels[i] = 255;
+        }
+        const std::string& path = screenshotCommand.name;
+        if (!writePng(path, pixels.data(), screenshotExtent.width, screenshotExtent.height)) {
+            std::cout << "✗ Could not write " << path << std::endl;
+            controlServer.reply(screenshotCommand, "\"ok\": false, \"error\": " + jsonString("cannot write " + path));
+            return;
+        }
+        std::cout << "✓ Screenshot " << path << std::endl;
+        controlServer.reply(screenshotCommand, "\"ok\": true, \"path\": " + jsonString(path) +
+                                                   ", \"width\": " + std::to_string(screenshotExtent.width) +
+                                                   ", \"height\": " + std::to_string(screenshotExtent.height));
+    }
+
+    void destroyScreenshotBuffer() {
+        if (screenshotBuffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, screenshotBuffer, nullptr);
+            vkFreeMemory(device, screenshotMemory, nullptr);
+            screenshotBuffer = VK_NULL_HANDLE;
+            screenshotExtent = {0, 0};
+        }
+    }
+
+    // Everything a frame of the shader needs besides the swapchain (also used offscreen)
+    void createShaderResources() {
         createCommandPool();
         createTextureImage();
         createTextureImageView();
         createTextureSampler();
+        createVideoChannel();
+        createAudioChannel();
+        createKeyboardChannel();
+        createImageChannels();
         createFeedbackBuffers();
+        createIterationBuffer();
         createUniformBuffer();
         createDescriptorPool();
         createDescriptorSets();
@@ -799,7 +3355,170 @@ private:
         createSyncObjects();
     }
 
-    void createInstance() {
+    // Instance, device and render pass without a window, for offline work (--validate).
+    // The render pass matches the RGBA feedback buffers offscreen frames are drawn into.
+    void initHeadlessVulkan(uint32_t width = WIDTH, uint32_t height = HEIGHT) {
+        createInstance(true);
+        pickPhysicalDevice();
+        createLogicalDevice();
+        swapchainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+        swapchainExtent = {width, height};
+        createRenderPass();
+    }
+
+    // Headless device with the current shader's pipeline and resources, a timestamp query
+    // pool and a host-visible readback buffer; release with cleanup()
+    void initOffscreen(uint32_t width, uint32_t height) {
+        initHeadlessVulkan(width, height);
+        createGraphicsPipeline();
+        createShaderResources();
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+        if (queueFamilies[findQueueFamily()].timestampValidBits > 0) {
+            timestampPeriod = properties.limits.timestampPeriod;
+            VkQueryPoolCreateInfo queryInfo{};
+            queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryInfo.queryCount = 2;
+            if (vkCreateQueryPool(device, &queryInfo, nullptr, &timestampPool) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create timestamp query pool!");
+            }
+        } else {
+            std::cout << "⚠ No GPU timestamps on this queue, timing frames on the CPU" << std::endl;
+        }
+
+        VkDeviceSize readbackSize = static_cast<VkDeviceSize>(width) * height * 4;
+        for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            createBuffer(readbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         readbackBuffers[i], readbackMemories[i]);
+            vkMapMemory(device, readbackMemories[i], 0, readbackSize, 0, &readbackMapped[i]);
+        }
+    }
+
+    // Render one frame offscreen at iTime = time and wait for it. Returns its GPU time in
+    // milliseconds; with rgba, also copies the frame out (RGBA8, top row first).
+    double renderOffscreen(double time, std::vector<uint8_t>* rgba = nullptr) {
+        timeOverride = time;
+        updateUniformBuffer();
+        updateInputs();
+        updateDeepZoom();
+
+        auto start = std::chrono::steady_clock::now();
+        submitOffscreen(rgba != nullptr, true);
+        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        double millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (timestampPool != VK_NULL_HANDLE) {
+            uint64_t ticks[2];
+            if (vkGetQueryPoolResults(device, timestampPool, 0, 2, sizeof(ticks), ticks, sizeof(uint64_t),
+                                      VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS) {
+                millis = (ticks[1] - ticks[0]) * timestampPeriod * 1e-6;
+            }
+        }
+        if (rgba) {
+            const uint8_t* pixels = static_cast<const uint8_t*>(readbackMapped[currentFrame]);
+            rgba->assign(pixels, pixels + static_cast<size_t>(swapchainExtent.width) * swapchainExtent.height * 4);
+        }
+        currentFeedbackBuffer = 1 - currentFeedbackBuffer;
+        return millis;
+    }
+
+    // Record and submit one offscreen frame on currentFrame's command buffer and fence, with
+    // the uniforms and inputs as they are; with readback, the frame is copied to
+    // readbackBuffers[currentFrame]. Doesn't wait and doesn't swap the feedback buffers.
+    // Timed frames share one query pool, so only one of them may be in flight.
+    void submitOffscreen(bool readback, bool timed) {
+        timed = timed && timestampPool != VK_NULL_HANDLE;
+        updateFeedbackDescriptor();
+        updateVideoChannel();
+        updateAudioChannel();
+        updateKeyboardChannel();
+
+        VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+        vkResetCommandBuffer(commandBuffer, 0);
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to begin recording command buffer!");
+        }
+        if (timed) {
+            vkCmdResetQueryPool(commandBuffer, timestampPool, 0, 2);
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, 0);
+        }
+        recordShaderPass(commandBuffer);
+        if (timed) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, 1);
+        }
+        if (readback) {
+            recordReadback(commandBuffer, feedbackImages[currentFeedbackBuffer]);
+        }
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to record command buffer!");
+        }
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        vkResetFences(device, 1, &inFlightFences[currentFrame]);
+        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit offscreen frame!");
+        }
+    }
+
+    // Copy a feedback buffer (in SHADER_READ_ONLY layout) to this frame's readback buffer and back
+    void recordReadback(VkCommandBuffer commandBuffer, VkImage image) {
+        VkImageMemoryBarrier toTransfer{};
+        toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toTransfer.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toTransfer.image = image;
+        toTransfer.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        toTransfer.subresourceRange.levelCount = 1;
+        toTransfer.subresourceRange.layerCount = 1;
+        toTransfer.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {swapchainExtent.width, swapchainExtent.height, 1};
+        vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffers[currentFrame],
+                               1, &region);
+
+        VkImageMemoryBarrier toShader = toTransfer;
+        toShader.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        toShader.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        toShader.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        toShader.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        VkBufferMemoryBarrier toHost{};
+        toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.buffer = readbackBuffers[currentFrame];
+        toHost.offset = 0;
+        toHost.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1,
+                             &toHost, 1, &toShader);
+    }
+
+    void createInstance(bool headless = false) {
         VkApplicationInfo appInfo{};
         appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
         appInfo.pApplicationName = "Metalshade Viewer";
@@ -808,10 +3527,12 @@ private:
         appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
         appInfo.apiVersion = VK_API_VERSION_1_0;
 
-        uint32_t glfwExtensionCount = 0;
-        const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-        std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        std::vector<const char*> extensions;
+        if (!headless) {
+            uint32_t glfwExtensionCount = 0;
+            const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
         extensions.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
         extensions.push_back("VK_KHR_get_physical_device_properties2");
 
@@ -859,8 +3580,10 @@ private:
         vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
 
         for (uint32_t i = 0; i < queueFamilies.size(); i++) {
-            VkBool32 presentSupport = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
+            VkBool32 presentSupport = surface == VK_NULL_HANDLE;
+            if (surface != VK_NULL_HANDLE) {
+                vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
+            }
             if (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT && presentSupport) {
                 return i;
             }
@@ -887,7 +3610,7 @@ private:
         createInfo.queueCreateInfoCount = 1;
         createInfo.pQueueCreateInfos = &queueCreateInfo;
         createInfo.pEnabledFeatures = &deviceFeatures;
-        createInfo.enabledExtensionCount = 1;
+        createInfo.enabledExtensionCount = surface != VK_NULL_HANDLE ? 1 : 0;
         createInfo.ppEnabledExtensionNames = deviceExtensions;
         createInfo.enabledLayerCount = 0;
 
@@ -1015,45 +3738,170 @@ private:
         renderPassInfo.dependencyCount = 1;
         renderPassInfo.pDependencies = &dependency;
 
-        if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create render pass!");
+        if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create render pass!");
+        }
+
+        // Same pass, but drawing over the shifted previous frame (compatible with the pipelines
+        // and framebuffers made for renderPass)
+        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &panRenderPass) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pan render pass!");
+        }
+
+        // // @recolor pass 0: overwrites the whole iteration buffer and leaves it for pass 1 to
+        // read; the dependencies order it after the previous frame's reads and before this one's
+        colorAttachment.format = ITERATION_FORMAT;
+        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        VkSubpassDependency iterationDependencies[2] = {};
+        iterationDependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        iterationDependencies[0].dstSubpass = 0;
+        iterationDependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        iterationDependencies[0].srcAccessMask = 0;
+        iterationDependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        iterationDependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        iterationDependencies[1].srcSubpass = 0;
+        iterationDependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        iterationDependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        iterationDependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        iterationDependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        iterationDependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        renderPassInfo.dependencyCount = 2;
+        renderPassInfo.pDependencies = iterationDependencies;
+        if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &iterationRenderPass) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create iteration render pass!");
         }
     }
 
-    void createDescriptorSetLayout() {
-        VkDescriptorSetLayoutBinding uboLayoutBinding{};
-        uboLayoutBinding.binding = 0;
-        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        uboLayoutBinding.descriptorCount = 1;
-        uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-        if (hasGeometryShader) {
-            uboLayoutBinding.stageFlags |= VK_SHADER_STAGE_GEOMETRY_BIT;
+    spirv_interface::Interface reflectShader(const std::vector<char>& code, VkShaderStageFlags stage) {
+        spirv_interface::Interface interface;
+        std::string error;
+        if (!spirv_interface::reflect(reinterpret_cast<const uint32_t*>(code.data()), code.size() / 4, stage,
+                                      interface, error)) {
+            throw std::runtime_error("Failed to reflect shader: " + error);
         }
+        return interface;
+    }
 
-        VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-        samplerLayoutBinding.binding = 1;
-        samplerLayoutBinding.descriptorCount = 1;
-        samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        samplerLayoutBinding.pImmutableSamplers = nullptr;
-        samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    // Descriptor set and pipeline layout for a shader interface, created on first use. Only
+    // bindings the shader reads are included; the viewer can feed binding 0 (the uniform
+    // block, at most sizeof(UniformBufferObject)), the ISF inputs block, the deep zoom orbit
+    // buffer, single combined image samplers and a push-constant block (the ISF inputs, or zeros).
+    ShaderLayout layoutFor(const spirv_interface::Interface& interface) {
+        std::lock_guard<std::mutex> lock(layoutCacheMutex);
+        uint64_t hash = interface.layoutHash();
+        auto cached = layoutCache.find(hash);
+        if (cached != layoutCache.end()) {
+            return cached->second;
+        }
 
-        // Feedback texture binding (iChannel1) for paint/persistent effects
-        VkDescriptorSetLayoutBinding feedbackLayoutBinding{};
-        feedbackLayoutBinding.binding = 2;
-        feedbackLayoutBinding.descriptorCount = 1;
-        feedbackLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        feedbackLayoutBinding.pImmutableSamplers = nullptr;
-        feedbackLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+        for (const spirv_interface::Binding& b : interface.bindings) {
+            if (!b.used) {
+                continue;
+            }
+            std::string where = "binding " + std::to_string(b.binding) + " (" + b.name + ")";
+            VkDescriptorSetLayoutBinding layoutBinding{};
+            layoutBinding.binding = b.binding;
+            layoutBinding.descriptorCount = 1;
+            layoutBinding.stageFlags = b.stages;
+            if (b.set != 0 || b.count != 1) {
+                throw std::runtime_error("Unsupported " + where + ": only single descriptors in set 0");
+            } else if (b.type == spirv_interface::ResourceType::UniformBuffer && b.binding == 0) {
+                if (b.blockSize > sizeof(UniformBufferObject)) {
+                    throw std::runtime_error("Uniform block is " + std::to_string(b.blockSize) + " bytes, the viewer provides " +
+                                             std::to_string(sizeof(UniformBufferObject)));
+                }
+                layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            } else if (b.type == spirv_interface::ResourceType::UniformBuffer && b.binding == isf_inputs::UNIFORM_BINDING) {
+                if (b.blockSize > isf_inputs::MAX_BLOCK_SIZE) {
+                    throw std::runtime_error("ISF inputs block is " + std::to_string(b.blockSize) + " bytes, at most " +
+                                             std::to_string(isf_inputs::MAX_BLOCK_SIZE) + " are supported");
+                }
+                layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            } else if (b.type == spirv_interface::ResourceType::StorageBuffer && b.binding == deep_zoom::ORBIT_BINDING) {
+                layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            } else if (b.type == spirv_interface::ResourceType::CombinedImageSampler) {
+                layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            } else {
+                throw std::runtime_error(std::string("Unsupported ") + spirv_interface::resourceTypeName(b.type) + " at " + where);
+            }
+            bindings.push_back(layoutBinding);
+        }
 
-        std::vector<VkDescriptorSetLayoutBinding> bindings = {uboLayoutBinding, samplerLayoutBinding, feedbackLayoutBinding};
+        ShaderLayout layout;
         VkDescriptorSetLayoutCreateInfo layoutInfo{};
         layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
         layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
         layoutInfo.pBindings = bindings.data();
-
-        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout.setLayout) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create descriptor set layout!");
         }
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = interface.pushConstantStages;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = interface.pushConstantSize;
+        if (interface.pushConstantSize > 0) {
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+            if (interface.pushConstantSize > properties.limits.maxPushConstantsSize) {
+                vkDestroyDescriptorSetLayout(device, layout.setLayout, nullptr);
+                throw std::runtime_error("Push constants are " + std::to_string(interface.pushConstantSize) +
+                                         " bytes, the device allows " +
+                                         std::to_string(properties.limits.maxPushConstantsSize));
+            }
+        }
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &layout.setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = interface.pushConstantSize > 0 ? 1 : 0;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &layout.pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline layout!");
+        }
+        layoutCache[hash] = layout;
+        return layout;
+    }
+
+    void destroyLayoutCache() {
+        for (const auto& entry : layoutCache) {
+            vkDestroyPipelineLayout(device, entry.second.pipelineLayout, nullptr);
+            vkDestroyDescriptorSetLayout(device, entry.second.setLayout, nullptr);
+        }
+        layoutCache.clear();
+    }
+
+    // Make `interface` current: its layouts, and decoders only for channels the shader reads
+    void setShaderInterface(const spirv_interface::Interface& interface) {
+        shaderInterface = interface;
+        ShaderLayout layout = layoutFor(interface);
+        deepZoomActive = interface.uses(deep_zoom::ORBIT_BINDING);
+        recolorActive = interface.uses(iteration_buffer::ITERATIONS_BINDING);
+        descriptorSetLayout = layout.setLayout;
+        pipelineLayout = layout.pipelineLayout;
+
+        // One decoder of each kind; the first channel that asks for it wins
+        videoChannel = -1;
+        audioChannel = -1;
+        keyboardChannel = -1;
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            if (!interface.uses(1 + i)) {
+                if (channelSources[i].kind != ChannelKind::Texture && channelSources[i].kind != ChannelKind::Feedback) {
+                    std::cout << "⚠ iChannel" << i << " is not used by the shader, not loading it" << std::endl;
+                }
+                continue;
+            }
+            if (channelSources[i].kind == ChannelKind::Video && videoChannel < 0) videoChannel = i;
+            if (channelSources[i].kind == ChannelKind::Audio && audioChannel < 0) audioChannel = i;
+            if (channelSources[i].kind == ChannelKind::Keyboard && keyboardChannel < 0) keyboardChannel = i;
+        }
     }
 
     VkShaderModule createShaderModule(const std::vector<char>& code) {
@@ -1069,7 +3917,33 @@ private:
         return shaderModule;
     }
 
+    // The shader's own <base>.vert.spv, or the fallback vertex shader if it has none
+    std::string vertexShaderPath(const std::string& fragPath) {
+        std::string path = getShaderDirectory(fragPath) + "/" + getShaderBaseName(fragPath) + ".vert.spv";
+        return fileExists(path) ? path : DEFAULT_VERTEX_SHADER;
+    }
+
     void createGraphicsPipeline() {
+        spirv_interface::Interface interface;
+        std::vector<uint32_t> constants = shader_params::constants(shaderParams);
+        graphicsPipeline = createShaderPipeline(interface, constants);
+        pipelineVariants[constants] = graphicsPipeline;
+        setShaderInterface(interface);
+    }
+
+    void createPipelineCache() {
+        VkPipelineCacheCreateInfo cacheInfo{};
+        cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline cache!");
+        }
+    }
+
+    // Pipeline from the current shader's compiled .spv files, plus the interface reflected
+    // from them (hot reload calls this on a worker thread while the old pipeline renders).
+    // constants fill the fragment stage's specialization constants 0..N-1. A // @recolor
+    // shader also gets its pass 0 pipeline, constant N = ITERATE_PASS (see iterationPipelines).
+    VkPipeline createShaderPipeline(spirv_interface::Interface& interface, const std::vector<uint32_t>& constants) {
         // Determine which .spv files to use
         std::string vertSpvPath;
         std::string fragSpvPath;
@@ -1078,18 +3952,25 @@ private:
         // if (currentShaderPath.empty()
         std::string baseName = getShaderBaseName(currentShaderPath);
         std::string shaderDir = getShaderDirectory(currentShaderPath);
-        vertSpvPath = shaderDir + "/" + baseName + ".vert.spv";
+        vertSpvPath = vertexShaderPath(currentShaderPath);
         fragSpvPath = shaderDir + "/" + baseName + ".frag.spv";
         geomSpvPath = shaderDir + "/" + baseName + ".geom.spv";
-
-        // Use fallback vertex shader if custom one doesn't exist
-        if (!fileExists(vertSpvPath)) {
-            vertSpvPath = "/opt/3d/metalshade/shaders/example.vert.spv";
+        if (vertSpvPath == DEFAULT_VERTEX_SHADER) {
             std::cout << "✓ Using default vertex shader" << std::endl;
         }
 
-        auto vertShaderCode = readFile(vertSpvPath);
-        auto fragShaderCode = readFile(fragSpvPath);
+        auto vertShaderCode = loadStageCode(vertSpvPath);
+        auto fragShaderCode = loadStageCode(fragSpvPath);
+        bool useGeometry = hasGeometryShader && fileExists(geomSpvPath);
+        std::vector<char> geomShaderCode = useGeometry ? loadStageCode(geomSpvPath) : std::vector<char>();
+
+        // The layout comes from the bindings the stages declare
+        interface = reflectShader(vertShaderCode, VK_SHADER_STAGE_VERTEX_BIT);
+        interface.merge(reflectShader(fragShaderCode, VK_SHADER_STAGE_FRAGMENT_BIT));
+        if (useGeometry) {
+            interface.merge(reflectShader(geomShaderCode, VK_SHADER_STAGE_GEOMETRY_BIT));
+        }
+        ShaderLayout layout = layoutFor(interface);
 
         VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
         VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
@@ -1106,12 +3987,28 @@ private:
         fragShaderStageInfo.module = fragShaderModule;
         fragShaderStageInfo.pName = "main";
 
+        std::vector<uint32_t> iterateConstants = constants;
+        iterateConstants.push_back(iteration_buffer::ITERATE_PASS);
+        std::vector<VkSpecializationMapEntry> mapEntries(iterateConstants.size());
+        for (size_t i = 0; i < iterateConstants.size(); i++) {
+            mapEntries[i].constantID = static_cast<uint32_t>(i);
+            mapEntries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+            mapEntries[i].size = sizeof(uint32_t);
+        }
+        VkSpecializationInfo specializationInfo{};
+        specializationInfo.mapEntryCount = static_cast<uint32_t>(constants.size());
+        specializationInfo.pMapEntries = mapEntries.data();
+        specializationInfo.dataSize = constants.size() * sizeof(uint32_t);
+        specializationInfo.pData = constants.data();
+        if (!constants.empty()) {
+            fragShaderStageInfo.pSpecializationInfo = &specializationInfo;
+        }
+
         std::vector<VkPipelineShaderStageCreateInfo> shaderStages = {vertShaderStageInfo, fragShaderStageInfo};
 
         // Load geometry shader if it exists
         VkShaderModule geomShaderModule = VK_NULL_HANDLE;
-        if (hasGeometryShader && fileExists(geomSpvPath)) {
-            auto geomShaderCode = readFile(geomSpvPath);
+        if (useGeometry) {
             geomShaderModule = createShaderModule(geomShaderCode);
 
             VkPipelineShaderStageCreateInfo geomShaderStageInfo{};
@@ -1125,6 +4022,71 @@ private:
             std::cout << "✓ Using geometry shader in pipeline" << std::endl;
         }
 
+        VkPipeline pipeline;
+        auto start = std::chrono::steady_clock::now();
+        VkResult result = createPipeline(shaderStages, layout.pipelineLayout, &pipeline);
+        VkPipeline iterationPipeline = VK_NULL_HANDLE;
+        if (result == VK_SUCCESS && interface.uses(iteration_buffer::ITERATIONS_BINDING)) {
+            specializationInfo.mapEntryCount = static_cast<uint32_t>(iterateConstants.size());
+            specializationInfo.dataSize = iterateConstants.size() * sizeof(uint32_t);
+            specializationInfo.pData = iterateConstants.data();
+            shaderStages.back().pSpecializationInfo = &specializationInfo;  // The fragment stage
+            result = createPipeline(shaderStages, layout.pipelineLayout, &iterationPipeline, iterationRenderPass);
+            if (result != VK_SUCCESS) {
+                vkDestroyPipeline(device, pipeline, nullptr);
+            }
+        }
+        lastPipelineMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        vkDestroyShaderModule(device, fragShaderModule, nullptr);
+        vkDestroyShaderModule(device, vertShaderModule, nullptr);
+        if (geomShaderModule != VK_NULL_HANDLE) {
+            vkDestroyShaderModule(device, geomShaderModule, nullptr);
+        }
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create graphics pipeline!");
+        }
+        if (iterationPipeline != VK_NULL_HANDLE) {
+            std::lock_guard<std::mutex> lock(iterationPipelinesMutex);
+            iterationPipelines[pipeline] = iterationPipeline;
+        }
+        UniformUse use;
+        addUniformUse(vertShaderCode, use);
+        addUniformUse(fragShaderCode, use);
+        if (useGeometry) {
+            addUniformUse(geomShaderCode, use);
+        }
+        {
+            std::lock_guard<std::mutex> lock(uniformUsesMutex);
+            uniformUses[pipeline] = use;
+        }
+        return pipeline;
+    }
+
+    // A compiled .spv, run through spirv-opt when --opt is set (unoptimised if that fails)
+    std::vector<char> loadStageCode(const std::string& path) {
+        std::vector<char> code = readFile(path);
+        if (spirvOptimization == spirv_optimizer::Level::None) {
+            return code;
+        }
+        std::vector<uint32_t> words(code.size() / 4);
+        memcpy(words.data(), code.data(), words.size() * 4);
+        std::vector<uint32_t> optimized;
+        std::string error;
+        if (!spirv_optimizer::optimize(words, spirvOptimization, channel_images::cacheDirectory(), optimized, error)) {
+            std::cout << "⚠ spirv-opt failed for " << path << ", using it unoptimised: "
+                      << error.substr(0, error.find('\n')) << std::endl;
+            return code;
+        }
+        code.resize(optimized.size() * 4);
+        memcpy(code.data(), optimized.data(), code.size());
+        return code;
+    }
+
+    // Fixed-function state shared by every shader; uses renderPass unless given another.
+    // Safe to call from several threads at once.
+    VkResult createPipeline(const std::vector<VkPipelineShaderStageCreateInfo>& shaderStages, VkPipelineLayout layout,
+                            VkPipeline* pipeline, VkRenderPass pass = VK_NULL_HANDLE) {
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
         vertexInputInfo.vertexBindingDescriptionCount = 0;
@@ -1135,24 +4097,18 @@ private:
         inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
         inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-        VkViewport viewport{};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = (float)swapchainExtent.width;
-        viewport.height = (float)swapchainExtent.height;
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-
-        VkRect2D scissor{};
-        scissor.offset = {0, 0};
-        scissor.extent = swapchainExtent;
-
+        // Viewport and scissor are set when the pass is recorded (tiles of --render move the
+        // viewport), so the pipeline doesn't depend on the framebuffer size
         VkPipelineViewportStateCreateInfo viewportState{};
         viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
         viewportState.viewportCount = 1;
-        viewportState.pViewports = &viewport;
         viewportState.scissorCount = 1;
-        viewportState.pScissors = &scissor;
+
+        const VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo dynamicState{};
+        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicState.dynamicStateCount = 2;
+        dynamicState.pDynamicStates = dynamicStates;
 
         VkPipelineRasterizationStateCreateInfo rasterizer{};
         rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
@@ -1180,15 +4136,6 @@ private:
         colorBlending.attachmentCount = 1;
         colorBlending.pAttachments = &colorBlendAttachment;
 
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 1;
-        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-
-        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create pipeline layout!");
-        }
-
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
         pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
@@ -1199,19 +4146,12 @@ private:
         pipelineInfo.pRasterizationState = &rasterizer;
         pipelineInfo.pMultisampleState = &multisampling;
         pipelineInfo.pColorBlendState = &colorBlending;
-        pipelineInfo.layout = pipelineLayout;
-        pipelineInfo.renderPass = renderPass;
+        pipelineInfo.pDynamicState = &dynamicState;
+        pipelineInfo.layout = layout;
+        pipelineInfo.renderPass = pass != VK_NULL_HANDLE ? pass : renderPass;
         pipelineInfo.subpass = 0;
 
-        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create graphics pipeline!");
-        }
-
-        vkDestroyShaderModule(device, fragShaderModule, nullptr);
-        vkDestroyShaderModule(device, vertShaderModule, nullptr);
-        if (geomShaderModule != VK_NULL_HANDLE) {
-            vkDestroyShaderModule(device, geomShaderModule, nullptr);
-        }
+        return vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, pipeline);
     }
 
     void createFramebuffers() {
@@ -1355,7 +4295,8 @@ private:
         vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
     }
 
-    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
+    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout,
+                               uint32_t layerCount = 1) {
         VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
         VkImageMemoryBarrier barrier{};
@@ -1369,7 +4310,7 @@ private:
         barrier.subresourceRange.baseMipLevel = 0;
         barrier.subresourceRange.levelCount = 1;
         barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
+        barrier.subresourceRange.layerCount = layerCount;
 
         VkPipelineStageFlags sourceStage;
         VkPipelineStageFlags destinationStage;
@@ -1417,7 +4358,9 @@ private:
         endSingleTimeCommands(commandBuffer);
     }
 
-    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
+    // Layers (cube faces) or depth slices must follow each other tightly packed in the buffer
+    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height,
+                           uint32_t depth = 1, uint32_t layerCount = 1) {
         VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
         VkBufferImageCopy region{};
@@ -1427,15 +4370,67 @@ private:
         region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         region.imageSubresource.mipLevel = 0;
         region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
+        region.imageSubresource.layerCount = layerCount;
         region.imageOffset = {0, 0, 0};
-        region.imageExtent = {width, height, 1};
+        region.imageExtent = {width, height, depth};
 
         vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 
         endSingleTimeCommands(commandBuffer);
     }
 
+    // RGBA8 stand-in for a missing @texture
+    static std::vector<uint8_t> proceduralGradient(uint32_t width, uint32_t height) {
+        std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                uint32_t idx = (y * width + x) * 4;
+                float fx = x / (float)width;
+                float fy = y / (float)height;
+                pixels[idx + 0] = (uint8_t)(fx * 255);
+                pixels[idx + 1] = (uint8_t)(fy * 255);
+                pixels[idx + 2] = (uint8_t)((fx + fy) * 128);
+                pixels[idx + 3] = 255;
+            }
+        }
+        return pixels;
+    }
+
+    // The same texture as linear floats for the CPU renderer (the image is R8G8B8A8_SRGB)
+    spirv_cpu::Texture loadCpuTexture() {
+        int texWidth = 0, texHeight = 0, texChannels = 0;
+        stbi_uc* pixels = nullptr;
+        if (!currentTexturePath.empty()) {
+            pixels = stbi_load(currentTexturePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+        }
+        std::vector<uint8_t> procedural;
+        if (!pixels) {
+            texWidth = 256;
+            texHeight = 256;
+            procedural = proceduralGradient(texWidth, texHeight);
+        }
+        textureWidth = texWidth;
+        textureHeight = texHeight;
+
+        float linear[256];
+        for (int i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            linear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+        }
+        const uint8_t* source = pixels ? pixels : procedural.data();
+        spirv_cpu::Texture texture;
+        texture.width = texWidth;
+        texture.height = texHeight;
+        texture.rgba.resize(static_cast<size_t>(texWidth) * texHeight * 4);
+        for (size_t i = 0; i < texture.rgba.size(); i++) {
+            texture.rgba[i] = i % 4 == 3 ? source[i] / 255.0f : linear[source[i]];
+        }
+        if (pixels) {
+            stbi_image_free(pixels);
+        }
+        return texture;
+    }
+
     void createTextureImage() {
         int texWidth, texHeight, texChannels;
         stbi_uc* pixels = nullptr;
@@ -1444,6 +4439,8 @@ private:
         if (!currentTexturePath.empty()) {
             pixels = stbi_load(currentTexturePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
         }
+        textureWidth = pixels ? texWidth : 256;
+        textureHeight = pixels ? texHeight : 256;
 
         // If no texture or loading failed, create a default procedural texture
         if (!pixels) {
@@ -1452,18 +4449,7 @@ private:
             texHeight = 256;
             VkDeviceSize imageSize = texWidth * texHeight * 4;
 
-            std::vector<uint8_t> proceduralPixels(imageSize);
-            for (uint32_t y = 0; y < (uint32_t)texHeight; y++) {
-                for (uint32_t x = 0; x < (uint32_t)texWidth; x++) {
-                    uint32_t idx = (y * texWidth + x) * 4;
-                    float fx = x / (float)texWidth;
-                    float fy = y / (float)texHeight;
-                    proceduralPixels[idx + 0] = (uint8_t)(fx * 255);
-                    proceduralPixels[idx + 1] = (uint8_t)(fy * 255);
-                    proceduralPixels[idx + 2] = (uint8_t)((fx + fy) * 128);
-                    proceduralPixels[idx + 3] = 255;
-                }
-            }
+            std::vector<uint8_t> proceduralPixels = proceduralGradient(texWidth, texHeight);
 
             VkBuffer stagingBuffer;
             VkDeviceMemory stagingBufferMemory;
@@ -1604,24 +4590,470 @@ private:
             }
         }
 
-        std::cout << "✓ Created ping-pong feedback buffers for paint effects" << std::endl;
+        std::cout << "✓ Created ping-pong feedback buffers for paint effects" << std::endl;
+    }
+
+    // Where // @recolor pass 0 leaves its iterations, one texel per framebuffer pixel
+    void createIterationBuffer() {
+        createImage(swapchainExtent.width, swapchainExtent.height, ITERATION_FORMAT, VK_IMAGE_TILING_OPTIMAL,
+                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, iterationImage, iterationImageMemory);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = iterationImage;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = ITERATION_FORMAT;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(device, &viewInfo, nullptr, &iterationImageView) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create iteration image view!");
+        }
+        transitionImageLayout(iterationImage, ITERATION_FORMAT, VK_IMAGE_LAYOUT_UNDEFINED,
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = iterationRenderPass;
+        framebufferInfo.attachmentCount = 1;
+        framebufferInfo.pAttachments = &iterationImageView;
+        framebufferInfo.width = swapchainExtent.width;
+        framebufferInfo.height = swapchainExtent.height;
+        framebufferInfo.layers = 1;
+        if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &iterationFramebuffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create iteration framebuffer!");
+        }
+    }
+
+    void createVideoChannel() {
+        videoInFlightUploads.assign(MAX_FRAMES_IN_FLIGHT, -1);
+        videoPendingUpload = -1;
+        if (videoChannel < 0 || !videoDecoder.open(channelSources[videoChannel].path)) {
+            videoActive = false;
+            return;
+        }
+
+        uint32_t width = videoDecoder.width();
+        uint32_t height = videoDecoder.height();
+
+        // Ring of persistently mapped staging buffers; the decoder thread writes RGBA straight into them
+        std::vector<void*> slotMemory(VIDEO_STAGING_SLOTS);
+        videoStagingBuffers.resize(VIDEO_STAGING_SLOTS);
+        videoStagingMemories.resize(VIDEO_STAGING_SLOTS);
+        for (int i = 0; i < VIDEO_STAGING_SLOTS; i++) {
+            createBuffer(videoDecoder.frameBytes(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         videoStagingBuffers[i], videoStagingMemories[i]);
+            vkMapMemory(device, videoStagingMemories[i], 0, videoDecoder.frameBytes(), 0, &slotMemory[i]);
+        }
+
+        // Double-buffered sampled image: upload into one while in-flight frames still read the other
+        for (int i = 0; i < 2; i++) {
+            createImage(width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+                        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, videoImages[i], videoImageMemories[i]);
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = videoImages[i];
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+            viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            viewInfo.subresourceRange.baseMipLevel = 0;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.baseArrayLayer = 0;
+            viewInfo.subresourceRange.layerCount = 1;
+
+            if (vkCreateImageView(device, &viewInfo, nullptr, &videoImageViews[i]) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create video image view!");
+            }
+
+            transitionImageLayout(videoImages[i], VK_FORMAT_R8G8B8A8_SRGB,
+                                  VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        }
+
+        videoDecoder.start(slotMemory);
+
+        // Seed both images with the first frame (load time, so waiting here is fine)
+        uint64_t firstFrame;
+        if (videoDecoder.waitFirstFrame(firstFrame)) {
+            for (int i = 0; i < 2; i++) {
+                copyBufferToImage(videoStagingBuffers[videoDecoder.slotIndex(firstFrame)], videoImages[i], width, height);
+            }
+            videoDecoder.release(firstFrame);
+        } else {
+            std::cout << "⚠ Video: no frame decoded yet, channel starts black" << std::endl;
+        }
+
+        for (int i = 0; i < 2; i++) {
+            transitionImageLayout(videoImages[i], VK_FORMAT_R8G8B8A8_SRGB,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
+
+        videoFrontImage = 0;
+        videoStartTime = currentTime;
+        videoActive = true;
+        std::cout << "✓ Streaming video on iChannel" << videoChannel << " (" << VIDEO_STAGING_SLOTS << " staging slots)" << std::endl;
+    }
+
+    void destroyVideoChannel() {
+        if (!videoActive) {
+            return;
+        }
+        videoDecoder.close();
+        std::cout << "✓ Video: " << videoDecoder.framesShown() << " frames shown, "
+                  << videoDecoder.framesDropped() << " dropped, "
+                  << videoDecoder.framesLate() << " late" << std::endl;
+
+        for (size_t i = 0; i < videoStagingBuffers.size(); i++) {
+            vkDestroyBuffer(device, videoStagingBuffers[i], nullptr);
+            vkFreeMemory(device, videoStagingMemories[i], nullptr);
+        }
+        videoStagingBuffers.clear();
+        videoStagingMemories.clear();
+
+        for (int i = 0; i < 2; i++) {
+            vkDestroyImageView(device, videoImageViews[i], nullptr);
+            vkDestroyImage(device, videoImages[i], nullptr);
+            vkFreeMemory(device, videoImageMemories[i], nullptr);
+        }
+        videoActive = false;
+    }
+
+    void createAudioChannel() {
+        audioUploadPending = false;
+        if (audioChannel < 0 || !audioAnalyzer.open(channelSources[audioChannel].path)) {
+            audioActive = false;
+            return;
+        }
+
+        createStreamingImage(audioImage, AudioAnalyzer::TEXTURE_WIDTH, AudioAnalyzer::TEXTURE_HEIGHT);
+        audioAnalyzer.start();
+        audioActive = true;
+        std::cout << "✓ Sound texture on iChannel" << audioChannel << std::endl;
+    }
+
+    void destroyAudioChannel() {
+        if (!audioActive) {
+            return;
+        }
+        audioAnalyzer.stop();
+        destroyStreamingImage(audioImage);
+        audioActive = false;
+    }
+
+    void createKeyboardChannel() {
+        keyboardUploadPending = false;
+        keyboardActive = keyboardChannel >= 0;
+        if (!keyboardActive) {
+            return;
+        }
+        keyboardState.reset();
+        createStreamingImage(keyboardImage, KeyboardState::TEXTURE_WIDTH, KeyboardState::TEXTURE_HEIGHT);
+        std::cout << "✓ Keyboard texture on iChannel" << keyboardChannel
+                  << " (viewer shortcuts: Ctrl+key)" << std::endl;
+    }
+
+    void destroyKeyboardChannel() {
+        if (!keyboardActive) {
+            return;
+        }
+        destroyStreamingImage(keyboardImage);
+        keyboardActive = false;
+        if (keyboardLatencySamples > 0) {
+            std::cout << "✓ Keyboard latency (event → frame complete): avg "
+                      << keyboardLatencyTotal / keyboardLatencySamples * 1000.0 << " ms, max "
+                      << keyboardLatencyMax * 1000.0 << " ms over " << keyboardLatencySamples << " frames" << std::endl;
+        }
+    }
+
+    void createStreamingImage(StreamingImage& stream, uint32_t width, uint32_t height) {
+        stream.width = width;
+        stream.height = height;
+
+        VkDeviceSize size = width * height;
+        stream.stagingBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+        stream.stagingMemories.resize(MAX_FRAMES_IN_FLIGHT);
+        stream.stagingMapped.resize(MAX_FRAMES_IN_FLIGHT);
+        for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         stream.stagingBuffers[i], stream.stagingMemories[i]);
+            vkMapMemory(device, stream.stagingMemories[i], 0, size, 0, &stream.stagingMapped[i]);
+            memset(stream.stagingMapped[i], 0, size);
+        }
+
+        // Linear R8 so texture().x returns the byte value / 255, as in ShaderToy
+        createImage(width, height, VK_FORMAT_R8_UNORM,
+                    VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, stream.target.image, stream.target.memory);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = stream.target.image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = VK_FORMAT_R8_UNORM;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device, &viewInfo, nullptr, &stream.target.view) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create streaming image view!");
+        }
+
+        transitionImageLayout(stream.target.image, VK_FORMAT_R8_UNORM,
+                              VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        copyBufferToImage(stream.stagingBuffers[0], stream.target.image, width, height);
+        transitionImageLayout(stream.target.image, VK_FORMAT_R8_UNORM,
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    void destroyStreamingImage(StreamingImage& stream) {
+        for (size_t i = 0; i < stream.stagingBuffers.size(); i++) {
+            vkDestroyBuffer(device, stream.stagingBuffers[i], nullptr);
+            vkFreeMemory(device, stream.stagingMemories[i], nullptr);
+        }
+        vkDestroyImageView(device, stream.target.view, nullptr);
+        vkDestroyImage(device, stream.target.image, nullptr);
+        vkFreeMemory(device, stream.target.memory, nullptr);
+        stream = StreamingImage{};
+    }
+
+    // Upload cube maps and volumes for every channel that asks for one.
+    // A source that fails to load falls back to a placeholder of the same image type,
+    // since the shader's samplerCube/sampler3D must never see a 2D view.
+    void createImageChannels() {
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            const ChannelSource& source = channelSources[i];
+            if (!shaderInterface.uses(1 + i)) {
+                continue;
+            }
+            ChannelImageData data;
+            if (source.kind == ChannelKind::Cube) {
+                if (!channel_images::loadCubemap(source.path, data)) {
+                    channel_images::fallbackCubemap(data);
+                }
+                // Cubemaps are colour images like @texture; volumes hold data, so stay linear
+                createChannelImage(data, VK_FORMAT_R8G8B8A8_SRGB, channelImages[i]);
+                channelExtents[i][0] = data.width;
+                channelExtents[i][1] = data.height;
+                channelExtents[i][2] = 1;
+                std::cout << "✓ Cubemap on iChannel" << i << " (" << data.width << "² x6)" << std::endl;
+            } else if (source.kind == ChannelKind::Volume) {
+                if (channel_images::isNoiseSpec(source.path)) {
+                    channel_images::noiseVolume(source.path, data);
+                } else if (!channel_images::loadVolume(source.path, data)) {
+                    std::cerr << "✗ Could not load volume: " << source.path << ", using noise" << std::endl;
+                    channel_images::noiseVolume("noise", data);
+                }
+                createChannelImage(data, VK_FORMAT_R8G8B8A8_UNORM, channelImages[i]);
+                channelExtents[i][0] = data.width;
+                channelExtents[i][1] = data.height;
+                channelExtents[i][2] = data.depth;
+                std::cout << "✓ Volume on iChannel" << i << " (" << data.width << "x" << data.height
+                          << "x" << data.depth << ")" << std::endl;
+            }
+        }
+    }
+
+    void createChannelImage(const ChannelImageData& data, VkFormat format, ChannelImage& target) {
+        bool cube = data.layers == 6;
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.flags = cube ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
+        imageInfo.imageType = cube ? VK_IMAGE_TYPE_2D : VK_IMAGE_TYPE_3D;
+        imageInfo.extent.width = data.width;
+        imageInfo.extent.height = data.height;
+        imageInfo.extent.depth = data.depth;
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = data.layers;
+        imageInfo.format = format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateImage(device, &imageInfo, nullptr, &target.image) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create channel image!");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(device, target.image, &memRequirements);
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = memRequirements.size;
+        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (vkAllocateMemory(device, &allocInfo, nullptr, &target.memory) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate channel image memory!");
+        }
+        vkBindImageMemory(device, target.image, target.memory, 0);
+
+        VkDeviceSize imageSize = data.pixels.size();
+        VkBuffer stagingBuffer;
+        VkDeviceMemory stagingBufferMemory;
+        createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     stagingBuffer, stagingBufferMemory);
+
+        void* mapped;
+        vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &mapped);
+        memcpy(mapped, data.pixels.data(), static_cast<size_t>(imageSize));
+        vkUnmapMemory(device, stagingBufferMemory);
+
+        transitionImageLayout(target.image, format, VK_IMAGE_LAYOUT_UNDEFINED,
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, data.layers);
+        copyBufferToImage(stagingBuffer, target.image, data.width, data.height, data.depth, data.layers);
+        transitionImageLayout(target.image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, data.layers);
+
+        vkDestroyBuffer(device, stagingBuffer, nullptr);
+        vkFreeMemory(device, stagingBufferMemory, nullptr);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = target.image;
+        viewInfo.viewType = cube ? VK_IMAGE_VIEW_TYPE_CUBE : VK_IMAGE_VIEW_TYPE_3D;
+        viewInfo.format = format;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = data.layers;
+
+        if (vkCreateImageView(device, &viewInfo, nullptr, &target.view) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create channel image view!");
+        }
+    }
+
+    void destroyImageChannels() {
+        for (ChannelImage& channelImage : channelImages) {
+            if (channelImage.image == VK_NULL_HANDLE) {
+                continue;
+            }
+            vkDestroyImageView(device, channelImage.view, nullptr);
+            vkDestroyImage(device, channelImage.image, nullptr);
+            vkFreeMemory(device, channelImage.memory, nullptr);
+            channelImage = ChannelImage{};
+        }
+    }
+
+    // Called after a shader switch (device idle): reload per-shader channels
+    void reloadChannels() {
+        destroyVideoChannel();
+        destroyAudioChannel();
+        destroyKeyboardChannel();
+        destroyImageChannels();
+        createVideoChannel();
+        createAudioChannel();
+        createKeyboardChannel();
+        createImageChannels();
+        for (size_t i = 0; i < descriptorSets.size(); i++) {
+            writeChannelDescriptors(descriptorSets[i]);
+        }
     }
 
     void createUniformBuffer() {
-        VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        VkDeviceSize alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+        uniformSlotSize = (sizeof(UniformBufferObject) + alignment - 1) / alignment * alignment;
+        VkDeviceSize bufferSize = uniformSlotSize * MAX_FRAMES_IN_FLIGHT;
         createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                      uniformBuffer, uniformBufferMemory);
         vkMapMemory(device, uniformBufferMemory, 0, bufferSize, 0, &uniformBufferMapped);
+
+        // ISF inputs too large for push constants: one block per frame in flight
+        for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            createBuffer(isf_inputs::MAX_BLOCK_SIZE, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         inputsBuffers[i], inputsBufferMemories[i]);
+            vkMapMemory(device, inputsBufferMemories[i], 0, isf_inputs::MAX_BLOCK_SIZE, 0, &inputsBuffersMapped[i]);
+        }
+
+        // Deep zoom reference orbits, also per frame in flight (the header changes every frame)
+        for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            createBuffer(deep_zoom::BUFFER_SIZE, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         orbitBuffers[i], orbitBufferMemories[i]);
+            vkMapMemory(device, orbitBufferMemories[i], 0, deep_zoom::BUFFER_SIZE, 0, &orbitBuffersMapped[i]);
+        }
+    }
+
+    // Once per frame: pack the ISF input values (the buffer this frame's descriptor set points
+    // at is no longer in flight after the fence wait)
+    void updateInputs() {
+        size_t size = std::max<size_t>(isfInputs.size, shaderInterface.pushConstantSize);
+        isfInputData.assign(size, 0);
+        if (size == 0) {
+            return;
+        }
+        if (isfInputs.size > 0) {
+            isfInputs.pack(isfInputData.data());
+        }
+        if (shaderInterface.uses(isf_inputs::UNIFORM_BINDING)) {
+            memcpy(inputsBuffersMapped[currentFrame], isfInputData.data(),
+                   std::min<size_t>(size, isf_inputs::MAX_BLOCK_SIZE));
+        }
+    }
+
+    // Once per frame for // @deepzoom shaders, after fillUniforms: follow this frame's zoom
+    // (at the cursor) and drag, and write the header and any new orbit into this frame's
+    // buffer. Offline renders wait for the orbit instead of drawing with a stale one.
+    void updateDeepZoom() {
+        if (!deepZoomActive) {
+            return;
+        }
+        VkExtent2D image = imageExtent();
+        double cursorX = 0.5 * image.width, cursorY = 0.5 * image.height;
+        double dragX = 0.0, dragY = 0.0;
+        if (window) {
+            cursorX = mouseX * scaleX;
+            cursorY = (cachedWindowHeight - mouseY) * scaleY;  // fragCoord is y-up
+            if (mouseLeftPressed && draggedPoint < 0) {
+                dragX = std::round((mouseX - mouseClickX) * scaleX);  // Whole pixels, for // @pancoherent
+                dragY = std::round((mouseClickY - mouseY) * scaleY);
+            }
+        }
+        panOrigin[0] = deepZoomPan[0] + dragX;
+        panOrigin[1] = deepZoomPan[1] + dragY;
+        if (deepZoom.update(unclampedZoom, image.width, image.height, cursorX, cursorY, dragX, dragY, window == nullptr)) {
+            const deep_zoom::Orbit& orbit = deepZoom.orbit();
+            char line[160];
+            snprintf(line, sizeof(line), "✓ Reference orbit: %zu iterations at %zu bits (%.1f ms, %u thread%s, zoom %.2e)",
+                     orbit.points(), orbit.x.size() * 32, orbit.millis, orbit.threads, orbit.threads == 1 ? "" : "s",
+                     unclampedZoom);
+            std::cout << line << std::endl;
+        }
+        deepZoom.fill(orbitBuffersMapped[currentFrame], orbitBufferVersions[currentFrame]);
     }
 
     void createDescriptorPool() {
-        std::array<VkDescriptorPoolSize, 2> poolSizes{};
-        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-        poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        // 2 samplers per frame: iChannel0 (static texture) + iChannel1 (feedback)
-        poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT * 2);
+        // Sized for the bindings the current shader reads, one set per frame in flight
+        uint32_t uniformBuffers = 0, storageBuffers = 0, samplers = 0;
+        for (const spirv_interface::Binding& b : shaderInterface.bindings) {
+            if (!b.used) continue;
+            if (b.type == spirv_interface::ResourceType::UniformBuffer) uniformBuffers++;
+            if (b.type == spirv_interface::ResourceType::StorageBuffer) storageBuffers++;
+            if (b.type == spirv_interface::ResourceType::CombinedImageSampler) samplers++;
+        }
+        std::vector<VkDescriptorPoolSize> poolSizes;
+        if (uniformBuffers > 0) {
+            poolSizes.push_back({VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, uniformBuffers * MAX_FRAMES_IN_FLIGHT});
+        }
+        if (storageBuffers > 0) {
+            poolSizes.push_back({VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, storageBuffers * MAX_FRAMES_IN_FLIGHT});
+        }
+        if (samplers > 0) {
+            poolSizes.push_back({VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, samplers * MAX_FRAMES_IN_FLIGHT});
+        }
 
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -1634,6 +5066,13 @@ private:
         }
     }
 
+    // After a switch to a shader with different bindings (device idle)
+    void recreateDescriptorSets() {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        createDescriptorPool();
+        createDescriptorSets();
+    }
+
     void createDescriptorSets() {
         std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
         VkDescriptorSetAllocateInfo allocInfo{};
@@ -1647,50 +5086,98 @@ private:
             throw std::runtime_error("Failed to allocate descriptor sets!");
         }
 
+        const spirv_interface::Binding* uniforms = shaderInterface.find(0);
+        const spirv_interface::Binding* inputs = shaderInterface.find(isf_inputs::UNIFORM_BINDING);
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            writeChannelDescriptors(descriptorSets[i]);
+            if (inputs && inputs->used && inputs->type == spirv_interface::ResourceType::UniformBuffer) {
+                VkDescriptorBufferInfo inputsInfo{};
+                inputsInfo.buffer = inputsBuffers[i];
+                inputsInfo.offset = 0;
+                inputsInfo.range = inputs->blockSize ? inputs->blockSize : isf_inputs::MAX_BLOCK_SIZE;
+
+                VkWriteDescriptorSet inputsWrite{};
+                inputsWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                inputsWrite.dstSet = descriptorSets[i];
+                inputsWrite.dstBinding = isf_inputs::UNIFORM_BINDING;
+                inputsWrite.dstArrayElement = 0;
+                inputsWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                inputsWrite.descriptorCount = 1;
+                inputsWrite.pBufferInfo = &inputsInfo;
+                vkUpdateDescriptorSets(device, 1, &inputsWrite, 0, nullptr);
+            }
+            if (deepZoomActive) {
+                VkDescriptorBufferInfo orbitInfo{};
+                orbitInfo.buffer = orbitBuffers[i];
+                orbitInfo.offset = 0;
+                orbitInfo.range = deep_zoom::BUFFER_SIZE;
+
+                VkWriteDescriptorSet orbitWrite{};
+                orbitWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                orbitWrite.dstSet = descriptorSets[i];
+                orbitWrite.dstBinding = deep_zoom::ORBIT_BINDING;
+                orbitWrite.dstArrayElement = 0;
+                orbitWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                orbitWrite.descriptorCount = 1;
+                orbitWrite.pBufferInfo = &orbitInfo;
+                vkUpdateDescriptorSets(device, 1, &orbitWrite, 0, nullptr);
+            }
+            if (!uniforms || !uniforms->used) {
+                continue;
+            }
             VkDescriptorBufferInfo bufferInfo{};
             bufferInfo.buffer = uniformBuffer;
-            bufferInfo.offset = 0;
-            bufferInfo.range = sizeof(UniformBufferObject);
-
-            VkDescriptorImageInfo imageInfo{};
-            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView = textureImageView;
-            imageInfo.sampler = textureSampler;
-
-            // Feedback texture info (iChannel1) - TODO: Make this dynamic for ping-pong
-            VkDescriptorImageInfo feedbackInfo{};
-            feedbackInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            feedbackInfo.imageView = feedbackImageViews[0];  // For now, always bind buffer 0
-            feedbackInfo.sampler = textureSampler;
-
-            std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
-
-            descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[0].dstSet = descriptorSets[i];
-            descriptorWrites[0].dstBinding = 0;
-            descriptorWrites[0].dstArrayElement = 0;
-            descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptorWrites[0].descriptorCount = 1;
-            descriptorWrites[0].pBufferInfo = &bufferInfo;
-
-            descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[1].dstSet = descriptorSets[i];
-            descriptorWrites[1].dstBinding = 1;
-            descriptorWrites[1].dstArrayElement = 0;
-            descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrites[1].descriptorCount = 1;
-            descriptorWrites[1].pImageInfo = &imageInfo;
-
-            descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[2].dstSet = descriptorSets[i];
-            descriptorWrites[2].dstBinding = 2;
-            descriptorWrites[2].dstArrayElement = 0;
-            descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrites[2].descriptorCount = 1;
-            descriptorWrites[2].pImageInfo = &feedbackInfo;
-
-            vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+            bufferInfo.offset = uniformSlotSize * i;
+            bufferInfo.range = uniforms->blockSize ? uniforms->blockSize : sizeof(UniformBufferObject);
+
+            VkWriteDescriptorSet descriptorWrite{};
+            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrite.dstSet = descriptorSets[i];
+            descriptorWrite.dstBinding = 0;
+            descriptorWrite.dstArrayElement = 0;
+            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            descriptorWrite.descriptorCount = 1;
+            descriptorWrite.pBufferInfo = &bufferInfo;
+
+            vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+        }
+    }
+
+    // Image view currently backing an iChannel (feedback reads the buffer not being written)
+    VkImageView channelImageView(int channel) {
+        switch (channelSources[channel].kind) {
+            case ChannelKind::Feedback:
+                return feedbackImageViews[1 - currentFeedbackBuffer];
+            case ChannelKind::Video:
+                if (videoActive && channel == videoChannel) return videoImageViews[videoFrontImage];
+                break;
+            case ChannelKind::Audio:
+                if (audioActive && channel == audioChannel) return audioImage.target.view;
+                break;
+            case ChannelKind::Keyboard:
+                if (keyboardActive && channel == keyboardChannel) return keyboardImage.target.view;
+                break;
+            case ChannelKind::Cube:
+            case ChannelKind::Volume:
+                return channelImages[channel].view;
+            case ChannelKind::Texture:
+                break;
+        }
+        return textureImageView;
+    }
+
+    // Every sampler the shader reads: iChannel0-3 at bindings 1-4, the // @recolor iterations,
+    // the @texture image for any other
+    void writeChannelDescriptors(VkDescriptorSet set) {
+        for (const spirv_interface::Binding& b : shaderInterface.bindings) {
+            if (b.type == spirv_interface::ResourceType::CombinedImageSampler) {
+                bool channel = b.binding >= 1 && b.binding <= CHANNEL_COUNT;
+                VkImageView view = channel ? channelImageView(b.binding - 1) : textureImageView;
+                if (b.binding == iteration_buffer::ITERATIONS_BINDING) {
+                    view = iterationImageView;
+                }
+                writeImageDescriptor(set, b.binding, view);
+            }
         }
     }
 
@@ -1709,62 +5196,385 @@ private:
     }
 
     void updateFeedbackDescriptor() {
-        // Update descriptor to point to the "read" feedback buffer
-        int readBuffer = 1 - currentFeedbackBuffer;  // Read from the other buffer
+        // Update descriptor(s) to point to the "read" feedback buffer (iChannel1 unless reassigned)
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            if (channelSources[i].kind == ChannelKind::Feedback) {
+                writeImageDescriptor(descriptorSets[currentFrame], 1 + i, channelImageView(i));
+            }
+        }
+    }
 
-        VkDescriptorImageInfo feedbackInfo{};
-        feedbackInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        feedbackInfo.imageView = feedbackImageViews[readBuffer];
-        feedbackInfo.sampler = textureSampler;
+    void writeImageDescriptor(VkDescriptorSet set, uint32_t binding, VkImageView view) {
+        if (!shaderInterface.uses(binding)) {
+            return;  // Not in this shader's layout
+        }
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView = view;
+        imageInfo.sampler = textureSampler;
 
         VkWriteDescriptorSet descriptorWrite{};
         descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = descriptorSets[currentFrame];
-        descriptorWrite.dstBinding = 2;  // iChannel1
+        descriptorWrite.dstSet = set;
+        descriptorWrite.dstBinding = binding;
         descriptorWrite.dstArrayElement = 0;
         descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         descriptorWrite.descriptorCount = 1;
-        descriptorWrite.pImageInfo = &feedbackInfo;
+        descriptorWrite.pImageInfo = &imageInfo;
 
         vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
     }
 
-    void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    void updateVideoChannel() {
+        if (!videoActive) {
+            return;
+        }
 
-        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to begin recording command buffer!");
+        // Non-blocking: if the decoder is behind we simply keep showing the current frame
+        uint64_t sequence;
+        if (videoDecoder.acquireFrame(currentTime - videoStartTime, sequence)) {
+            videoFrontImage = 1 - videoFrontImage;
+            videoPendingUpload = static_cast<int64_t>(sequence);
+            videoInFlightUploads[currentFrame] = videoPendingUpload;
         }
+        writeImageDescriptor(descriptorSets[currentFrame], 1 + videoChannel, videoImageViews[videoFrontImage]);
+    }
 
-        int writeBuffer = currentFeedbackBuffer;
-        int readBuffer = 1 - currentFeedbackBuffer;
+    // Copy the newest analyzer output (if any) into this frame's staging buffer
+    void updateAudioChannel() {
+        if (!audioActive) {
+            return;
+        }
+        const AudioAnalyzer::Texture* texture = audioAnalyzer.latestTexture();
+        if (texture) {
+            memcpy(audioImage.stagingMapped[currentFrame], texture->data(), texture->size());
+            audioUploadPending = true;
+        }
+    }
+
+    // Apply this frame's key events; only the span of changed columns is uploaded
+    void updateKeyboardChannel() {
+        double oldestEvent = keyboardState.drain();
+        keyboardEventTimes[currentFrame] = keyboardActive ? oldestEvent : -1.0;
+        if (!keyboardActive || !keyboardState.dirty()) {
+            return;
+        }
+        keyboardUploadOffset = keyboardState.dirtyOffset();
+        keyboardUploadWidth = keyboardState.dirtyWidth();
+        keyboardState.copyTo(keyboardImage.stagingMapped[currentFrame]);
+        keyboardUploadPending = true;
+    }
+
+    // Called once the frame's fence has signalled: its key events are now visible on screen
+    void recordKeyboardLatency() {
+        double eventTime = keyboardEventTimes[currentFrame];
+        if (eventTime < 0.0) {
+            return;
+        }
+        double latency = steadySeconds() - eventTime;
+        keyboardLatencySamples++;
+        keyboardLatencyTotal += latency;
+        keyboardLatencyMax = std::max(keyboardLatencyMax, latency);
+        keyboardEventTimes[currentFrame] = -1.0;
+    }
+
+    // This frame's fence has signalled, so its staging slot copy is done
+    void releaseVideoUpload() {
+        if (videoInFlightUploads.empty() || videoInFlightUploads[currentFrame] < 0) {
+            return;
+        }
+        videoDecoder.release(static_cast<uint64_t>(videoInFlightUploads[currentFrame]));
+        videoInFlightUploads[currentFrame] = -1;
+    }
 
-        // === STEP 1: Transition feedback write buffer to COLOR_ATTACHMENT ===
-        VkImageMemoryBarrier barrier1{};
-        barrier1.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier1.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        barrier1.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-        barrier1.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier1.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier1.image = feedbackImages[writeBuffer];
-        barrier1.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier1.subresourceRange.baseMipLevel = 0;
-        barrier1.subresourceRange.levelCount = 1;
-        barrier1.subresourceRange.baseArrayLayer = 0;
-        barrier1.subresourceRange.layerCount = 1;
-        barrier1.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        barrier1.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    // Record a staging buffer → sampled image copy, bracketed by shader-read ↔ transfer barriers.
+    // With offsetX/bufferRowLength set, only columns [offsetX, offsetX + width) of a
+    // bufferRowLength-wide buffer are copied.
+    void recordImageUpload(VkCommandBuffer commandBuffer, VkBuffer source, VkImage image, uint32_t width, uint32_t height,
+                           uint32_t offsetX = 0, uint32_t bufferRowLength = 0) {
+        VkImageMemoryBarrier toTransfer{};
+        toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toTransfer.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toTransfer.image = image;
+        toTransfer.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        toTransfer.subresourceRange.baseMipLevel = 0;
+        toTransfer.subresourceRange.levelCount = 1;
+        toTransfer.subresourceRange.baseArrayLayer = 0;
+        toTransfer.subresourceRange.layerCount = 1;
+        toTransfer.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 
         vkCmdPipelineBarrier(commandBuffer,
             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-            0, 0, nullptr, 0, nullptr, 1, &barrier1);
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = offsetX;  // R8: one byte per texel
+        region.bufferRowLength = bufferRowLength;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {static_cast<int32_t>(offsetX), 0, 0};
+        region.imageExtent = {width, height, 1};
+
+        vkCmdCopyBufferToImage(commandBuffer, source, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        VkImageMemoryBarrier toShader = toTransfer;
+        toShader.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        toShader.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        toShader.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toShader.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &toShader);
+    }
+
+    void recordVideoUpload(VkCommandBuffer commandBuffer) {
+        if (videoPendingUpload < 0) {
+            return;
+        }
+        recordImageUpload(commandBuffer,
+                          videoStagingBuffers[videoDecoder.slotIndex(static_cast<uint64_t>(videoPendingUpload))],
+                          videoImages[videoFrontImage], videoDecoder.width(), videoDecoder.height());
+        videoPendingUpload = -1;
+    }
+
+    void recordAudioUpload(VkCommandBuffer commandBuffer) {
+        if (!audioUploadPending) {
+            return;
+        }
+        recordImageUpload(commandBuffer, audioImage.stagingBuffers[currentFrame], audioImage.target.image,
+                          audioImage.width, audioImage.height);
+        audioUploadPending = false;
+    }
+
+    void recordKeyboardUpload(VkCommandBuffer commandBuffer) {
+        if (!keyboardUploadPending) {
+            return;
+        }
+        recordImageUpload(commandBuffer, keyboardImage.stagingBuffers[currentFrame], keyboardImage.target.image,
+                          keyboardUploadWidth, keyboardImage.height, keyboardUploadOffset, keyboardImage.width);
+        keyboardUploadPending = false;
+    }
+
+    // // @pancoherent, pure pan: copy the previous frame into target moved by panShift and
+    // leave target ready (COLOR_ATTACHMENT) for the exposed strips to be drawn over it
+    void recordPanShift(VkCommandBuffer commandBuffer, VkImage previous, VkImage target) {
+        VkImageMemoryBarrier toSource{};
+        toSource.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toSource.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        toSource.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        toSource.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toSource.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toSource.image = previous;
+        toSource.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        toSource.subresourceRange.levelCount = 1;
+        toSource.subresourceRange.layerCount = 1;
+        toSource.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        toSource.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        VkImageMemoryBarrier toDestination = toSource;
+        toDestination.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        toDestination.image = target;
+        toDestination.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        VkImageMemoryBarrier toTransfer[] = {toSource, toDestination};
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, toTransfer);
+
+        VkImageCopy region{};
+        region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.srcSubresource.layerCount = 1;
+        region.dstSubresource = region.srcSubresource;
+        region.srcOffset = {std::max(0, -panShift.x), std::max(0, -panShift.y), 0};
+        region.dstOffset = {std::max(0, panShift.x), std::max(0, panShift.y), 0};
+        region.extent = {swapchainExtent.width - std::abs(panShift.x), swapchainExtent.height - std::abs(panShift.y), 1};
+        vkCmdCopyImage(commandBuffer, previous, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, target,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        VkImageMemoryBarrier toShader = toSource;
+        toShader.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        toShader.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        toShader.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        toShader.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        VkImageMemoryBarrier toAttachment = toDestination;
+        toAttachment.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        toAttachment.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        toAttachment.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toAttachment.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+        VkImageMemoryBarrier toDraw[] = {toShader, toAttachment};
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0,
+                             nullptr, 0, nullptr, 2, toDraw);
+    }
+
+    // The parts of the frame panShift uncovers: a column and a row strip (either may be empty)
+    std::vector<VkRect2D> exposedStrips() const {
+        int32_t width = static_cast<int32_t>(swapchainExtent.width);
+        int32_t height = static_cast<int32_t>(swapchainExtent.height);
+        std::vector<VkRect2D> strips;
+        if (panShift.x != 0) {
+            int32_t x = panShift.x > 0 ? 0 : width + panShift.x;
+            strips.push_back({{x, 0}, {static_cast<uint32_t>(std::abs(panShift.x)), swapchainExtent.height}});
+        }
+        if (panShift.y != 0) {
+            int32_t y = panShift.y > 0 ? 0 : height + panShift.y;
+            strips.push_back({{0, y}, {swapchainExtent.width, static_cast<uint32_t>(std::abs(panShift.y))}});
+        }
+        return strips;
+    }
+
+    // The view this frame's uniforms describe (after fillUniforms and updateDeepZoom)
+    PanView currentView() const {
+        PanView view;
+        view.pipeline = graphicsPipeline;
+        view.extent = swapchainExtent;
+        view.zoom = unclampedZoom;
+        view.focus[0] = referenceMouseX;
+        view.focus[1] = referenceMouseY;
+        view.orbitVersion = deepZoomActive ? deepZoom.version() : 0;
+        view.inputs = isfInputData;
+        if (uniformUseOf(graphicsPipeline).clock) {
+            view.time = currentTime;
+            view.frame = frameCount;
+        }
+        view.origin[0] = panOrigin[0];
+        view.origin[1] = panOrigin[1];
+        return view;
+    }
+
+    // Everything but the origin matches
+    static bool sameFraming(const PanView& a, const PanView& b) {
+        return a.pipeline == b.pipeline && a.extent.width == b.extent.width && a.extent.height == b.extent.height &&
+               a.zoom == b.zoom && a.focus[0] == b.focus[0] && a.focus[1] == b.focus[1] &&
+               a.orbitVersion == b.orbitVersion && a.inputs == b.inputs && a.time == b.time && a.frame == b.frame;
+    }
+
+    // Once per frame before recording: can this frame be the previous one shifted? Only for
+    // // @pancoherent shaders with the same pipeline, size, zoom, inputs, reference orbit and
+    // (if the shader reads it) time whose view moved by whole pixels, less than the frame
+    void updatePanReuse() {
+        PanView view = currentView();
+        double dx = view.origin[0] - previousView.origin[0];
+        double dy = view.origin[1] - previousView.origin[1];
+        panReuse = panCoherent && !recolorActive && sameFraming(view, previousView) && dx == std::round(dx) &&
+                   dy == std::round(dy) && std::abs(dx) < view.extent.width && std::abs(dy) < view.extent.height;
+        // Content moves with the origin; fragCoord is y-up, framebuffer rows go down
+        panShift = panReuse ? VkOffset2D{static_cast<int32_t>(dx), -static_cast<int32_t>(dy)} : VkOffset2D{0, 0};
+        previousView = std::move(view);
+    }
+
+    // Once per frame before recording: a // @recolor shader only re-runs iterate() (pass 0)
+    // when its view changed; palette animation redraws colorize() over the same iterations
+    void updateIterationReuse() {
+        if (!recolorActive) {
+            iterationsValid = false;
+            return;
+        }
+        PanView view = currentView();
+        view.time = 0.0;  // The colour pass animates; iterate() must not read the clock
+        view.frame = 0;
+        iterationsValid = sameFraming(view, iterationView) && view.origin[0] == iterationView.origin[0] &&
+                          view.origin[1] == iterationView.origin[1];
+        iterationView = std::move(view);
+    }
+
+    // Pipeline, viewport, descriptors and push constants for drawing the shader's quad
+    void bindShader(VkCommandBuffer commandBuffer, VkPipeline pipeline) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+
+        // The full-screen quad covers the whole image; a tile is the window of it at tileOrigin.
+        // Shaders that take fragCoord from iTileOrigin only need the tile itself.
+        VkExtent2D image = imageExtent();
+        VkViewport viewport{};
+        if (uniformUseOf(graphicsPipeline).tileOrigin) {
+            image = swapchainExtent;
+        } else {
+            viewport.x = static_cast<float>(-tileOrigin.x);
+            viewport.y = static_cast<float>(-tileOrigin.y);
+        }
+        viewport.width = static_cast<float>(image.width);
+        viewport.height = static_cast<float>(image.height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+        if (shaderInterface.pushConstantSize > 0) {
+            vkCmdPushConstants(commandBuffer, pipelineLayout, shaderInterface.pushConstantStages, 0,
+                               shaderInterface.pushConstantSize, isfInputData.data());
+        }
+    }
+
+    // // @recolor pass 0: iterate() into the iteration buffer (the render pass orders it
+    // between the previous frame's colour pass and this one's)
+    void recordIterationPass(VkCommandBuffer commandBuffer) {
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = iterationRenderPass;
+        renderPassInfo.framebuffer = iterationFramebuffer;
+        renderPassInfo.renderArea.offset = {0, 0};
+        renderPassInfo.renderArea.extent = swapchainExtent;
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        bindShader(commandBuffer, iterationPipelineFor(graphicsPipeline));
+        VkRect2D scissor = {{0, 0}, swapchainExtent};
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        vkCmdDraw(commandBuffer, 6, 1, 0, 0);
+        vkCmdEndRenderPass(commandBuffer);
+    }
+
+    // Uploads, then steps 1-3: the shader draws into the current feedback buffer, which ends
+    // up in SHADER_READ_ONLY layout. On a pan reuse only the exposed strips are drawn, over
+    // the shifted previous frame; a // @recolor shader first runs pass 0 unless its
+    // iterations are still valid.
+    void recordShaderPass(VkCommandBuffer commandBuffer) {
+        recordVideoUpload(commandBuffer);
+        recordAudioUpload(commandBuffer);
+        recordKeyboardUpload(commandBuffer);
+        if (recolorActive && !iterationsValid) {
+            recordIterationPass(commandBuffer);
+        }
+
+        int writeBuffer = currentFeedbackBuffer;
+        int readBuffer = 1 - currentFeedbackBuffer;
+
+        if (panReuse) {
+            recordPanShift(commandBuffer, feedbackImages[readBuffer], feedbackImages[writeBuffer]);
+        } else {
+            // === STEP 1: Transition feedback write buffer to COLOR_ATTACHMENT ===
+            VkImageMemoryBarrier barrier1{};
+            barrier1.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier1.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier1.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            barrier1.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier1.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier1.image = feedbackImages[writeBuffer];
+            barrier1.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier1.subresourceRange.baseMipLevel = 0;
+            barrier1.subresourceRange.levelCount = 1;
+            barrier1.subresourceRange.baseArrayLayer = 0;
+            barrier1.subresourceRange.layerCount = 1;
+            barrier1.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            barrier1.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+            vkCmdPipelineBarrier(commandBuffer,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                0, 0, nullptr, 0, nullptr, 1, &barrier1);
+        }
 
         // === STEP 2: Render to feedback buffer ===
         VkRenderPassBeginInfo renderPassInfo{};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass = renderPass;
+        renderPassInfo.renderPass = panReuse ? panRenderPass : renderPass;
         renderPassInfo.framebuffer = feedbackFramebuffers[writeBuffer];
         renderPassInfo.renderArea.offset = {0, 0};
         renderPassInfo.renderArea.extent = swapchainExtent;
@@ -1774,9 +5584,15 @@ private:
         renderPassInfo.pClearValues = &clearColor;
 
         vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
-        vkCmdDraw(commandBuffer, 6, 1, 0, 0);
+        bindShader(commandBuffer, graphicsPipeline);
+        std::vector<VkRect2D> scissors = {{{0, 0}, swapchainExtent}};
+        if (panReuse) {
+            scissors = exposedStrips();
+        }
+        for (const VkRect2D& scissor : scissors) {
+            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+            vkCmdDraw(commandBuffer, 6, 1, 0, 0);
+        }
         vkCmdEndRenderPass(commandBuffer);
 
         // === STEP 3: Transition feedback buffer back to SHADER_READ ===
@@ -1799,6 +5615,18 @@ private:
             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
             0, 0, nullptr, 0, nullptr, 1, &barrier2);
+    }
+
+    void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to begin recording command buffer!");
+        }
+
+        recordShaderPass(commandBuffer);
+        int writeBuffer = currentFeedbackBuffer;
 
         // === STEP 4: Transition feedback buffer to TRANSFER_SRC for blit ===
         VkImageMemoryBarrier barrier3{};
@@ -1857,6 +5685,8 @@ private:
             feedbackImages[writeBuffer], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
             swapchainImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
             1, &blit, VK_FILTER_NEAREST);
+        recordStreamCopy(commandBuffer, feedbackImages[writeBuffer]);
+        recordScreenshotCopy(commandBuffer, feedbackImages[writeBuffer]);
 
         // === STEP 6: Transition swapchain to PRESENT ===
         VkImageMemoryBarrier barrier5{};
@@ -1922,49 +5752,115 @@ private:
         }
     }
 
+    // Queued mouse events in arrival order: each move or button becomes a history sample and
+    // a step of the smoothing (scrolls were already applied by the callback)
+    void drainInputEvents(double tau) {
+        input_events::Event event;
+        while (inputEvents.pop(event)) {
+            if (event.kind == input_events::Kind::Scroll) {
+                continue;
+            }
+            if (event.kind == input_events::Kind::Button) {
+                uint32_t bit = input_events::buttonBit(event.button);
+                mouseButtons = event.pressed ? mouseButtons | bit : mouseButtons & ~bit;
+            }
+            mouseHistory.push({event.timestamp, event.x, event.y, mouseButtons});
+            mouseSmoother.sample(event.x, event.y, event.timestamp, tau);
+        }
+    }
+
+    // Wait for this frame's fence, polling events meanwhile, so the mouse callbacks (and the
+    // timestamps of iMouseHistory) come every INPUT_POLL_NANOS rather than once per frame.
+    // Nothing of the frame is recorded yet, so the callbacks may do what they do in mainLoop.
+    void waitForFrameFence() {
+        while (vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, INPUT_POLL_NANOS) == VK_TIMEOUT) {
+            glfwPollEvents();
+        }
+    }
+
     void updateUniformBuffer() {
-        auto currentTime = std::chrono::steady_clock::now();
-        float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
-        static float lastTime = 0.0f;
-        float deltaTime = time - lastTime;
-        lastTime = time;
+        UniformBufferObject ubo{};
+        fillUniforms(ubo);
+        writeUniforms(ubo);
+    }
+
+    // Into this frame's slot (its previous use has finished)
+    void writeUniforms(const UniformBufferObject& ubo) {
+        memcpy(static_cast<char*>(uniformBufferMapped) + uniformSlotSize * currentFrame, &ubo, sizeof(ubo));
+    }
+
+    // fragCoord of the framebuffer's top-left pixel corner: (0, height), or a --render tile's
+    void fillTileOrigin(UniformBufferObject& ubo) const {
+        ubo.iTileOrigin[0] = static_cast<float>(tileOrigin.x);
+        ubo.iTileOrigin[1] = static_cast<float>(static_cast<int64_t>(imageExtent().height) - tileOrigin.y);
+    }
+
+    // Size of the image the shader renders: the framebuffer, or the whole --render image
+    VkExtent2D imageExtent() const {
+        return virtualExtent.width > 0 ? virtualExtent : swapchainExtent;
+    }
+
+    // iTime as the clock runs: seconds since startTime, or frames at --fixed-step, moved by
+    // the control server's "time" command
+    double clockSeconds() const {
+        double seconds = fixedTimeStep > 0.0
+                             ? frameCount * fixedTimeStep
+                             : std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return seconds + timeShift;
+    }
+
+    // This frame's uniform values (advances iFrame and the mouse smoothing)
+    void fillUniforms(UniformBufferObject& ubo) {
+        float time = static_cast<float>(clockSeconds());
+        if (timeOverride >= 0.0) {
+            time = static_cast<float>(timeOverride);
+        }
+        float deltaTime = frameCount == 0 ? 0.0f : time - lastFrameTime;
+        lastFrameTime = time;
+        if (deltaTime > 0.0f) {
+            frameRate += (1.0f / deltaTime - frameRate) * 0.1f;
+        }
 
         // Store current time for reset functionality
         this->currentTime = time;
 
-        UniformBufferObject ubo{};
-        ubo.iResolution[0] = static_cast<float>(swapchainExtent.width);
-        ubo.iResolution[1] = static_cast<float>(swapchainExtent.height);
+        VkExtent2D image = imageExtent();
+        ubo.iResolution[0] = static_cast<float>(image.width);
+        ubo.iResolution[1] = static_cast<float>(image.height);
         ubo.iResolution[2] = 1.0f;
         ubo.iTime = time;
+        fillTileOrigin(ubo);
 
         // Get window size to calculate framebuffer scale (for Retina displays)
-        int windowWidth, windowHeight;
-        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        int windowWidth = static_cast<int>(swapchainExtent.width);
+        int windowHeight = static_cast<int>(swapchainExtent.height);
+        if (window) {
+            glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        }
         scaleX = static_cast<float>(swapchainExtent.width) / static_cast<float>(windowWidth);
         scaleY = static_cast<float>(swapchainExtent.height) / static_cast<float>(windowHeight);
 
         // Cache values for use in callbacks
         cachedWindowWidth = windowWidth;
         cachedWindowHeight = windowHeight;
-        aspect = static_cast<float>(swapchainExtent.width) / static_cast<float>(swapchainExtent.height);
+        aspect = static_cast<float>(image.width) / static_cast<float>(image.height);
 
         // Mouse smoothing: reduce jitter at high zoom levels
-        // Use zoom-based dampening: lerp_factor = 1 / zoom^power
-        float lerpFactor = 1.0f / powf(currentZoom, 1.2f);
-        lerpFactor = std::max(0.0001f, std::min(1.0f, lerpFactor));
-        float smoothSpeed = lerpFactor * deltaTime * 60.0f * 0.5f;  // 2x slower, frame-rate independent
-        smoothSpeed = std::min(smoothSpeed, 1.0f);
-
-        mouseSmoothedX += (mouseX - mouseSmoothedX) * smoothSpeed;
-        mouseSmoothedY += (mouseY - mouseSmoothedY) * smoothSpeed;
+        // Use zoom-based dampening: lerp_factor = 1 / zoom^power, as a time constant that
+        // moves the same way as lerping by lerp_factor / 2 every 60th of a second. The filter
+        // steps through each timestamped cursor sample, then up to now.
+        double lerpFactor = std::max(0.0001, std::min(1.0, 1.0 / std::pow(currentZoom, 1.2)));
+        double tau = -1.0 / (60.0 * std::log(1.0 - lerpFactor * 0.5));
+        drainInputEvents(tau);
+        double now = inputNow();
+        mouseSmoother.advance(now, tau);
 
         // ShaderToy mouse convention:
         // xy = current mouse position (or click position)
         // zw = click position (negative if mouse button is up)
         // Scale mouse coordinates to match framebuffer coordinates (use smoothed position)
-        float scaledMouseX = static_cast<float>(mouseSmoothedX) * scaleX;
-        float scaledMouseY = static_cast<float>(mouseSmoothedY) * scaleY;
+        float scaledMouseX = static_cast<float>(mouseSmoother.x()) * scaleX;
+        float scaledMouseY = static_cast<float>(mouseSmoother.y()) * scaleY;
         float scaledClickX = static_cast<float>(mouseClickX) * scaleX;
         float scaledClickY = static_cast<float>(mouseClickY) * scaleY;
 
@@ -1980,6 +5876,18 @@ private:
             ubo.iMouse[3] = -scaledClickY;
         }
 
+        // Cursor samples, newest first, unsmoothed: position like iMouse, age, buttons
+        static_assert(sizeof(ubo.iMouseHistory) / sizeof(ubo.iMouseHistory[0]) == input_events::HISTORY_SIZE,
+                      "iMouseHistory length");
+        for (uint32_t i = 0; i < mouseHistory.size(); i++) {
+            const input_events::Sample& sample = mouseHistory.at(i);
+            ubo.iMouseHistory[i][0] = static_cast<float>(sample.x) * scaleX;
+            ubo.iMouseHistory[i][1] = static_cast<float>(sample.y) * scaleY;
+            ubo.iMouseHistory[i][2] = static_cast<float>(now - sample.timestamp);
+            ubo.iMouseHistory[i][3] = static_cast<float>(sample.buttons);
+        }
+        ubo.iMouseHistoryCount = static_cast<int32_t>(mouseHistory.takeArrived());
+
         // Pass scroll offset for shaders to use as they wish
         // For auto-zoom: iScroll.x = reference mouse X (normalized), iScroll.y = time offset
         ubo.iScroll[0] = static_cast<float>(referenceMouseX) / windowWidth;
@@ -1991,13 +5899,14 @@ private:
             // Auto-zoom mode: zoom = exp((time - scroll_y) * ZOOM_SPEED)
             const float ZOOM_SPEED = 0.15f;
             float effectiveTime = time - scrollY;
-            currentZoom = exp(effectiveTime * ZOOM_SPEED);
+            unclampedZoom = std::exp(static_cast<double>(effectiveTime) * ZOOM_SPEED);
         } else {
             // Manual zoom mode: zoom = sqrt(exp(scroll_y * 0.1))
             // Matches mandelbrot_simple.frag and other manual shaders
-            currentZoom = sqrt(exp(scrollY * 0.1f));
+            // (as exp(scroll_y * 0.05), which deep zoom scroll ranges don't overflow)
+            unclampedZoom = std::exp(static_cast<double>(scrollY) * 0.05);
         }
-        currentZoom = std::max(0.01f, std::min(1e10f, currentZoom));
+        currentZoom = static_cast<float>(viewZoom());
 
         // Zoom-at-cursor: NOW HANDLED IN SHADER (see mandelbrot_simple.frag)
         // (C++ adjustment removed - shader does: center += (mouse - 0.5) * 3.0 * (z-1)/z)
@@ -2031,8 +5940,24 @@ private:
         //
         // Wait that's what I have! The formula is correct...
         // Let me just remove aspect correction and see if that fixes it:
-        float panOffsetX = -basePanX * swapchainExtent.width * currentZoom / 3.0f;
-        float panOffsetY = -basePanY * swapchainExtent.height * currentZoom / 3.0f;
+        double panX = basePanX, panY = basePanY;
+        if ((panCoherent || recolorActive) && mouseLeftPressed && draggedPoint < 0) {
+            // The drag in progress moves the view through iPan (for pan-coherent shaders in
+            // whole pixels, so every frame is the previous one shifted); the shader mustn't
+            // add the iMouse drag itself
+            double dragPanX, dragPanY;
+            dragPan(dragPanX, dragPanY);
+            panX += dragPanX;
+            panY += dragPanY;
+        }
+        double panOffsetX = -panX * image.width * viewZoom() / 3.0;
+        double panOffsetY = -panY * image.height * viewZoom() / 3.0;
+        if (panCoherent) {
+            panOffsetX = std::round(panOffsetX);
+            panOffsetY = std::round(panOffsetY);
+        }
+        panOrigin[0] = panOffsetX;
+        panOrigin[1] = panOffsetY;
 
         // Update button press durations (accumulate while pressed, keep value after release)
         if (mouseLeftPressed) buttonPressDuration[0] += deltaTime;
@@ -2050,14 +5975,89 @@ private:
         ubo.iButton5 = buttonPressDuration[4];
 
         // Pass pan offset (accumulated drag distance in pixels)
-        ubo.iPan[0] = panOffsetX;
-        ubo.iPan[1] = panOffsetY;
+        df64::split(panOffsetX, ubo.iPan[0], ubo.iPanLo[0]);
+        df64::split(panOffsetY, ubo.iPan[1], ubo.iPanLo[1]);
+        df64::split(referenceMouseX / windowWidth, ubo.iZoomCenter[0], ubo.iZoomCenter[2]);
+        df64::split(referenceMouseY / windowHeight, ubo.iZoomCenter[1], ubo.iZoomCenter[3]);
+
+        ubo.iTimeDelta = deltaTime;
+        ubo.iFrame = frameCount++;
+        ubo.iFrameRate = fixedTimeStep > 0.0 ? static_cast<float>(1.0 / fixedTimeStep) : frameRate;
+        ubo.iSampleRate = audioActive ? static_cast<float>(audioAnalyzer.rate()) : 44100.0f;
+        fillDate(ubo.iDate);
+        if (replaying) {
+            // A replay renders the same frames whenever it runs
+            ubo.iDate[0] = 2000.0f;
+            ubo.iDate[1] = 0.0f;
+            ubo.iDate[2] = 1.0f;
+            ubo.iDate[3] = time;
+        }
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            channelResolution(i, ubo.iChannelResolution[i]);
+        }
+    }
+
+    // ShaderToy iDate: year, month (0-11), day of month, seconds since local midnight
+    static void fillDate(float date[4]) {
+        auto now = std::chrono::system_clock::now();
+        time_t seconds = std::chrono::system_clock::to_time_t(now);
+        struct tm local;
+        localtime_r(&seconds, &local);
+        double fraction = std::chrono::duration<double>(now.time_since_epoch()).count() - static_cast<double>(seconds);
+        date[0] = static_cast<float>(local.tm_year + 1900);
+        date[1] = static_cast<float>(local.tm_mon);
+        date[2] = static_cast<float>(local.tm_mday);
+        date[3] = static_cast<float>(local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec + fraction);
+    }
 
-        memcpy(uniformBufferMapped, &ubo, sizeof(ubo));
+    // Width, height, depth of whatever is bound to an iChannel
+    void channelResolution(int channel, float resolution[4]) {
+        uint32_t size[3] = {static_cast<uint32_t>(textureWidth), static_cast<uint32_t>(textureHeight), 1};
+        switch (channelSources[channel].kind) {
+            case ChannelKind::Feedback:
+                size[0] = swapchainExtent.width;
+                size[1] = swapchainExtent.height;
+                break;
+            case ChannelKind::Video:
+                if (videoActive && channel == videoChannel) {
+                    size[0] = videoDecoder.width();
+                    size[1] = videoDecoder.height();
+                }
+                break;
+            case ChannelKind::Audio:
+                if (audioActive && channel == audioChannel) {
+                    size[0] = audioImage.width;
+                    size[1] = audioImage.height;
+                }
+                break;
+            case ChannelKind::Keyboard:
+                if (keyboardActive && channel == keyboardChannel) {
+                    size[0] = keyboardImage.width;
+                    size[1] = keyboardImage.height;
+                }
+                break;
+            case ChannelKind::Cube:
+            case ChannelKind::Volume:
+                size[0] = channelExtents[channel][0];
+                size[1] = channelExtents[channel][1];
+                size[2] = channelExtents[channel][2];
+                break;
+            case ChannelKind::Texture:
+                break;
+        }
+        resolution[0] = static_cast<float>(size[0]);
+        resolution[1] = static_cast<float>(size[1]);
+        resolution[2] = static_cast<float>(size[2]);
+        resolution[3] = 0.0f;
     }
 
     void drawFrame() {
-        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        waitForFrameFence();
+        collectStreamFrame();
+        collectScreenshot();
+        releaseRetiredPipelines();
+        releaseVideoUpload();
+        recordKeyboardLatency();
 
         uint32_t imageIndex;
         VkResult result = vkAcquireNextImageKHR(device, swapchain, UINT64_MAX,
@@ -2067,8 +6067,16 @@ private:
             throw std::runtime_error("Failed to acquire swapchain image!");
         }
 
+        recordFrame();               // --record: this frame's trace line, after its input
         updateUniformBuffer();
+        updateInputs();              // ISF input values for push constants / their uniform block
+        updateDeepZoom();            // View and reference orbit of // @deepzoom shaders
+        updatePanReuse();            // Pure pan of a // @pancoherent shader: shift, draw the strips
+        updateIterationReuse();      // // @recolor: skip pass 0 while the view stays put
         updateFeedbackDescriptor();  // Update which feedback buffer to read from
+        updateVideoChannel();        // Pick the video frame due at iTime (never waits on the decoder)
+        updateAudioChannel();        // Latest spectrum from the analyzer thread, if a new one is ready
+        updateKeyboardChannel();     // Drain queued key events into the keyboard texture
 
         vkResetFences(device, 1, &inFlightFences[currentFrame]);
 
@@ -2117,14 +6125,36 @@ private:
         std::cout << "  Scroll wheel - Shader-specific (typically zoom)" << std::endl;
         std::cout << "  R - Reset scroll offset" << std::endl;
         std::cout << "  ← → - Switch shaders" << std::endl;
+        std::cout << "  Tab / ↑ ↓ - Select / adjust // @param values and ISF inputs" << std::endl;
+        std::cout << "  Shift+drag - Move an ISF point2D input" << std::endl;
         std::cout << "  F or F11 - Toggle fullscreen" << std::endl;
         std::cout << "  ESC - Exit" << std::endl;
+        std::cout << "  (saving the shader, its #includes or textures reloads them)" << std::endl;
 
+        watchShaderFiles();
+        updateOverlay();
+        if (!recordPath.empty()) {
+            startRecording();
+        }
+        if (!controlAddress.empty()) {
+            startControlServer();
+        }
         while (!glfwWindowShouldClose(window)) {
             glfwPollEvents();
+            checkHotReload();
+            runControlCommands();
             drawFrame();
         }
+        controlServer.stop();
+        stopRecording();
+        shaderWatcher.stop();
+        waitForReload();
         vkDeviceWaitIdle(device);
+        for (const auto& retired : retiredPipelines) {
+            destroyShaderPipeline(retired.first);
+        }
+        retiredPipelines.clear();
+        destroyPipelineVariants();
     }
 
     void cleanup() {
@@ -2140,22 +6170,59 @@ private:
             vkDestroyFramebuffer(device, framebuffer, nullptr);
         }
 
-        vkDestroyPipeline(device, graphicsPipeline, nullptr);
-        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        vkDestroyPipelineCache(device, pipelineCache, nullptr);
         vkDestroyRenderPass(device, renderPass, nullptr);
+        vkDestroyRenderPass(device, panRenderPass, nullptr);
+        vkDestroyRenderPass(device, iterationRenderPass, nullptr);
 
         for (auto imageView : swapchainImageViews) {
             vkDestroyImageView(device, imageView, nullptr);
         }
 
-        vkDestroySwapchainKHR(device, swapchain, nullptr);
+        if (surface != VK_NULL_HANDLE) {
+            vkDestroySwapchainKHR(device, swapchain, nullptr);
+        }
+        if (timestampPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(device, timestampPool, nullptr);
+        }
+        if (servePort != 0) {
+            frameServer.stop();  // Finishes the frames the encoders hold
+            std::cout << "✓ Streamed " << frameServer.framesSent() << " frames, " << frameServer.framesDropped()
+                      << " dropped for slow clients" << std::endl;
+        }
+        for (int i = 0; i < STREAM_SLOTS; i++) {
+            if (streamBuffers[i] != VK_NULL_HANDLE) {
+                vkDestroyBuffer(device, streamBuffers[i], nullptr);
+                vkFreeMemory(device, streamMemories[i], nullptr);
+                streamBuffers[i] = VK_NULL_HANDLE;
+            }
+        }
+        destroyScreenshotBuffer();
+        for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            if (readbackBuffers[i] != VK_NULL_HANDLE) {
+                vkDestroyBuffer(device, readbackBuffers[i], nullptr);
+                vkFreeMemory(device, readbackMemories[i], nullptr);
+                readbackBuffers[i] = VK_NULL_HANDLE;
+            }
+        }
 
         vkDestroyBuffer(device, uniformBuffer, nullptr);
         vkFreeMemory(device, uniformBufferMemory, nullptr);
+        for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            vkDestroyBuffer(device, inputsBuffers[i], nullptr);
+            vkFreeMemory(device, inputsBufferMemories[i], nullptr);
+            vkDestroyBuffer(device, orbitBuffers[i], nullptr);
+            vkFreeMemory(device, orbitBufferMemories[i], nullptr);
+        }
+        deepZoom.stop();
 
         vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+        destroyLayoutCache();
 
+        destroyVideoChannel();
+        destroyAudioChannel();
+        destroyKeyboardChannel();
+        destroyImageChannels();
         vkDestroySampler(device, textureSampler, nullptr);
         vkDestroyImageView(device, textureImageView, nullptr);
         vkDestroyImage(device, textureImage, nullptr);
@@ -2168,25 +6235,230 @@ private:
             vkDestroyImage(device, feedbackImages[i], nullptr);
             vkFreeMemory(device, feedbackImageMemories[i], nullptr);
         }
+        vkDestroyFramebuffer(device, iterationFramebuffer, nullptr);
+        vkDestroyImageView(device, iterationImageView, nullptr);
+        vkDestroyImage(device, iterationImage, nullptr);
+        vkFreeMemory(device, iterationImageMemory, nullptr);
 
         vkDestroyDevice(device, nullptr);
-        vkDestroySurfaceKHR(instance, surface, nullptr);
+        if (surface != VK_NULL_HANDLE) {
+            vkDestroySurfaceKHR(instance, surface, nullptr);
+        }
         vkDestroyInstance(instance, nullptr);
 
-        glfwDestroyWindow(window);
-        glfwTerminate();
+        if (window) {
+            glfwDestroyWindow(window);
+            glfwTerminate();
+        }
     }
 };
 
 int main(int argc, char* argv[]) {
     MetalshadeViewer app;
-    try {
-        // Check if a shader path was provided as command-line argument
-        if (argc > 1) {
-            app.run(argv[1]);
+    std::string shaderPath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--fixed-step" && i + 1 < argc) {
+            app.setFixedStep(atof(argv[++i]));
+        } else if (arg == "--opt" && i + 1 < argc) {
+            std::string level = argv[++i];
+            app.setOptimization(level == "Os" || level == "-Os" ? spirv_optimizer::Level::Size
+                                                                : spirv_optimizer::Level::Performance);
+        } else if (arg == "--serve" && i + 1 < argc) {
+            int port = atoi(argv[++i]);
+            if (port <= 0 || port > 65535) {
+                std::cerr << "Error: --serve expects a port like 8080" << std::endl;
+                return EXIT_FAILURE;
+            }
+            app.setServePort(static_cast<uint16_t>(port));
+        } else if (arg == "--control" && i + 1 < argc) {
+            app.setControlAddress(argv[++i]);
+        } else if (arg == "--record" && i + 1 < argc) {
+            app.setRecordPath(argv[++i]);
+        } else if (arg == "--encode" && i + 2 < argc) {
+            std::string output = argv[i + 1];
+            std::string shader = argv[i + 2];
+            unsigned width = WIDTH, height = HEIGHT;
+            int fps = 60;
+            double duration = 10.0;
+            int64_t frames = -1;
+            std::string codec;
+            for (i += 3; i < argc; i++) {
+                std::string option = argv[i];
+                if (option == "--size" && i + 1 < argc) {
+                    if (sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0 ||
+                        width % 2 || height % 2) {
+                        std::cerr << "Error: --size expects an even size like 1920x1080" << std::endl;
+                        return EXIT_FAILURE;
+                    }
+                } else if (option == "--fps" && i + 1 < argc) {
+                    fps = std::max(1, atoi(argv[++i]));
+                } else if (option == "--duration" && i + 1 < argc) {
+                    duration = atof(argv[++i]);
+                } else if (option == "--frames" && i + 1 < argc) {
+                    frames = std::max(1, atoi(argv[++i]));
+                } else if (option == "--codec" && i + 1 < argc) {
+                    codec = argv[++i];
+                }
+            }
+            if (frames < 0) {
+                frames = std::max<int64_t>(1, static_cast<int64_t>(std::llround(duration * fps)));
+            }
+            try {
+                return app.encodeVideo(shader, output, width, height, fps, static_cast<uint64_t>(frames), codec);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--replay" && i + 1 < argc) {
+            std::string trace = argv[++i];
+            std::string report;
+            for (i++; i < argc; i++) {
+                std::string option = argv[i];
+                if (option == "--report" && i + 1 < argc) {
+                    report = argv[++i];
+                }
+            }
+            try {
+                return app.replayTrace(trace, report);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--analyze" && i + 1 < argc) {
+            std::string target = argv[++i];
+            int timeFrames = 0;
+            std::string report;
+            for (i++; i < argc; i++) {
+                std::string option = argv[i];
+                if (option == "--time") {
+                    timeFrames = i + 1 < argc && isdigit(argv[i + 1][0]) ? std::max(1, atoi(argv[++i])) : 60;
+                } else if (option == "--report" && i + 1 < argc) {
+                    report = argv[++i];
+                }
+            }
+            try {
+                return app.analyzeShaders(target, timeFrames, report);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--compare-opt" && i + 1 < argc) {
+            std::string shader = argv[++i];
+            int frames = 100;
+            if (i + 2 < argc && std::string(argv[i + 1]) == "--frames") {
+                frames = std::max(1, atoi(argv[i + 2]));
+                i += 2;
+            }
+            try {
+                return app.compareOptimization(shader, frames);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--cpu" && i + 1 < argc) {
+            std::string shader = argv[++i];
+            int frames = 10;
+            bool compare = false;
+            for (i++; i < argc; i++) {
+                std::string option = argv[i];
+                if (option == "--frames" && i + 1 < argc) {
+                    frames = std::max(1, atoi(argv[++i]));
+                } else if (option == "--compare") {
+                    compare = true;
+                }
+            }
+            try {
+                return app.renderOnCpu(shader, frames, compare);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--render" && i + 2 < argc) {
+            unsigned width = 0, height = 0;
+            if (sscanf(argv[i + 1], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                std::cerr << "Error: --render expects a size like 16384x16384" << std::endl;
+                return EXIT_FAILURE;
+            }
+            std::string shader = argv[i + 2];
+            std::string output;
+            double time = 0.0;
+            uint32_t tile = 1024;
+            for (i += 3; i < argc; i++) {
+                std::string option = argv[i];
+                if (option == "--out" && i + 1 < argc) {
+                    output = argv[++i];
+                } else if (option == "--time" && i + 1 < argc) {
+                    time = atof(argv[++i]);
+                } else if (option == "--tile" && i + 1 < argc) {
+                    tile = static_cast<uint32_t>(std::max(16, atoi(argv[++i])));
+                }
+            }
+            try {
+                return app.renderTiled(shader, width, height, time, tile, output);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--convert" && i + 1 < argc) {
+            std::string input = argv[++i];
+            std::string output = i + 1 < argc && argv[i + 1][0] != '-' ? argv[++i] : "";
+            return app.convertOnly(input, output);
+        } else if (arg == "--convert-check" && i + 2 < argc) {
+            bool update = i + 3 < argc && std::string(argv[i + 3]) == "--update";
+            return app.checkConversions(argv[i + 1], argv[i + 2], update);
+        } else if (arg == "--golden" && i + 2 < argc) {
+            std::string corpus = argv[i + 1];
+            std::string golden = argv[i + 2];
+            bool update = false;
+            double minSsim = 0.99;
+            std::string diffs;
+            for (i += 3; i < argc; i++) {
+                std::string option = argv[i];
+                if (option == "--update") {
+                    update = true;
+                } else if (option == "--ssim" && i + 1 < argc) {
+                    minSsim = atof(argv[++i]);
+                } else if (option == "--diffs" && i + 1 < argc) {
+                    diffs = argv[++i];
+                }
+            }
+            try {
+                return app.checkGoldenImages(corpus, golden, update, minSsim, diffs);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--validate" && i + 1 < argc) {
+            std::string corpus = argv[++i];
+            bool pipelines = false;
+            std::string report;
+            for (i++; i < argc; i++) {
+                std::string option = argv[i];
+                if (option == "--pipelines") {
+                    pipelines = true;
+                } else if (option == "--report" && i + 1 < argc) {
+                    report = argv[++i];
+                }
+            }
+            try {
+                return app.validateCorpus(corpus, pipelines, report);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--print-uniforms") {
+            // Source of uniforms.glsl, used by convert.py and import
+            std::cout << "// Generated from uniforms.h by `metalshade --print-uniforms` - do not edit\n"
+                      << uniformBlockGLSL();
+            return EXIT_SUCCESS;
         } else {
-            app.run();
+            shaderPath = arg;
         }
+    }
+
+    try {
+        app.run(shaderPath);
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return EXIT_FAILURE;
@@ -0,0 +1,213 @@
+// png_writer.h - Streaming PNG writer: rows are written as they arrive
+//
+// For --render output too large to hold in memory: the caller appends rows top to bottom and
+// only the previous row (for filtering) and one chunk of compressed data are kept. Rows are
+// Paeth-filtered and deflated with zlib when the build found it (HAVE_ZLIB); otherwise the
+// data goes into stored (uncompressed) deflate blocks, which is still a valid PNG.
+// 8-bit RGBA only.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace png_writer {
+
+constexpr size_t CHUNK_SIZE = 1 << 18;  // Compressed bytes per IDAT chunk
+
+struct CrcTable {
+    uint32_t entries[256];
+
+    CrcTable() {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[n] = c;
+        }
+    }
+};
+
+inline uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) {
+    static const CrcTable crcTable;  // Built once, safely, when writers run on several threads
+    const uint32_t* table = crcTable.entries;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+class Writer {
+public:
+    ~Writer() {
+        if (file) {
+            fclose(file);
+        }
+#ifdef HAVE_ZLIB
+        if (deflating) {
+            deflateEnd(&stream);
+        }
+#endif
+    }
+
+    bool open(const std::string& path, uint32_t imageWidth, uint32_t imageHeight, std::string& error) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) {
+            error = "cannot create " + path;
+            return false;
+        }
+        width = imageWidth;
+        height = imageHeight;
+        previous.assign(static_cast<size_t>(width) * 4, 0);
+        filtered.resize(static_cast<size_t>(width) * 4 + 1);
+
+        static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        fwrite(signature, 1, sizeof(signature), file);
+        uint8_t header[13];
+        put32(header, width);
+        put32(header + 4, height);
+        header[8] = 8;   // Bit depth
+        header[9] = 6;   // RGBA
+        header[10] = 0;  // Deflate
+        header[11] = 0;  // Adaptive filtering
+        header[12] = 0;  // No interlace
+        chunk("IHDR", header, sizeof(header));
+
+#ifdef HAVE_ZLIB
+        stream = z_stream{};
+        if (deflateInit(&stream, 6) != Z_OK) {
+            error = "deflateInit failed";
+            return false;
+        }
+        deflating = true;
+#else
+        const uint8_t zlibHeader[2] = {0x78, 0x01};
+        pending.insert(pending.end(), zlibHeader, zlibHeader + 2);
+#endif
+        return !ferror(file);
+    }
+
+    // Append rows of RGBA8 pixels (top row first)
+    bool writeRows(const uint8_t* rgba, uint32_t rows) {
+        size_t stride = static_cast<size_t>(width) * 4;
+        for (uint32_t r = 0; r < rows && written < height; r++, written++) {
+            const uint8_t* row = rgba + r * stride;
+            filtered[0] = 4;  // Paeth
+            for (size_t i = 0; i < stride; i++) {
+                int a = i >= 4 ? row[i - 4] : 0;
+                int b = previous[i];
+                int c = i >= 4 ? previous[i - 4] : 0;
+                int p = a + b - c;
+                int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+                int predictor = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+                filtered[i + 1] = static_cast<uint8_t>(row[i] - predictor);
+            }
+            previous.assign(row, row + stride);
+            compress(filtered.data(), filtered.size(), false);
+        }
+        return !ferror(file);
+    }
+
+    // Finish the image; every row must have been written
+    bool close() {
+        if (!file) {
+            return false;
+        }
+        compress(nullptr, 0, true);
+        if (!pending.empty()) {
+            chunk("IDAT", pending.data(), pending.size());
+        }
+        chunk("IEND", nullptr, 0);
+        bool ok = written == height && !ferror(file);
+        ok = fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+private:
+    static void put32(uint8_t* out, uint32_t value) {
+        out[0] = static_cast<uint8_t>(value >> 24);
+        out[1] = static_cast<uint8_t>(value >> 16);
+        out[2] = static_cast<uint8_t>(value >> 8);
+        out[3] = static_cast<uint8_t>(value);
+    }
+
+    void chunk(const char* type, const uint8_t* data, size_t size) {
+        uint8_t header[8];
+        put32(header, static_cast<uint32_t>(size));
+        memcpy(header + 4, type, 4);
+        uint32_t crc = crc32(crc32(0, header + 4, 4), data, size);
+        uint8_t trailer[4];
+        put32(trailer, crc);
+        fwrite(header, 1, 8, file);
+        if (size > 0) fwrite(data, 1, size, file);
+        fwrite(trailer, 1, 4, file);
+    }
+
+    void flushPending(bool all) {
+        while (pending.size() >= CHUNK_SIZE || (all && !pending.empty())) {
+            size_t size = std::min(pending.size(), CHUNK_SIZE);
+            chunk("IDAT", pending.data(), size);
+            pending.erase(pending.begin(), pending.begin() + size);
+        }
+    }
+
+    void compress(const uint8_t* data, size_t size, bool finish) {
+#ifdef HAVE_ZLIB
+        uint8_t out[1 << 16];
+        stream.next_in = const_cast<Bytef*>(data);
+        stream.avail_in = static_cast<uInt>(size);
+        int result;
+        do {
+            stream.next_out = out;
+            stream.avail_out = sizeof(out);
+            result = deflate(&stream, finish ? Z_FINISH : Z_NO_FLUSH);
+            pending.insert(pending.end(), out, out + (sizeof(out) - stream.avail_out));
+        } while (stream.avail_out == 0 || (finish && result == Z_OK));
+#else
+        // Stored blocks of up to 65535 bytes, then the Adler-32 of the uncompressed data
+        for (size_t at = 0; at < size;) {
+            uint16_t length = static_cast<uint16_t>(std::min<size_t>(size - at, 65535));
+            const uint8_t header[5] = {0, static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8),
+                                       static_cast<uint8_t>(~length), static_cast<uint8_t>(~length >> 8)};
+            pending.insert(pending.end(), header, header + 5);
+            pending.insert(pending.end(), data + at, data + at + length);
+            for (size_t i = at; i < at + length; i++) {
+                adlerA = (adlerA + data[i]) % 65521;
+                adlerB = (adlerB + adlerA) % 65521;
+            }
+            at += length;
+        }
+        if (finish) {
+            const uint8_t last[5] = {1, 0, 0, 0xff, 0xff};
+            pending.insert(pending.end(), last, last + 5);
+            uint8_t adler[4];
+            put32(adler, (adlerB << 16) | adlerA);
+            pending.insert(pending.end(), adler, adler + 4);
+        }
+#endif
+        flushPending(false);
+    }
+
+    FILE* file = nullptr;
+    uint32_t width = 0, height = 0, written = 0;
+    std::vector<uint8_t> previous, filtered, pending;
+#ifdef HAVE_ZLIB
+    z_stream stream;
+    bool deflating = false;
+#else
+    uint32_t adlerA = 1, adlerB = 0;
+#endif
+};
+
+}  // namespace png_writer
@@ -0,0 +1,124 @@
+// shader_params.h - Compile-time shader parameters declared with // @param
+//
+//   // @param ITER int 64 [16..512]
+//   // @param STEP float 0.01 [0.001..0.1]
+//   // @param AA bool false
+//
+// The converter turns each into a specialization constant (constant_id = declaration order)
+// replacing any `#define ITER ...` or global `const int ITER = ...;`, so the viewer can build
+// pipeline variants with other values without running glslang again. Without a range, ints
+// get [1..4x default] and floats [0..2x default] ([0..1] for a default of 0).
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace shader_params {
+
+enum class Type { Int, Float, Bool };
+
+struct Param {
+    std::string name;
+    Type type = Type::Int;
+    double value = 0.0;  // Current value (the default after parsing)
+    double min = 0.0;
+    double max = 1.0;
+    uint32_t constantId = 0;
+
+    // Quality knobs are mostly powers of two apart, so ints step by ~1/16 of the range
+    double step() const {
+        if (type == Type::Bool) return 1.0;
+        if (type == Type::Int) return std::max(1.0, std::floor((max - min) / 16.0));
+        return (max - min) / 32.0;
+    }
+
+    void adjust(int direction) {
+        value = type == Type::Bool ? (value != 0.0 ? 0.0 : 1.0)
+                                   : std::min(max, std::max(min, value + direction * step()));
+    }
+
+    // 32-bit specialization constant data
+    uint32_t bits() const {
+        if (type == Type::Float) {
+            float f = static_cast<float>(value);
+            uint32_t word;
+            memcpy(&word, &f, sizeof(word));
+            return word;
+        }
+        return static_cast<uint32_t>(static_cast<int32_t>(std::lround(value)));
+    }
+
+    std::string valueText() const {
+        if (type == Type::Bool) return value != 0.0 ? "true" : "false";
+        if (type == Type::Int) return std::to_string(std::lround(value));
+        std::ostringstream text;
+        text << value;
+        std::string s = text.str();
+        return s.find_first_of(".e") == std::string::npos ? s + ".0" : s;
+    }
+
+    std::string declaration() const {
+        static const char* typeNames[] = {"int", "float", "bool"};
+        return "layout(constant_id = " + std::to_string(constantId) + ") const " +
+               typeNames[static_cast<int>(type)] + " " + name + " = " + valueText() + ";";
+    }
+};
+
+inline std::vector<Param> parse(const std::string& source) {
+    std::vector<Param> params;
+    std::istringstream lines(source);
+    std::string line;
+    while (std::getline(lines, line)) {
+        size_t at = line.find("// @param ");
+        if (at == std::string::npos) {
+            continue;
+        }
+        std::istringstream fields(line.substr(at + 10));
+        Param param;
+        std::string type, value, range;
+        if (!(fields >> param.name >> type >> value)) {
+            continue;
+        }
+        if (type == "int") {
+            param.type = Type::Int;
+        } else if (type == "float") {
+            param.type = Type::Float;
+        } else if (type == "bool") {
+            param.type = Type::Bool;
+        } else {
+            continue;
+        }
+        param.value = param.type == Type::Bool ? (value == "true" || value == "1") : atof(value.c_str());
+        param.min = param.type == Type::Int ? 1.0 : 0.0;
+        if (param.type == Type::Int) {
+            param.max = std::max(param.min + 1.0, param.value * 4.0);
+        } else if (param.type == Type::Float) {
+            param.max = param.value > 0.0 ? param.value * 2.0 : 1.0;
+        }
+        size_t dots;
+        if (fields >> range && range.size() > 4 && range.front() == '[' && range.back() == ']' &&
+            (dots = range.find("..")) != std::string::npos) {
+            param.min = atof(range.substr(1, dots - 1).c_str());
+            param.max = atof(range.substr(dots + 2, range.size() - dots - 3).c_str());
+        }
+        param.constantId = static_cast<uint32_t>(params.size());
+        params.push_back(param);
+    }
+    return params;
+}
+
+// Specialization data for a set of parameters, in constant_id order
+inline std::vector<uint32_t> constants(const std::vector<Param>& params) {
+    std::vector<uint32_t> data;
+    for (const Param& param : params) {
+        data.push_back(param.bits());
+    }
+    return data;
+}
+
+}  // namespace shader_params
@@ -0,0 +1,730 @@
+// spirv_analysis.h - Static cost estimate of a fragment shader from its SPIR-V (--analyze)
+//
+// Counts instructions by category, both statically and "per pixel": instructions inside loops
+// with a static trip count are multiplied by it (UNKNOWN_TRIP_COUNT otherwise) and calls are
+// expanded, starting at the entry point. Trip counts are recognised for the counter loops
+// glslang emits (a constant start, a constant step added in the continue block and a
+// comparison against a constant or specialization constant). Register pressure is the peak
+// number of live 32-bit scalars over a linear walk of each function, with values used inside
+// a loop kept live until its merge block. Both are estimates meant for ranking shaders and
+// fitting a cost model against measured GPU time (fitCostModel), not exact ISA numbers.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace spirv_analysis {
+
+constexpr uint32_t UNKNOWN_TRIP_COUNT = 32;  // Iterations assumed for loops without a static count
+constexpr double LARGE_UNROLL = 512;        // Unrolled body instructions × trips worth a warning
+constexpr uint32_t HIGH_PRESSURE = 128;     // Live scalars where most GPUs lose occupancy
+constexpr int64_t TEXTURE_LOOP = 64;        // Iterations of a sampling loop worth a warning
+
+enum Category { Alu, Transcendental, Texture, Derivative, Memory, Control, Other, CATEGORY_COUNT };
+
+inline const char* categoryName(int category) {
+    static const char* names[] = {"alu", "transcendental", "texture", "derivative", "memory", "control", "other"};
+    return names[category];
+}
+
+struct Loop {
+    std::string function;
+    int64_t tripCount = -1;     // -1: no static trip count
+    bool specialized = false;   // Bound is a specialization constant (its default is used)
+    bool unroll = false;        // LoopControl Unroll
+    uint32_t depth = 1;
+    uint32_t instructions = 0;  // Static instructions in the loop, calls not expanded
+    uint32_t samples = 0;       // Texture instructions among them
+};
+
+struct Flag {
+    std::string kind;  // dynamic-index, large-unroll, unknown-trip-count, texture-loop, register-pressure
+    std::string detail;
+};
+
+struct Report {
+    uint32_t instructions[CATEGORY_COUNT] = {};  // Whole module, each instruction once
+    double perPixel[CATEGORY_COUNT] = {};        // From the entry point, loops and calls expanded
+    std::vector<Loop> loops;
+    uint32_t peakLiveScalars = 0;
+    std::vector<std::string> uniforms;       // Uniform block members read
+    std::vector<std::string> pushConstants;  // Push-constant members read
+    std::vector<std::string> textures;       // Image / sampler variables used
+    std::vector<Flag> flags;
+
+    uint32_t total() const {
+        uint32_t sum = 0;
+        for (uint32_t count : instructions) sum += count;
+        return sum;
+    }
+
+    double perPixelTotal() const {
+        double sum = 0.0;
+        for (double count : perPixel) sum += count;
+        return sum;
+    }
+
+    // JSON object members (no braces), each line starting with indent
+    std::string json(const std::string& indent) const;
+};
+
+namespace detail {
+
+enum : uint32_t {
+    OpName = 5, OpMemberName = 6, OpExtInstImport = 11, OpExtInst = 12, OpEntryPoint = 15,
+    OpTypeBool = 20, OpTypeInt = 21, OpTypeFloat = 22, OpTypeVector = 23, OpTypeMatrix = 24, OpTypeArray = 28,
+    OpTypeStruct = 30, OpTypePointer = 32, OpConstantTrue = 41, OpConstantFalse = 42, OpConstant = 43,
+    OpConstantComposite = 44, OpConstantNull = 46, OpSpecConstantTrue = 48, OpSpecConstantFalse = 49,
+    OpSpecConstant = 50, OpSpecConstantComposite = 51, OpSpecConstantOp = 52, OpFunction = 54,
+    OpFunctionParameter = 55, OpFunctionEnd = 56, OpFunctionCall = 57, OpVariable = 59, OpLoad = 61,
+    OpStore = 62, OpAccessChain = 65, OpInBoundsAccessChain = 66, OpVectorExtractDynamic = 77,
+    OpVectorInsertDynamic = 78, OpIAdd = 128, OpFAdd = 129, OpISub = 130, OpFSub = 131, OpUDiv = 134,
+    OpFMod = 141, OpINotEqual = 171, OpUGreaterThan = 172, OpSGreaterThan = 173, OpUGreaterThanEqual = 174,
+    OpSGreaterThanEqual = 175, OpULessThan = 176, OpSLessThan = 177, OpULessThanEqual = 178,
+    OpSLessThanEqual = 179, OpFOrdLessThan = 184, OpFOrdGreaterThan = 186, OpFOrdLessThanEqual = 188,
+    OpFOrdGreaterThanEqual = 190, OpPhi = 245, OpLoopMerge = 246, OpSelectionMerge = 247, OpLabel = 248,
+    OpBranch = 249, OpBranchConditional = 250, OpLine = 8, OpNoLine = 317,
+};
+enum : uint32_t { StorageUniformConstant = 0, StorageUniform = 2, StoragePrivate = 6, StorageFunction = 7,
+                  StoragePushConstant = 9, StorageStorageBuffer = 12 };
+enum : uint32_t { LoopControlUnroll = 1 };
+
+// Instructions without a result id (everything else in a function body has type + result,
+// except OpLabel, whose only operand is its id)
+inline bool hasResult(uint32_t opcode) {
+    switch (opcode) {
+        case OpStore: case 63: /* OpCopyMemory */ case 99: /* OpImageWrite */
+        case OpLoopMerge: case OpSelectionMerge: case OpBranch: case OpBranchConditional:
+        case 251: case 252: case 253: case 254: case 255:  // Switch, Kill, Return, ReturnValue, Unreachable
+        case 224: case 225:                                 // Barriers
+        case OpLine: case OpNoLine: case OpFunctionEnd: case OpLabel: case 4416: case 5380:
+            return false;
+    }
+    return true;
+}
+
+inline Category categorize(uint32_t opcode, const uint32_t* op, uint32_t operands, bool glslExt) {
+    if (opcode == OpExtInst) {
+        if (!glslExt || operands < 4) return Alu;
+        uint32_t inst = op[3];
+        // Sin..InverseSqrt, Length, Distance, Normalize, Refract (the last four need a sqrt)
+        bool special = (inst >= 13 && inst <= 32) || inst == 66 || inst == 67 || inst == 69 || inst == 72;
+        return special ? Transcendental : Alu;
+    }
+    if (opcode >= 87 && opcode <= 98) return Texture;           // ImageSample* .. ImageRead
+    if (opcode >= 305 && opcode <= 320) return Texture;         // ImageSparse*
+    if (opcode >= 207 && opcode <= 215) return Derivative;      // DPdx .. FwidthCoarse
+    if (opcode >= OpUDiv && opcode <= OpFMod) return Transcendental;  // Divisions and remainders
+    if ((opcode >= 109 && opcode <= 124) || (opcode >= 126 && opcode <= 205)) return Alu;
+    if (opcode == OpLoad || opcode == OpStore || opcode == 63 || opcode == OpAccessChain ||
+        opcode == OpInBoundsAccessChain) return Memory;
+    if (opcode == OpPhi || (opcode >= OpBranch && opcode <= 255) || opcode == OpFunctionCall || opcode == 4416 ||
+        opcode == 5380) return Control;
+    return Other;
+}
+
+inline bool counted(uint32_t opcode) {
+    return opcode != OpLabel && opcode != OpLine && opcode != OpNoLine && opcode != OpLoopMerge &&
+           opcode != OpSelectionMerge && opcode != OpFunctionParameter && opcode != OpVariable;
+}
+
+inline std::string literalString(const uint32_t* words, size_t count) {
+    std::string text;
+    for (size_t i = 0; i < count; i++) {
+        for (int b = 0; b < 4; b++) {
+            char c = static_cast<char>((words[i] >> (8 * b)) & 0xff);
+            if (c == '\0') return text;
+            text += c;
+        }
+    }
+    return text;
+}
+
+inline std::string quote(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) quoted += c;
+    }
+    return quoted + "\"";
+}
+
+struct Instruction {
+    uint32_t opcode;
+    const uint32_t* op;
+    uint32_t operands;
+};
+
+struct Function {
+    uint32_t id = 0;
+    std::vector<Instruction> body;  // OpFunction .. OpFunctionEnd, exclusive
+};
+
+struct Constant {
+    uint32_t type = 0;
+    uint32_t value = 0;
+    bool known = false;  // Scalar with a value (spec constants: their default)
+    bool spec = false;
+};
+
+}  // namespace detail
+
+inline std::string Report::json(const std::string& indent) const {
+    std::ostringstream out;
+    out << indent << "\"instructions\": {";
+    for (int c = 0; c < CATEGORY_COUNT; c++) {
+        out << (c ? ", " : "") << "\"" << categoryName(c) << "\": " << instructions[c];
+    }
+    out << ", \"total\": " << total() << "},\n" << indent << "\"perPixel\": {";
+    for (int c = 0; c < CATEGORY_COUNT; c++) {
+        out << (c ? ", " : "") << "\"" << categoryName(c) << "\": " << std::llround(perPixel[c]);
+    }
+    out << ", \"total\": " << std::llround(perPixelTotal()) << "},\n";
+    out << indent << "\"peakLiveScalars\": " << peakLiveScalars << ",\n" << indent << "\"loops\": [";
+    for (size_t i = 0; i < loops.size(); i++) {
+        const Loop& loop = loops[i];
+        out << (i ? ", " : "") << "{\"function\": " << detail::quote(loop.function) << ", \"tripCount\": ";
+        if (loop.tripCount >= 0) {
+            out << loop.tripCount;
+        } else {
+            out << "null";
+        }
+        out << ", \"specialized\": " << (loop.specialized ? "true" : "false")
+            << ", \"unroll\": " << (loop.unroll ? "true" : "false") << ", \"depth\": " << loop.depth
+            << ", \"instructions\": " << loop.instructions << ", \"samples\": " << loop.samples << "}";
+    }
+    auto list = [&](const char* name, const std::vector<std::string>& items) {
+        out << "],\n" << indent << "\"" << name << "\": [";
+        for (size_t i = 0; i < items.size(); i++) {
+            out << (i ? ", " : "") << detail::quote(items[i]);
+        }
+    };
+    list("uniforms", uniforms);
+    list("pushConstants", pushConstants);
+    list("textures", textures);
+    out << "],\n" << indent << "\"flags\": [";
+    for (size_t i = 0; i < flags.size(); i++) {
+        out << (i ? ", " : "") << "{\"kind\": \"" << flags[i].kind << "\", \"detail\": " << detail::quote(flags[i].detail)
+            << "}";
+    }
+    out << "]";
+    return out.str();
+}
+
+// Analyse one module. Returns false with `error` set if the binary is malformed.
+inline bool analyze(const uint32_t* words, size_t wordCount, Report& report, std::string& error) {
+    using namespace detail;
+    if (wordCount < 5 || words[0] != 0x07230203) {
+        error = "not a SPIR-V module";
+        return false;
+    }
+
+    std::map<uint32_t, std::string> names;
+    std::map<uint32_t, std::map<uint32_t, std::string>> memberNames;
+    std::set<uint32_t> glslSets;
+    std::map<uint32_t, std::pair<uint32_t, std::vector<uint32_t>>> types;  // id → (opcode, operands)
+    std::map<uint32_t, Constant> constants;
+    std::map<uint32_t, std::pair<uint32_t, uint32_t>> variables;  // id → (pointer type, storage class)
+    std::map<uint32_t, uint32_t> resultTypes;
+    std::vector<Function> functions;
+    uint32_t entryPoint = 0;
+
+    for (size_t at = 5; at < wordCount;) {
+        uint32_t length = words[at] >> 16;
+        uint32_t opcode = words[at] & 0xffff;
+        if (length == 0 || at + length > wordCount) {
+            error = "truncated instruction at word " + std::to_string(at);
+            return false;
+        }
+        const uint32_t* op = words + at + 1;
+        uint32_t operands = length - 1;
+        at += length;
+
+        if (opcode == OpFunction && operands >= 2) {
+            functions.emplace_back();
+            functions.back().id = op[1];
+            continue;
+        }
+        if (opcode == OpFunctionEnd) {
+            continue;
+        }
+        if (!functions.empty()) {
+            functions.back().body.push_back({opcode, op, operands});
+            if (opcode == OpVariable && operands >= 3) {
+                variables[op[1]] = {op[0], op[2]};
+            }
+            if (opcode != OpLabel && hasResult(opcode) && operands >= 2) {
+                resultTypes[op[1]] = op[0];
+            }
+            continue;
+        }
+
+        if (opcode == OpName && operands >= 2) {
+            names[op[0]] = literalString(op + 1, operands - 1);
+        } else if (opcode == OpMemberName && operands >= 3) {
+            memberNames[op[0]][op[1]] = literalString(op + 2, operands - 2);
+        } else if (opcode == OpExtInstImport && operands >= 2) {
+            if (literalString(op + 1, operands - 1) == "GLSL.std.450") glslSets.insert(op[0]);
+        } else if (opcode == OpEntryPoint && operands >= 2) {
+            if (entryPoint == 0 || op[0] == 4) entryPoint = op[1];  // Prefer the Fragment entry point
+        } else if (opcode >= OpTypeBool && opcode <= OpTypePointer && operands >= 1) {
+            types[op[0]] = {opcode, std::vector<uint32_t>(op + 1, op + operands)};
+        } else if ((opcode == OpConstant || opcode == OpSpecConstant) && operands >= 3) {
+            constants[op[1]] = Constant{op[0], op[2], true, opcode == OpSpecConstant};
+        } else if ((opcode >= OpConstantTrue && opcode <= OpConstantNull) ||
+                   (opcode >= OpSpecConstantTrue && opcode <= OpSpecConstantOp)) {
+            if (operands >= 2) {
+                bool value = opcode == OpConstantTrue || opcode == OpSpecConstantTrue;
+                bool scalar = opcode != OpConstantComposite && opcode != OpSpecConstantComposite &&
+                              opcode != OpSpecConstantOp && opcode != OpConstantNull;
+                constants[op[1]] = Constant{op[0], value ? 1u : 0u, scalar, opcode >= OpSpecConstantTrue};
+            }
+        } else if (opcode == OpVariable && operands >= 3) {
+            variables[op[1]] = {op[0], op[2]};
+        }
+    }
+
+    // Scalars in a value of the given type (pointers and opaque types count as none)
+    std::function<uint32_t(uint32_t)> components = [&](uint32_t id) -> uint32_t {
+        auto type = types.find(id);
+        if (type == types.end()) return 0;
+        const std::vector<uint32_t>& operands = type->second.second;
+        switch (type->second.first) {
+            case OpTypeBool:
+            case OpTypeInt:
+            case OpTypeFloat:
+                return 1;
+            case OpTypeVector:
+            case OpTypeMatrix:
+                return operands.size() < 2 ? 0 : components(operands[0]) * operands[1];
+            case OpTypeArray: {
+                auto length = constants.find(operands.size() < 2 ? 0 : operands[1]);
+                return length == constants.end() ? 0 : components(operands[0]) * length->second.value;
+            }
+            case OpTypeStruct: {
+                uint32_t sum = 0;
+                for (uint32_t member : operands) sum += components(member);
+                return sum;
+            }
+        }
+        return 0;
+    };
+    auto pointee = [&](uint32_t pointerType) -> uint32_t {
+        auto type = types.find(pointerType);
+        return type != types.end() && type->second.first == OpTypePointer && type->second.second.size() >= 2
+                   ? type->second.second[1]
+                   : 0;
+    };
+    auto isFloat = [&](uint32_t typeId) {
+        auto type = types.find(typeId);
+        return type != types.end() && type->second.first == OpTypeFloat;
+    };
+    auto constantValue = [&](uint32_t id, double& value) {
+        auto constant = constants.find(id);
+        if (constant == constants.end() || !constant->second.known) return false;
+        if (isFloat(constant->second.type)) {
+            float f;
+            memcpy(&f, &constant->second.value, sizeof(f));
+            value = f;
+        } else {
+            value = static_cast<int32_t>(constant->second.value);
+        }
+        return true;
+    };
+    auto variableName = [&](uint32_t id) {
+        auto name = names.find(id);
+        return name != names.end() && !name->second.empty() ? name->second : "%" + std::to_string(id);
+    };
+
+    // Block members and textures the shader reads
+    std::map<uint32_t, std::set<std::string>> membersRead;  // Block variable → member names
+    std::set<std::string> textures;
+    uint32_t dynamicVectorIndices = 0;
+    std::set<uint32_t> dynamicLocals;
+
+    struct FunctionCost {
+        double perPixel[CATEGORY_COUNT] = {};
+        std::vector<std::pair<uint32_t, double>> calls;  // Callee, times called per invocation
+    };
+    std::map<uint32_t, FunctionCost> costs;
+
+    for (const Function& function : functions) {
+        const std::vector<Instruction>& body = function.body;
+        std::map<uint32_t, size_t> labels;
+        std::map<uint32_t, size_t> definitions;
+        for (size_t i = 0; i < body.size(); i++) {
+            if (body[i].opcode == OpLabel && body[i].operands >= 1) {
+                labels[body[i].op[0]] = i;
+            } else if (hasResult(body[i].opcode) && body[i].operands >= 2) {
+                definitions[body[i].op[1]] = i;
+            }
+        }
+
+        // Loops: [header label, merge label) in layout order
+        struct Range {
+            size_t begin, end, continueAt;
+            size_t loop;  // Index into report.loops
+        };
+        std::vector<Range> ranges;
+        size_t header = 0;
+        for (size_t i = 0; i < body.size(); i++) {
+            if (body[i].opcode == OpLabel) header = i;
+            if (body[i].opcode != OpLoopMerge || body[i].operands < 3) continue;
+            auto merge = labels.find(body[i].op[0]);
+            auto continueTarget = labels.find(body[i].op[1]);
+            if (merge == labels.end() || merge->second <= header) continue;
+            Loop loop;
+            loop.function = variableName(function.id);
+            loop.unroll = (body[i].op[2] & LoopControlUnroll) != 0;
+            ranges.push_back({header, merge->second,
+                              continueTarget == labels.end() ? merge->second : continueTarget->second,
+                              report.loops.size()});
+            report.loops.push_back(loop);
+        }
+
+        auto contains = [&](const Range& range, size_t at) { return at >= range.begin && at < range.end; };
+        auto definition = [&](uint32_t id) -> const Instruction* {
+            auto found = definitions.find(id);
+            return found == definitions.end() ? nullptr : &body[found->second];
+        };
+
+        // Static trip count of a counter loop (see the file comment); -1 if not recognised
+        auto tripCount = [&](const Range& range, bool& specialized) -> int64_t {
+            const Instruction* exit = nullptr;
+            for (size_t i = range.begin; i < range.end && !exit; i++) {
+                if (body[i].opcode == OpBranchConditional && body[i].operands >= 3 &&
+                    labels.count(body[i].op[2]) && labels[body[i].op[2]] == range.end) {
+                    exit = &body[i];
+                }
+            }
+            const Instruction* compare = exit ? definition(exit->op[0]) : nullptr;
+            if (!compare || compare->operands < 4) return -1;
+            uint32_t comparison = compare->opcode;
+            uint32_t counter = compare->op[2];
+            double bound;
+            if (constantValue(compare->op[3], bound)) {
+                specialized = constants[compare->op[3]].spec;
+            } else if (constantValue(compare->op[2], bound)) {
+                specialized = constants[compare->op[2]].spec;
+                counter = compare->op[3];
+                // k < x  is  x > k
+                switch (comparison) {
+                    case OpSLessThan: comparison = OpSGreaterThan; break;
+                    case OpULessThan: comparison = OpUGreaterThan; break;
+                    case OpSLessThanEqual: comparison = OpSGreaterThanEqual; break;
+                    case OpULessThanEqual: comparison = OpUGreaterThanEqual; break;
+                    case OpSGreaterThan: comparison = OpSLessThan; break;
+                    case OpUGreaterThan: comparison = OpULessThan; break;
+                    case OpSGreaterThanEqual: comparison = OpSLessThanEqual; break;
+                    case OpUGreaterThanEqual: comparison = OpULessThanEqual; break;
+                    case OpFOrdLessThan: comparison = OpFOrdGreaterThan; break;
+                    case OpFOrdGreaterThan: comparison = OpFOrdLessThan; break;
+                    case OpFOrdLessThanEqual: comparison = OpFOrdGreaterThanEqual; break;
+                    case OpFOrdGreaterThanEqual: comparison = OpFOrdLessThanEqual; break;
+                }
+            } else {
+                return -1;
+            }
+
+            // Start and step: through a Function variable (unoptimised) or an OpPhi (optimised)
+            double start = 0.0, step = 0.0;
+            bool haveStart = false, haveStep = false;
+            auto stepOf = [&](uint32_t id) {
+                const Instruction* add = definition(id);
+                if (!add || add->operands < 4) return false;
+                bool negate = add->opcode == OpISub || add->opcode == OpFSub;
+                if (add->opcode != OpIAdd && add->opcode != OpFAdd && !negate) return false;
+                double amount;
+                if (!constantValue(add->op[3], amount) && (negate || !constantValue(add->op[2], amount))) {
+                    return false;
+                }
+                step = negate ? -amount : amount;
+                return true;
+            };
+            const Instruction* counterDefinition = definition(counter);
+            if (counterDefinition && counterDefinition->opcode == OpLoad && counterDefinition->operands >= 3) {
+                uint32_t variable = counterDefinition->op[2];
+                for (size_t i = range.begin; i-- > 0;) {
+                    if (body[i].opcode == OpStore && body[i].operands >= 2 && body[i].op[0] == variable) {
+                        haveStart = constantValue(body[i].op[1], start);
+                        break;
+                    }
+                }
+                for (size_t i = range.continueAt; i < range.end && !haveStep; i++) {
+                    if (body[i].opcode == OpStore && body[i].operands >= 2 && body[i].op[0] == variable) {
+                        haveStep = stepOf(body[i].op[1]);
+                    }
+                }
+            } else if (counterDefinition && counterDefinition->opcode == OpPhi) {
+                for (uint32_t i = 2; i + 1 < counterDefinition->operands; i += 2) {
+                    uint32_t value = counterDefinition->op[i];
+                    if (constantValue(value, start)) {
+                        haveStart = true;
+                    } else {
+                        haveStep = stepOf(value);
+                    }
+                }
+            }
+            if (!haveStart || !haveStep || step == 0.0) return -1;
+
+            double trips = -1.0;
+            switch (comparison) {
+                case OpSLessThan: case OpULessThan: case OpFOrdLessThan:
+                    if (step > 0) trips = std::ceil((bound - start) / step);
+                    break;
+                case OpSLessThanEqual: case OpULessThanEqual: case OpFOrdLessThanEqual:
+                    if (step > 0) trips = std::floor((bound - start) / step) + 1;
+                    break;
+                case OpSGreaterThan: case OpUGreaterThan: case OpFOrdGreaterThan:
+                    if (step < 0) trips = std::ceil((start - bound) / -step);
+                    break;
+                case OpSGreaterThanEqual: case OpUGreaterThanEqual: case OpFOrdGreaterThanEqual:
+                    if (step < 0) trips = std::floor((start - bound) / -step) + 1;
+                    break;
+                case OpINotEqual:
+                    if (std::fmod(bound - start, step) == 0.0) trips = (bound - start) / step;
+                    break;
+            }
+            if (trips > 1e7) return -1;
+            return trips < 0 ? -1 : static_cast<int64_t>(std::max(0.0, trips));
+        };
+
+        for (Range& range : ranges) {
+            Loop& loop = report.loops[range.loop];
+            loop.tripCount = tripCount(range, loop.specialized);
+            for (const Range& outer : ranges) {
+                if (&outer != &range && outer.begin < range.begin && range.begin < outer.end) loop.depth++;
+            }
+            for (size_t i = range.begin; i < range.end; i++) {
+                if (!counted(body[i].opcode)) continue;
+                loop.instructions++;
+                if (categorize(body[i].opcode, body[i].op, body[i].operands, false) == Texture) loop.samples++;
+            }
+        }
+
+        // Instruction counts, weighted by the trip counts of the enclosing loops
+        FunctionCost& cost = costs[function.id];
+        for (size_t i = 0; i < body.size(); i++) {
+            const Instruction& instruction = body[i];
+            if (!counted(instruction.opcode)) continue;
+            double weight = 1.0;
+            for (const Range& range : ranges) {
+                if (contains(range, i)) {
+                    int64_t trips = report.loops[range.loop].tripCount;
+                    weight *= trips >= 0 ? static_cast<double>(trips) : UNKNOWN_TRIP_COUNT;
+                }
+            }
+            bool glslExt = instruction.opcode == OpExtInst && instruction.operands >= 3 &&
+                           glslSets.count(instruction.op[2]);
+            Category category = categorize(instruction.opcode, instruction.op, instruction.operands, glslExt);
+            report.instructions[category]++;
+            cost.perPixel[category] += weight;
+            if (instruction.opcode == OpFunctionCall && instruction.operands >= 3) {
+                cost.calls.push_back({instruction.op[2], weight});
+            }
+
+            // Resource usage and slow patterns
+            if ((instruction.opcode == OpAccessChain || instruction.opcode == OpInBoundsAccessChain) &&
+                instruction.operands >= 4) {
+                auto variable = variables.find(instruction.op[2]);
+                uint32_t storage = variable == variables.end() ? UINT32_MAX : variable->second.second;
+                if (storage == StorageUniform || storage == StoragePushConstant) {
+                    uint32_t block = pointee(variable->second.first);
+                    auto member = constants.find(instruction.op[3]);
+                    if (member != constants.end() && member->second.known) {
+                        auto name = memberNames[block].find(member->second.value);
+                        membersRead[instruction.op[2]].insert(
+                            name != memberNames[block].end() ? name->second
+                                                              : "member " + std::to_string(member->second.value));
+                    }
+                } else if (storage == StorageFunction || storage == StoragePrivate) {
+                    for (uint32_t index = 3; index < instruction.operands; index++) {
+                        auto constant = constants.find(instruction.op[index]);
+                        if (constant == constants.end()) dynamicLocals.insert(instruction.op[2]);
+                    }
+                }
+            } else if (instruction.opcode == OpVectorExtractDynamic || instruction.opcode == OpVectorInsertDynamic) {
+                dynamicVectorIndices++;
+            }
+            for (uint32_t o = 0; o < instruction.operands; o++) {
+                auto variable = variables.find(instruction.op[o]);
+                if (variable != variables.end() && variable->second.second == StorageUniformConstant) {
+                    textures.insert(variableName(instruction.op[o]));
+                }
+            }
+        }
+
+        // Register pressure: live ranges of SSA values and Function variables in layout order
+        std::map<uint32_t, std::pair<size_t, size_t>> live;  // id → [first, last]
+        std::map<uint32_t, uint32_t> width;
+        for (size_t i = 0; i < body.size(); i++) {
+            const Instruction& instruction = body[i];
+            if (instruction.opcode == OpVariable && instruction.operands >= 2) {
+                width[instruction.op[1]] = components(pointee(instruction.op[0]));
+            } else if (hasResult(instruction.opcode) && instruction.operands >= 2 &&
+                       instruction.opcode != OpAccessChain && instruction.opcode != OpInBoundsAccessChain) {
+                width[instruction.op[1]] = components(instruction.op[0]);
+                live[instruction.op[1]] = {i, i};
+            }
+            uint32_t first = hasResult(instruction.opcode) && instruction.opcode != OpLabel ? 2 : 0;
+            for (uint32_t o = first; o < instruction.operands; o++) {
+                uint32_t id = instruction.op[o];
+                if (!width.count(id)) continue;
+                auto range = live.find(id);
+                if (range == live.end()) {
+                    live[id] = {i, i};  // Variables are live from their first access
+                    continue;
+                }
+                size_t last = i;
+                // A value from before a loop that the loop reads stays live for all of it
+                for (const Range& loop : ranges) {
+                    if (contains(loop, i) && !contains(loop, range->second.first)) last = std::max(last, loop.end);
+                }
+                range->second.second = std::max(range->second.second, last);
+            }
+        }
+        std::vector<int64_t> delta(body.size() + 2, 0);
+        for (const auto& range : live) {
+            if (range.second.second == range.second.first) continue;  // Never read
+            delta[range.second.first] += width[range.first];
+            delta[range.second.second + 1] -= width[range.first];
+        }
+        int64_t scalars = 0;
+        for (int64_t change : delta) {
+            scalars += change;
+            report.peakLiveScalars = std::max(report.peakLiveScalars, static_cast<uint32_t>(std::max<int64_t>(0, scalars)));
+        }
+    }
+
+    // Per-pixel counts from the entry point, calls expanded (GLSL has no recursion)
+    std::set<uint32_t> visiting;
+    std::function<void(uint32_t, double)> expand = [&](uint32_t function, double times) {
+        auto cost = costs.find(function);
+        if (cost == costs.end() || visiting.count(function)) return;
+        visiting.insert(function);
+        for (int c = 0; c < CATEGORY_COUNT; c++) {
+            report.perPixel[c] += cost->second.perPixel[c] * times;
+        }
+        for (const auto& call : cost->second.calls) {
+            expand(call.first, times * call.second);
+        }
+        visiting.erase(function);
+    };
+    expand(entryPoint, 1.0);
+
+    for (const auto& block : membersRead) {
+        std::vector<std::string>& list =
+            variables[block.first].second == StoragePushConstant ? report.pushConstants : report.uniforms;
+        list.insert(list.end(), block.second.begin(), block.second.end());
+    }
+    report.textures.assign(textures.begin(), textures.end());
+
+    // Known-slow patterns
+    for (uint32_t local : dynamicLocals) {
+        report.flags.push_back({"dynamic-index", "dynamic index into local `" + variableName(local) + "` (" +
+                                                     std::to_string(components(pointee(variables[local].first))) +
+                                                     " scalars), often moved to scratch memory"});
+    }
+    if (dynamicVectorIndices > 0) {
+        report.flags.push_back({"dynamic-index", std::to_string(dynamicVectorIndices) +
+                                                     " vector components selected by a dynamic index"});
+    }
+    for (const Loop& loop : report.loops) {
+        std::string where = "loop in " + loop.function;
+        if (loop.tripCount < 0) {
+            report.flags.push_back({"unknown-trip-count", where + " has no static trip count (counted as " +
+                                                              std::to_string(UNKNOWN_TRIP_COUNT) + " iterations)"});
+        } else if (loop.unroll && static_cast<double>(loop.tripCount) * loop.instructions > LARGE_UNROLL) {
+            report.flags.push_back({"large-unroll", where + " unrolls " + std::to_string(loop.tripCount) + " × " +
+                                                        std::to_string(loop.instructions) + " instructions"});
+        }
+        if (loop.samples > 0 && (loop.tripCount < 0 || loop.tripCount >= TEXTURE_LOOP)) {
+            report.flags.push_back({"texture-loop", where + " samples " + std::to_string(loop.samples) + " textures × " +
+                                                        (loop.tripCount < 0 ? std::string("?")
+                                                                            : std::to_string(loop.tripCount)) +
+                                                        " iterations"});
+        }
+    }
+    if (report.peakLiveScalars > HIGH_PRESSURE) {
+        report.flags.push_back({"register-pressure", "about " + std::to_string(report.peakLiveScalars) +
+                                                         " live scalars at the peak"});
+    }
+    return true;
+}
+
+// Least-squares fit of measured GPU time against the per-pixel ALU, transcendental and
+// texture counts: millis ≈ intercept + Σ weight × count
+struct CostModel {
+    bool valid = false;
+    double intercept = 0.0;
+    double weights[3] = {};  // alu, transcendental, texture
+    double r2 = 0.0;
+
+    static void features(const Report& report, double x[3]) {
+        x[0] = report.perPixel[Alu] + report.perPixel[Other] + report.perPixel[Memory] + report.perPixel[Control];
+        x[1] = report.perPixel[Transcendental] + report.perPixel[Derivative];
+        x[2] = report.perPixel[Texture];
+    }
+
+    double predict(const Report& report) const {
+        double x[3];
+        features(report, x);
+        return intercept + weights[0] * x[0] + weights[1] * x[1] + weights[2] * x[2];
+    }
+};
+
+inline CostModel fitCostModel(const std::vector<const Report*>& reports, const std::vector<double>& millis) {
+    CostModel model;
+    size_t n = std::min(reports.size(), millis.size());
+    if (n < 6) {
+        return model;  // Too few shaders for four coefficients
+    }
+    // Normal equations (XᵀX + λI) b = Xᵀy, with a tiny ridge so unused features don't make it singular
+    double a[4][5] = {};
+    for (size_t i = 0; i < n; i++) {
+        double x[4] = {1.0};
+        CostModel::features(*reports[i], x + 1);
+        for (int r = 0; r < 4; r++) {
+            for (int c = 0; c < 4; c++) a[r][c] += x[r] * x[c];
+            a[r][4] += x[r] * millis[i];
+        }
+    }
+    for (int r = 1; r < 4; r++) a[r][r] += 1e-9 * (a[r][r] + 1.0);
+    for (int col = 0; col < 4; col++) {
+        int pivot = col;
+        for (int r = col + 1; r < 4; r++) {
+            if (std::fabs(a[r][col]) > std::fabs(a[pivot][col])) pivot = r;
+        }
+        if (std::fabs(a[pivot][col]) < 1e-30) return model;
+        for (int c = 0; c < 5; c++) std::swap(a[col][c], a[pivot][c]);
+        for (int r = 0; r < 4; r++) {
+            if (r == col) continue;
+            double factor = a[r][col] / a[col][col];
+            for (int c = col; c < 5; c++) a[r][c] -= factor * a[col][c];
+        }
+    }
+    model.intercept = a[0][4] / a[0][0];
+    for (int k = 0; k < 3; k++) model.weights[k] = a[k + 1][4] / a[k + 1][k + 1];
+
+    double mean = 0.0;
+    for (size_t i = 0; i < n; i++) mean += millis[i] / n;
+    double residual = 0.0, spread = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double error = millis[i] - model.predict(*reports[i]);
+        residual += error * error;
+        spread += (millis[i] - mean) * (millis[i] - mean);
+    }
+    model.r2 = spread > 0.0 ? 1.0 - residual / spread : 0.0;
+    model.valid = true;
+    return model;
+}
+
+}  // namespace spirv_analysis
@@ -0,0 +1,1977 @@
+// spirv_cpu.h - CPU fallback renderer: interprets the compiled vertex and fragment SPIR-V
+//
+// For machines with no usable Vulkan device (or to cross-check one). The interpreter covers
+// what glslangValidator emits for fullscreen shaders: scalar/vector/matrix arithmetic,
+// GLSL.std.450, structured control flow (selection, loops, switch, OpPhi, discard), function
+// calls, uniform and push-constant blocks and 2D combined image samplers. Storage buffers,
+// 64-bit types, atomics and cube/3D sampling are not supported (cube and 3D reads return 0).
+//
+// Each invocation runs LANES = 8 pixels at once, a 4x2 block made of two 2x2 quads, so
+// derivatives are differences between neighbouring lanes exactly as on a GPU. Registers hold
+// one 32-bit word per lane and every operation is a loop over the lanes, which the compiler
+// vectorises; divergent control flow runs both paths under lane masks. Frames are cut into
+// tiles that a WorkPool spreads over the cores (work stealing), one Invocation per worker.
+//
+// Vertex shaders are interpreted too: the six vertices of the fullscreen draw are run once
+// per frame and their outputs become affine planes over the framebuffer, which is how the
+// rasteriser would interpolate them (w = 1 for a fullscreen quad).
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "work_pool.h"
+
+namespace spirv_cpu {
+
+constexpr uint32_t LANES = 8;
+constexpr uint32_t ALL_LANES = (1u << LANES) - 1;
+constexpr uint32_t TILE_WIDTH = 32;
+constexpr uint32_t TILE_HEIGHT = 16;
+constexpr uint32_t MAX_LOOP_ITERATIONS = 1u << 20;  // Per loop entry; a runaway loop exits instead of hanging
+constexpr uint32_t MAX_BINDINGS = 16;
+constexpr uint32_t PUSH_CONSTANTS = 0xffffffff;    // setBlock() binding for the push-constant block
+
+// RGBA float image sampled like the viewer's sampler: bilinear, repeat, no mipmaps
+struct Texture {
+    uint32_t width = 0, height = 0;
+    std::vector<float> rgba;  // Row-major, top row first, linear values
+
+    void fetch(int64_t x, int64_t y, float out[4]) const {
+        if (x < 0 || y < 0 || x >= width || y >= height) {
+            out[0] = out[1] = out[2] = out[3] = 0.0f;
+            return;
+        }
+        memcpy(out, &rgba[(static_cast<size_t>(y) * width + static_cast<size_t>(x)) * 4], 4 * sizeof(float));
+    }
+
+    void sample(float u, float v, float out[4]) const {
+        float x = u * width - 0.5f, y = v * height - 0.5f;
+        if (width == 0 || height == 0 || !std::isfinite(x) || !std::isfinite(y)) {
+            out[0] = out[1] = out[2] = out[3] = 0.0f;
+            return;
+        }
+        float fx = std::floor(x), fy = std::floor(y);
+        float tx = x - fx, ty = y - fy;
+        auto wrap = [](float i, uint32_t n) {
+            int64_t m = static_cast<int64_t>(std::fmod(static_cast<double>(i), static_cast<double>(n)));
+            return static_cast<size_t>(m < 0 ? m + n : m);
+        };
+        size_t x0 = wrap(fx, width), x1 = (x0 + 1) % width;
+        size_t y0 = wrap(fy, height), y1 = (y0 + 1) % height;
+        const float* p00 = &rgba[(y0 * width + x0) * 4];
+        const float* p10 = &rgba[(y0 * width + x1) * 4];
+        const float* p01 = &rgba[(y1 * width + x0) * 4];
+        const float* p11 = &rgba[(y1 * width + x1) * 4];
+        for (int c = 0; c < 4; c++) {
+            float top = p00[c] + (p10[c] - p00[c]) * tx;
+            float bottom = p01[c] + (p11[c] - p01[c]) * tx;
+            out[c] = top + (bottom - top) * ty;
+        }
+    }
+};
+
+namespace detail {
+
+enum : uint32_t {
+    OpUndef = 1, OpExtInstImport = 11, OpExtInst = 12, OpEntryPoint = 15, OpCapability = 17, OpTypeVoid = 19,
+    OpTypeBool = 20, OpTypeInt = 21, OpTypeFloat = 22, OpTypeVector = 23, OpTypeMatrix = 24, OpTypeImage = 25,
+    OpTypeSampler = 26, OpTypeSampledImage = 27, OpTypeArray = 28, OpTypeRuntimeArray = 29, OpTypeStruct = 30,
+    OpTypePointer = 32, OpTypeFunction = 33, OpConstantTrue = 41, OpConstantFalse = 42, OpConstant = 43,
+    OpConstantComposite = 44, OpConstantNull = 46, OpSpecConstantTrue = 48, OpSpecConstantFalse = 49,
+    OpSpecConstant = 50, OpSpecConstantComposite = 51, OpSpecConstantOp = 52, OpFunction = 54,
+    OpFunctionParameter = 55, OpFunctionEnd = 56, OpFunctionCall = 57, OpVariable = 59, OpLoad = 61, OpStore = 62,
+    OpCopyMemory = 63, OpAccessChain = 65, OpInBoundsAccessChain = 66, OpDecorate = 71, OpMemberDecorate = 72,
+    OpVectorExtractDynamic = 77, OpVectorInsertDynamic = 78, OpVectorShuffle = 79, OpCompositeConstruct = 80,
+    OpCompositeExtract = 81, OpCompositeInsert = 82, OpCopyObject = 83, OpTranspose = 84, OpSampledImage = 86,
+    OpImageSampleImplicitLod = 87, OpImageSampleExplicitLod = 88, OpImageFetch = 95, OpImage = 100,
+    OpImageQuerySizeLod = 103, OpImageQuerySize = 104, OpImageQueryLevels = 106, OpConvertFToU = 109,
+    OpConvertFToS = 110, OpConvertSToF = 111, OpConvertUToF = 112, OpUConvert = 113, OpSConvert = 114,
+    OpFConvert = 115, OpQuantizeToF16 = 116, OpBitcast = 124, OpSNegate = 126, OpFNegate = 127, OpIAdd = 128,
+    OpFAdd = 129, OpISub = 130, OpFSub = 131, OpIMul = 132, OpFMul = 133, OpUDiv = 134, OpSDiv = 135,
+    OpFDiv = 136, OpUMod = 137, OpSRem = 138, OpSMod = 139, OpFRem = 140, OpFMod = 141,
+    OpVectorTimesScalar = 142, OpMatrixTimesScalar = 143, OpVectorTimesMatrix = 144, OpMatrixTimesVector = 145,
+    OpMatrixTimesMatrix = 146, OpOuterProduct = 147, OpDot = 148, OpAny = 154, OpAll = 155, OpIsNan = 156,
+    OpIsInf = 157, OpLogicalEqual = 164, OpLogicalNotEqual = 165, OpLogicalOr = 166, OpLogicalAnd = 167,
+    OpLogicalNot = 168, OpSelect = 169, OpIEqual = 170, OpINotEqual = 171, OpUGreaterThan = 172,
+    OpSGreaterThan = 173, OpUGreaterThanEqual = 174, OpSGreaterThanEqual = 175, OpULessThan = 176,
+    OpSLessThan = 177, OpULessThanEqual = 178, OpSLessThanEqual = 179, OpFOrdEqual = 180, OpFUnordEqual = 181,
+    OpFOrdNotEqual = 182, OpFUnordNotEqual = 183, OpFOrdLessThan = 184, OpFUnordLessThan = 185,
+    OpFOrdGreaterThan = 186, OpFUnordGreaterThan = 187, OpFOrdLessThanEqual = 188, OpFUnordLessThanEqual = 189,
+    OpFOrdGreaterThanEqual = 190, OpFUnordGreaterThanEqual = 191, OpShiftRightLogical = 194,
+    OpShiftRightArithmetic = 195, OpShiftLeftLogical = 196, OpBitwiseOr = 197, OpBitwiseXor = 198,
+    OpBitwiseAnd = 199, OpNot = 200, OpBitFieldInsert = 201, OpBitFieldSExtract = 202, OpBitFieldUExtract = 203,
+    OpBitReverse = 204, OpBitCount = 205, OpDPdx = 207, OpDPdy = 208, OpFwidth = 209, OpDPdxFine = 210,
+    OpDPdyFine = 211, OpFwidthFine = 212, OpDPdxCoarse = 213, OpDPdyCoarse = 214, OpFwidthCoarse = 215,
+    OpPhi = 245, OpLoopMerge = 246, OpSelectionMerge = 247, OpLabel = 248, OpBranch = 249,
+    OpBranchConditional = 250, OpSwitch = 251, OpKill = 252, OpReturn = 253, OpReturnValue = 254,
+    OpUnreachable = 255, OpNoLine = 317, OpTerminateInvocation = 4416, OpDemoteToHelperInvocation = 5380,
+};
+enum : uint32_t { DecorationSpecId = 1, DecorationArrayStride = 6, DecorationMatrixStride = 7, DecorationBuiltIn = 11,
+                  DecorationLocation = 30, DecorationBinding = 33, DecorationOffset = 35 };
+enum : uint32_t { StorageUniformConstant = 0, StorageInput = 1, StorageUniform = 2, StorageOutput = 3,
+                  StoragePrivate = 6, StorageFunction = 7, StoragePushConstant = 9, StorageStorageBuffer = 12 };
+enum : uint32_t { ModelVertex = 0, ModelFragment = 4 };
+enum : uint32_t { BuiltInPosition = 0, BuiltInFragCoord = 15, BuiltInFrontFacing = 17, BuiltInVertexIndex = 42,
+                  BuiltInInstanceIndex = 43 };
+
+constexpr uint32_t NONE = 0xffffffff;
+
+// Instructions that have a result type and result id (the rest of the executable set have neither)
+inline bool hasResult(uint32_t opcode) {
+    switch (opcode) {
+        case OpStore: case OpCopyMemory: case OpBranch: case OpBranchConditional: case OpSwitch: case OpKill:
+        case OpReturn: case OpReturnValue: case OpUnreachable: case OpTerminateInvocation:
+        case OpDemoteToHelperInvocation: case OpLoopMerge: case OpSelectionMerge:
+            return false;
+    }
+    return true;
+}
+
+inline bool executable(uint32_t opcode) {
+    switch (opcode) {
+        case OpUndef: case OpExtInst: case OpFunctionCall: case OpVariable: case OpLoad: case OpStore:
+        case OpCopyMemory: case OpAccessChain: case OpInBoundsAccessChain: case OpVectorExtractDynamic:
+        case OpVectorInsertDynamic: case OpVectorShuffle: case OpCompositeConstruct: case OpCompositeExtract:
+        case OpCompositeInsert: case OpCopyObject: case OpTranspose: case OpSampledImage:
+        case OpImageSampleImplicitLod: case OpImageSampleExplicitLod: case OpImageFetch: case OpImage:
+        case OpImageQuerySizeLod: case OpImageQuerySize: case OpImageQueryLevels: case OpPhi:
+        case OpBranch: case OpBranchConditional: case OpSwitch: case OpKill: case OpReturn: case OpReturnValue:
+        case OpUnreachable: case OpTerminateInvocation: case OpDemoteToHelperInvocation:
+            return true;
+    }
+    return (opcode >= OpConvertFToU && opcode <= OpQuantizeToF16) || (opcode >= OpBitcast && opcode <= OpDot) ||
+           (opcode >= OpAny && opcode <= OpIsInf) || (opcode >= OpLogicalEqual && opcode <= OpFUnordGreaterThanEqual) ||
+           (opcode >= OpShiftRightLogical && opcode <= OpBitCount) || (opcode >= OpDPdx && opcode <= OpFwidthCoarse);
+}
+
+// GLSL.std.450 instructions the interpreter implements
+inline bool supportedExtInst(uint32_t instruction) {
+    return (instruction >= 1 && instruction <= 35) || (instruction >= 37 && instruction <= 50) ||
+           (instruction >= 66 && instruction <= 72) || (instruction >= 79 && instruction <= 81);
+}
+
+inline uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float bitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Lane-array views of a register component, which is LANES consecutive words
+template <typename T>
+inline void loadLanes(const uint32_t* src, T* out) {
+    static_assert(sizeof(T) == 4, "32-bit lanes");
+    memcpy(out, src, LANES * sizeof(T));
+}
+
+inline void putLanes(uint32_t* dst, const uint32_t* src, uint32_t mask) {
+    if (mask == ALL_LANES) {
+        memcpy(dst, src, LANES * sizeof(uint32_t));
+        return;
+    }
+    for (uint32_t l = 0; l < LANES; l++) {
+        if (mask & (1u << l)) dst[l] = src[l];
+    }
+}
+
+template <typename T>
+inline void storeLanes(uint32_t* dst, const T* values, uint32_t mask) {
+    static_assert(sizeof(T) == 4, "32-bit lanes");
+    uint32_t bits[LANES];
+    memcpy(bits, values, sizeof(bits));
+    putLanes(dst, bits, mask);
+}
+
+}  // namespace detail
+
+class Invocation;
+
+// One decoded SPIR-V module plus the data its global variables start from
+class Program {
+public:
+    // Interface variable (Input or Output storage) by location or built-in
+    struct Variable {
+        uint32_t slot = 0;
+        uint32_t comps = 0;
+        int32_t location = -1;
+        int32_t builtIn = -1;
+    };
+
+    // specialization[i] is SpecId i; missing ones keep the module's default
+    bool load(const std::vector<uint32_t>& words, const std::vector<uint32_t>& specialization, std::string& error);
+
+    // Copy a uniform block (binding) or the push constants (PUSH_CONSTANTS) from its std140 /
+    // std430 bytes, laid out by the Offset, ArrayStride and MatrixStride decorations
+    void setBlock(uint32_t binding, const void* data, size_t size);
+    void setTexture(uint32_t binding, const Texture* texture) {
+        if (binding < MAX_BINDINGS) textures[binding] = texture;
+    }
+
+    bool isVertex() const { return model == detail::ModelVertex; }
+    bool isFragment() const { return model == detail::ModelFragment; }
+    const std::vector<Variable>& inputs() const { return inputVariables; }
+    const std::vector<Variable>& outputs() const { return outputVariables; }
+    const Variable* input(int32_t location, int32_t builtIn = -1) const { return find(inputVariables, location, builtIn); }
+    const Variable* output(int32_t location, int32_t builtIn = -1) const { return find(outputVariables, location, builtIn); }
+    // Sampled texture bindings whose dimension the interpreter can't sample (read as 0)
+    const std::vector<uint32_t>& unsupportedTextures() const { return unsupportedBindings; }
+
+private:
+    friend class Invocation;
+
+    struct Type {
+        uint32_t opcode = 0;
+        uint32_t comps = 0;               // Scalars when flattened (pointers and images: 1)
+        uint32_t element = 0;             // Vector, matrix, array and pointer element type
+        uint32_t length = 0;              // Vector size, matrix columns, array length
+        uint32_t dim = 1;                 // Images: SPIR-V Dim
+        std::vector<uint32_t> members;    // Struct member types
+        std::vector<uint32_t> offsets;    // Struct member offsets in scalars
+    };
+    struct Instruction {
+        uint32_t opcode = 0;
+        uint32_t type = 0;     // Result type id
+        uint32_t result = 0;   // Result id
+        uint32_t first = 0;    // Operands in `operands`
+        uint32_t count = 0;
+    };
+    struct Block {
+        uint32_t phiBegin = 0, begin = 0, end = 0;  // Phis [phiBegin, begin), body [begin, end), terminator at end
+        uint32_t merge = 0;                         // Selection or loop merge label
+        uint32_t continueTarget = 0;
+        bool loop = false;
+    };
+    struct Function {
+        uint32_t entry = 0;                   // First block label
+        std::vector<uint32_t> parameters;
+        uint32_t returnId = 0;                // Pseudo id holding the return value (0 for void)
+    };
+
+    static const Variable* find(const std::vector<Variable>& variables, int32_t location, int32_t builtIn) {
+        for (const Variable& v : variables) {
+            if (builtIn >= 0 ? v.builtIn == builtIn : v.location == location) return &v;
+        }
+        return nullptr;
+    }
+
+    uint32_t decoration(uint32_t id, uint32_t kind, uint32_t fallback = detail::NONE) const {
+        auto d = decorations.find(id);
+        if (d == decorations.end()) return fallback;
+        auto v = d->second.find(kind);
+        return v == d->second.end() ? fallback : v->second;
+    }
+
+    uint32_t memberDecoration(uint32_t id, uint32_t member, uint32_t kind, uint32_t fallback = detail::NONE) const {
+        return decoration(memberKey(id, member), kind, fallback);
+    }
+
+    // Member decorations share the map under ids past the module's bound
+    uint32_t memberKey(uint32_t id, uint32_t member) const { return bound + id * 64 + std::min(member, 63u); }
+
+    uint32_t allocate(uint32_t id, uint32_t comps) {
+        valueComps[id] = comps;
+        if (comps == 0) return detail::NONE;
+        regOf[id] = registerCount;
+        registerCount += comps;
+        return regOf[id];
+    }
+
+    bool decodeType(uint32_t opcode, const uint32_t* op, uint32_t operands, std::string& error);
+    bool decodeConstant(uint32_t opcode, const uint32_t* op, uint32_t operands, std::string& error);
+    bool evaluateSpecOp(const uint32_t* op, uint32_t operands, std::vector<uint32_t>& value) const;
+    void fill(uint32_t type, const uint8_t* data, size_t size, size_t byteOffset, uint32_t matrixStride, uint32_t slot);
+
+    uint32_t bound = 0;
+    uint32_t model = detail::NONE;
+    uint32_t entry = 0;
+    uint32_t glsl = 0;
+    std::vector<Type> types;
+    std::map<uint32_t, std::map<uint32_t, uint32_t>> decorations;  // id (or memberKey) → decoration → value
+    std::map<uint32_t, std::vector<uint32_t>> constants;          // Flattened constant values
+    std::vector<uint32_t> constantWord;  // Id → first word of its constant (variable slots, struct indices)
+    std::vector<uint32_t> typeOf, regOf, valueComps, blockOf;
+    std::vector<Function> functions;     // By id; entry 0 for ids that aren't functions
+    std::vector<Instruction> code;
+    std::vector<uint32_t> operands;
+    std::vector<Block> blocks;
+    uint32_t registerCount = 0;
+    uint32_t slotCount = 0;
+    uint32_t globalSlots = 0;             // Globals occupy slots [0, globalSlots)
+    std::vector<uint32_t> registerImage;  // Constants and variable pointers, LANES words per register
+    std::vector<uint32_t> memoryImage;    // Initial value of each global slot
+    std::map<uint32_t, std::pair<uint32_t, uint32_t>> blocksByBinding;  // Binding → (slot, block type)
+    std::vector<Variable> inputVariables, outputVariables;
+    std::vector<uint32_t> unsupportedBindings;
+    const Texture* textures[MAX_BINDINGS] = {};
+};
+
+inline bool Program::decodeType(uint32_t opcode, const uint32_t* op, uint32_t operands, std::string& error) {
+    using namespace detail;
+    Type& type = types[op[0]];
+    type.opcode = opcode;
+    switch (opcode) {
+        case OpTypeVoid:
+        case OpTypeFunction:
+            type.comps = 0;
+            break;
+        case OpTypeInt:
+        case OpTypeFloat:
+            if (operands < 2 || op[1] != 32) {
+                error = "only 32-bit scalar types are supported";
+                return false;
+            }
+            type.comps = 1;
+            break;
+        case OpTypeBool:
+        case OpTypeImage:
+        case OpTypeSampler:
+        case OpTypeSampledImage:
+            type.comps = 1;
+            if (opcode == OpTypeImage && operands >= 3) type.dim = op[2];
+            if (opcode == OpTypeSampledImage && operands >= 2) {
+                type.element = op[1];
+                type.dim = types[op[1]].dim;
+            }
+            break;
+        case OpTypeVector:
+        case OpTypeMatrix:
+            type.element = op[1];
+            type.length = op[2];
+            type.comps = types[op[1]].comps * op[2];
+            break;
+        case OpTypeArray: {
+            auto length = constants.find(op[2]);
+            if (length == constants.end() || length->second.empty()) {
+                error = "array length is not a constant";
+                return false;
+            }
+            type.element = op[1];
+            type.length = length->second[0];
+            type.comps = types[op[1]].comps * type.length;
+            break;
+        }
+        case OpTypeRuntimeArray:
+            error = "runtime arrays (storage buffers) are not supported";
+            return false;
+        case OpTypeStruct:
+            for (uint32_t m = 1; m < operands; m++) {
+                type.members.push_back(op[m]);
+                type.offsets.push_back(type.comps);
+                type.comps += types[op[m]].comps;
+            }
+            break;
+        case OpTypePointer:
+            type.element = op[2];
+            type.comps = 1;
+            break;
+    }
+    return true;
+}
+
+inline bool Program::evaluateSpecOp(const uint32_t* op, uint32_t operands, std::vector<uint32_t>& value) const {
+    using namespace detail;
+    // op: result type, result, opcode, operands...
+    std::vector<const std::vector<uint32_t>*> args;
+    for (uint32_t i = 3; i < operands; i++) {
+        auto c = constants.find(op[i]);
+        if (c == constants.end()) return false;
+        args.push_back(&c->second);
+    }
+    uint32_t opcode = op[2];
+    if (opcode == OpCompositeExtract && !args.empty() && operands >= 5) {
+        value = {op[4] < args[0]->size() ? (*args[0])[op[4]] : 0};
+        return true;
+    }
+    if (args.empty()) return false;
+    uint32_t n = static_cast<uint32_t>(args[0]->size());
+    value.assign(n, 0);
+    for (uint32_t c = 0; c < n; c++) {
+        auto arg = [&](size_t i) { return i < args.size() && c < args[i]->size() ? (*args[i])[c] : 0u; };
+        uint32_t a = arg(0), b = arg(1);
+        int32_t sa = static_cast<int32_t>(a), sb = static_cast<int32_t>(b);
+        uint32_t& r = value[c];
+        switch (opcode) {
+            case OpSConvert: case OpUConvert: case OpFConvert: case OpBitcast: r = a; break;
+            case OpConvertSToF: r = floatBits(static_cast<float>(sa)); break;
+            case OpConvertUToF: r = floatBits(static_cast<float>(a)); break;
+            case OpConvertFToS: r = static_cast<uint32_t>(static_cast<int32_t>(bitsFloat(a))); break;
+            case OpConvertFToU: r = static_cast<uint32_t>(std::max(0.0f, bitsFloat(a))); break;
+            case OpSNegate: r = 0u - a; break;
+            case OpNot: r = ~a; break;
+            case OpIAdd: r = a + b; break;
+            case OpISub: r = a - b; break;
+            case OpIMul: r = a * b; break;
+            case OpUDiv: r = b ? a / b : 0; break;
+            case OpSDiv: r = sb ? static_cast<uint32_t>(sa / sb) : 0; break;
+            case OpUMod: r = b ? a % b : 0; break;
+            case OpSRem: case OpSMod: r = sb ? static_cast<uint32_t>(sa % sb) : 0; break;
+            case OpFAdd: r = floatBits(bitsFloat(a) + bitsFloat(b)); break;
+            case OpFSub: r = floatBits(bitsFloat(a) - bitsFloat(b)); break;
+            case OpFMul: r = floatBits(bitsFloat(a) * bitsFloat(b)); break;
+            case OpFDiv: r = floatBits(bitsFloat(a) / bitsFloat(b)); break;
+            case OpShiftLeftLogical: r = a << (b & 31); break;
+            case OpShiftRightLogical: r = a >> (b & 31); break;
+            case OpShiftRightArithmetic: r = static_cast<uint32_t>(sa >> (b & 31)); break;
+            case OpBitwiseOr: r = a | b; break;
+            case OpBitwiseAnd: r = a & b; break;
+            case OpBitwiseXor: r = a ^ b; break;
+            case OpLogicalNot: r = !a; break;
+            case OpLogicalOr: r = a || b; break;
+            case OpLogicalAnd: r = a && b; break;
+            case OpLogicalEqual: case OpIEqual: r = a == b; break;
+            case OpLogicalNotEqual: case OpINotEqual: r = a != b; break;
+            case OpSLessThan: r = sa < sb; break;
+            case OpSGreaterThan: r = sa > sb; break;
+            case OpSLessThanEqual: r = sa <= sb; break;
+            case OpSGreaterThanEqual: r = sa >= sb; break;
+            case OpULessThan: r = a < b; break;
+            case OpUGreaterThan: r = a > b; break;
+            case OpULessThanEqual: r = a <= b; break;
+            case OpUGreaterThanEqual: r = a >= b; break;
+            case OpSelect: r = a ? b : arg(2); break;
+            default: return false;
+        }
+    }
+    return true;
+}
+
+inline bool Program::decodeConstant(uint32_t opcode, const uint32_t* op, uint32_t operands, std::string& error) {
+    using namespace detail;
+    uint32_t type = op[0], id = op[1];
+    std::vector<uint32_t> value;
+    switch (opcode) {
+        case OpConstantTrue:
+        case OpSpecConstantTrue:
+            value = {1};
+            break;
+        case OpConstantFalse:
+        case OpSpecConstantFalse:
+            value = {0};
+            break;
+        case OpConstant:
+        case OpSpecConstant:
+            value = {operands >= 3 ? op[2] : 0};
+            break;
+        case OpConstantNull:
+            value.assign(types[type].comps, 0);
+            break;
+        case OpConstantComposite:
+        case OpSpecConstantComposite:
+            for (uint32_t i = 2; i < operands; i++) {
+                auto c = constants.find(op[i]);
+                if (c == constants.end()) {
+                    error = "composite constant refers to an unknown constant";
+                    return false;
+                }
+                value.insert(value.end(), c->second.begin(), c->second.end());
+            }
+            break;
+        case OpSpecConstantOp:
+            if (!evaluateSpecOp(op, operands, value)) {
+                error = "unsupported OpSpecConstantOp " + std::to_string(operands >= 3 ? op[2] : 0);
+                return false;
+            }
+            break;
+    }
+    typeOf[id] = type;
+    value.resize(types[type].comps, 0);
+    constants[id] = value;
+    allocate(id, types[type].comps);
+    return true;
+}
+
+// Specialization overrides, applied as spec constants are decoded
+inline bool Program::load(const std::vector<uint32_t>& words, const std::vector<uint32_t>& specialization,
+                          std::string& error) {
+    using namespace detail;
+    *this = Program();
+    if (words.size() < 5 || words[0] != 0x07230203) {
+        error = "not a SPIR-V module";
+        return false;
+    }
+    bound = words[3];
+    types.resize(bound);
+    typeOf.assign(bound, 0);
+    regOf.assign(bound, NONE);
+    valueComps.assign(bound, 0);
+    blockOf.assign(bound, NONE);
+    functions.resize(bound);
+
+    struct GlobalVariable { uint32_t id, storage, initializer; };
+    std::vector<GlobalVariable> globals;
+    Function* function = nullptr;
+    Block* block = nullptr;
+
+    for (size_t at = 5; at < words.size();) {
+        uint32_t length = words[at] >> 16;
+        uint32_t opcode = words[at] & 0xffff;
+        if (length == 0 || at + length > words.size()) {
+            error = "truncated instruction at word " + std::to_string(at);
+            return false;
+        }
+        const uint32_t* op = words.data() + at + 1;
+        uint32_t count = length - 1;
+        at += length;
+
+        switch (opcode) {
+            case OpExtInstImport:
+                if (count >= 2 && memcmp(op + 1, "GLSL.std.450", 12) == 0) glsl = op[0];
+                continue;
+            case OpEntryPoint:
+                if (model == NONE && count >= 2) {
+                    model = op[0];
+                    entry = op[1];
+                }
+                continue;
+            case OpDecorate:
+                if (count >= 2 && op[0] < bound) decorations[op[0]][op[1]] = count >= 3 ? op[2] : 1;
+                continue;
+            case OpMemberDecorate:
+                if (count >= 3 && op[0] < bound) decorations[memberKey(op[0], op[1])][op[2]] = count >= 4 ? op[3] : 1;
+                continue;
+            case OpTypeVoid: case OpTypeBool: case OpTypeInt: case OpTypeFloat: case OpTypeVector:
+            case OpTypeMatrix: case OpTypeImage: case OpTypeSampler: case OpTypeSampledImage: case OpTypeArray:
+            case OpTypeRuntimeArray: case OpTypeStruct: case OpTypePointer: case OpTypeFunction:
+                if (count < 1 || op[0] >= bound || !decodeType(opcode, op, count, error)) {
+                    if (error.empty()) error = "malformed type";
+                    return false;
+                }
+                continue;
+            case OpSpecConstantTrue: case OpSpecConstantFalse: case OpSpecConstant:
+                if (count >= 2) {
+                    uint32_t specId = decoration(op[1], DecorationSpecId);
+                    if (specId < specialization.size()) {
+                        uint32_t value = specialization[specId];
+                        if (opcode != OpSpecConstant) opcode = value ? OpSpecConstantTrue : OpSpecConstantFalse;
+                        std::vector<uint32_t> overridden(op, op + count);
+                        if (opcode == OpSpecConstant && overridden.size() >= 3) overridden[2] = value;
+                        if (!decodeConstant(opcode, overridden.data(), count, error)) return false;
+                        continue;
+                    }
+                }
+                [[fallthrough]];
+            case OpConstantTrue: case OpConstantFalse: case OpConstant: case OpConstantComposite:
+            case OpConstantNull: case OpSpecConstantComposite: case OpSpecConstantOp:
+                if (count < 2 || op[1] >= bound || !decodeConstant(opcode, op, count, error)) {
+                    if (error.empty()) error = "malformed constant";
+                    return false;
+                }
+                continue;
+            case OpFunction:
+                if (count < 2 || op[1] >= bound) {
+                    error = "malformed function";
+                    return false;
+                }
+                function = &functions[op[1]];
+                typeOf[op[1]] = op[0];
+                if (types[op[0]].comps > 0) {
+                    // Return values live in a register named past the module's bound
+                    function->returnId = static_cast<uint32_t>(regOf.size());
+                    regOf.push_back(NONE);
+                    valueComps.push_back(0);
+                    allocate(function->returnId, types[op[0]].comps);
+                }
+                continue;
+            case OpFunctionParameter:
+                if (function) {
+                    function->parameters.push_back(op[1]);
+                    typeOf[op[1]] = op[0];
+                    allocate(op[1], types[op[0]].comps);
+                }
+                continue;
+            case OpFunctionEnd:
+                function = nullptr;
+                continue;
+            case OpLabel:
+                if (!function) continue;
+                blockOf[op[0]] = static_cast<uint32_t>(blocks.size());
+                if (function->entry == 0) function->entry = op[0];
+                blocks.push_back(Block());
+                block = &blocks.back();
+                block->phiBegin = block->begin = static_cast<uint32_t>(code.size());
+                continue;
+            case OpLoopMerge:
+                if (block) {
+                    block->loop = true;
+                    block->merge = op[0];
+                    block->continueTarget = op[1];
+                }
+                continue;
+            case OpSelectionMerge:
+                if (block) block->merge = op[0];
+                continue;
+        }
+
+        if (!function) {
+            if (opcode == OpVariable && count >= 3) {
+                globals.push_back({op[1], op[2], count >= 4 ? op[3] : 0});
+                typeOf[op[1]] = op[0];
+                allocate(op[1], 1);
+            } else if (opcode == OpUndef && count >= 2) {
+                typeOf[op[1]] = op[0];
+                constants[op[1]].assign(types[op[0]].comps, 0);
+                allocate(op[1], types[op[0]].comps);
+            }
+            continue;  // Debug info, capabilities, execution modes
+        }
+        if (!block || !executable(opcode)) {
+            if (opcode == 8 || opcode == OpNoLine) continue;  // OpLine
+            error = "unsupported SPIR-V instruction " + std::to_string(opcode);
+            return false;
+        }
+        if (opcode == OpExtInst && (count < 4 || op[2] != glsl || !supportedExtInst(op[3]))) {
+            error = "unsupported extended instruction " + std::to_string(count >= 4 ? op[3] : 0);
+            return false;
+        }
+
+        Instruction instruction;
+        instruction.opcode = opcode;
+        uint32_t skip = 0;
+        if (hasResult(opcode)) {
+            instruction.type = op[0];
+            instruction.result = op[1];
+            typeOf[op[1]] = op[0];
+            allocate(op[1], types[op[0]].comps);
+            skip = 2;
+        }
+        instruction.first = static_cast<uint32_t>(operands.size());
+        instruction.count = count - skip;
+        operands.insert(operands.end(), op + skip, op + count);
+        if (opcode == OpPhi && block->begin != code.size()) {
+            error = "OpPhi after the start of a block";
+            return false;
+        }
+        code.push_back(instruction);
+        if (opcode == OpPhi) {
+            block->begin = static_cast<uint32_t>(code.size());
+        }
+        switch (opcode) {
+            case OpBranch: case OpBranchConditional: case OpSwitch: case OpKill: case OpReturn: case OpReturnValue:
+            case OpUnreachable: case OpTerminateInvocation:
+                block->end = static_cast<uint32_t>(code.size() - 1);
+                block = nullptr;
+                break;
+        }
+    }
+    if (model != ModelVertex && model != ModelFragment) {
+        error = "not a vertex or fragment shader";
+        return false;
+    }
+    if (entry >= bound || !functions[entry].entry) {
+        error = "entry point has no body";
+        return false;
+    }
+
+    // Memory: globals first (reset for each group of lanes), then function variables
+    for (const GlobalVariable& g : globals) {
+        uint32_t pointee = types[typeOf[g.id]].element;
+        if (g.storage == StorageStorageBuffer) {
+            error = "storage buffers are not supported";
+            return false;
+        }
+        uint32_t slot = slotCount;
+        slotCount += std::max(1u, types[pointee].comps);
+        memoryImage.resize(slotCount, 0);
+        constants[g.id] = {slot};
+        if (g.initializer && constants.count(g.initializer)) {
+            const std::vector<uint32_t>& init = constants[g.initializer];
+            std::copy(init.begin(), init.begin() + std::min<size_t>(init.size(), slotCount - slot),
+                      memoryImage.begin() + slot);
+        }
+        uint32_t binding = decoration(g.id, DecorationBinding, 0);
+        if (g.storage == StorageUniformConstant) {
+            memoryImage[slot] = binding;
+            uint32_t dim = types[pointee].dim;
+            if (dim != 1 && std::find(unsupportedBindings.begin(), unsupportedBindings.end(), binding) ==
+                                unsupportedBindings.end()) {
+                unsupportedBindings.push_back(binding);
+            }
+        } else if (g.storage == StorageUniform) {
+            blocksByBinding[binding] = {slot, pointee};
+        } else if (g.storage == StoragePushConstant) {
+            blocksByBinding[PUSH_CONSTANTS] = {slot, pointee};
+        } else if (g.storage == StorageInput || g.storage == StorageOutput) {
+            std::vector<Variable>& list = g.storage == StorageInput ? inputVariables : outputVariables;
+            const Type& type = types[pointee];
+            if (type.opcode == OpTypeStruct) {
+                // gl_PerVertex: one variable per built-in member
+                for (uint32_t m = 0; m < type.members.size(); m++) {
+                    Variable v;
+                    v.slot = slot + type.offsets[m];
+                    v.comps = types[type.members[m]].comps;
+                    v.builtIn = static_cast<int32_t>(memberDecoration(pointee, m, DecorationBuiltIn, NONE));
+                    v.location = static_cast<int32_t>(memberDecoration(pointee, m, DecorationLocation, NONE));
+                    list.push_back(v);
+                }
+            } else {
+                Variable v;
+                v.slot = slot;
+                v.comps = type.comps;
+                v.builtIn = static_cast<int32_t>(decoration(g.id, DecorationBuiltIn, NONE));
+                v.location = static_cast<int32_t>(decoration(g.id, DecorationLocation, NONE));
+                list.push_back(v);
+            }
+        }
+    }
+    globalSlots = slotCount;
+    for (const Instruction& instruction : code) {
+        if (instruction.opcode == OpVariable) {
+            constants[instruction.result] = {slotCount};
+            slotCount += std::max(1u, types[types[instruction.type].element].comps);
+        } else if (instruction.opcode == OpFunctionCall) {
+            uint32_t callee = instruction.count ? operands[instruction.first] : NONE;
+            if (callee >= bound || !functions[callee].entry) {
+                error = "call to a function without a body";
+                return false;
+            }
+        }
+    }
+
+    registerImage.assign(static_cast<size_t>(registerCount) * LANES, 0);
+    for (const auto& c : constants) {
+        uint32_t reg = regOf[c.first];
+        for (uint32_t i = 0; reg != NONE && i < c.second.size() && i < valueComps[c.first]; i++) {
+            std::fill_n(&registerImage[(static_cast<size_t>(reg) + i) * LANES], LANES, c.second[i]);
+        }
+    }
+    // What the interpreter looks up per instruction, resolved once
+    constantWord.assign(bound, 0);
+    for (const auto& c : constants) {
+        if (c.first < bound && !c.second.empty()) constantWord[c.first] = c.second[0];
+    }
+    return true;
+}
+
+inline void Program::fill(uint32_t typeId, const uint8_t* data, size_t size, size_t byteOffset, uint32_t matrixStride,
+                          uint32_t slot) {
+    using namespace detail;
+    const Type& type = types[typeId];
+    switch (type.opcode) {
+        case OpTypeInt:
+        case OpTypeFloat:
+        case OpTypeBool:
+            if (byteOffset + 4 <= size) memcpy(&memoryImage[slot], data + byteOffset, 4);
+            break;
+        case OpTypeVector:
+            for (uint32_t i = 0; i < type.length; i++) {
+                fill(type.element, data, size, byteOffset + 4 * i, 0, slot + i);
+            }
+            break;
+        case OpTypeMatrix: {
+            uint32_t stride = matrixStride ? matrixStride : 16;
+            for (uint32_t i = 0; i < type.length; i++) {
+                fill(type.element, data, size, byteOffset + i * stride, 0, slot + i * types[type.element].comps);
+            }
+            break;
+        }
+        case OpTypeArray: {
+            uint32_t stride = decoration(typeId, DecorationArrayStride, 16);
+            for (uint32_t i = 0; i < type.length; i++) {
+                fill(type.element, data, size, byteOffset + i * stride, matrixStride,
+                     slot + i * types[type.element].comps);
+            }
+            break;
+        }
+        case OpTypeStruct:
+            for (uint32_t m = 0; m < type.members.size(); m++) {
+                uint32_t offset = memberDecoration(typeId, m, DecorationOffset, 0);
+                uint32_t stride = memberDecoration(typeId, m, DecorationMatrixStride, 0);
+                fill(type.members[m], data, size, byteOffset + offset, stride, slot + type.offsets[m]);
+            }
+            break;
+    }
+}
+
+inline void Program::setBlock(uint32_t binding, const void* data, size_t size) {
+    auto block = blocksByBinding.find(binding);
+    if (block != blocksByBinding.end()) {
+        fill(block->second.second, static_cast<const uint8_t*>(data), size, 0, 0, block->second.first);
+    }
+}
+
+// Execution state for one worker: a register file and memory, LANES words per entry
+class Invocation {
+public:
+    explicit Invocation(const Program& program)
+        : p(program), regs(program.registerImage), memory(static_cast<size_t>(program.slotCount) * LANES, 0) {}
+
+    // Start a new group of lanes: globals go back to their initial values (uniform data,
+    // initialisers, zeroed inputs and outputs); function variables start undefined as in GLSL
+    void begin() {
+        for (uint32_t s = 0; s < p.globalSlots; s++) {
+            std::fill_n(&memory[static_cast<size_t>(s) * LANES], LANES, p.memoryImage[s]);
+        }
+    }
+
+    // LANES words of one memory slot (interface variables: Program::Variable::slot + component)
+    uint32_t* slot(uint32_t index) { return &memory[static_cast<size_t>(index) * LANES]; }
+
+    // Run the entry point on the lanes in mask; returns those that were not discarded
+    uint32_t run(uint32_t mask) {
+        killed = 0;
+        runFunction(p.entry, mask, 0);
+        return mask & ~killed;
+    }
+
+private:
+    using Instruction = Program::Instruction;
+    using Block = Program::Block;
+
+    // Lanes leave a region by branching to one of its stop labels: the enclosing region's
+    // stops, then its own (merge, continue target, loop header). Regions nest (selections,
+    // loops), one per depth, and share two stacks: a region's stops are stopStack[base, base +
+    // size) with its own appended after its parent's, so nothing is copied on entry, and its
+    // arrival masks (the lanes that reached each stop) are arrivalStack[arrivalBase, ...).
+    struct Region {
+        size_t base = 0;
+        size_t parentCount = 0;  // Stops inherited from the enclosing region
+        size_t size = 0;
+        size_t arrivalBase = 0;
+    };
+
+    const uint32_t* value(uint32_t id, uint32_t component = 0) const {
+        uint32_t c = p.valueComps[id] == 1 ? 0 : component;
+        return &regs[(static_cast<size_t>(p.regOf[id]) + c) * LANES];
+    }
+    uint32_t* target(uint32_t id, uint32_t component = 0) {
+        return &regs[(static_cast<size_t>(p.regOf[id]) + component) * LANES];
+    }
+    uint32_t comps(uint32_t id) const { return p.valueComps[id]; }
+
+    // Copy n components (masked)
+    void copy(uint32_t* dst, const uint32_t* src, uint32_t n, uint32_t mask) {
+        for (uint32_t c = 0; c < n; c++) {
+            detail::putLanes(dst + c * LANES, src + c * LANES, mask);
+        }
+    }
+
+    // Whole value into a buffer of comps × LANES floats (scalars broadcast to n components)
+    void loadFloats(uint32_t id, float* out, uint32_t n) const {
+        for (uint32_t c = 0; c < n; c++) {
+            detail::loadLanes(value(id, c), out + c * LANES);
+        }
+    }
+
+    template <typename T, typename F>
+    void unary(const Instruction& in, uint32_t a, uint32_t mask, F f) {
+        using R = decltype(f(T()));
+        for (uint32_t c = 0; c < comps(in.result); c++) {
+            T x[LANES];
+            R r[LANES];
+            detail::loadLanes(value(a, c), x);
+            for (uint32_t l = 0; l < LANES; l++) r[l] = f(x[l]);
+            detail::storeLanes(target(in.result, c), r, mask);
+        }
+    }
+
+    template <typename T, typename F>
+    void binary(const Instruction& in, uint32_t a, uint32_t b, uint32_t mask, F f) {
+        using R = decltype(f(T(), T()));
+        for (uint32_t c = 0; c < comps(in.result); c++) {
+            T x[LANES], y[LANES];
+            R r[LANES];
+            detail::loadLanes(value(a, c), x);
+            detail::loadLanes(value(b, c), y);
+            for (uint32_t l = 0; l < LANES; l++) r[l] = f(x[l], y[l]);
+            detail::storeLanes(target(in.result, c), r, mask);
+        }
+    }
+
+    template <typename T, typename F>
+    void ternary(const Instruction& in, uint32_t a, uint32_t b, uint32_t d, uint32_t mask, F f) {
+        using R = decltype(f(T(), T(), T()));
+        for (uint32_t c = 0; c < comps(in.result); c++) {
+            T x[LANES], y[LANES], z[LANES];
+            R r[LANES];
+            detail::loadLanes(value(a, c), x);
+            detail::loadLanes(value(b, c), y);
+            detail::loadLanes(value(d, c), z);
+            for (uint32_t l = 0; l < LANES; l++) r[l] = f(x[l], y[l], z[l]);
+            detail::storeLanes(target(in.result, c), r, mask);
+        }
+    }
+
+    // Flat component offset and type of a constant index into a composite type
+    void step(uint32_t& type, uint32_t index, uint32_t& offset) const {
+        const Program::Type& t = p.types[type];
+        if (t.opcode == detail::OpTypeStruct) {
+            offset += t.offsets[std::min<size_t>(index, t.offsets.size() - 1)];
+            type = t.members[std::min<size_t>(index, t.members.size() - 1)];
+        } else {
+            offset += std::min(index, t.length ? t.length - 1 : 0) * p.types[t.element].comps;
+            type = t.element;
+        }
+    }
+
+    Region& enter(size_t depth, const Region* parent, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0) {
+        while (regions.size() <= depth) regions.emplace_back();
+        Region& region = regions[depth];
+        // Stacked above the region this one runs inside (the caller's, for a function)
+        const Region* below = depth ? &regions[depth - 1] : nullptr;
+        region.base = parent ? parent->base : below ? below->base + below->size : 0;
+        region.parentCount = parent ? parent->size : 0;
+        region.size = region.parentCount;
+        region.arrivalBase = below ? below->arrivalBase + below->size : 0;
+        size_t end = region.base + region.size + 3;
+        if (stopStack.size() < end) stopStack.resize(end);
+        for (uint32_t label : {a, b, c}) {
+            if (label) stopStack[region.base + region.size++] = label;
+        }
+        end = region.arrivalBase + region.size;
+        if (arrivalStack.size() < end) arrivalStack.resize(end);
+        std::fill(arrivalStack.begin() + region.arrivalBase, arrivalStack.begin() + end, 0u);
+        return region;
+    }
+
+    // Index of the first of the region's stops that is label, region.size if none
+    size_t find(const Region& region, uint32_t label) const {
+        const uint32_t* stops = &stopStack[region.base];
+        for (size_t i = 0; i < region.size; i++) {
+            if (stops[i] == label) return i;
+        }
+        return region.size;
+    }
+
+    uint32_t& arrival(const Region& region, size_t i) { return arrivalStack[region.arrivalBase + i]; }
+
+    // Pass arrivals at the enclosing region's stops outwards, except for the given labels
+    void propagate(size_t depth, uint32_t skipA, uint32_t skipB = 0, uint32_t skipC = 0) {
+        const Region& inner = regions[depth + 1];
+        const Region& outer = regions[depth];
+        for (size_t i = 0; i < inner.parentCount; i++) {
+            uint32_t label = stopStack[inner.base + i];
+            if (label != skipA && label != skipB && label != skipC) arrival(outer, i) |= arrival(inner, i);
+        }
+    }
+
+    bool deposit(uint32_t label, uint32_t mask, size_t depth) {
+        const Region& region = regions[depth];
+        size_t i = find(region, label);
+        if (i == region.size) return false;
+        arrival(region, i) |= mask;
+        return true;
+    }
+
+    void setPredecessor(uint32_t label, uint32_t mask) {
+        for (uint32_t l = 0; l < LANES; l++) {
+            if (mask & (1u << l)) predecessor[l] = label;
+        }
+    }
+
+    void runFunction(uint32_t id, uint32_t mask, size_t depth) {
+        const Program::Function& function = p.functions[id];
+        uint32_t savedReturn = returnId;
+        returnId = function.returnId;
+        enter(depth, nullptr);
+        run(function.entry, mask, depth, 0);
+        returnId = savedReturn;
+    }
+
+    // Both sides of a selection (or every case of a switch); returns the lanes at its merge
+    uint32_t select(size_t depth, uint32_t merge, const std::pair<uint32_t, uint32_t>* targets, size_t count) {
+        Region& inner = enter(depth + 1, &regions[depth], merge);
+        for (size_t i = 0; i < count; i++) {
+            if (targets[i].second && !deposit(targets[i].first, targets[i].second, depth + 1)) {
+                run(targets[i].first, targets[i].second, depth + 1, 0);
+            }
+        }
+        propagate(depth, merge);
+        return arrival(inner, find(inner, merge));
+    }
+
+    uint32_t runLoop(uint32_t header, uint32_t mask, size_t depth) {
+        const Block& block = p.blocks[p.blockOf[header]];
+        uint32_t merge = block.merge, continueTarget = block.continueTarget;
+        uint32_t exit = 0, active = mask;
+        for (uint32_t iteration = 0; active; iteration++) {
+            if (iteration == MAX_LOOP_ITERATIONS) {
+                exit |= active;
+                break;
+            }
+            Region& body = enter(depth + 1, &regions[depth], merge, continueTarget, header);
+            run(header, active, depth + 1, header);
+            exit |= arrival(body, find(body, merge));
+            uint32_t continuing = arrival(body, find(body, continueTarget));
+            uint32_t back = continueTarget == header ? 0 : arrival(body, find(body, header));
+            propagate(depth, merge, continueTarget, header);
+            if (continueTarget != header && continuing) {
+                Region& step = enter(depth + 1, &regions[depth], merge, header);
+                run(continueTarget, continuing, depth + 1, 0);
+                exit |= arrival(step, find(step, merge));
+                back |= arrival(step, find(step, header));
+                propagate(depth, merge, header);
+            } else {
+                back |= continuing;
+            }
+            active = back & ~killed;
+        }
+        return exit & ~killed;
+    }
+
+    // Run from label until every lane has reached a stop of regions[depth], returned or died
+    void run(uint32_t label, uint32_t mask, size_t depth, uint32_t activeLoop) {
+        using namespace detail;
+        for (;;) {
+            mask &= ~killed;
+            if (!mask) return;
+            const Block& block = p.blocks[p.blockOf[label]];
+            if (block.loop && label != activeLoop) {
+                mask = runLoop(label, mask, depth);
+                label = block.merge;
+                activeLoop = 0;
+                if (deposit(label, mask, depth)) return;
+                continue;
+            }
+            activeLoop = 0;  // The header runs once per iteration
+
+            runPhis(block, mask);
+            for (uint32_t i = block.begin; i < block.end && mask; i++) {
+                execute(p.code[i], mask, depth);
+            }
+            if (!mask) return;
+
+            const Instruction& terminator = p.code[block.end];
+            const uint32_t* op = &p.operands[terminator.first];
+            setPredecessor(label, mask);
+            switch (terminator.opcode) {
+                case OpBranch:
+                    if (deposit(op[0], mask, depth)) return;
+                    label = op[0];
+                    continue;
+                case OpBranchConditional: {
+                    uint32_t lanes[LANES], taken = 0;
+                    loadLanes(value(op[0]), lanes);
+                    for (uint32_t l = 0; l < LANES; l++) {
+                        if (lanes[l]) taken |= 1u << l;
+                    }
+                    uint32_t whenTrue = mask & taken, whenFalse = mask & ~taken;
+                    if (block.merge && !block.loop) {
+                        std::pair<uint32_t, uint32_t> targets[2] = {{op[1], whenTrue}, {op[2], whenFalse}};
+                        mask = select(depth, block.merge, targets, 2);
+                        label = block.merge;
+                        if (deposit(label, mask, depth)) return;
+                        continue;
+                    }
+                    // Loop tests, breaks and continues: at least one side leaves the region
+                    bool stopTrue = deposit(op[1], whenTrue, depth);
+                    bool stopFalse = deposit(op[2], whenFalse, depth);
+                    if (!stopTrue && !stopFalse) {
+                        run(op[1], whenTrue, depth, 0);
+                        label = op[2];
+                        mask = whenFalse;
+                    } else if (!stopTrue) {
+                        label = op[1];
+                        mask = whenTrue;
+                    } else if (!stopFalse) {
+                        label = op[2];
+                        mask = whenFalse;
+                    } else {
+                        return;
+                    }
+                    continue;
+                }
+                case OpSwitch: {
+                    std::vector<std::pair<uint32_t, uint32_t>> targets;
+                    uint32_t selector[LANES];
+                    loadLanes(value(op[0]), selector);
+                    for (uint32_t l = 0; l < LANES; l++) {
+                        if (!(mask & (1u << l))) continue;
+                        uint32_t destination = op[1];
+                        for (uint32_t i = 2; i + 1 < terminator.count; i += 2) {
+                            if (op[i] == selector[l]) {
+                                destination = op[i + 1];
+                                break;
+                            }
+                        }
+                        auto existing = std::find_if(targets.begin(), targets.end(), [&](const std::pair<uint32_t, uint32_t>& t) {
+                            return t.first == destination;
+                        });
+                        if (existing == targets.end()) {
+                            targets.push_back({destination, 1u << l});
+                        } else {
+                            existing->second |= 1u << l;
+                        }
+                    }
+                    if (!block.merge) {
+                        for (const auto& t : targets) {
+                            if (!deposit(t.first, t.second, depth)) run(t.first, t.second, depth, 0);
+                        }
+                        return;
+                    }
+                    mask = select(depth, block.merge, targets.data(), targets.size());
+                    label = block.merge;
+                    if (deposit(label, mask, depth)) return;
+                    continue;
+                }
+                case OpReturnValue:
+                    if (returnId) copy(target(returnId), value(op[0]), comps(returnId), mask);
+                    return;
+                case OpKill:
+                case OpTerminateInvocation:
+                    killed |= mask;
+                    return;
+                default:  // OpReturn, OpUnreachable
+                    return;
+            }
+        }
+    }
+
+    // Parallel copy: every phi reads its incoming value before any is written
+    void runPhis(const Block& block, uint32_t mask) {
+        size_t used = 0;
+        for (uint32_t i = block.phiBegin; i < block.begin; i++) {
+            const Instruction& phi = p.code[i];
+            const uint32_t* op = &p.operands[phi.first];
+            uint32_t n = comps(phi.result);
+            if (phiScratch.size() < used + n * LANES) phiScratch.resize(used + n * LANES);
+            uint32_t* out = &phiScratch[used];
+            for (uint32_t k = 0; k + 1 < phi.count; k += 2) {
+                uint32_t from = 0;
+                for (uint32_t l = 0; l < LANES; l++) {
+                    if (predecessor[l] == op[k + 1]) from |= 1u << l;
+                }
+                if (from & mask) {
+                    for (uint32_t c = 0; c < n; c++) detail::putLanes(out + c * LANES, value(op[k], c), from & mask);
+                }
+            }
+            used += n * LANES;
+        }
+        used = 0;
+        for (uint32_t i = block.phiBegin; i < block.begin; i++) {
+            uint32_t n = comps(p.code[i].result);
+            copy(target(p.code[i].result), &phiScratch[used], n, mask);
+            used += n * LANES;
+        }
+    }
+
+    void execute(const Instruction& in, uint32_t& mask, size_t depth);
+    void extInst(const Instruction& in, const uint32_t* op, uint32_t mask);
+    void image(const Instruction& in, const uint32_t* op, uint32_t mask);
+    void derivative(const Instruction& in, uint32_t a, uint32_t mask);
+
+    const Program& p;
+    std::vector<uint32_t> regs;
+    std::vector<uint32_t> memory;
+    std::vector<float> scratch;
+    std::vector<uint32_t> phiScratch;
+    std::deque<Region> regions;  // deque: references stay valid as deeper regions are added
+    std::vector<uint32_t> stopStack, arrivalStack;
+    uint32_t predecessor[LANES] = {};
+    uint32_t killed = 0;
+    uint32_t returnId = 0;
+};
+
+inline void Invocation::derivative(const Instruction& in, uint32_t a, uint32_t mask) {
+    using namespace detail;
+    // Lanes: x = l & 3, y = l >> 2; quad neighbours differ in bit 0 (x) and bit 2 (y)
+    bool coarse = in.opcode >= OpDPdxCoarse;
+    int kind = (in.opcode - OpDPdx) % 3;  // 0 = d/dx, 1 = d/dy, 2 = fwidth
+    for (uint32_t c = 0; c < comps(in.result); c++) {
+        float v[LANES], r[LANES];
+        loadLanes(value(a, c), v);
+        for (uint32_t l = 0; l < LANES; l++) {
+            uint32_t xRow = coarse ? (l & ~5u) : (l & ~1u);
+            uint32_t yColumn = coarse ? (l & ~5u) : (l & ~4u);
+            float dx = v[xRow | 1] - v[xRow];
+            float dy = v[yColumn | 4] - v[yColumn];
+            r[l] = kind == 0 ? dx : kind == 1 ? dy : std::fabs(dx) + std::fabs(dy);
+        }
+        storeLanes(target(in.result, c), r, mask);
+    }
+}
+
+inline void Invocation::image(const Instruction& in, const uint32_t* op, uint32_t mask) {
+    using namespace detail;
+    uint32_t lane = 0;
+    while (lane + 1 < LANES && !(mask & (1u << lane))) lane++;
+    uint32_t binding = value(op[0])[lane];
+    const Texture* texture = binding < MAX_BINDINGS ? p.textures[binding] : nullptr;
+    uint32_t type = p.typeOf[op[0]];
+    bool flat = p.types[type].dim == 1;
+    uint32_t n = comps(in.result);
+
+    if (in.opcode == OpImageQuerySizeLod || in.opcode == OpImageQuerySize || in.opcode == OpImageQueryLevels) {
+        int32_t size[3] = {texture ? static_cast<int32_t>(texture->width) : 1,
+                           texture ? static_cast<int32_t>(texture->height) : 1, 1};
+        for (uint32_t c = 0; c < n; c++) {
+            int32_t lanes[LANES];
+            std::fill_n(lanes, LANES, in.opcode == OpImageQueryLevels ? 1 : size[std::min(c, 2u)]);
+            storeLanes(target(in.result, c), lanes, mask);
+        }
+        return;
+    }
+
+    float texel[4][LANES] = {};
+    if (texture && flat) {
+        float u[LANES], v[LANES];
+        int32_t x[LANES], y[LANES];
+        if (in.opcode == OpImageFetch) {
+            loadLanes(value(op[1], 0), x);
+            loadLanes(value(op[1], 1), y);
+        } else {
+            loadLanes(value(op[1], 0), u);
+            loadLanes(value(op[1], 1), v);
+        }
+        for (uint32_t l = 0; l < LANES; l++) {
+            if (!(mask & (1u << l))) continue;
+            float out[4];
+            if (in.opcode == OpImageFetch) {
+                texture->fetch(x[l], y[l], out);
+            } else {
+                texture->sample(u[l], v[l], out);
+            }
+            for (int c = 0; c < 4; c++) texel[c][l] = out[c];
+        }
+    }
+    for (uint32_t c = 0; c < n && c < 4; c++) {
+        storeLanes(target(in.result, c), texel[c], mask);
+    }
+}
+
+inline void Invocation::extInst(const Instruction& in, const uint32_t* op, uint32_t mask) {
+    using namespace detail;
+    uint32_t a = in.count > 2 ? op[2] : 0, b = in.count > 3 ? op[3] : 0, c = in.count > 4 ? op[4] : 0;
+    switch (op[1]) {
+        case 1: unary<float>(in, a, mask, [](float x) { return std::round(x); }); return;
+        case 2: unary<float>(in, a, mask, [](float x) { return std::nearbyint(x); }); return;
+        case 3: unary<float>(in, a, mask, [](float x) { return std::trunc(x); }); return;
+        case 4: unary<float>(in, a, mask, [](float x) { return std::fabs(x); }); return;
+        case 5: unary<int32_t>(in, a, mask, [](int32_t x) { return x < 0 ? static_cast<int32_t>(0u - static_cast<uint32_t>(x)) : x; }); return;
+        case 6: unary<float>(in, a, mask, [](float x) { return x > 0.0f ? 1.0f : x < 0.0f ? -1.0f : 0.0f; }); return;
+        case 7: unary<int32_t>(in, a, mask, [](int32_t x) { return x > 0 ? 1 : x < 0 ? -1 : 0; }); return;
+        case 8: unary<float>(in, a, mask, [](float x) { return std::floor(x); }); return;
+        case 9: unary<float>(in, a, mask, [](float x) { return std::ceil(x); }); return;
+        case 10: unary<float>(in, a, mask, [](float x) { return x - std::floor(x); }); return;
+        case 11: unary<float>(in, a, mask, [](float x) { return x * 0.017453292519943295f; }); return;
+        case 12: unary<float>(in, a, mask, [](float x) { return x * 57.29577951308232f; }); return;
+        case 13: unary<float>(in, a, mask, [](float x) { return std::sin(x); }); return;
+        case 14: unary<float>(in, a, mask, [](float x) { return std::cos(x); }); return;
+        case 15: unary<float>(in, a, mask, [](float x) { return std::tan(x); }); return;
+        case 16: unary<float>(in, a, mask, [](float x) { return std::asin(x); }); return;
+        case 17: unary<float>(in, a, mask, [](float x) { return std::acos(x); }); return;
+        case 18: unary<float>(in, a, mask, [](float x) { return std::atan(x); }); return;
+        case 19: unary<float>(in, a, mask, [](float x) { return std::sinh(x); }); return;
+        case 20: unary<float>(in, a, mask, [](float x) { return std::cosh(x); }); return;
+        case 21: unary<float>(in, a, mask, [](float x) { return std::tanh(x); }); return;
+        case 22: unary<float>(in, a, mask, [](float x) { return std::asinh(x); }); return;
+        case 23: unary<float>(in, a, mask, [](float x) { return std::acosh(x); }); return;
+        case 24: unary<float>(in, a, mask, [](float x) { return std::atanh(x); }); return;
+        case 25: binary<float>(in, a, b, mask, [](float y, float x) { return std::atan2(y, x); }); return;
+        case 26: binary<float>(in, a, b, mask, [](float x, float y) { return std::pow(x, y); }); return;
+        case 27: unary<float>(in, a, mask, [](float x) { return std::exp(x); }); return;
+        case 28: unary<float>(in, a, mask, [](float x) { return std::log(x); }); return;
+        case 29: unary<float>(in, a, mask, [](float x) { return std::exp2(x); }); return;
+        case 30: unary<float>(in, a, mask, [](float x) { return std::log2(x); }); return;
+        case 31: unary<float>(in, a, mask, [](float x) { return std::sqrt(x); }); return;
+        case 32: unary<float>(in, a, mask, [](float x) { return 1.0f / std::sqrt(x); }); return;
+        case 33:    // Determinant
+        case 34: {  // MatrixInverse
+            uint32_t n = p.types[p.typeOf[a]].length;
+            std::vector<float> m(n * n * LANES);
+            loadFloats(a, m.data(), n * n);
+            std::vector<float> out(op[1] == 33 ? LANES : n * n * LANES);
+            for (uint32_t l = 0; l < LANES; l++) {
+                // Gauss-Jordan with partial pivoting on [M | I]
+                double work[4][8] = {};
+                for (uint32_t i = 0; i < n; i++) {
+                    for (uint32_t j = 0; j < n; j++) work[i][j] = m[(j * n + i) * LANES + l];  // Row i, column j
+                    work[i][n + i] = 1.0;
+                }
+                double det = 1.0;
+                for (uint32_t col = 0; col < n; col++) {
+                    uint32_t pivot = col;
+                    for (uint32_t r = col + 1; r < n; r++) {
+                        if (std::fabs(work[r][col]) > std::fabs(work[pivot][col])) pivot = r;
+                    }
+                    if (pivot != col) {
+                        std::swap(work[pivot], work[col]);
+                        det = -det;
+                    }
+                    double d = work[col][col];
+                    det *= d;
+                    if (d == 0.0) continue;
+                    for (uint32_t j = 0; j < 2 * n; j++) work[col][j] /= d;
+                    for (uint32_t r = 0; r < n; r++) {
+                        if (r == col) continue;
+                        double f = work[r][col];
+                        for (uint32_t j = 0; j < 2 * n; j++) work[r][j] -= f * work[col][j];
+                    }
+                }
+                if (op[1] == 33) {
+                    out[l] = static_cast<float>(det);
+                } else {
+                    for (uint32_t i = 0; i < n; i++) {
+                        for (uint32_t j = 0; j < n; j++) out[(j * n + i) * LANES + l] = static_cast<float>(work[i][n + j]);
+                    }
+                }
+            }
+            for (uint32_t k = 0; k < comps(in.result); k++) storeLanes(target(in.result, k), &out[k * LANES], mask);
+            return;
+        }
+        case 35: {  // Modf: fraction returned, whole part stored through the pointer
+            unary<float>(in, a, mask, [](float x) { return x - std::trunc(x); });
+            uint32_t slots[LANES];
+            loadLanes(value(b), slots);
+            for (uint32_t k = 0; k < comps(in.result); k++) {
+                float x[LANES];
+                loadLanes(value(a, k), x);
+                for (uint32_t l = 0; l < LANES; l++) {
+                    if (mask & (1u << l)) memory[(static_cast<size_t>(slots[l]) + k) * LANES + l] = floatBits(std::trunc(x[l]));
+                }
+            }
+            return;
+        }
+        case 37: case 79: binary<float>(in, a, b, mask, [](float x, float y) { return y < x ? y : x; }); return;
+        case 38: binary<uint32_t>(in, a, b, mask, [](uint32_t x, uint32_t y) { return std::min(x, y); }); return;
+        case 39: binary<int32_t>(in, a, b, mask, [](int32_t x, int32_t y) { return std::min(x, y); }); return;
+        case 40: case 80: binary<float>(in, a, b, mask, [](float x, float y) { return x < y ? y : x; }); return;
+        case 41: binary<uint32_t>(in, a, b, mask, [](uint32_t x, uint32_t y) { return std::max(x, y); }); return;
+        case 42: binary<int32_t>(in, a, b, mask, [](int32_t x, int32_t y) { return std::max(x, y); }); return;
+        case 43: case 81:
+            ternary<float>(in, a, b, c, mask, [](float x, float lo, float hi) { return std::min(std::max(x, lo), hi); });
+            return;
+        case 44:
+            ternary<uint32_t>(in, a, b, c, mask, [](uint32_t x, uint32_t lo, uint32_t hi) { return std::min(std::max(x, lo), hi); });
+            return;
+        case 45:
+            ternary<int32_t>(in, a, b, c, mask, [](int32_t x, int32_t lo, int32_t hi) { return std::min(std::max(x, lo), hi); });
+            return;
+        case 46: ternary<float>(in, a, b, c, mask, [](float x, float y, float t) { return x * (1.0f - t) + y * t; }); return;
+        case 47: ternary<float>(in, a, b, c, mask, [](float x, float y, float t) { return t != 0.0f ? y : x; }); return;
+        case 48: binary<float>(in, a, b, mask, [](float edge, float x) { return x < edge ? 0.0f : 1.0f; }); return;
+        case 49:
+            ternary<float>(in, a, b, c, mask, [](float e0, float e1, float x) {
+                float t = std::min(std::max((x - e0) / (e1 - e0), 0.0f), 1.0f);
+                return t * t * (3.0f - 2.0f * t);
+            });
+            return;
+        case 50: ternary<float>(in, a, b, c, mask, [](float x, float y, float z) { return std::fma(x, y, z); }); return;
+        default:
+            break;
+    }
+
+    // Geometric functions work across components
+    uint32_t na = comps(a);
+    float x[4][LANES], y[4][LANES], z[4][LANES], r[4][LANES];
+    for (uint32_t k = 0; k < na && k < 4; k++) {
+        loadLanes(value(a, k), x[k]);
+        if (b) loadLanes(value(b, k), y[k]);
+        if (c && op[1] != 72) loadLanes(value(c, k), z[k]);
+    }
+    auto dot = [&](float (*u)[LANES], float (*v)[LANES], uint32_t l) {
+        float sum = 0.0f;
+        for (uint32_t k = 0; k < na; k++) sum += u[k][l] * v[k][l];
+        return sum;
+    };
+    for (uint32_t l = 0; l < LANES; l++) {
+        switch (op[1]) {
+            case 66: r[0][l] = std::sqrt(dot(x, x, l)); break;  // Length
+            case 67: {                                          // Distance
+                float sum = 0.0f;
+                for (uint32_t k = 0; k < na; k++) sum += (x[k][l] - y[k][l]) * (x[k][l] - y[k][l]);
+                r[0][l] = std::sqrt(sum);
+                break;
+            }
+            case 68:  // Cross
+                r[0][l] = x[1][l] * y[2][l] - y[1][l] * x[2][l];
+                r[1][l] = x[2][l] * y[0][l] - y[2][l] * x[0][l];
+                r[2][l] = x[0][l] * y[1][l] - y[0][l] * x[1][l];
+                break;
+            case 69: {  // Normalize
+                float inverse = 1.0f / std::sqrt(dot(x, x, l));
+                for (uint32_t k = 0; k < na; k++) r[k][l] = x[k][l] * inverse;
+                break;
+            }
+            case 70: {  // FaceForward(N, I, Nref)
+                float sign = dot(z, y, l) < 0.0f ? 1.0f : -1.0f;
+                for (uint32_t k = 0; k < na; k++) r[k][l] = x[k][l] * sign;
+                break;
+            }
+            case 71: {  // Reflect(I, N)
+                float d = 2.0f * dot(y, x, l);
+                for (uint32_t k = 0; k < na; k++) r[k][l] = x[k][l] - d * y[k][l];
+                break;
+            }
+            case 72: {  // Refract(I, N, eta)
+                float eta = bitsFloat(value(c)[l]);
+                float d = dot(y, x, l);
+                float k2 = 1.0f - eta * eta * (1.0f - d * d);
+                for (uint32_t k = 0; k < na; k++) {
+                    r[k][l] = k2 < 0.0f ? 0.0f : eta * x[k][l] - (eta * d + std::sqrt(k2)) * y[k][l];
+                }
+                break;
+            }
+        }
+    }
+    for (uint32_t k = 0; k < comps(in.result) && k < 4; k++) storeLanes(target(in.result, k), r[k], mask);
+}
+
+inline void Invocation::execute(const Instruction& in, uint32_t& mask, size_t depth) {
+    using namespace detail;
+    const uint32_t* op = &p.operands[in.first];
+    uint32_t n = in.result ? comps(in.result) : 0;
+    switch (in.opcode) {
+        case OpUndef:
+            return;
+        case OpVariable:
+            if (in.count >= 2) {  // Function variable with an initialiser
+                uint32_t base = p.constantWord[in.result];
+                uint32_t size = comps(op[1]);
+                copy(&memory[static_cast<size_t>(base) * LANES], value(op[1]), size, mask);
+            }
+            return;
+        case OpLoad: {
+            uint32_t slots[LANES];
+            loadLanes(value(op[0]), slots);
+            for (uint32_t c = 0; c < n; c++) {
+                uint32_t* out = target(in.result, c);
+                for (uint32_t l = 0; l < LANES; l++) {
+                    if (mask & (1u << l)) out[l] = memory[(static_cast<size_t>(slots[l]) + c) * LANES + l];
+                }
+            }
+            return;
+        }
+        case OpStore:
+        case OpCopyMemory: {
+            uint32_t slots[LANES], sources[LANES];
+            loadLanes(value(op[0]), slots);
+            bool fromMemory = in.opcode == OpCopyMemory;
+            if (fromMemory) loadLanes(value(op[1]), sources);
+            uint32_t size = fromMemory ? p.types[p.types[p.typeOf[op[0]]].element].comps : comps(op[1]);
+            for (uint32_t c = 0; c < size; c++) {
+                const uint32_t* src = fromMemory ? nullptr : value(op[1], c);
+                for (uint32_t l = 0; l < LANES; l++) {
+                    if (!(mask & (1u << l))) continue;
+                    memory[(static_cast<size_t>(slots[l]) + c) * LANES + l] =
+                        fromMemory ? memory[(static_cast<size_t>(sources[l]) + c) * LANES + l] : src[l];
+                }
+            }
+            return;
+        }
+        case OpAccessChain:
+        case OpInBoundsAccessChain: {
+            uint32_t slots[LANES];
+            loadLanes(value(op[0]), slots);
+            uint32_t type = p.types[p.typeOf[op[0]]].element;
+            for (uint32_t i = 1; i < in.count; i++) {
+                const Program::Type& t = p.types[type];
+                if (t.opcode == OpTypeStruct) {
+                    uint32_t offset = 0;
+                    step(type, p.constantWord[op[i]], offset);
+                    for (uint32_t l = 0; l < LANES; l++) slots[l] += offset;
+                    continue;
+                }
+                // Dynamic indices are clamped, as robust buffer access would
+                int32_t index[LANES];
+                loadLanes(value(op[i]), index);
+                int32_t last = static_cast<int32_t>(t.length) - 1;
+                uint32_t stride = p.types[t.element].comps;
+                for (uint32_t l = 0; l < LANES; l++) {
+                    slots[l] += static_cast<uint32_t>(std::min(std::max(index[l], 0), std::max(last, 0))) * stride;
+                }
+                type = t.element;
+            }
+            storeLanes(target(in.result), slots, mask);
+            return;
+        }
+        case OpFunctionCall: {
+            const Program::Function& function = p.functions[op[0]];
+            for (size_t i = 0; i < function.parameters.size() && i + 1 < in.count; i++) {
+                uint32_t parameter = function.parameters[i];
+                copy(target(parameter), value(op[i + 1]), comps(parameter), mask);
+            }
+            runFunction(op[0], mask, depth + 1);
+            mask &= ~killed;
+            if (n && function.returnId) copy(target(in.result), value(function.returnId), n, mask);
+            return;
+        }
+        case OpExtInst:
+            extInst(in, op, mask);
+            return;
+
+        // Composites
+        case OpCopyObject: case OpBitcast: case OpUConvert: case OpSConvert: case OpFConvert: case OpQuantizeToF16:
+        case OpSampledImage: case OpImage:
+            copy(target(in.result), value(op[0]), n, mask);
+            return;
+        case OpCompositeConstruct: {
+            uint32_t at = 0;
+            for (uint32_t i = 0; i < in.count && at < n; i++) {
+                uint32_t k = std::min(comps(op[i]), n - at);
+                copy(target(in.result, at), value(op[i]), k, mask);
+                at += k;
+            }
+            return;
+        }
+        case OpCompositeExtract: {
+            uint32_t type = p.typeOf[op[0]], offset = 0;
+            for (uint32_t i = 1; i < in.count; i++) step(type, op[i], offset);
+            copy(target(in.result), value(op[0], offset), n, mask);
+            return;
+        }
+        case OpCompositeInsert: {
+            uint32_t type = p.typeOf[op[1]], offset = 0;
+            for (uint32_t i = 2; i < in.count; i++) step(type, op[i], offset);
+            copy(target(in.result), value(op[1]), n, mask);
+            copy(target(in.result, offset), value(op[0]), comps(op[0]), mask);
+            return;
+        }
+        case OpVectorShuffle: {
+            uint32_t first = comps(op[0]);
+            for (uint32_t c = 0; c < n && c + 2 < in.count; c++) {
+                uint32_t index = op[c + 2];
+                if (index == 0xffffffff) continue;
+                const uint32_t* src = index < first ? value(op[0], index) : value(op[1], index - first);
+                putLanes(target(in.result, c), src, mask);
+            }
+            return;
+        }
+        case OpVectorExtractDynamic:
+        case OpVectorInsertDynamic: {
+            bool insert = in.opcode == OpVectorInsertDynamic;
+            uint32_t vector = op[0];
+            int32_t index[LANES];
+            loadLanes(value(insert ? op[2] : op[1]), index);
+            uint32_t size = comps(vector);
+            if (insert) copy(target(in.result), value(vector), n, mask);
+            uint32_t* out = target(in.result);
+            for (uint32_t l = 0; l < LANES; l++) {
+                if (!(mask & (1u << l))) continue;
+                uint32_t i = static_cast<uint32_t>(std::min(std::max(index[l], 0), static_cast<int32_t>(size) - 1));
+                if (insert) {
+                    out[i * LANES + l] = value(op[1])[l];
+                } else {
+                    out[l] = value(vector, i)[l];
+                }
+            }
+            return;
+        }
+        case OpTranspose: {
+            uint32_t columns = p.types[p.typeOf[op[0]]].length, rows = comps(op[0]) / columns;
+            for (uint32_t c = 0; c < columns; c++) {
+                for (uint32_t r = 0; r < rows; r++) putLanes(target(in.result, r * columns + c), value(op[0], c * rows + r), mask);
+            }
+            return;
+        }
+
+        // Conversions
+        case OpConvertFToU:
+            unary<float>(in, op[0], mask, [](float x) {
+                return x >= 4294967040.0f ? 0xffffffffu : x > 0.0f ? static_cast<uint32_t>(x) : 0u;
+            });
+            return;
+        case OpConvertFToS:
+            unary<float>(in, op[0], mask, [](float x) {
+                return x >= 2147483520.0f ? INT32_MAX : x > -2147483648.0f ? static_cast<int32_t>(x) : INT32_MIN;
+            });
+            return;
+        case OpConvertSToF: unary<int32_t>(in, op[0], mask, [](int32_t x) { return static_cast<float>(x); }); return;
+        case OpConvertUToF: unary<uint32_t>(in, op[0], mask, [](uint32_t x) { return static_cast<float>(x); }); return;
+
+        // Arithmetic
+        case OpSNegate: unary<uint32_t>(in, op[0], mask, [](uint32_t x) { return 0u - x; }); return;
+        case OpFNegate: unary<float>(in, op[0], mask, [](float x) { return -x; }); return;
+        case OpIAdd: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return x + y; }); return;
+        case OpISub: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return x - y; }); return;
+        case OpIMul: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return x * y; }); return;
+        case OpFAdd: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return x + y; }); return;
+        case OpFSub: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return x - y; }); return;
+        case OpFMul: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return x * y; }); return;
+        case OpFDiv: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return x / y; }); return;
+        case OpUDiv: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return y ? x / y : 0u; }); return;
+        case OpUMod: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return y ? x % y : 0u; }); return;
+        case OpSDiv:
+            binary<int32_t>(in, op[0], op[1], mask, [](int32_t x, int32_t y) {
+                return y == 0 || (y == -1 && x == INT32_MIN) ? 0 : x / y;
+            });
+            return;
+        case OpSRem:
+            binary<int32_t>(in, op[0], op[1], mask, [](int32_t x, int32_t y) {
+                return y == 0 || y == -1 ? 0 : x % y;
+            });
+            return;
+        case OpSMod:
+            binary<int32_t>(in, op[0], op[1], mask, [](int32_t x, int32_t y) {
+                if (y == 0 || y == -1) return 0;
+                int32_t r = x % y;
+                return r != 0 && ((r < 0) != (y < 0)) ? r + y : r;
+            });
+            return;
+        case OpFRem: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return std::fmod(x, y); }); return;
+        case OpFMod: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return x - y * std::floor(x / y); }); return;
+        case OpVectorTimesScalar:
+        case OpMatrixTimesScalar:
+            binary<float>(in, op[0], op[1], mask, [](float x, float y) { return x * y; });
+            return;
+        case OpDot: {
+            float sum[LANES] = {}, x[LANES], y[LANES];
+            for (uint32_t c = 0; c < comps(op[0]); c++) {
+                loadLanes(value(op[0], c), x);
+                loadLanes(value(op[1], c), y);
+                for (uint32_t l = 0; l < LANES; l++) sum[l] += x[l] * y[l];
+            }
+            storeLanes(target(in.result), sum, mask);
+            return;
+        }
+        case OpMatrixTimesVector:
+        case OpVectorTimesMatrix:
+        case OpMatrixTimesMatrix:
+        case OpOuterProduct: {
+            // Column-major: element (column c, row r) of an R-row matrix is component c * R + r
+            uint32_t na = comps(op[0]), nb = comps(op[1]);
+            if (scratch.size() < (na + nb + n) * LANES) scratch.resize((na + nb + n) * LANES);
+            float* a = scratch.data();
+            float* b = a + na * LANES;
+            float* r = b + nb * LANES;
+            loadFloats(op[0], a, na);
+            loadFloats(op[1], b, nb);
+            std::fill_n(r, n * LANES, 0.0f);
+            auto madd = [&](uint32_t out, uint32_t x, uint32_t y) {
+                for (uint32_t l = 0; l < LANES; l++) r[out * LANES + l] += a[x * LANES + l] * b[y * LANES + l];
+            };
+            if (in.opcode == OpMatrixTimesVector) {  // R×C matrix, C vector
+                uint32_t rows = n, columns = nb;
+                for (uint32_t c = 0; c < columns; c++) {
+                    for (uint32_t row = 0; row < rows; row++) madd(row, c * rows + row, c);
+                }
+            } else if (in.opcode == OpVectorTimesMatrix) {  // R vector, R×C matrix
+                uint32_t rows = na, columns = n;
+                for (uint32_t c = 0; c < columns; c++) {
+                    for (uint32_t row = 0; row < rows; row++) {
+                        for (uint32_t l = 0; l < LANES; l++) r[c * LANES + l] += a[row * LANES + l] * b[(c * rows + row) * LANES + l];
+                    }
+                }
+            } else if (in.opcode == OpMatrixTimesMatrix) {  // (R×K)(K×C)
+                uint32_t inner = p.types[p.typeOf[op[0]]].length, rows = na / inner, columns = nb / inner;
+                for (uint32_t c = 0; c < columns; c++) {
+                    for (uint32_t row = 0; row < rows; row++) {
+                        for (uint32_t k = 0; k < inner; k++) madd(c * rows + row, k * rows + row, c * inner + k);
+                    }
+                }
+            } else {  // Outer product: column c = a * b[c]
+                for (uint32_t c = 0; c < nb; c++) {
+                    for (uint32_t row = 0; row < na; row++) madd(c * na + row, row, c);
+                }
+            }
+            for (uint32_t c = 0; c < n; c++) storeLanes(target(in.result, c), r + c * LANES, mask);
+            return;
+        }
+
+        // Relational and logical
+        case OpAny:
+        case OpAll: {
+            bool any = in.opcode == OpAny;
+            uint32_t result[LANES], x[LANES];
+            std::fill_n(result, LANES, any ? 0u : 1u);
+            for (uint32_t c = 0; c < comps(op[0]); c++) {
+                loadLanes(value(op[0], c), x);
+                for (uint32_t l = 0; l < LANES; l++) result[l] = any ? (result[l] | (x[l] != 0)) : (result[l] & (x[l] != 0));
+            }
+            storeLanes(target(in.result), result, mask);
+            return;
+        }
+        case OpIsNan: unary<float>(in, op[0], mask, [](float x) { return static_cast<uint32_t>(std::isnan(x)); }); return;
+        case OpIsInf: unary<float>(in, op[0], mask, [](float x) { return static_cast<uint32_t>(std::isinf(x)); }); return;
+        case OpLogicalEqual: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return static_cast<uint32_t>((x != 0) == (y != 0)); }); return;
+        case OpLogicalNotEqual: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return static_cast<uint32_t>((x != 0) != (y != 0)); }); return;
+        case OpLogicalOr: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return static_cast<uint32_t>(x || y); }); return;
+        case OpLogicalAnd: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return static_cast<uint32_t>(x && y); }); return;
+        case OpLogicalNot: unary<uint32_t>(in, op[0], mask, [](uint32_t x) { return static_cast<uint32_t>(!x); }); return;
+        case OpSelect:
+            for (uint32_t c = 0; c < n; c++) {
+                uint32_t condition[LANES], x[LANES], y[LANES], r[LANES];
+                loadLanes(value(op[0], c), condition);
+                loadLanes(value(op[1], c), x);
+                loadLanes(value(op[2], c), y);
+                for (uint32_t l = 0; l < LANES; l++) r[l] = condition[l] ? x[l] : y[l];
+                putLanes(target(in.result, c), r, mask);
+            }
+            return;
+        case OpIEqual: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return static_cast<uint32_t>(x == y); }); return;
+        case OpINotEqual: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return static_cast<uint32_t>(x != y); }); return;
+        case OpUGreaterThan: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return static_cast<uint32_t>(x > y); }); return;
+        case OpUGreaterThanEqual: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return static_cast<uint32_t>(x >= y); }); return;
+        case OpULessThan: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return static_cast<uint32_t>(x < y); }); return;
+        case OpULessThanEqual: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return static_cast<uint32_t>(x <= y); }); return;
+        case OpSGreaterThan: binary<int32_t>(in, op[0], op[1], mask, [](int32_t x, int32_t y) { return static_cast<uint32_t>(x > y); }); return;
+        case OpSGreaterThanEqual: binary<int32_t>(in, op[0], op[1], mask, [](int32_t x, int32_t y) { return static_cast<uint32_t>(x >= y); }); return;
+        case OpSLessThan: binary<int32_t>(in, op[0], op[1], mask, [](int32_t x, int32_t y) { return static_cast<uint32_t>(x < y); }); return;
+        case OpSLessThanEqual: binary<int32_t>(in, op[0], op[1], mask, [](int32_t x, int32_t y) { return static_cast<uint32_t>(x <= y); }); return;
+        case OpFOrdEqual: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return static_cast<uint32_t>(x == y); }); return;
+        case OpFUnordEqual: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return static_cast<uint32_t>(!(x < y || x > y)); }); return;
+        case OpFOrdNotEqual: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return static_cast<uint32_t>(x < y || x > y); }); return;
+        case OpFUnordNotEqual: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return static_cast<uint32_t>(x != y); }); return;
+        case OpFOrdLessThan: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return static_cast<uint32_t>(x < y); }); return;
+        case OpFUnordLessThan: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return static_cast<uint32_t>(!(x >= y)); }); return;
+        case OpFOrdGreaterThan: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return static_cast<uint32_t>(x > y); }); return;
+        case OpFUnordGreaterThan: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return static_cast<uint32_t>(!(x <= y)); }); return;
+        case OpFOrdLessThanEqual: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return static_cast<uint32_t>(x <= y); }); return;
+        case OpFUnordLessThanEqual: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return static_cast<uint32_t>(!(x > y)); }); return;
+        case OpFOrdGreaterThanEqual: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return static_cast<uint32_t>(x >= y); }); return;
+        case OpFUnordGreaterThanEqual: binary<float>(in, op[0], op[1], mask, [](float x, float y) { return static_cast<uint32_t>(!(x < y)); }); return;
+
+        // Bits
+        case OpShiftRightLogical: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return x >> (y & 31); }); return;
+        case OpShiftRightArithmetic: binary<int32_t>(in, op[0], op[1], mask, [](int32_t x, int32_t y) { return x >> (y & 31); }); return;
+        case OpShiftLeftLogical: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return x << (y & 31); }); return;
+        case OpBitwiseOr: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return x | y; }); return;
+        case OpBitwiseXor: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return x ^ y; }); return;
+        case OpBitwiseAnd: binary<uint32_t>(in, op[0], op[1], mask, [](uint32_t x, uint32_t y) { return x & y; }); return;
+        case OpNot: unary<uint32_t>(in, op[0], mask, [](uint32_t x) { return ~x; }); return;
+        case OpBitCount:
+            unary<uint32_t>(in, op[0], mask, [](uint32_t x) {
+                uint32_t count = 0;
+                for (; x; x &= x - 1) count++;
+                return count;
+            });
+            return;
+        case OpBitReverse:
+            unary<uint32_t>(in, op[0], mask, [](uint32_t x) {
+                uint32_t r = 0;
+                for (int i = 0; i < 32; i++) r |= ((x >> i) & 1u) << (31 - i);
+                return r;
+            });
+            return;
+        case OpBitFieldInsert:
+        case OpBitFieldSExtract:
+        case OpBitFieldUExtract: {
+            bool insert = in.opcode == OpBitFieldInsert;
+            uint32_t offsetId = op[insert ? 2 : 1], countId = op[insert ? 3 : 2];
+            for (uint32_t c = 0; c < n; c++) {
+                uint32_t base[LANES], insertBits[LANES], offset[LANES], count[LANES], r[LANES];
+                loadLanes(value(op[0], c), base);
+                if (insert) loadLanes(value(op[1], c), insertBits);
+                loadLanes(value(offsetId), offset);
+                loadLanes(value(countId), count);
+                for (uint32_t l = 0; l < LANES; l++) {
+                    uint32_t o = offset[l] & 31, k = std::min(count[l], 32 - o);
+                    uint32_t field = k == 32 ? 0xffffffffu : ((1u << k) - 1u);
+                    if (insert) {
+                        r[l] = (base[l] & ~(field << o)) | ((insertBits[l] & field) << o);
+                    } else {
+                        uint32_t bits = (base[l] >> o) & field;
+                        bool negative = in.opcode == OpBitFieldSExtract && k > 0 && k < 32 && (bits >> (k - 1)) & 1u;
+                        r[l] = negative ? bits | ~field : bits;
+                    }
+                }
+                putLanes(target(in.result, c), r, mask);
+            }
+            return;
+        }
+
+        case OpDPdx: case OpDPdy: case OpFwidth: case OpDPdxFine: case OpDPdyFine: case OpFwidthFine:
+        case OpDPdxCoarse: case OpDPdyCoarse: case OpFwidthCoarse:
+            derivative(in, op[0], mask);
+            return;
+
+        case OpImageSampleImplicitLod: case OpImageSampleExplicitLod: case OpImageFetch:
+        case OpImageQuerySizeLod: case OpImageQuerySize: case OpImageQueryLevels:
+            image(in, op, mask);
+            return;
+
+        case OpDemoteToHelperInvocation:
+            killed |= mask;
+            mask = 0;
+            return;
+    }
+}
+
+// Renders frames of a vertex + fragment program pair into RGBA8 on all cores
+class Renderer {
+public:
+    bool load(const std::vector<uint32_t>& vertexWords, const std::vector<uint32_t>& fragmentWords,
+              const std::vector<uint32_t>& specialization, std::string& error) {
+        workers.clear();
+        if (!vertex.load(vertexWords, {}, error) || !vertex.isVertex()) {
+            if (error.empty()) error = "not a vertex shader";
+            error = "vertex shader: " + error;
+            return false;
+        }
+        if (!fragment.load(fragmentWords, specialization, error) || !fragment.isFragment()) {
+            if (error.empty()) error = "not a fragment shader";
+            error = "fragment shader: " + error;
+            return false;
+        }
+        return true;
+    }
+
+    // Uniform data and textures reach both stages
+    void setBlock(uint32_t binding, const void* data, size_t size) {
+        vertex.setBlock(binding, data, size);
+        fragment.setBlock(binding, data, size);
+    }
+    void setTexture(uint32_t binding, const Texture* texture) {
+        vertex.setTexture(binding, texture);
+        fragment.setTexture(binding, texture);
+    }
+    const Program& fragmentProgram() const { return fragment; }
+
+    // Render a width × height frame (top row first) cleared to opaque black like the
+    // viewer's render pass. Returns false if the vertex stage produced no triangle.
+    bool render(uint32_t width, uint32_t height, std::vector<uint8_t>& rgba, WorkPool& pool) {
+        rgba.assign(static_cast<size_t>(width) * height * 4, 0);
+        for (size_t i = 3; i < rgba.size(); i += 4) rgba[i] = 255;
+        if (!setupTriangles(width, height)) {
+            return false;
+        }
+        while (workers.size() < pool.size()) {
+            workers.push_back(std::unique_ptr<Invocation>(new Invocation(fragment)));
+        }
+        const Program::Variable* color = fragment.output(0);
+        uint32_t tilesX = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+        uint32_t tilesY = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+        pool.parallelFor(tilesX * tilesY, [&](size_t tile, unsigned worker) {
+            Invocation& invocation = *workers[worker];
+            uint32_t x0 = static_cast<uint32_t>(tile % tilesX) * TILE_WIDTH;
+            uint32_t y0 = static_cast<uint32_t>(tile / tilesX) * TILE_HEIGHT;
+            uint32_t x1 = std::min(x0 + TILE_WIDTH, width), y1 = std::min(y0 + TILE_HEIGHT, height);
+            for (uint32_t y = y0; y < y1; y += 2) {
+                for (uint32_t x = x0; x < x1; x += 4) {
+                    uint32_t covered = shadeGroup(invocation, x, y, width, height);
+                    if (!covered || !color) continue;
+                    for (uint32_t l = 0; l < LANES; l++) {
+                        if (!(covered & (1u << l))) continue;
+                        uint8_t* pixel = &rgba[((static_cast<size_t>(y) + l / 4) * width + x + l % 4) * 4];
+                        for (uint32_t c = 0; c < 4; c++) {
+                            float v = c < color->comps ? detail::bitsFloat(invocation.slot(color->slot + c)[l]) : 1.0f;
+                            v = v > 0.0f ? (v < 1.0f ? v : 1.0f) : 0.0f;  // NaN → 0
+                            pixel[c] = static_cast<uint8_t>(v * 255.0f + 0.5f);
+                        }
+                    }
+                }
+            }
+        });
+        return true;
+    }
+
+private:
+    // value(x, y) = a·x + b·y + c over framebuffer pixel coordinates
+    struct Plane {
+        float a = 0.0f, b = 0.0f, c = 0.0f;
+        float at(float x, float y) const { return a * x + b * y + c; }
+    };
+    struct Triangle {
+        Plane barycentric[2];            // Weights of the second and third vertex
+        std::vector<Plane> attributes;   // Per fragment input component, in inputs() order
+    };
+
+    static Plane plane(const float x[3], const float y[3], const float v[3]) {
+        Plane p;
+        float det = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        p.a = ((v[1] - v[0]) * (y[2] - y[0]) - (v[2] - v[0]) * (y[1] - y[0])) / det;
+        p.b = ((x[1] - x[0]) * (v[2] - v[0]) - (x[2] - x[0]) * (v[1] - v[0])) / det;
+        p.c = v[0] - p.a * x[0] - p.b * y[0];
+        return p;
+    }
+
+    // Run the vertex shader for the six vertices of the fullscreen draw
+    bool setupTriangles(uint32_t width, uint32_t height) {
+        using namespace detail;
+        triangles.clear();
+        Invocation invocation(vertex);
+        invocation.begin();
+        if (const Program::Variable* index = vertex.input(-1, BuiltInVertexIndex)) {
+            uint32_t* lanes = invocation.slot(index->slot);
+            for (uint32_t l = 0; l < LANES; l++) lanes[l] = l;
+        }
+        invocation.run(0x3f);
+        const Program::Variable* position = vertex.output(-1, BuiltInPosition);
+        if (!position || position->comps < 4) {
+            return false;
+        }
+        auto component = [&](const Program::Variable& v, uint32_t c, uint32_t vertexIndex) {
+            return c < v.comps ? bitsFloat(invocation.slot(v.slot + c)[vertexIndex]) : 0.0f;
+        };
+        for (uint32_t t = 0; t < 2; t++) {
+            float x[3], y[3];
+            for (uint32_t k = 0; k < 3; k++) {
+                uint32_t v = t * 3 + k;
+                float w = component(*position, 3, v);
+                x[k] = (component(*position, 0, v) / w * 0.5f + 0.5f) * width;
+                y[k] = (component(*position, 1, v) / w * 0.5f + 0.5f) * height;
+            }
+            float det = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+            if (!std::isfinite(det) || std::fabs(det) < 1e-6f) continue;
+            Triangle triangle;
+            const float second[3] = {0.0f, 1.0f, 0.0f}, third[3] = {0.0f, 0.0f, 1.0f};
+            triangle.barycentric[0] = plane(x, y, second);
+            triangle.barycentric[1] = plane(x, y, third);
+            for (const Program::Variable& input : fragment.inputs()) {
+                const Program::Variable* source = input.location >= 0 ? vertex.output(input.location) : nullptr;
+                for (uint32_t c = 0; c < input.comps; c++) {
+                    float v[3] = {0.0f, 0.0f, 0.0f};
+                    for (uint32_t k = 0; source && k < 3; k++) v[k] = component(*source, c, t * 3 + k);
+                    triangle.attributes.push_back(plane(x, y, v));
+                }
+            }
+            triangles.push_back(triangle);
+        }
+        return !triangles.empty();
+    }
+
+    // Shade the 4x2 block at (x, y); returns the lanes to write (inside the frame, covered,
+    // not discarded). Uncovered lanes still run, like helper invocations, for derivatives.
+    uint32_t shadeGroup(Invocation& invocation, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+        using namespace detail;
+        float px[LANES], py[LANES];
+        uint32_t inside = 0;
+        int triangleOf[LANES];
+        for (uint32_t l = 0; l < LANES; l++) {
+            px[l] = static_cast<float>(x + l % 4) + 0.5f;
+            py[l] = static_cast<float>(y + l / 4) + 0.5f;
+            triangleOf[l] = -1;
+            for (size_t t = 0; t < triangles.size(); t++) {
+                float b1 = triangles[t].barycentric[0].at(px[l], py[l]);
+                float b2 = triangles[t].barycentric[1].at(px[l], py[l]);
+                if (b1 >= -1e-6f && b2 >= -1e-6f && b1 + b2 <= 1.0f + 1e-6f) {
+                    triangleOf[l] = static_cast<int>(t);
+                    break;
+                }
+            }
+            if (x + l % 4 < width && y + l / 4 < height && triangleOf[l] >= 0) inside |= 1u << l;
+        }
+        if (!inside) {
+            return 0;
+        }
+
+        invocation.begin();
+        size_t attribute = 0;
+        for (const Program::Variable& input : fragment.inputs()) {
+            for (uint32_t c = 0; c < input.comps; c++, attribute++) {
+                float v[LANES];
+                for (uint32_t l = 0; l < LANES; l++) {
+                    switch (input.builtIn) {
+                        case BuiltInFragCoord: v[l] = c == 0 ? px[l] : c == 1 ? py[l] : c == 3 ? 1.0f : 0.0f; break;
+                        case BuiltInFrontFacing: v[l] = bitsFloat(1u); break;
+                        default: {
+                            // Helper lanes outside both triangles extrapolate from the first
+                            const Triangle& t = triangles[triangleOf[l] >= 0 ? triangleOf[l] : 0];
+                            v[l] = t.attributes[attribute].at(px[l], py[l]);
+                        }
+                    }
+                }
+                storeLanes(invocation.slot(input.slot + c), v, ALL_LANES);
+            }
+        }
+        return invocation.run(ALL_LANES) & inside;
+    }
+
+    Program vertex, fragment;
+    std::vector<Triangle> triangles;
+    std::vector<std::unique_ptr<Invocation>> workers;
+};
+
+}  // namespace spirv_cpu
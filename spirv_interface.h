@@ -0,0 +1,286 @@
+// spirv_interface.h - Minimal SPIR-V reflection: the descriptor bindings a shader module uses
+//
+// Walks the module once, collecting names, decorations (DescriptorSet, Binding, Block,
+// BufferBlock, Offset, ArrayStride, MatrixStride) and types, then classifies every global
+// variable in the UniformConstant / Uniform / StorageBuffer storage classes. A binding is
+// "used" when its variable is referenced from any function body; unused ones can be left
+// out of the descriptor set layout. Uniform blocks also report their byte size, so the
+// viewer can check a shader's block against UniformBufferObject.
+//
+// Stage flags are an opaque bitmask supplied by the caller (VkShaderStageFlags in practice);
+// merging the interfaces of all stages ORs them together. A push-constant block is reported
+// by size and stages, for the pipeline layout's push-constant range.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace spirv_interface {
+
+enum class ResourceType { UniformBuffer, StorageBuffer, CombinedImageSampler, SampledImage, StorageImage, Sampler };
+
+inline const char* resourceTypeName(ResourceType type) {
+    switch (type) {
+        case ResourceType::UniformBuffer: return "uniform buffer";
+        case ResourceType::StorageBuffer: return "storage buffer";
+        case ResourceType::CombinedImageSampler: return "sampler";
+        case ResourceType::SampledImage: return "texture";
+        case ResourceType::StorageImage: return "image";
+        case ResourceType::Sampler: return "separate sampler";
+    }
+    return "?";
+}
+
+struct Binding {
+    uint32_t set = 0;
+    uint32_t binding = 0;
+    uint32_t count = 1;       // Array size (0 for runtime-sized arrays)
+    ResourceType type = ResourceType::UniformBuffer;
+    uint32_t dimension = 1;   // SPIR-V Dim of images: 0 = 1D, 1 = 2D, 2 = 3D, 3 = Cube
+    uint32_t blockSize = 0;   // Uniform/storage blocks: bytes up to the end of the last member
+    uint32_t stages = 0;
+    bool used = false;
+    std::string name;
+};
+
+struct Interface {
+    std::vector<Binding> bindings;  // Sorted by (set, binding)
+    uint32_t pushConstantSize = 0;
+    uint32_t pushConstantStages = 0;
+
+    const Binding* find(uint32_t binding, uint32_t set = 0) const {
+        for (const Binding& b : bindings) {
+            if (b.set == set && b.binding == binding) return &b;
+        }
+        return nullptr;
+    }
+
+    bool uses(uint32_t binding) const {
+        const Binding* b = find(binding);
+        return b && b->used;
+    }
+
+    // Combine with another stage of the same pipeline
+    void merge(const Interface& other) {
+        pushConstantSize = std::max(pushConstantSize, other.pushConstantSize);
+        if (other.pushConstantSize > 0) pushConstantStages |= other.pushConstantStages;
+        for (const Binding& b : other.bindings) {
+            auto existing = std::find_if(bindings.begin(), bindings.end(), [&](const Binding& a) {
+                return a.set == b.set && a.binding == b.binding;
+            });
+            if (existing == bindings.end()) {
+                bindings.push_back(b);
+                continue;
+            }
+            existing->stages |= b.stages;
+            existing->used = existing->used || b.used;
+            existing->blockSize = std::max(existing->blockSize, b.blockSize);
+        }
+        std::sort(bindings.begin(), bindings.end(), [](const Binding& a, const Binding& b) {
+            return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+        });
+    }
+
+    // FNV-1a over what determines a descriptor set layout (used bindings only)
+    uint64_t layoutHash() const {
+        uint64_t hash = 1469598103934665603ull;
+        auto mix = [&](uint32_t value) {
+            for (int i = 0; i < 4; i++) {
+                hash = (hash ^ ((value >> (8 * i)) & 0xff)) * 1099511628211ull;
+            }
+        };
+        for (const Binding& b : bindings) {
+            if (!b.used) continue;
+            mix(b.set);
+            mix(b.binding);
+            mix(b.count);
+            mix(static_cast<uint32_t>(b.type));
+            mix(b.stages);
+        }
+        mix(pushConstantSize);
+        mix(pushConstantStages);
+        return hash;
+    }
+};
+
+namespace detail {
+
+enum : uint32_t {
+    OpName = 5, OpTypeInt = 21, OpTypeFloat = 22, OpTypeVector = 23, OpTypeMatrix = 24, OpTypeImage = 25,
+    OpTypeSampler = 26, OpTypeSampledImage = 27, OpTypeArray = 28, OpTypeRuntimeArray = 29, OpTypeStruct = 30,
+    OpTypePointer = 32, OpConstant = 43, OpFunction = 54, OpVariable = 59, OpDecorate = 71, OpMemberDecorate = 72,
+};
+enum : uint32_t { DecorationBlock = 2, DecorationBufferBlock = 3, DecorationArrayStride = 6, DecorationMatrixStride = 7,
+                  DecorationBinding = 33, DecorationDescriptorSet = 34, DecorationOffset = 35 };
+enum : uint32_t { StorageUniformConstant = 0, StorageUniform = 2, StoragePushConstant = 9, StorageStorageBuffer = 12 };
+
+struct Type {
+    uint32_t opcode = 0;
+    std::vector<uint32_t> operands;  // Everything after the result id
+};
+
+inline std::string literalString(const uint32_t* words, size_t count) {
+    std::string text;
+    for (size_t i = 0; i < count; i++) {
+        for (int b = 0; b < 4; b++) {
+            char c = static_cast<char>((words[i] >> (8 * b)) & 0xff);
+            if (c == '\0') return text;
+            text += c;
+        }
+    }
+    return text;
+}
+
+}  // namespace detail
+
+// Add the descriptor bindings declared by one SPIR-V module to `result`. Returns false with
+// `error` set if the binary is malformed.
+inline bool reflect(const uint32_t* words, size_t wordCount, uint32_t stage, Interface& result, std::string& error) {
+    using namespace detail;
+    if (wordCount < 5 || words[0] != 0x07230203) {
+        error = "not a SPIR-V module";
+        return false;
+    }
+
+    std::map<uint32_t, std::string> names;
+    std::map<uint32_t, std::map<uint32_t, uint32_t>> decorations;  // id → decoration → value
+    std::map<uint32_t, std::map<uint32_t, uint32_t>> memberOffsets;  // struct → member → offset
+    std::map<uint32_t, std::map<uint32_t, uint32_t>> memberMatrixStrides;
+    std::map<uint32_t, Type> types;
+    std::map<uint32_t, uint32_t> constants;
+    std::map<uint32_t, std::pair<uint32_t, uint32_t>> variables;  // id → (pointer type, storage class)
+    std::set<uint32_t> referenced;
+    bool inFunctions = false;
+
+    for (size_t at = 5; at < wordCount;) {
+        uint32_t length = words[at] >> 16;
+        uint32_t opcode = words[at] & 0xffff;
+        if (length == 0 || at + length > wordCount) {
+            error = "truncated instruction at word " + std::to_string(at);
+            return false;
+        }
+        const uint32_t* op = words + at + 1;
+        uint32_t operands = length - 1;
+
+        if (opcode == OpFunction) {
+            inFunctions = true;
+        }
+        if (inFunctions) {
+            // Any operand that names a variable counts as a use (literals may alias ids,
+            // which only makes the answer conservative)
+            for (uint32_t i = 0; i < operands; i++) {
+                referenced.insert(op[i]);
+            }
+        } else if (opcode == OpName && operands >= 2) {
+            names[op[0]] = literalString(op + 1, operands - 1);
+        } else if (opcode == OpDecorate && operands >= 2) {
+            decorations[op[0]][op[1]] = operands >= 3 ? op[2] : 1;
+        } else if (opcode == OpMemberDecorate && operands >= 4) {
+            if (op[2] == DecorationOffset) memberOffsets[op[0]][op[1]] = op[3];
+            if (op[2] == DecorationMatrixStride) memberMatrixStrides[op[0]][op[1]] = op[3];
+        } else if (opcode >= OpTypeInt && opcode <= OpTypePointer && operands >= 1) {
+            types[op[0]] = Type{opcode, std::vector<uint32_t>(op + 1, op + operands)};
+        } else if (opcode == OpConstant && operands >= 3) {
+            constants[op[1]] = op[2];
+        } else if (opcode == OpVariable && operands >= 3) {
+            variables[op[1]] = {op[0], op[2]};
+        }
+        at += length;
+    }
+
+    // Byte size of a type inside a block (std140/std430 layout comes from the decorations)
+    std::function<uint32_t(uint32_t, uint32_t)> sizeOf = [&](uint32_t id, uint32_t matrixStride) -> uint32_t {
+        const Type& type = types[id];
+        switch (type.opcode) {
+            case OpTypeInt:
+            case OpTypeFloat:
+                return type.operands.empty() ? 4 : type.operands[0] / 8;
+            case OpTypeVector:
+                return type.operands.size() < 2 ? 0 : sizeOf(type.operands[0], 0) * type.operands[1];
+            case OpTypeMatrix:
+                return type.operands.size() < 2 ? 0 : (matrixStride ? matrixStride : sizeOf(type.operands[0], 0)) * type.operands[1];
+            case OpTypeArray: {
+                uint32_t stride = decorations[id].count(DecorationArrayStride) ? decorations[id][DecorationArrayStride] : 0;
+                return type.operands.size() < 2 ? 0 : stride * constants[type.operands[1]];
+            }
+            case OpTypeStruct: {
+                uint32_t size = 0;
+                for (uint32_t m = 0; m < type.operands.size(); m++) {
+                    uint32_t stride = memberMatrixStrides[id].count(m) ? memberMatrixStrides[id][m] : 0;
+                    size = std::max(size, memberOffsets[id][m] + sizeOf(type.operands[m], stride));
+                }
+                return size;
+            }
+        }
+        return 0;
+    };
+
+    for (const auto& entry : variables) {
+        uint32_t id = entry.first;
+        uint32_t storage = entry.second.second;
+        if (storage == StoragePushConstant) {
+            const Type& pointer = types[entry.second.first];
+            if (pointer.opcode == OpTypePointer && pointer.operands.size() >= 2) {
+                result.pushConstantSize = std::max(result.pushConstantSize, sizeOf(pointer.operands[1], 0));
+                result.pushConstantStages |= stage;
+            }
+            continue;
+        }
+        if (storage != StorageUniformConstant && storage != StorageUniform && storage != StorageStorageBuffer) {
+            continue;
+        }
+        const Type& pointer = types[entry.second.first];
+        if (pointer.opcode != OpTypePointer || pointer.operands.size() < 2) {
+            continue;
+        }
+
+        Binding binding;
+        binding.set = decorations[id][DecorationDescriptorSet];
+        binding.binding = decorations[id][DecorationBinding];
+        binding.stages = stage;
+        binding.used = referenced.count(id) > 0;
+        binding.name = names[id];
+
+        // Peel one level of arrays
+        uint32_t typeId = pointer.operands[1];
+        if (types[typeId].opcode == OpTypeArray && types[typeId].operands.size() >= 2) {
+            binding.count = constants[types[typeId].operands[1]];
+            typeId = types[typeId].operands[0];
+        } else if (types[typeId].opcode == OpTypeRuntimeArray && !types[typeId].operands.empty()) {
+            binding.count = 0;
+            typeId = types[typeId].operands[0];
+        }
+        const Type& type = types[typeId];
+
+        if (type.opcode == OpTypeStruct) {
+            bool bufferBlock = decorations[typeId].count(DecorationBufferBlock) > 0;
+            binding.type = storage == StorageStorageBuffer || bufferBlock ? ResourceType::StorageBuffer
+                                                                          : ResourceType::UniformBuffer;
+            binding.blockSize = sizeOf(typeId, 0);
+            if (binding.name.empty()) binding.name = names[typeId];
+        } else if (type.opcode == OpTypeSampledImage && !type.operands.empty()) {
+            binding.type = ResourceType::CombinedImageSampler;
+            const Type& image = types[type.operands[0]];
+            binding.dimension = image.operands.size() >= 2 ? image.operands[1] : 1;
+        } else if (type.opcode == OpTypeImage && type.operands.size() >= 6) {
+            binding.type = type.operands[5] == 2 ? ResourceType::StorageImage : ResourceType::SampledImage;
+            binding.dimension = type.operands[1];
+        } else if (type.opcode == OpTypeSampler) {
+            binding.type = ResourceType::Sampler;
+        } else {
+            continue;  // Not a descriptor (e.g. an acceleration structure we don't know)
+        }
+
+        Interface single;
+        single.bindings.push_back(binding);
+        result.merge(single);
+    }
+    return true;
+}
+
+}  // namespace spirv_interface
@@ -0,0 +1,147 @@
+// spirv_optimizer.h - Optional spirv-opt pass over compiled shaders, cached on disk
+//
+// glslangValidator's SPIR-V is unoptimised, and code-golfed shaders carry dead code and
+// redundant loads into SPIRV-Cross (MoltenVK) or NIR (lavapipe). With SPIRV-Tools available at
+// build time (HAVE_SPIRV_TOOLS) the optimizer runs in-process; otherwise the spirv-opt
+// executable is used if it is on PATH. Results are cached as
+// <cacheDir>/spirv-opt-<hash>.spv, keyed by a hash of the input module and the level, so an
+// unchanged shader costs one file read.
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#ifdef HAVE_SPIRV_TOOLS
+#include <spirv-tools/optimizer.hpp>
+#endif
+
+namespace spirv_optimizer {
+
+enum class Level { None, Performance, Size };
+
+// spirv-opt flag: -O (performance) or -Os (size)
+inline const char* levelFlag(Level level) {
+    switch (level) {
+        case Level::Performance: return "-O";
+        case Level::Size: return "-Os";
+        case Level::None: break;
+    }
+    return "";
+}
+
+// FNV-1a over the module and the level
+inline uint64_t hash(const std::vector<uint32_t>& words, Level level) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&](uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            h = (h ^ ((value >> (8 * i)) & 0xff)) * 1099511628211ull;
+        }
+    };
+    mix(static_cast<uint32_t>(level));
+    for (uint32_t word : words) {
+        mix(word);
+    }
+    return h;
+}
+
+inline bool readWords(const std::string& path, std::vector<uint32_t>& words) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    size_t size = static_cast<size_t>(file.tellg());
+    if (size == 0 || size % 4 != 0) {
+        return false;
+    }
+    words.resize(size / 4);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(words.data()), size);
+    return file.good() && words[0] == 0x07230203;
+}
+
+// Optimise without the cache
+inline bool run(const std::vector<uint32_t>& input, Level level, std::vector<uint32_t>& output, std::string& error) {
+    if (level == Level::None) {
+        output = input;
+        return true;
+    }
+#ifdef HAVE_SPIRV_TOOLS
+    spvtools::Optimizer optimizer(SPV_ENV_VULKAN_1_0);
+    optimizer.SetMessageConsumer([&](spv_message_level_t, const char*, const spv_position_t&, const char* message) {
+        error += std::string(message) + "\n";
+    });
+    if (level == Level::Size) {
+        optimizer.RegisterSizePasses();
+    } else {
+        optimizer.RegisterPerformancePasses();
+    }
+    if (!optimizer.Run(input.data(), input.size(), &output)) {
+        if (error.empty()) error = "spirv-opt failed";
+        return false;
+    }
+    return true;
+#else
+    char inputPath[] = "/tmp/metalshade-spirv-XXXXXX";
+    int fd = mkstemp(inputPath);
+    if (fd < 0) {
+        error = "could not create a temporary file";
+        return false;
+    }
+    bool written = write(fd, input.data(), input.size() * 4) == static_cast<ssize_t>(input.size() * 4);
+    close(fd);
+    std::string outputPath = std::string(inputPath) + ".opt";
+    std::string command = std::string("spirv-opt ") + levelFlag(level) + " \"" + inputPath + "\" -o \"" +
+                          outputPath + "\" 2>&1";
+    FILE* pipe = written ? popen(command.c_str(), "r") : nullptr;
+    if (pipe) {
+        char line[512];
+        while (fgets(line, sizeof(line), pipe)) {
+            error += line;
+        }
+    }
+    bool ok = pipe && pclose(pipe) == 0 && readWords(outputPath, output);
+    unlink(inputPath);
+    unlink(outputPath.c_str());
+    if (!ok && error.empty()) error = "spirv-opt not available";
+    return ok;
+#endif
+}
+
+// Optimise through the disk cache; cached (if given) tells whether it was a hit
+inline bool optimize(const std::vector<uint32_t>& input, Level level, const std::string& cacheDir,
+                     std::vector<uint32_t>& output, std::string& error, bool* cached = nullptr) {
+    if (cached) *cached = false;
+    if (level == Level::None) {
+        output = input;
+        return true;
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "/spirv-opt-%016llx.spv", static_cast<unsigned long long>(hash(input, level)));
+    std::string cachePath = cacheDir + name;
+    if (readWords(cachePath, output)) {
+        if (cached) *cached = true;
+        return true;
+    }
+    if (!run(input, level, output, error)) {
+        return false;
+    }
+    // Write-then-rename, so concurrent compiles never see a partial file
+    std::string temporary = cachePath + ".XXXXXX";
+    int fd = mkstemp(&temporary[0]);
+    if (fd < 0) {
+        return true;
+    }
+    bool written = write(fd, output.data(), output.size() * 4) == static_cast<ssize_t>(output.size() * 4);
+    close(fd);
+    if (!written || rename(temporary.c_str(), cachePath.c_str()) != 0) {
+        unlink(temporary.c_str());
+    }
+    return true;
+}
+
+}  // namespace spirv_optimizer
@@ -0,0 +1,48 @@
+#version 450
+
+layout(location = 0) in vec2 fragCoord;
+layout(location = 0) out vec4 fragColor;
+
+layout(binding = 0) uniform UniformBufferObject {
+    vec3 iResolution;
+    float iTime;
+    vec4 iMouse;
+    vec2 iScroll;
+    float iButtonLeft;
+    float iButtonRight;
+    float iButtonMiddle;
+    float iButton4;
+    float iButton5;
+    vec2 iPan;
+    float iTimeDelta;
+    int iFrame;
+    float iFrameRate;
+    float iSampleRate;
+    vec4 iDate;
+    vec3 iChannelResolution[4];
+    vec2 iPanLo;
+    vec4 iZoomCenter;
+    vec4 iMouseHistory[32];
+    int iMouseHistoryCount;
+    vec2 iTileOrigin;
+} ubo;
+
+layout(binding = 1) uniform sampler2D iChannel0;
+layout(binding = 2) uniform sampler2D iChannel1;
+layout(binding = 3) uniform sampler2D iChannel2;
+layout(binding = 4) uniform sampler2D iChannel3;
+
+// The Book of Shaders: u_* uniforms, gl_FragCoord and gl_FragColor in main()
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+
+
+
+
+void main() {
+    vec2 st = fragCoord.xy / ubo.iResolution.xy;
+    vec2 mouse = ubo.iMouse.xy / ubo.iResolution.xy;
+    fragColor = vec4(st.x, mouse.y, abs(sin(ubo.iTime)), 1.0);
+}
@@ -0,0 +1,50 @@
+#version 450
+
+layout(location = 0) in vec2 fragCoord;
+layout(location = 0) out vec4 fragColor;
+
+layout(binding = 0) uniform UniformBufferObject {
+    vec3 iResolution;
+    float iTime;
+    vec4 iMouse;
+    vec2 iScroll;
+    float iButtonLeft;
+    float iButtonRight;
+    float iButtonMiddle;
+    float iButton4;
+    float iButton5;
+    vec2 iPan;
+    float iTimeDelta;
+    int iFrame;
+    float iFrameRate;
+    float iSampleRate;
+    vec4 iDate;
+    vec3 iChannelResolution[4];
+    vec2 iPanLo;
+    vec4 iZoomCenter;
+    vec4 iMouseHistory[32];
+    int iMouseHistoryCount;
+    vec2 iTileOrigin;
+} ubo;
+
+layout(binding = 1) uniform sampler2D iChannel0;
+layout(binding = 2) uniform sampler2D iChannel1;
+layout(binding = 3) uniform sampler2D iChannel2;
+layout(binding = 4) uniform sampler2D iChannel3;
+
+// Every declarator in a comma list is a declaration, not only the first
+float g = 0.5, iFrameRate = 30.0;
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    float x = 1.0, iMouse = 2.0;
+    x += iMouse;
+    vec2 a = max(vec2(0.0), vec2(1.0, ubo.iTime)), iPan = a * 2.0, b;
+    b = iPan + a;
+    fragColor = vec4(x + iFrameRate, b, ubo.iTimeDelta);
+}
+
+void main() {
+    vec4 color = vec4(0.0);
+    mainImage(color, ubo.iTileOrigin + vec2(gl_FragCoord.x, -gl_FragCoord.y));
+    fragColor = color;
+}
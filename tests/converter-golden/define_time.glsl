@@ -0,0 +1,49 @@
+#version 450
+
+layout(location = 0) in vec2 fragCoord;
+layout(location = 0) out vec4 fragColor;
+
+layout(binding = 0) uniform UniformBufferObject {
+    vec3 iResolution;
+    float iTime;
+    vec4 iMouse;
+    vec2 iScroll;
+    float iButtonLeft;
+    float iButtonRight;
+    float iButtonMiddle;
+    float iButton4;
+    float iButton5;
+    vec2 iPan;
+    float iTimeDelta;
+    int iFrame;
+    float iFrameRate;
+    float iSampleRate;
+    vec4 iDate;
+    vec3 iChannelResolution[4];
+    vec2 iPanLo;
+    vec4 iZoomCenter;
+    vec4 iMouseHistory[32];
+    int iMouseHistoryCount;
+    vec2 iTileOrigin;
+} ubo;
+
+layout(binding = 1) uniform sampler2D iChannel0;
+layout(binding = 2) uniform sampler2D iChannel1;
+layout(binding = 3) uniform sampler2D iChannel2;
+layout(binding = 4) uniform sampler2D iChannel3;
+
+// Short names for uniforms through #define are rewritten in the define
+#define t ubo.iTime
+#define R ubo.iResolution
+#define S(a, b, x) smoothstep(a, b, x)
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    vec2 uv = (2.0 * fragCoord - R.xy) / R.y;
+    fragColor = vec4(S(0.0, 1.0, length(uv) - sin(t)));
+}
+
+void main() {
+    vec4 color = vec4(0.0);
+    mainImage(color, ubo.iTileOrigin + vec2(gl_FragCoord.x, -gl_FragCoord.y));
+    fragColor = color;
+}
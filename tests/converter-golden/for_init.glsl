@@ -0,0 +1,52 @@
+#version 450
+
+layout(location = 0) in vec2 fragCoord;
+layout(location = 0) out vec4 fragColor;
+
+layout(binding = 0) uniform UniformBufferObject {
+    vec3 iResolution;
+    float iTime;
+    vec4 iMouse;
+    vec2 iScroll;
+    float iButtonLeft;
+    float iButtonRight;
+    float iButtonMiddle;
+    float iButton4;
+    float iButton5;
+    vec2 iPan;
+    float iTimeDelta;
+    int iFrame;
+    float iFrameRate;
+    float iSampleRate;
+    vec4 iDate;
+    vec3 iChannelResolution[4];
+    vec2 iPanLo;
+    vec4 iZoomCenter;
+    vec4 iMouseHistory[32];
+    int iMouseHistoryCount;
+    vec2 iTileOrigin;
+} ubo;
+
+layout(binding = 1) uniform sampler2D iChannel0;
+layout(binding = 2) uniform sampler2D iChannel1;
+layout(binding = 3) uniform sampler2D iChannel2;
+layout(binding = 4) uniform sampler2D iChannel3;
+
+// A for-init variable lives until the end of the loop body
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    float a = 0.0;
+    for (int iFrame = 0; iFrame < 4; iFrame++) a += float(iFrame);
+    a += float(ubo.iFrame);
+    for (int iFrame = 0, n = 2; iFrame < n; iFrame++) {
+        for (int i = 0; i < iFrame; i++)
+            for (float iTime = 0.0; iTime < 1.0; iTime += 0.5) a += iTime;
+        a += ubo.iTime;
+    }
+    fragColor = vec4(a, float(ubo.iFrame), ubo.iTime, 1.0);
+}
+
+void main() {
+    vec4 color = vec4(0.0);
+    mainImage(color, ubo.iTileOrigin + vec2(gl_FragCoord.x, -gl_FragCoord.y));
+    fragColor = color;
+}
@@ -0,0 +1,53 @@
+#version 450
+
+layout(location = 0) in vec2 fragCoord;
+layout(location = 0) out vec4 fragColor;
+
+layout(binding = 0) uniform UniformBufferObject {
+    vec3 iResolution;
+    float iTime;
+    vec4 iMouse;
+    vec2 iScroll;
+    float iButtonLeft;
+    float iButtonRight;
+    float iButtonMiddle;
+    float iButton4;
+    float iButton5;
+    vec2 iPan;
+    float iTimeDelta;
+    int iFrame;
+    float iFrameRate;
+    float iSampleRate;
+    vec4 iDate;
+    vec3 iChannelResolution[4];
+    vec2 iPanLo;
+    vec4 iZoomCenter;
+    vec4 iMouseHistory[32];
+    int iMouseHistoryCount;
+    vec2 iTileOrigin;
+} ubo;
+
+layout(binding = 1) uniform sampler2D iChannel0;
+layout(binding = 2) uniform sampler2D iChannel1;
+layout(binding = 3) uniform sampler2D iChannel2;
+layout(binding = 4) uniform sampler2D iChannel3;
+
+// A local named like a uniform shadows it until its block ends
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    vec2 uv = fragCoord / ubo.iResolution.xy;
+    {
+        vec2 iResolution = vec2(100.0);
+        uv *= iResolution;
+    }
+    if (uv.x > 0.5) {
+        float iTime = 1.0;
+        uv += iTime;
+    }
+    fragColor = vec4(uv, ubo.iTime, ubo.iResolution.x);
+}
+
+void main() {
+    vec4 color = vec4(0.0);
+    mainImage(color, ubo.iTileOrigin + vec2(gl_FragCoord.x, -gl_FragCoord.y));
+    fragColor = color;
+}
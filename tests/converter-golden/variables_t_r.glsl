@@ -0,0 +1,55 @@
+#version 450
+
+layout(location = 0) in vec2 fragCoord;
+layout(location = 0) out vec4 fragColor;
+
+layout(binding = 0) uniform UniformBufferObject {
+    vec3 iResolution;
+    float iTime;
+    vec4 iMouse;
+    vec2 iScroll;
+    float iButtonLeft;
+    float iButtonRight;
+    float iButtonMiddle;
+    float iButton4;
+    float iButton5;
+    vec2 iPan;
+    float iTimeDelta;
+    int iFrame;
+    float iFrameRate;
+    float iSampleRate;
+    vec4 iDate;
+    vec3 iChannelResolution[4];
+    vec2 iPanLo;
+    vec4 iZoomCenter;
+    vec4 iMouseHistory[32];
+    int iMouseHistoryCount;
+    vec2 iTileOrigin;
+} ubo;
+
+layout(binding = 1) uniform sampler2D iChannel0;
+layout(binding = 2) uniform sampler2D iChannel1;
+layout(binding = 3) uniform sampler2D iChannel2;
+layout(binding = 4) uniform sampler2D iChannel3;
+
+// Variables named t and r are plain variables
+float march(vec3 ro, vec3 rd) {
+    float t = 0.0;
+    for (int i = 0; i < 64; i++) {
+        float r = length(ro + rd * t) - 1.0;
+        t += r;
+    }
+    return t;
+}
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    vec2 r = ubo.iResolution.xy;
+    float t = march(vec3(0.0, 0.0, -3.0), normalize(vec3((fragCoord - 0.5 * r) / r.y, 1.0)));
+    fragColor = vec4(vec3(t * 0.1), 1.0) * (0.5 + 0.5 * sin(ubo.iTime));
+}
+
+void main() {
+    vec4 color = vec4(0.0);
+    mainImage(color, ubo.iTileOrigin + vec2(gl_FragCoord.x, -gl_FragCoord.y));
+    fragColor = color;
+}
@@ -0,0 +1,14 @@
+// The Book of Shaders: u_* uniforms, gl_FragCoord and gl_FragColor in main()
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+uniform vec2 u_resolution;
+uniform vec2 u_mouse;
+uniform float u_time;
+
+void main() {
+    vec2 st = gl_FragCoord.xy / u_resolution;
+    vec2 mouse = u_mouse / u_resolution;
+    gl_FragColor = vec4(st.x, mouse.y, abs(sin(u_time)), 1.0);
+}
@@ -0,0 +1,10 @@
+// Every declarator in a comma list is a declaration, not only the first
+float g = 0.5, iFrameRate = 30.0;
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    float x = 1.0, iMouse = 2.0;
+    x += iMouse;
+    vec2 a = max(vec2(0.0), vec2(1.0, iTime)), iPan = a * 2.0, b;
+    b = iPan + a;
+    fragColor = vec4(x + iFrameRate, b, iTimeDelta);
+}
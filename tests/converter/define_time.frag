@@ -0,0 +1,9 @@
+// Short names for uniforms through #define are rewritten in the define
+#define t iTime
+#define R iResolution
+#define S(a, b, x) smoothstep(a, b, x)
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    vec2 uv = (2.0 * fragCoord - R.xy) / R.y;
+    fragColor = vec4(S(0.0, 1.0, length(uv) - sin(t)));
+}
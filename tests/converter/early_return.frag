@@ -0,0 +1,9 @@
+// An early return from mainImage still writes the colour through the main() wrapper
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    vec2 uv = fragCoord / iResolution.xy;
+    if (uv.x < 0.5) {
+        fragColor = vec4(1.0, 0.0, 0.0, 1.0);
+        return;
+    }
+    fragColor = vec4(uv, 0.5 + 0.5 * sin(iTime), 1.0);
+}
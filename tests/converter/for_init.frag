@@ -0,0 +1,12 @@
+// A for-init variable lives until the end of the loop body
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    float a = 0.0;
+    for (int iFrame = 0; iFrame < 4; iFrame++) a += float(iFrame);
+    a += float(iFrame);
+    for (int iFrame = 0, n = 2; iFrame < n; iFrame++) {
+        for (int i = 0; i < iFrame; i++)
+            for (float iTime = 0.0; iTime < 1.0; iTime += 0.5) a += iTime;
+        a += iTime;
+    }
+    fragColor = vec4(a, float(iFrame), iTime, 1.0);
+}
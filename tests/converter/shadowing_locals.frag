@@ -0,0 +1,13 @@
+// A local named like a uniform shadows it until its block ends
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    vec2 uv = fragCoord / iResolution.xy;
+    {
+        vec2 iResolution = vec2(100.0);
+        uv *= iResolution;
+    }
+    if (uv.x > 0.5) {
+        float iTime = 1.0;
+        uv += iTime;
+    }
+    fragColor = vec4(uv, iTime, iResolution.x);
+}
@@ -0,0 +1,11 @@
+// Parameters named like uniforms shadow them inside their function only
+float wave(float iTime, vec2 iMouse);
+
+float wave(float iTime, vec2 iMouse) {
+    return sin(iTime + iMouse.x);
+}
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    float v = wave(iTime * 2.0, iMouse.xy);
+    fragColor = vec4(v, iMouse.y, 0.0, 1.0);
+}
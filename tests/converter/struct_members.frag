@@ -0,0 +1,13 @@
+// Names after '.' are members or swizzles, never uniforms
+struct Camera {
+    vec3 iResolution;
+    float iTime;
+};
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    Camera cam;
+    cam.iTime = iTime;
+    cam.iResolution = iResolution;
+    vec2 m = iMouse.xy / cam.iResolution.xy;
+    fragColor = vec4(m, cam.iTime, iMouse.z);
+}
@@ -0,0 +1,12 @@
+// GLSL ES texture functions map to texture / textureLod; sampler uniforms are dropped
+// @iChannel1 cube sky/
+uniform sampler2D iChannel0;
+uniform samplerCube iChannel1;
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    vec2 uv = fragCoord / iResolution.xy;
+    vec4 a = texture2D(iChannel0, uv);
+    vec4 b = textureCube(iChannel1, vec3(uv, 1.0));
+    vec4 c = texture2DLod(iChannel0, uv, 2.0);
+    fragColor = mix(a, b, 0.5) + c * 0.1;
+}
@@ -0,0 +1,15 @@
+// Variables named t and r are plain variables
+float march(vec3 ro, vec3 rd) {
+    float t = 0.0;
+    for (int i = 0; i < 64; i++) {
+        float r = length(ro + rd * t) - 1.0;
+        t += r;
+    }
+    return t;
+}
+
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    vec2 r = iResolution.xy;
+    float t = march(vec3(0.0, 0.0, -3.0), normalize(vec3((fragCoord - 0.5 * r) / r.y, 1.0)));
+    fragColor = vec4(vec3(t * 0.1), 1.0) * (0.5 + 0.5 * sin(iTime));
+}
@@ -0,0 +1,82 @@
+// uniforms.h - Single definition of the shader uniform block (binding 0)
+//
+// METALSHADE_UNIFORMS lists every field once; the C++ struct and the GLSL block that is
+// injected into converted shaders are both generated from it, with std140 alignment
+// spelled out per GLSL type, so the two cannot drift apart. To add a uniform, add a line
+// here and regenerate uniforms.glsl (make uniforms.glsl) for the Python tools.
+//
+//   FIELD(glslType, name)          float, int, vec2, vec3, vec4
+//   ARRAY(glslType, name, count)   std140 arrays: every element padded to 16 bytes
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define METALSHADE_UNIFORMS(FIELD, ARRAY) \
+    FIELD(vec3, iResolution) \
+    FIELD(float, iTime) \
+    FIELD(vec4, iMouse) \
+    FIELD(vec2, iScroll)          /* Accumulated scroll offset (x, y) */ \
+    FIELD(float, iButtonLeft)     /* Button states as individual floats */ \
+    FIELD(float, iButtonRight) \
+    FIELD(float, iButtonMiddle) \
+    FIELD(float, iButton4) \
+    FIELD(float, iButton5) \
+    FIELD(vec2, iPan)             /* Pan offset for drag-and-drop (pixels) */ \
+    FIELD(float, iTimeDelta)      /* Seconds since the previous frame */ \
+    FIELD(int, iFrame)            /* Frames since the shader was loaded */ \
+    FIELD(float, iFrameRate)      /* Smoothed frames per second */ \
+    FIELD(float, iSampleRate)     /* Audio channel sample rate */ \
+    FIELD(vec4, iDate)            /* Year, month (0-11), day, seconds since midnight */ \
+    ARRAY(vec3, iChannelResolution, 4) \
+    FIELD(vec2, iPanLo)           /* iPan + iPanLo = the pan offset to ~48 bits (df64) */ \
+    FIELD(vec4, iZoomCenter)      /* Zoom focus (iScroll.x, iButtonLeft) as hi.xy, lo.zw */ \
+    ARRAY(vec4, iMouseHistory, 32) /* Cursor samples, newest first: x, y, age (s), buttons */ \
+    FIELD(int, iMouseHistoryCount) /* How many of them arrived since the previous frame */ \
+    FIELD(vec2, iTileOrigin)      /* fragCoord of the framebuffer's top-left corner (--render tiles) */
+
+// std140 member declarations per GLSL type
+#define STD140_MEMBER_float(name) alignas(4) float name;
+#define STD140_MEMBER_int(name) alignas(4) int32_t name;
+#define STD140_MEMBER_vec2(name) alignas(8) float name[2];
+#define STD140_MEMBER_vec3(name) alignas(16) float name[3];
+#define STD140_MEMBER_vec4(name) alignas(16) float name[4];
+
+#define UNIFORM_STRUCT_FIELD(type, name) STD140_MEMBER_##type(name)
+#define UNIFORM_STRUCT_ARRAY(type, name, count) alignas(16) float name[count][4];
+
+struct UniformBufferObject {
+    METALSHADE_UNIFORMS(UNIFORM_STRUCT_FIELD, UNIFORM_STRUCT_ARRAY)
+};
+
+#define UNIFORM_GLSL_FIELD(type, name) "    " #type " " #name ";\n"
+#define UNIFORM_GLSL_ARRAY(type, name, count) "    " #type " " #name "[" #count "];\n"
+
+// The GLSL side of the same block, as injected into converted shaders
+inline std::string uniformBlockGLSL() {
+    return "layout(binding = 0) uniform UniformBufferObject {\n"
+           METALSHADE_UNIFORMS(UNIFORM_GLSL_FIELD, UNIFORM_GLSL_ARRAY)
+           "} ubo;\n";
+}
+
+// fragCoord in the whole image (y up) for a generated main(): gl_FragCoord moved to the tile
+// being drawn, so a --render tile needs no viewport larger than itself
+inline const char* fragCoordGLSL() {
+    return "ubo.iTileOrigin + vec2(gl_FragCoord.x, -gl_FragCoord.y)";
+}
+
+#define UNIFORM_NAME_FIELD(type, name) #name,
+#define UNIFORM_NAME_ARRAY(type, name, count) #name,
+
+// Member names, for rewriting iTime → ubo.iTime etc. during conversion
+inline std::vector<std::string> uniformNames() {
+    return {METALSHADE_UNIFORMS(UNIFORM_NAME_FIELD, UNIFORM_NAME_ARRAY)};
+}
+
+#undef UNIFORM_STRUCT_FIELD
+#undef UNIFORM_STRUCT_ARRAY
+#undef UNIFORM_GLSL_FIELD
+#undef UNIFORM_GLSL_ARRAY
+#undef UNIFORM_NAME_FIELD
+#undef UNIFORM_NAME_ARRAY
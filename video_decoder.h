@@ -0,0 +1,294 @@
+// video_decoder.h - Background video decoding for the // @video iChannel source
+//
+// Frames are decoded on a worker thread (FFmpeg) and converted to RGBA straight into
+// caller-owned slots (mapped Vulkan staging buffers). The slots form a bounded
+// single-producer/single-consumer ring:
+//
+//   decoder thread ──write──► [slot][slot][slot][slot] ──acquire──► render thread
+//                      ▲                                          │
+//                      └──────────── release (after GPU copy) ◄───┘
+//
+// The render thread never waits on the decoder: acquireFrame() only looks at atomics
+// and returns false when nothing new is due. The decoder blocks itself when the ring
+// is full. Build with -DHAVE_FFMPEG (see Makefile) to enable decoding.
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef HAVE_FFMPEG
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/avutil.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+class VideoDecoder {
+public:
+    ~VideoDecoder() { close(); }
+
+    // Probe the file and pick an output size (downscaled to maxWidth if larger).
+    // Decoding does not start until start() hands over the slot memory.
+    bool open(const std::string& path, uint32_t maxWidth = 1920) {
+        close();
+#ifdef HAVE_FFMPEG
+        if (avformat_open_input(&formatCtx, path.c_str(), nullptr, nullptr) < 0) {
+            std::cerr << "✗ Could not open video: " << path << std::endl;
+            return false;
+        }
+        if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
+            std::cerr << "✗ Could not read stream info: " << path << std::endl;
+            close();
+            return false;
+        }
+
+        const AVCodec* codec = nullptr;
+        streamIndex = av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+        if (streamIndex < 0 || !codec) {
+            std::cerr << "✗ No decodable video stream in: " << path << std::endl;
+            close();
+            return false;
+        }
+
+        AVStream* stream = formatCtx->streams[streamIndex];
+        codecCtx = avcodec_alloc_context3(codec);
+        avcodec_parameters_to_context(codecCtx, stream->codecpar);
+        codecCtx->thread_count = 0;  // Let FFmpeg pick (frame/slice threads)
+        if (avcodec_open2(codecCtx, codec, nullptr) < 0) {
+            std::cerr << "✗ Could not open video decoder: " << path << std::endl;
+            close();
+            return false;
+        }
+
+        outWidth = codecCtx->width;
+        outHeight = codecCtx->height;
+        if (outWidth > maxWidth) {
+            outHeight = (uint32_t)((uint64_t)outHeight * maxWidth / outWidth);
+            outWidth = maxWidth;
+        }
+
+        timeBase = av_q2d(stream->time_base);
+        frameDuration = 1.0 / 30.0;
+        if (stream->avg_frame_rate.num > 0 && stream->avg_frame_rate.den > 0) {
+            frameDuration = 1.0 / av_q2d(stream->avg_frame_rate);
+        }
+        clipDuration = formatCtx->duration > 0 ? (double)formatCtx->duration / AV_TIME_BASE : 0.0;
+
+        std::cout << "✓ Video: " << path << " (" << codecCtx->width << "x" << codecCtx->height
+                  << " → " << outWidth << "x" << outHeight << ", "
+                  << (int)std::round(1.0 / frameDuration) << " fps)" << std::endl;
+        return true;
+#else
+        std::cerr << "⚠ Video channel needs FFmpeg; rebuild with libavformat/libavcodec/libswscale installed ("
+                  << path << " ignored)" << std::endl;
+        return false;
+#endif
+    }
+
+    uint32_t width() const { return outWidth; }
+    uint32_t height() const { return outHeight; }
+    size_t frameBytes() const { return (size_t)outWidth * outHeight * 4; }
+    double framePeriod() const { return frameDuration; }
+
+    // Start decoding into the given slots (each frameBytes() large, tightly packed RGBA)
+    void start(const std::vector<void*>& slotMemory) {
+        slots = slotMemory;
+        slotPts.assign(slots.size(), 0.0);
+        writeSeq = 0;
+        releasedSeq = 0;
+        readSeq = 0;
+        dropped = 0;
+        late = 0;
+        shown = 0;
+        running = true;
+        worker = std::thread(&VideoDecoder::decodeLoop, this);
+    }
+
+    void stop() {
+        running = false;
+        spaceAvailable.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    void close() {
+        stop();
+#ifdef HAVE_FFMPEG
+        if (swsCtx) sws_freeContext(swsCtx);
+        if (codecCtx) avcodec_free_context(&codecCtx);
+        if (formatCtx) avformat_close_input(&formatCtx);
+        swsCtx = nullptr;
+#endif
+        slots.clear();
+    }
+
+    // Render thread: select the newest decoded frame with pts <= time.
+    // Older frames that were superseded are skipped and counted as dropped; a frame
+    // shown more than one period after its pts is counted as late. Never blocks.
+    bool acquireFrame(double time, uint64_t& sequence) {
+        uint64_t available = writeSeq.load(std::memory_order_acquire);
+        if (readSeq == available) {
+            return false;
+        }
+        while (readSeq + 1 < available && slotPts[(readSeq + 1) % slots.size()] <= time) {
+            readSeq++;
+            dropped++;
+        }
+        double pts = slotPts[readSeq % slots.size()];
+        if (pts > time) {
+            return false;
+        }
+        if (time - pts > frameDuration * 1.5) {
+            late++;
+        }
+        sequence = readSeq++;
+        shown++;
+        return true;
+    }
+
+    // Wait (at load time only) for the first decoded frame so the channel never starts empty
+    bool waitFirstFrame(uint64_t& sequence, int timeoutMs = 2000) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (writeSeq.load(std::memory_order_acquire) == 0) {
+            if (!running || std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        sequence = readSeq++;
+        shown++;
+        return true;
+    }
+
+    size_t slotIndex(uint64_t sequence) const { return sequence % slots.size(); }
+
+    // Render thread: the GPU copy of `sequence` finished, so it and every frame before
+    // it (including dropped ones) can be overwritten by the decoder
+    void release(uint64_t sequence) {
+        releasedSeq.store(sequence + 1, std::memory_order_release);
+        spaceAvailable.notify_one();
+    }
+
+    uint64_t framesShown() const { return shown; }
+    uint64_t framesDropped() const { return dropped; }
+    uint64_t framesLate() const { return late; }
+
+private:
+    uint32_t outWidth = 0;
+    uint32_t outHeight = 0;
+    double frameDuration = 1.0 / 30.0;
+    double clipDuration = 0.0;
+    double timeBase = 0.0;
+
+    std::vector<void*> slots;
+    std::vector<double> slotPts;
+    std::atomic<uint64_t> writeSeq{0};     // Frames published by the decoder
+    std::atomic<uint64_t> releasedSeq{0};  // Frames handed back by the render thread
+    uint64_t readSeq = 0;                  // Render thread only
+    uint64_t shown = 0;
+    uint64_t dropped = 0;
+    uint64_t late = 0;
+
+    std::atomic<bool> running{false};
+    std::thread worker;
+    std::mutex waitMutex;
+    std::condition_variable spaceAvailable;
+
+#ifdef HAVE_FFMPEG
+    AVFormatContext* formatCtx = nullptr;
+    AVCodecContext* codecCtx = nullptr;
+    SwsContext* swsCtx = nullptr;
+    int streamIndex = -1;
+
+    // Decode the next frame, looping at end of file. Returns false on a hard error.
+    bool decodeNext(AVFrame* frame, AVPacket* packet, double& loopOffset, double& lastPts) {
+        while (running) {
+            int ret = avcodec_receive_frame(codecCtx, frame);
+            if (ret == 0) {
+                return true;
+            }
+            if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+                return false;
+            }
+            if (ret == AVERROR_EOF) {
+                // Loop: restart the stream and keep timestamps monotonic
+                loopOffset += clipDuration > 0.0 ? clipDuration : lastPts + frameDuration;
+                av_seek_frame(formatCtx, streamIndex, 0, AVSEEK_FLAG_BACKWARD);
+                avcodec_flush_buffers(codecCtx);
+                continue;
+            }
+
+            int readResult = av_read_frame(formatCtx, packet);
+            if (readResult < 0) {
+                avcodec_send_packet(codecCtx, nullptr);  // Drain remaining frames
+                continue;
+            }
+            if (packet->stream_index == streamIndex) {
+                avcodec_send_packet(codecCtx, packet);
+            }
+            av_packet_unref(packet);
+        }
+        return false;
+    }
+
+    void decodeLoop() {
+        AVFrame* frame = av_frame_alloc();
+        AVPacket* packet = av_packet_alloc();
+        double loopOffset = 0.0;
+        double lastPts = 0.0;
+        double firstPts = -1.0;
+
+        while (running) {
+            // Wait for a free slot; this is the only place the decoder blocks
+            uint64_t seq = writeSeq.load(std::memory_order_relaxed);
+            if (seq - releasedSeq.load(std::memory_order_acquire) >= slots.size()) {
+                std::unique_lock<std::mutex> lock(waitMutex);
+                spaceAvailable.wait_for(lock, std::chrono::milliseconds(5));
+                continue;
+            }
+
+            if (!decodeNext(frame, packet, loopOffset, lastPts)) {
+                if (running) {
+                    std::cerr << "✗ Video decode error, stopping video channel" << std::endl;
+                }
+                break;
+            }
+
+            int64_t ts = frame->best_effort_timestamp;
+            double pts = ts == AV_NOPTS_VALUE ? lastPts + frameDuration : ts * timeBase;
+            if (firstPts < 0.0) {
+                firstPts = pts;
+            }
+            lastPts = pts - firstPts;
+
+            swsCtx = sws_getCachedContext(swsCtx, frame->width, frame->height, (AVPixelFormat)frame->format,
+                                          outWidth, outHeight, AV_PIX_FMT_RGBA, SWS_BILINEAR,
+                                          nullptr, nullptr, nullptr);
+            uint8_t* dst[4] = {static_cast<uint8_t*>(slots[seq % slots.size()]), nullptr, nullptr, nullptr};
+            int dstStride[4] = {(int)outWidth * 4, 0, 0, 0};
+            sws_scale(swsCtx, frame->data, frame->linesize, 0, frame->height, dst, dstStride);
+            av_frame_unref(frame);
+
+            slotPts[seq % slots.size()] = lastPts + loopOffset;
+            writeSeq.store(seq + 1, std::memory_order_release);
+        }
+
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+    }
+#else
+    void decodeLoop() {}
+#endif
+};
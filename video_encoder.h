@@ -0,0 +1,305 @@
+// video_encoder.h - Pipelined video encoding of rendered frames for --encode
+//
+// The mirror image of video_decoder.h. The render thread fills caller-owned slots (the mapped
+// Vulkan readback buffers, RGBA8, top row first) and hands them over by sequence number; two
+// workers take it from there:
+//
+//   render thread ──submit──► [slot][slot] ──► converter ──► [YUV][YUV][YUV][YUV] ──► encoder ──► file
+//         ▲                                     │ RGBA → YUV420 (swscale)               libavcodec
+//         └──────── waitForSlot (converted) ◄───┘                                       + libavformat
+//
+// The converter reads the slots in place and releases each one as soon as it is converted,
+// so the GPU can render into it again while the encoder is still compressing older frames.
+// Both queues are bounded: when the encoder falls behind, the converter and then the render
+// thread wait, so memory stays flat however long the render. Build with -DHAVE_FFMPEG (see
+// Makefile) to enable encoding.
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef HAVE_FFMPEG
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/avutil.h>
+#include <libavutil/opt.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+class VideoEncoder {
+public:
+    static constexpr size_t YUV_FRAMES = 4;  // Converted frames waiting for the encoder
+
+    ~VideoEncoder() { finish(); }
+
+    // Create the file and the encoder: codecName (e.g. "libx264", "ffv1"), or H.264 / MPEG-4
+    // Part 2, whichever this FFmpeg has, when empty. Width and height must be even.
+    bool open(const std::string& path, uint32_t width, uint32_t height, int fps, const std::string& codecName,
+              std::string& error) {
+#ifdef HAVE_FFMPEG
+        frameWidth = width;
+        frameHeight = height;
+        if (avformat_alloc_output_context2(&formatCtx, nullptr, nullptr, path.c_str()) < 0 || !formatCtx) {
+            error = "unknown container for " + path;
+            return false;
+        }
+        const AVCodec* codec = nullptr;
+        if (!codecName.empty()) {
+            codec = avcodec_find_encoder_by_name(codecName.c_str());
+            if (!codec) {
+                error = "no " + codecName + " encoder in this FFmpeg";
+                return false;
+            }
+        } else {
+            codec = avcodec_find_encoder(AV_CODEC_ID_H264);
+            if (!codec) {
+                codec = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+            }
+            if (!codec) {
+                error = "no H.264 or MPEG-4 encoder in this FFmpeg";
+                return false;
+            }
+        }
+
+        stream = avformat_new_stream(formatCtx, nullptr);
+        codecCtx = avcodec_alloc_context3(codec);
+        packet = av_packet_alloc();
+        codecCtx->width = static_cast<int>(width);
+        codecCtx->height = static_cast<int>(height);
+        codecCtx->pix_fmt = AV_PIX_FMT_YUV420P;
+        codecCtx->time_base = AVRational{1, fps};
+        codecCtx->framerate = AVRational{fps, 1};
+        codecCtx->gop_size = fps * 2;
+        codecCtx->thread_count = 0;  // Let FFmpeg pick (frame/slice threads)
+        if (formatCtx->oformat->flags & AVFMT_GLOBALHEADER) {
+            codecCtx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+        if (std::string(codec->name) == "libx264") {
+            av_opt_set(codecCtx->priv_data, "crf", "18", 0);  // Visually lossless for publishing
+            av_opt_set(codecCtx->priv_data, "preset", "medium", 0);
+        } else if (codec->id == AV_CODEC_ID_MPEG4) {
+            codecCtx->bit_rate = static_cast<int64_t>(width) * height * fps / 4;
+        }
+        if (avcodec_open2(codecCtx, codec, nullptr) < 0) {
+            error = std::string("could not open the ") + codec->name + " encoder";
+            return false;
+        }
+        avcodec_parameters_from_context(stream->codecpar, codecCtx);
+        stream->time_base = codecCtx->time_base;
+
+        if (!(formatCtx->oformat->flags & AVFMT_NOFILE) &&
+            avio_open(&formatCtx->pb, path.c_str(), AVIO_FLAG_WRITE) < 0) {
+            error = "cannot create " + path;
+            return false;
+        }
+        if (avformat_write_header(formatCtx, nullptr) < 0) {
+            error = "could not write the " + std::string(formatCtx->oformat->name) + " header";
+            return false;
+        }
+        headerWritten = true;
+
+        for (AVFrame*& frame : yuvFrames) {
+            frame = av_frame_alloc();
+            frame->format = AV_PIX_FMT_YUV420P;
+            frame->width = codecCtx->width;
+            frame->height = codecCtx->height;
+            if (av_frame_get_buffer(frame, 0) < 0) {
+                error = "out of memory for YUV frames";
+                return false;
+            }
+        }
+        encoderName = codec->name;
+        return true;
+#else
+        (void)path, (void)width, (void)height, (void)fps, (void)codecName;
+        error = "encoding needs FFmpeg; rebuild with libavformat/libavcodec/libswscale installed";
+        return false;
+#endif
+    }
+
+    const std::string& codecName() const { return encoderName; }
+
+    // Start the workers on the given slots (each width x height x 4 bytes)
+    void start(const std::vector<const void*>& slotMemory) {
+        slots = slotMemory;
+        submitted = converted = encoded = 0;
+        failed = false;
+        running = true;
+        converter = std::thread(&VideoEncoder::convertLoop, this);
+        encoder = std::thread(&VideoEncoder::encodeLoop, this);
+    }
+
+    // Render thread: block until frame sequence has been converted, so its slot can be
+    // rendered into again. False if encoding failed.
+    bool waitForSlot(uint64_t sequence) {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        progress.wait(lock, [&] { return converted > sequence || failed; });
+        return !failed;
+    }
+
+    // Render thread: frame `sequence` (the next one) is in slot sequence % slots.size()
+    void submit(uint64_t sequence) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        submitted = sequence + 1;
+        progress.notify_all();
+    }
+
+    // Encode what was submitted, flush the encoder and close the file. True if every frame
+    // made it into the file.
+    bool finish() {
+        if (running) {
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                running = false;
+                progress.notify_all();
+            }
+            converter.join();
+            encoder.join();
+        }
+#ifdef HAVE_FFMPEG
+        if (codecCtx && headerWritten) {
+            if (!failed) {
+                avcodec_send_frame(codecCtx, nullptr);
+                failed = !writePackets();
+            }
+            av_write_trailer(formatCtx);
+            headerWritten = false;
+        }
+        if (formatCtx && !(formatCtx->oformat->flags & AVFMT_NOFILE)) {
+            avio_closep(&formatCtx->pb);
+        }
+        for (AVFrame*& frame : yuvFrames) {
+            av_frame_free(&frame);
+        }
+        if (packet) av_packet_free(&packet);
+        if (swsCtx) sws_freeContext(swsCtx);
+        if (codecCtx) avcodec_free_context(&codecCtx);
+        if (formatCtx) avformat_free_context(formatCtx);
+        swsCtx = nullptr;
+        formatCtx = nullptr;
+#endif
+        return !failed;
+    }
+
+    uint64_t framesEncoded() const { return encoded; }
+    double convertSeconds() const { return convertTime; }  // Converter busy time
+    double encodeSeconds() const { return encodeTime; }    // Encoder busy time
+
+private:
+    std::vector<const void*> slots;
+    std::string encoderName;
+
+    // Frames [0, submitted) are in slots, [0, converted) in YUV frames, [0, encoded) written
+    std::mutex stateMutex;
+    std::condition_variable progress;
+    uint64_t submitted = 0, converted = 0, encoded = 0;
+    bool running = false;
+    bool failed = false;
+    double convertTime = 0.0, encodeTime = 0.0;
+    std::thread converter, encoder;
+
+    static double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+#ifdef HAVE_FFMPEG
+    uint32_t frameWidth = 0, frameHeight = 0;
+    AVFormatContext* formatCtx = nullptr;
+    AVCodecContext* codecCtx = nullptr;
+    AVStream* stream = nullptr;
+    SwsContext* swsCtx = nullptr;
+    AVPacket* packet = nullptr;
+    AVFrame* yuvFrames[YUV_FRAMES] = {};
+    bool headerWritten = false;
+
+    void convertLoop() {
+        swsCtx = sws_getContext(frameWidth, frameHeight, AV_PIX_FMT_RGBA, frameWidth, frameHeight,
+                                AV_PIX_FMT_YUV420P, SWS_BILINEAR, nullptr, nullptr, nullptr);
+        for (;;) {
+            uint64_t sequence;
+            {
+                // Wait for a filled slot and a free YUV frame
+                std::unique_lock<std::mutex> lock(stateMutex);
+                progress.wait(lock, [&] {
+                    return failed || (converted < submitted && converted - encoded < YUV_FRAMES) ||
+                           (!running && converted == submitted);
+                });
+                if (failed || converted == submitted) {
+                    return;
+                }
+                sequence = converted;
+            }
+            auto start = std::chrono::steady_clock::now();
+            AVFrame* frame = yuvFrames[sequence % YUV_FRAMES];
+            av_frame_make_writable(frame);
+            const uint8_t* src[4] = {static_cast<const uint8_t*>(slots[sequence % slots.size()]), nullptr, nullptr,
+                                     nullptr};
+            int srcStride[4] = {static_cast<int>(frameWidth) * 4, 0, 0, 0};
+            sws_scale(swsCtx, src, srcStride, 0, frameHeight, frame->data, frame->linesize);
+            frame->pts = static_cast<int64_t>(sequence);
+            convertTime += secondsSince(start);
+
+            std::lock_guard<std::mutex> lock(stateMutex);
+            converted = sequence + 1;
+            progress.notify_all();
+        }
+    }
+
+    void encodeLoop() {
+        for (;;) {
+            uint64_t sequence;
+            {
+                std::unique_lock<std::mutex> lock(stateMutex);
+                progress.wait(lock, [&] {
+                    return failed || encoded < converted || (!running && encoded == submitted);
+                });
+                if (failed || encoded == converted) {
+                    return;
+                }
+                sequence = encoded;
+            }
+            auto start = std::chrono::steady_clock::now();
+            bool ok = avcodec_send_frame(codecCtx, yuvFrames[sequence % YUV_FRAMES]) >= 0 && writePackets();
+            encodeTime += secondsSince(start);
+
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (!ok) {
+                std::cerr << "✗ Video encode error at frame " << sequence << std::endl;
+                failed = true;
+            } else {
+                encoded = sequence + 1;
+            }
+            progress.notify_all();
+        }
+    }
+
+    // Mux every packet the encoder has ready
+    bool writePackets() {
+        for (;;) {
+            int ret = avcodec_receive_packet(codecCtx, packet);
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                return true;
+            }
+            if (ret < 0) {
+                return false;
+            }
+            av_packet_rescale_ts(packet, codecCtx->time_base, stream->time_base);
+            packet->stream_index = stream->index;
+            if (av_interleaved_write_frame(formatCtx, packet) < 0) {
+                return false;
+            }
+        }
+    }
+#else
+    void convertLoop() {}
+    void encodeLoop() {}
+#endif
+};
@@ -0,0 +1,146 @@
+// work_pool.h - Persistent work-stealing thread pool for batch jobs (corpus validation, ...)
+//
+// parallelFor(count, body) splits [0, count) into one contiguous block per worker. Each
+// worker pops from the back of its own deque and, once that runs dry, steals from the front
+// of the others', so a few slow items (a shader that takes seconds to compile) don't leave
+// the rest of the cores idle. The calling thread works too; body gets the worker index so it
+// can use per-thread scratch state. Bodies must not throw.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkPool {
+public:
+    // threadCount 0 = one worker per hardware thread
+    explicit WorkPool(unsigned threadCount = 0) {
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 0; i < threadCount; i++) {
+            queues.emplace_back(new Queue());
+        }
+        for (unsigned i = 1; i < threadCount; i++) {
+            threads.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~WorkPool() {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    unsigned size() const { return static_cast<unsigned>(queues.size()); }
+
+    // Run body(index, worker) for every index in [0, count); returns when all have finished
+    void parallelFor(size_t count, const std::function<void(size_t, unsigned)>& body) {
+        if (count == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> batch(batchMutex);
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            job = &body;
+            remaining = count;
+        }
+        // Publishing the indices under the queue locks also publishes job to the thieves
+        unsigned workers = size();
+        for (unsigned w = 0; w < workers; w++) {
+            std::lock_guard<std::mutex> lock(queues[w]->mutex);
+            for (size_t i = count * w / workers; i < count * (w + 1) / workers; i++) {
+                queues[w]->items.push_back(i);
+            }
+        }
+        // Only now: a worker that saw the new generation with empty queues would sleep
+        // through the batch
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            generation++;
+        }
+        wake.notify_all();
+
+        work(0);
+        std::unique_lock<std::mutex> lock(stateMutex);
+        done.wait(lock, [this] { return remaining.load() == 0; });
+        job = nullptr;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> items;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex batchMutex;  // One parallelFor at a time
+    std::mutex stateMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t, unsigned)>* job = nullptr;
+    std::atomic<size_t> remaining{0};
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    bool take(unsigned worker, size_t& index) {
+        {
+            Queue& own = *queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.items.empty()) {
+                index = own.items.back();
+                own.items.pop_back();
+                return true;
+            }
+        }
+        for (unsigned k = 1; k < size(); k++) {
+            Queue& victim = *queues[(worker + k) % size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.items.empty()) {
+                index = victim.items.front();
+                victim.items.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(unsigned worker) {
+        size_t index;
+        while (take(worker, index)) {
+            (*job)(index, worker);
+            if (remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                done.notify_all();
+            }
+        }
+    }
+
+    void workerLoop(unsigned worker) {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(stateMutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            work(worker);
+        }
+    }
+};